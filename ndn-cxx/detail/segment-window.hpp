@@ -0,0 +1,584 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_DETAIL_SEGMENT_WINDOW_HPP
+#define NDN_DETAIL_SEGMENT_WINDOW_HPP
+
+#include "ndn-cxx/detail/common.hpp"
+
+#include <bitset>
+#include <deque>
+#include <limits>
+#include <map>
+#include <vector>
+
+namespace ndn {
+namespace detail {
+
+/** \brief Upper bound on the number of segments for which a fetcher reserves buffer space in
+ *         advance, since the number of segments announced in FinalBlockId is not trusted.
+ */
+const uint64_t MAX_RESERVED_SEGMENTS = 65536;
+
+/** \brief Per-segment state of a window of segments, in a circular array.
+ *
+ *  An entry is stored in slot `segment number % capacity` of the array, which covers the segment
+ *  numbers from the lowest stored one to at most `capacity - 1` above it, so that lookup, insertion
+ *  and removal do not allocate. The array doubles when the span of stored segment numbers outgrows
+ *  it, up to \p maxCapacity slots. Entries that do not fit even then (e.g., a first segment far
+ *  ahead of segment zero) are kept in an overflow map; lower segment numbers are kept in the array
+ *  in preference to higher ones.
+ */
+template<typename T>
+class SegmentRing : noncopyable
+{
+public:
+  explicit
+  SegmentRing(size_t maxCapacity, size_t initialCapacity = 64)
+    : m_maxCapacity(roundUpToPowerOfTwo(maxCapacity))
+    , m_slots(std::min(roundUpToPowerOfTwo(initialCapacity), m_maxCapacity))
+  {
+  }
+
+  bool
+  empty() const
+  {
+    return size() == 0;
+  }
+
+  size_t
+  size() const
+  {
+    return m_nRingEntries + m_overflow.size();
+  }
+
+  /** \return the entry of \p segNum, or nullptr if there is none
+   */
+  T*
+  find(uint64_t segNum)
+  {
+    if (isInRing(segNum)) {
+      auto& slot = m_slots[getIndex(segNum)];
+      return slot ? &*slot : nullptr;
+    }
+    if (!m_overflow.empty()) {
+      auto it = m_overflow.find(segNum);
+      return it == m_overflow.end() ? nullptr : &it->second;
+    }
+    return nullptr;
+  }
+
+  /** \brief Construct the entry of \p segNum
+   *  \pre there is no entry for \p segNum
+   */
+  template<typename... Args>
+  T&
+  emplace(uint64_t segNum, Args&&... args)
+  {
+    BOOST_ASSERT(find(segNum) == nullptr);
+
+    if (m_nRingEntries > 0 && segNum < m_base && m_high - segNum >= m_maxCapacity) {
+      moveToOverflow(segNum + m_maxCapacity);
+    }
+
+    if (m_nRingEntries == 0) {
+      m_base = m_high = segNum;
+    }
+    else if (segNum < m_base) {
+      reserve(m_high - segNum + 1);
+      m_base = segNum;
+    }
+    else if (segNum - m_base >= m_slots.size()) {
+      if (segNum - m_base >= m_maxCapacity) {
+        return m_overflow.emplace(std::piecewise_construct, std::forward_as_tuple(segNum),
+                                  std::forward_as_tuple(std::forward<Args>(args)...)).first->second;
+      }
+      reserve(segNum - m_base + 1);
+    }
+
+    m_high = std::max(m_high, segNum);
+    ++m_nRingEntries;
+    auto& slot = m_slots[getIndex(segNum)];
+    slot.emplace(std::forward<Args>(args)...);
+    return *slot;
+  }
+
+  /** \brief Destroy the entry of \p segNum, if any
+   *  \return whether an entry was destroyed
+   */
+  bool
+  erase(uint64_t segNum)
+  {
+    if (isInRing(segNum)) {
+      auto& slot = m_slots[getIndex(segNum)];
+      if (!slot) {
+        return false;
+      }
+      slot = nullopt;
+      if (--m_nRingEntries > 0) {
+        while (!m_slots[getIndex(m_base)]) {
+          ++m_base;
+        }
+        while (!m_slots[getIndex(m_high)]) {
+          --m_high;
+        }
+      }
+      return true;
+    }
+    return m_overflow.erase(segNum) > 0;
+  }
+
+  /** \brief Destroy the entries of \p segNum and all higher segment numbers
+   *  \return number of destroyed entries
+   */
+  size_t
+  eraseFrom(uint64_t segNum)
+  {
+    size_t nErased = m_overflow.size();
+    m_overflow.erase(m_overflow.lower_bound(segNum), m_overflow.end());
+    nErased -= m_overflow.size();
+
+    if (m_nRingEntries > 0 && segNum <= m_high) {
+      for (uint64_t i = std::max(segNum, m_base); i <= m_high; ++i) {
+        auto& slot = m_slots[getIndex(i)];
+        if (slot) {
+          slot = nullopt;
+          --m_nRingEntries;
+          ++nErased;
+        }
+      }
+      if (m_nRingEntries > 0) {
+        m_high = segNum - 1;
+        while (!m_slots[getIndex(m_high)]) {
+          --m_high;
+        }
+      }
+    }
+    return nErased;
+  }
+
+  /** \return the lowest segment number that has an entry
+   *  \pre !empty()
+   */
+  uint64_t
+  front() const
+  {
+    BOOST_ASSERT(!empty());
+    if (m_overflow.empty()) {
+      return m_base;
+    }
+    uint64_t lowestOverflow = m_overflow.begin()->first;
+    return m_nRingEntries > 0 ? std::min(m_base, lowestOverflow) : lowestOverflow;
+  }
+
+  void
+  clear()
+  {
+    if (m_nRingEntries > 0) {
+      for (uint64_t i = m_base; i <= m_high; ++i) {
+        m_slots[getIndex(i)] = nullopt;
+      }
+      m_nRingEntries = 0;
+    }
+    m_overflow.clear();
+  }
+
+private:
+  static size_t
+  roundUpToPowerOfTwo(size_t n)
+  {
+    size_t p = 1;
+    while (p < n) {
+      p <<= 1;
+    }
+    return p;
+  }
+
+  size_t
+  getIndex(uint64_t segNum) const
+  {
+    return static_cast<size_t>(segNum) & (m_slots.size() - 1);
+  }
+
+  bool
+  isInRing(uint64_t segNum) const
+  {
+    return m_nRingEntries > 0 && segNum >= m_base && segNum - m_base < m_slots.size();
+  }
+
+  /** \brief Grow the array to hold at least \p span consecutive segment numbers
+   *  \pre span <= m_maxCapacity
+   */
+  void
+  reserve(uint64_t span)
+  {
+    if (span <= m_slots.size()) {
+      return;
+    }
+
+    std::vector<optional<T>> slots(roundUpToPowerOfTwo(static_cast<size_t>(span)));
+    for (uint64_t i = m_base; i <= m_high; ++i) {
+      auto& slot = m_slots[getIndex(i)];
+      if (slot) {
+        slots[static_cast<size_t>(i) & (slots.size() - 1)].emplace(std::move(*slot));
+      }
+    }
+    m_slots.swap(slots);
+  }
+
+  /** \brief Move the array entries of \p segNum and all higher segment numbers to the overflow map
+   */
+  void
+  moveToOverflow(uint64_t segNum)
+  {
+    for (uint64_t i = std::max(segNum, m_base); i <= m_high; ++i) {
+      auto& slot = m_slots[getIndex(i)];
+      if (slot) {
+        m_overflow.emplace(i, std::move(*slot));
+        slot = nullopt;
+        --m_nRingEntries;
+      }
+    }
+    if (m_nRingEntries == 0) {
+      return;
+    }
+    m_high = segNum - 1;
+    while (!m_slots[getIndex(m_high)]) {
+      --m_high;
+    }
+  }
+
+private:
+  const size_t m_maxCapacity;
+  std::vector<optional<T>> m_slots; ///< size is a power of two
+  size_t m_nRingEntries = 0;
+  uint64_t m_base = 0; ///< lowest segment number in m_slots, valid if m_nRingEntries > 0
+  uint64_t m_high = 0; ///< highest segment number in m_slots, valid if m_nRingEntries > 0
+  std::map<uint64_t, T> m_overflow;
+};
+
+/** \brief Set of received segment numbers, as a bitmap.
+ *
+ *  The bitmap starts at the lowest segment number not yet received, rounded down to a multiple
+ *  of 64, so its size is proportional to the spread of out-of-order segments rather than to
+ *  the number of segments received. The bitmap spans at most #MAX_WORDS words; segment numbers
+ *  beyond it (e.g., a bogus segment number received from a peer) are kept as ranges, and are
+ *  moved into the bitmap once it gets close enough to them.
+ *
+ *  Segment number `std::numeric_limits<uint64_t>::max()` cannot be stored.
+ */
+class SegmentBitmap
+{
+public:
+  /** \brief maximum number of bitmap words (32 KiB)
+   */
+  static constexpr size_t MAX_WORDS = 4096;
+
+  /** \return whether \p segNum was not already in the set
+   */
+  bool
+  insert(uint64_t segNum)
+  {
+    if (segNum < m_base || segNum == std::numeric_limits<uint64_t>::max()) {
+      return false;
+    }
+
+    uint64_t wordIndex = (segNum - m_base) / 64;
+    if (wordIndex >= MAX_WORDS) {
+      if (insertFar(segNum, segNum + 1) == 0) {
+        return false;
+      }
+      ++m_size;
+      return true;
+    }
+
+    if (wordIndex >= m_words.size()) {
+      m_words.resize(static_cast<size_t>(wordIndex) + 1, 0);
+    }
+    uint64_t& word = m_words[static_cast<size_t>(wordIndex)];
+    uint64_t bit = uint64_t(1) << (segNum % 64);
+    if ((word & bit) != 0) {
+      return false;
+    }
+    word |= bit;
+    ++m_size;
+
+    normalize();
+    return true;
+  }
+
+  /** \brief Add segment numbers in the half-open range [\p first, \p last)
+   *  \return number of segment numbers that were not already in the set
+   *
+   *  A range that starts at or below getFirstMissing() is added in time proportional to the
+   *  number of bitmap words, regardless of its length.
+   */
+  uint64_t
+  insertRange(uint64_t first, uint64_t last)
+  {
+    first = std::max(first, m_base);
+    if (first >= last) {
+      return 0;
+    }
+
+    uint64_t nInserted = fill(first, last);
+    m_size += nInserted;
+    normalize();
+    return nInserted;
+  }
+
+  /** \brief Add all segment numbers below \p segNum to an empty set
+   */
+  void
+  skipTo(uint64_t segNum)
+  {
+    BOOST_ASSERT(m_size == 0);
+    m_base = segNum - segNum % 64;
+    m_words.clear();
+    m_far.clear();
+    if (segNum % 64 != 0) {
+      m_words.push_back((uint64_t(1) << (segNum % 64)) - 1);
+    }
+    m_size = segNum;
+  }
+
+  bool
+  contains(uint64_t segNum) const
+  {
+    if (segNum < m_base) {
+      return true;
+    }
+    uint64_t wordIndex = (segNum - m_base) / 64;
+    if (wordIndex < m_words.size()) {
+      return (m_words[static_cast<size_t>(wordIndex)] & (uint64_t(1) << (segNum % 64))) != 0;
+    }
+    auto it = m_far.upper_bound(segNum);
+    return it != m_far.begin() && std::prev(it)->second > segNum;
+  }
+
+  /** \return number of segments in the set
+   */
+  uint64_t
+  size() const
+  {
+    return m_size;
+  }
+
+  /** \return the lowest segment number that is not in the set
+   */
+  uint64_t
+  getFirstMissing() const
+  {
+    uint64_t segNum = m_base;
+    while (contains(segNum)) {
+      ++segNum;
+    }
+    return segNum;
+  }
+
+  /** \return the set as sorted, disjoint, non-adjacent half-open ranges [first, last)
+   */
+  std::vector<std::pair<uint64_t, uint64_t>>
+  getRanges() const
+  {
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    auto add = [&ranges] (uint64_t first, uint64_t last) {
+      if (!ranges.empty() && ranges.back().second == first) {
+        ranges.back().second = last;
+      }
+      else {
+        ranges.emplace_back(first, last);
+      }
+    };
+
+    if (m_base > 0) {
+      ranges.emplace_back(0, m_base);
+    }
+    for (size_t i = 0; i < m_words.size(); ++i) {
+      uint64_t word = m_words[i];
+      for (uint64_t bit = 0; word != 0; ++bit, word >>= 1) {
+        if ((word & 1) != 0) {
+          uint64_t segNum = m_base + i * 64 + bit;
+          add(segNum, segNum + 1);
+        }
+      }
+    }
+    for (const auto& range : m_far) {
+      add(range.first, range.second);
+    }
+    return ranges;
+  }
+
+private:
+  static uint64_t
+  popcount(uint64_t word)
+  {
+    return std::bitset<64>(word).count();
+  }
+
+  /** \return the end of the segment numbers that can be stored in the bitmap
+   */
+  uint64_t
+  getWindowEnd() const
+  {
+    constexpr uint64_t span = MAX_WORDS * 64;
+    return m_base < std::numeric_limits<uint64_t>::max() - span ?
+           m_base + span : std::numeric_limits<uint64_t>::max();
+  }
+
+  /** \brief Add [\p first, \p last), where `m_base <= first < last`, without updating m_size
+   *  \return number of segment numbers that were not already in the set
+   */
+  uint64_t
+  fill(uint64_t first, uint64_t last)
+  {
+    if (first == m_base && m_words.size() * 64 <= last - m_base) {
+      // the range covers the whole bitmap: move the base instead of setting bits
+      uint64_t nInserted = last - first - eraseFar(first, last);
+      for (uint64_t word : m_words) {
+        nInserted -= popcount(word);
+      }
+      m_base = last - last % 64;
+      m_words.clear();
+      if (last % 64 != 0) {
+        m_words.push_back((uint64_t(1) << (last % 64)) - 1);
+      }
+      return nInserted;
+    }
+
+    uint64_t nInserted = 0;
+    uint64_t windowEnd = getWindowEnd();
+    if (last > windowEnd) {
+      nInserted += insertFar(std::max(first, windowEnd), last);
+      last = windowEnd;
+    }
+    if (first >= last) {
+      return nInserted;
+    }
+
+    auto lastWordIndex = static_cast<size_t>((last - 1 - m_base) / 64);
+    if (lastWordIndex >= m_words.size()) {
+      m_words.resize(lastWordIndex + 1, 0);
+    }
+    for (uint64_t segNum = first; segNum < last;) {
+      uint64_t& word = m_words[static_cast<size_t>((segNum - m_base) / 64)];
+      uint64_t firstBit = segNum % 64;
+      uint64_t endBit = std::min<uint64_t>(64, firstBit + (last - segNum));
+      uint64_t mask = endBit == 64 ? ~uint64_t(0) : (uint64_t(1) << endBit) - 1;
+      mask &= ~((uint64_t(1) << firstBit) - 1);
+      nInserted += popcount(mask & ~word);
+      word |= mask;
+      segNum += endBit - firstBit;
+    }
+    return nInserted;
+  }
+
+  /** \brief Add [\p first, \p last) to the ranges beyond the bitmap
+   *  \return number of segment numbers that were not already in the set
+   */
+  uint64_t
+  insertFar(uint64_t first, uint64_t last)
+  {
+    uint64_t nInserted = last - first;
+    uint64_t mergedFirst = first;
+    uint64_t mergedLast = last;
+
+    auto it = m_far.upper_bound(first);
+    if (it != m_far.begin() && std::prev(it)->second >= first) {
+      --it;
+    }
+    while (it != m_far.end() && it->first <= last) {
+      uint64_t overlapFirst = std::max(it->first, first);
+      uint64_t overlapLast = std::min(it->second, last);
+      if (overlapFirst < overlapLast) {
+        nInserted -= overlapLast - overlapFirst;
+      }
+      mergedFirst = std::min(mergedFirst, it->first);
+      mergedLast = std::max(mergedLast, it->second);
+      it = m_far.erase(it);
+    }
+    m_far.emplace_hint(it, mergedFirst, mergedLast);
+    return nInserted;
+  }
+
+  /** \brief Remove [\p first, \p last) from the ranges beyond the bitmap
+   *  \return number of segment numbers removed
+   */
+  uint64_t
+  eraseFar(uint64_t first, uint64_t last)
+  {
+    uint64_t nErased = 0;
+    auto it = m_far.upper_bound(first);
+    if (it != m_far.begin()) {
+      --it;
+    }
+    while (it != m_far.end() && it->first < last) {
+      uint64_t rangeFirst = it->first;
+      uint64_t rangeLast = it->second;
+      if (rangeLast <= first) {
+        ++it;
+        continue;
+      }
+      it = m_far.erase(it);
+      nErased += std::min(rangeLast, last) - std::max(rangeFirst, first);
+      if (rangeFirst < first) {
+        m_far.emplace_hint(it, rangeFirst, first);
+      }
+      if (rangeLast > last) {
+        m_far.emplace_hint(it, last, rangeLast);
+        break;
+      }
+    }
+    return nErased;
+  }
+
+  /** \brief Drop full words from the front of the bitmap, and move ranges that came within
+   *         reach into it
+   */
+  void
+  normalize()
+  {
+    while (true) {
+      while (!m_words.empty() && m_words.front() == ~uint64_t(0)) {
+        m_words.pop_front();
+        m_base += 64;
+      }
+      if (m_far.empty() || m_far.begin()->first >= getWindowEnd()) {
+        return;
+      }
+      auto range = *m_far.begin();
+      m_far.erase(m_far.begin());
+      fill(range.first, range.second); // already counted in m_size
+    }
+  }
+
+private:
+  uint64_t m_base = 0; ///< all segment numbers below it are in the set; a multiple of 64
+  std::deque<uint64_t> m_words;
+  /// disjoint, non-adjacent half-open ranges at or beyond getWindowEnd()
+  std::map<uint64_t, uint64_t> m_far;
+  uint64_t m_size = 0;
+};
+
+} // namespace detail
+} // namespace ndn
+
+#endif // NDN_DETAIL_SEGMENT_WINDOW_HPP
@@ -57,6 +57,15 @@ public:
   void
   removeTag() const;
 
+  /** \brief replace all tag items with those stored in \p other
+   *  \note Tags can be copied even onto a const tag host instance
+   */
+  void
+  copyTagsFrom(const TagHost& other) const
+  {
+    m_tags = other.m_tags;
+  }
+
 private:
   mutable std::map<int, shared_ptr<Tag>> m_tags;
 };
@@ -0,0 +1,338 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/face-counters.hpp"
+#include "ndn-cxx/face.hpp"
+#include "ndn-cxx/encoding/block-helpers.hpp"
+#include "ndn-cxx/encoding/encoding-buffer.hpp"
+#include "ndn-cxx/encoding/tlv-nfd.hpp"
+#include "ndn-cxx/mgmt/status-dataset-context.hpp"
+
+#include <cmath>
+
+namespace ndn {
+
+constexpr size_t LatencyHistogram::N_BUCKETS;
+
+time::microseconds
+LatencyHistogram::Snapshot::getMean() const
+{
+  if (nSamples == 0) {
+    return time::microseconds::zero();
+  }
+  return sum / nSamples;
+}
+
+time::microseconds
+LatencyHistogram::Snapshot::getQuantile(double q) const
+{
+  if (nSamples == 0) {
+    return time::microseconds::zero();
+  }
+
+  auto rank = static_cast<uint64_t>(std::ceil(q * nSamples));
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < N_BUCKETS; ++i) {
+    cumulative += buckets[i];
+    if (cumulative >= rank && cumulative > 0) {
+      return time::microseconds(uint64_t{1} << i);
+    }
+  }
+  return time::microseconds(uint64_t{1} << (N_BUCKETS - 1));
+}
+
+size_t
+LatencyHistogram::getBucketIndex(time::nanoseconds latency) noexcept
+{
+  auto us = time::duration_cast<time::microseconds>(latency).count();
+  if (us <= 0) {
+    return 0;
+  }
+
+  size_t width = 0;
+  for (auto v = static_cast<uint64_t>(us); v != 0; v >>= 1) {
+    ++width;
+  }
+  return std::min(width, N_BUCKETS - 1);
+}
+
+void
+LatencyHistogram::record(time::nanoseconds latency) noexcept
+{
+  m_buckets[getBucketIndex(latency)].fetch_add(1, std::memory_order_relaxed);
+  m_nSamples.fetch_add(1, std::memory_order_relaxed);
+  auto us = time::duration_cast<time::microseconds>(latency).count();
+  m_sumMicroseconds.fetch_add(static_cast<uint64_t>(std::max<decltype(us)>(us, 0)),
+                              std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot
+LatencyHistogram::snapshot() const noexcept
+{
+  Snapshot s;
+  for (size_t i = 0; i < N_BUCKETS; ++i) {
+    s.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+  }
+  s.nSamples = m_nSamples.load(std::memory_order_relaxed);
+  s.sum = time::microseconds(m_sumMicroseconds.load(std::memory_order_relaxed));
+  return s;
+}
+
+void
+FaceCounters::trackLatency(const Name& prefix)
+{
+  std::lock_guard<std::mutex> lock(m_trackMutex);
+
+  auto current = std::atomic_load(&m_prefixHistograms);
+  for (const auto& item : *current) {
+    if (item.first == prefix) {
+      return;
+    }
+  }
+
+  auto updated = make_shared<PrefixHistograms>(*current);
+  updated->emplace_back(prefix, make_shared<LatencyHistogram>());
+  std::atomic_store(&m_prefixHistograms, shared_ptr<const PrefixHistograms>(std::move(updated)));
+  m_hasPrefixHistograms.store(true, std::memory_order_release);
+}
+
+void
+FaceCounters::recordLatency(const Name& interestName, time::nanoseconds latency) noexcept
+{
+  this->latency.record(latency);
+  if (!m_hasPrefixHistograms.load(std::memory_order_acquire)) {
+    return;
+  }
+
+  auto histograms = std::atomic_load(&m_prefixHistograms);
+  for (const auto& item : *histograms) {
+    if (item.first.isPrefixOf(interestName)) {
+      item.second->record(latency);
+    }
+  }
+}
+
+FaceCounters::Snapshot
+FaceCounters::snapshot() const
+{
+  Snapshot s;
+  s.nInInterests = nInInterests;
+  s.nOutInterests = nOutInterests;
+  s.nInData = nInData;
+  s.nOutData = nOutData;
+  s.nInNacks = nInNacks;
+  s.nOutNacks = nOutNacks;
+  s.nInBytes = nInBytes;
+  s.nOutBytes = nOutBytes;
+  s.nSatisfiedInterests = nSatisfiedInterests;
+  s.nDispatchedInterests = nDispatchedInterests;
+  s.latency = latency.snapshot();
+
+  auto histograms = std::atomic_load(&m_prefixHistograms);
+  s.prefixLatency.reserve(histograms->size());
+  for (const auto& item : *histograms) {
+    s.prefixLatency.emplace_back(item.first, item.second->snapshot());
+  }
+  return s;
+}
+
+static size_t
+prependHistogram(EncodingBuffer& encoder, const LatencyHistogram::Snapshot& histogram,
+                 const Name* prefix)
+{
+  size_t totalLength = 0;
+  for (size_t i = LatencyHistogram::N_BUCKETS; i > 0; --i) {
+    totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::LatencyBucket,
+                                                  histogram.buckets[i - 1]);
+  }
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::LatencySum,
+                                                static_cast<uint64_t>(histogram.sum.count()));
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::NLatencySamples,
+                                                histogram.nSamples);
+  if (prefix != nullptr) {
+    totalLength += prefix->wireEncode(encoder);
+  }
+
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::counters::LatencyHistogram);
+  return totalLength;
+}
+
+static LatencyHistogram::Snapshot
+decodeHistogram(const Block& wire, optional<Name>& prefix)
+{
+  wire.parse();
+
+  LatencyHistogram::Snapshot histogram;
+  size_t bucket = 0;
+  for (const auto& element : wire.elements()) {
+    switch (element.type()) {
+      case tlv::Name:
+        prefix.emplace(element);
+        break;
+      case tlv::counters::NLatencySamples:
+        histogram.nSamples = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::LatencySum:
+        histogram.sum = time::microseconds(readNonNegativeInteger(element));
+        break;
+      case tlv::counters::LatencyBucket:
+        if (bucket >= LatencyHistogram::N_BUCKETS) {
+          NDN_THROW(FaceCounters::Snapshot::Error("Too many LatencyBucket elements"));
+        }
+        histogram.buckets[bucket++] = readNonNegativeInteger(element);
+        break;
+      default:
+        if (tlv::isCriticalType(element.type())) {
+          NDN_THROW(FaceCounters::Snapshot::Error("Unrecognized element of critical type " +
+                                                  to_string(element.type())));
+        }
+        break;
+    }
+  }
+  return histogram;
+}
+
+FaceCounters::Snapshot::Snapshot(const Block& block)
+{
+  this->wireDecode(block);
+}
+
+Block
+FaceCounters::Snapshot::wireEncode() const
+{
+  EncodingBuffer encoder;
+  size_t totalLength = 0;
+
+  for (auto i = prefixLatency.rbegin(); i != prefixLatency.rend(); ++i) {
+    totalLength += prependHistogram(encoder, i->second, &i->first);
+  }
+  totalLength += prependHistogram(encoder, latency, nullptr);
+
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::SendQueuePackets,
+                                                sendQueuePackets);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::SendQueueBytes,
+                                                sendQueueBytes);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::NPendingInterests,
+                                                nPendingInterests);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::counters::NDispatchedInterests,
+                                                nDispatchedInterests);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NSatisfiedInterests,
+                                                nSatisfiedInterests);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NOutBytes, nOutBytes);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NInBytes, nInBytes);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NOutNacks, nOutNacks);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NOutData, nOutData);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NOutInterests, nOutInterests);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NInNacks, nInNacks);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NInData, nInData);
+  totalLength += prependNonNegativeIntegerBlock(encoder, tlv::nfd::NInInterests, nInInterests);
+
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(tlv::counters::FaceCounters);
+  return encoder.block();
+}
+
+void
+FaceCounters::Snapshot::wireDecode(const Block& wire)
+{
+  if (wire.type() != tlv::counters::FaceCounters) {
+    NDN_THROW(Error("FaceCounters", wire.type()));
+  }
+  wire.parse();
+
+  *this = Snapshot();
+  bool hasOverallLatency = false;
+  for (const auto& element : wire.elements()) {
+    switch (element.type()) {
+      case tlv::nfd::NInInterests:
+        nInInterests = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NInData:
+        nInData = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NInNacks:
+        nInNacks = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NOutInterests:
+        nOutInterests = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NOutData:
+        nOutData = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NOutNacks:
+        nOutNacks = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NInBytes:
+        nInBytes = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NOutBytes:
+        nOutBytes = readNonNegativeInteger(element);
+        break;
+      case tlv::nfd::NSatisfiedInterests:
+        nSatisfiedInterests = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::NDispatchedInterests:
+        nDispatchedInterests = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::NPendingInterests:
+        nPendingInterests = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::SendQueueBytes:
+        sendQueueBytes = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::SendQueuePackets:
+        sendQueuePackets = readNonNegativeInteger(element);
+        break;
+      case tlv::counters::LatencyHistogram: {
+        optional<Name> prefix;
+        auto histogram = decodeHistogram(element, prefix);
+        if (prefix) {
+          prefixLatency.emplace_back(std::move(*prefix), histogram);
+        }
+        else if (!hasOverallLatency) {
+          latency = histogram;
+          hasOverallLatency = true;
+        }
+        else {
+          NDN_THROW(Error("Duplicate overall LatencyHistogram"));
+        }
+        break;
+      }
+      default:
+        if (tlv::isCriticalType(element.type())) {
+          NDN_THROW(Error("Unrecognized element of critical type " + to_string(element.type())));
+        }
+        break;
+    }
+  }
+}
+
+std::function<void(const Name&, const Interest&, mgmt::StatusDatasetContext&)>
+makeFaceCountersDatasetHandler(const Face& face)
+{
+  return [&face] (const Name&, const Interest&, mgmt::StatusDatasetContext& context) {
+    context.append(face.getCountersSnapshot().wireEncode());
+    context.end();
+  };
+}
+
+} // namespace ndn
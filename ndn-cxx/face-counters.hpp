@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_FACE_COUNTERS_HPP
+#define NDN_FACE_COUNTERS_HPP
+
+#include "ndn-cxx/name.hpp"
+#include "ndn-cxx/util/time.hpp"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+
+namespace ndn {
+
+class Face;
+class Interest;
+
+namespace mgmt {
+class StatusDatasetContext;
+} // namespace mgmt
+
+namespace tlv {
+namespace counters {
+
+/** @brief TLV-TYPE numbers of the FaceCounters dataset
+ *
+ *  Packet and byte counters reuse the TLV-TYPE numbers of NFD FaceStatus (see tlv-nfd.hpp).
+ */
+enum {
+  FaceCounters         = 128,
+  NPendingInterests    = 133,
+  NDispatchedInterests = 155,
+  SendQueueBytes       = 156,
+  SendQueuePackets     = 157,
+  LatencyHistogram     = 160,
+  NLatencySamples      = 161,
+  LatencySum           = 162,
+  LatencyBucket        = 163,
+};
+
+} // namespace counters
+} // namespace tlv
+
+/** @brief Histogram of Interest-Data latencies
+ *
+ *  Recording is lock-free and uses relaxed atomic increments; a snapshot taken concurrently
+ *  with recording may be off by the samples being recorded.
+ */
+class LatencyHistogram : noncopyable
+{
+public:
+  /** @brief number of buckets
+   *
+   *  Bucket 0 counts latencies below 1 microsecond. Bucket i (i > 0) counts latencies in
+   *  [2^(i-1), 2^i) microseconds. The last bucket also counts all longer latencies.
+   */
+  static constexpr size_t N_BUCKETS = 32;
+
+  class Snapshot
+  {
+  public:
+    /** @return mean latency, or zero if there are no samples
+     */
+    time::microseconds
+    getMean() const;
+
+    /** @return upper bound of the bucket that contains the @p q quantile, or zero if there
+     *          are no samples
+     *  @param q quantile in [0, 1]
+     */
+    time::microseconds
+    getQuantile(double q) const;
+
+  public:
+    std::array<uint64_t, N_BUCKETS> buckets{};
+    uint64_t nSamples = 0;
+    time::microseconds sum = time::microseconds::zero();
+  };
+
+  void
+  record(time::nanoseconds latency) noexcept;
+
+  Snapshot
+  snapshot() const noexcept;
+
+  static size_t
+  getBucketIndex(time::nanoseconds latency) noexcept;
+
+private:
+  std::array<std::atomic<uint64_t>, N_BUCKETS> m_buckets{};
+  std::atomic<uint64_t> m_nSamples{0};
+  std::atomic<uint64_t> m_sumMicroseconds{0};
+};
+
+/** @brief Packet counters and latency histograms of a Face
+ *
+ *  Counters are updated by the Face on its io_service thread with relaxed atomic increments,
+ *  and can be read from any thread.
+ */
+class FaceCounters : noncopyable
+{
+public:
+  /** @brief A monotonically increasing counter
+   */
+  class Counter : noncopyable
+  {
+  public:
+    void
+    increment(uint64_t n = 1) noexcept
+    {
+      m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t
+    get() const noexcept
+    {
+      return m_value.load(std::memory_order_relaxed);
+    }
+
+    operator uint64_t() const noexcept
+    {
+      return get();
+    }
+
+  private:
+    std::atomic<uint64_t> m_value{0};
+  };
+
+  /** @brief Point-in-time copy of FaceCounters, plus gauges of the Face
+   *
+   *  A snapshot is encoded as one item of the FaceCounters StatusDataset.
+   */
+  class Snapshot
+  {
+  public:
+    class Error : public tlv::Error
+    {
+    public:
+      using tlv::Error::Error;
+    };
+
+    Snapshot() = default;
+
+    explicit
+    Snapshot(const Block& block);
+
+    Block
+    wireEncode() const;
+
+    void
+    wireDecode(const Block& wire);
+
+  public:
+    uint64_t nInInterests = 0;
+    uint64_t nOutInterests = 0;
+    uint64_t nInData = 0;
+    uint64_t nOutData = 0;
+    uint64_t nInNacks = 0;
+    uint64_t nOutNacks = 0;
+    uint64_t nInBytes = 0;
+    uint64_t nOutBytes = 0;
+    uint64_t nSatisfiedInterests = 0;
+    uint64_t nDispatchedInterests = 0;
+
+    uint64_t nPendingInterests = 0;
+    uint64_t sendQueueBytes = 0;
+    uint64_t sendQueuePackets = 0;
+
+    LatencyHistogram::Snapshot latency;
+    std::vector<std::pair<Name, LatencyHistogram::Snapshot>> prefixLatency;
+  };
+
+  /** @brief Maintain a separate latency histogram for Interests under @p prefix
+   *
+   *  An Interest is recorded in the histogram of every tracked prefix that matches it,
+   *  in addition to the overall histogram. This method is thread-safe; tracking an already
+   *  tracked prefix has no effect.
+   */
+  void
+  trackLatency(const Name& prefix);
+
+  /** @brief Record the latency of a satisfied Interest
+   */
+  void
+  recordLatency(const Name& interestName, time::nanoseconds latency) noexcept;
+
+  /** @brief Copy the counters into a Snapshot
+   *  @note Gauges in the returned Snapshot are zero; use Face::getCountersSnapshot() to fill them.
+   */
+  Snapshot
+  snapshot() const;
+
+public:
+  Counter nInInterests;
+  Counter nOutInterests;
+  Counter nInData;
+  Counter nOutData;
+  Counter nInNacks;
+  Counter nOutNacks;
+  Counter nInBytes;
+  Counter nOutBytes;
+  Counter nSatisfiedInterests; ///< expressed Interests satisfied by Data
+  Counter nDispatchedInterests; ///< Interests delivered to InterestFilter callbacks
+  LatencyHistogram latency; ///< Interest-Data latency of all satisfied Interests
+
+private:
+  using PrefixHistograms = std::vector<std::pair<Name, shared_ptr<LatencyHistogram>>>;
+
+  std::mutex m_trackMutex; ///< serializes trackLatency() calls
+  /** @brief replaced (never modified) upon trackLatency()
+   *
+   *  recordLatency() does not take m_trackMutex, but std::atomic_load on a shared_ptr is not
+   *  lock-free: libstdc++ guards it with a spinlock from a process-wide pool. recordLatency()
+   *  skips the load until a prefix is tracked.
+   */
+  shared_ptr<const PrefixHistograms> m_prefixHistograms = make_shared<PrefixHistograms>();
+  std::atomic<bool> m_hasPrefixHistograms{false};
+};
+
+/** @brief Make a StatusDataset handler that publishes a snapshot of the counters of @p face
+ *
+ *  Example:
+ *  @code
+ *  dispatcher.addStatusDataset("face-counters", makeAcceptAllAuthorization(),
+ *                              makeFaceCountersDatasetHandler(face));
+ *  @endcode
+ *
+ *  @note @p face must outlive the returned handler.
+ */
+std::function<void(const Name&, const Interest&, mgmt::StatusDatasetContext&)>
+makeFaceCountersDatasetHandler(const Face& face);
+
+} // namespace ndn
+
+#endif // NDN_FACE_COUNTERS_HPP
@@ -151,13 +151,27 @@ Face::construct(shared_ptr<Transport> transport, KeyChain& keyChain)
     BOOST_ASSERT(transport != nullptr);
   }
   m_transport = std::move(transport);
+  m_transport->setSendQueueStateCallback([this] (bool isHigh) {
+    if (isHigh) {
+      onSendQueueHigh();
+    }
+    else {
+      onSendQueueDrained();
+    }
+  });
 
   IO_CAPTURE_WEAK_IMPL(post) {
     impl->ensureConnected(false);
   } IO_CAPTURE_WEAK_IMPL_END
 }
 
-Face::~Face() = default;
+Face::~Face()
+{
+  // the transport may outlive this Face while it has outstanding asynchronous operations
+  if (m_transport != nullptr) {
+    m_transport->setSendQueueStateCallback(nullptr);
+  }
+}
 
 PendingInterestHandle
 Face::expressInterest(const Interest& interest,
@@ -177,6 +191,37 @@ Face::expressInterest(const Interest& interest,
   return PendingInterestHandle(m_impl, id);
 }
 
+std::vector<PendingInterestHandle>
+Face::expressInterests(const std::vector<Interest>& interests,
+                       const DataCallback& afterSatisfied,
+                       const NackCallback& afterNacked,
+                       const TimeoutCallback& afterTimeout)
+{
+  // every Interest is encoded before any of them is expressed, so that an oversized Interest
+  // leaves the whole batch unexpressed
+  auto batch = make_shared<std::vector<Impl::BatchedInterest>>();
+  batch->reserve(interests.size());
+  for (const auto& interest : interests) {
+    auto interest2 = make_shared<Interest>(interest);
+    interest2->getNonce();
+    Block wire = Impl::encodeInterest(*interest2);
+    batch->push_back({0, std::move(interest2), std::move(wire)});
+  }
+
+  std::vector<PendingInterestHandle> handles;
+  handles.reserve(batch->size());
+  for (auto& item : *batch) {
+    item.id = m_impl->m_pendingInterestTable.allocateId();
+    handles.push_back(PendingInterestHandle(m_impl, item.id));
+  }
+
+  IO_CAPTURE_WEAK_IMPL(post) {
+    impl->expressInterests(*batch, afterSatisfied, afterNacked, afterTimeout);
+  } IO_CAPTURE_WEAK_IMPL_END
+
+  return handles;
+}
+
 void
 Face::removeAllPendingInterests()
 {
@@ -207,6 +252,51 @@ Face::put(lp::Nack nack)
   } IO_CAPTURE_WEAK_IMPL_END
 }
 
+bool
+Face::tryPut(const Data& data)
+{
+  if (m_transport->isSendQueueHigh()) {
+    return false;
+  }
+
+  m_impl->putData(data);
+  return true;
+}
+
+void
+Face::setSendQueueWatermarks(const Transport::SendQueueWatermarks& watermarks)
+{
+  m_transport->setSendQueueWatermarks(watermarks);
+}
+
+size_t
+Face::getSendQueueBytes() const noexcept
+{
+  return m_transport->getSendQueueBytes();
+}
+
+size_t
+Face::getSendQueuePackets() const noexcept
+{
+  return m_transport->getSendQueuePackets();
+}
+
+bool
+Face::isSendQueueHigh() const noexcept
+{
+  return m_transport->isSendQueueHigh();
+}
+
+FaceCounters::Snapshot
+Face::getCountersSnapshot() const
+{
+  auto snapshot = m_counters.snapshot();
+  snapshot.nPendingInterests = getNPendingInterests();
+  snapshot.sendQueueBytes = getSendQueueBytes();
+  snapshot.sendQueuePackets = getSendQueuePackets();
+  return snapshot;
+}
+
 RegisteredPrefixHandle
 Face::setInterestFilter(const InterestFilter& filter, const InterestCallback& onInterest,
                         const RegisterPrefixFailureCallback& onFailure,
@@ -316,6 +406,7 @@ Face::onReceiveElement(const Block& blockFromDaemon)
   Buffer::const_iterator begin, end;
   std::tie(begin, end) = lpPacket.get<lp::FragmentField>();
   Block netPacket(&*begin, std::distance(begin, end));
+  m_counters.nInBytes.increment(blockFromDaemon.size());
   switch (netPacket.type()) {
     case tlv::Interest: {
       auto interest = make_shared<Interest>(netPacket);
@@ -324,11 +415,13 @@ Face::onReceiveElement(const Block& blockFromDaemon)
         nack->setHeader(lpPacket.get<lp::NackField>());
         extractLpLocalFields(*nack, lpPacket);
         NDN_LOG_DEBUG(">N " << nack->getInterest() << '~' << nack->getHeader().getReason());
+        m_counters.nInNacks.increment();
         m_impl->nackPendingInterests(*nack);
       }
       else {
         extractLpLocalFields(*interest, lpPacket);
         NDN_LOG_DEBUG(">I " << *interest);
+        m_counters.nInInterests.increment();
         m_impl->processIncomingInterest(std::move(interest));
       }
       break;
@@ -337,6 +430,7 @@ Face::onReceiveElement(const Block& blockFromDaemon)
       auto data = make_shared<Data>(netPacket);
       extractLpLocalFields(*data, lpPacket);
       NDN_LOG_DEBUG(">D " << data->getName());
+      m_counters.nInData.increment();
       m_impl->satisfyPendingInterests(*data);
       break;
     }
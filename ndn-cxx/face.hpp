@@ -23,6 +23,7 @@
 #define NDN_FACE_HPP
 
 #include "ndn-cxx/data.hpp"
+#include "ndn-cxx/face-counters.hpp"
 #include "ndn-cxx/interest.hpp"
 #include "ndn-cxx/interest-filter.hpp"
 #include "ndn-cxx/detail/asio-fwd.hpp"
@@ -31,11 +32,11 @@
 #include "ndn-cxx/lp/nack.hpp"
 #include "ndn-cxx/security/key-chain.hpp"
 #include "ndn-cxx/security/signing-info.hpp"
+#include "ndn-cxx/transport/transport.hpp"
+#include "ndn-cxx/util/signal.hpp"
 
 namespace ndn {
 
-class Transport;
-
 class PendingInterestHandle;
 class RegisteredPrefixHandle;
 class InterestFilterHandle;
@@ -237,6 +238,29 @@ public: // consumer
                   const NackCallback& afterNacked,
                   const TimeoutCallback& afterTimeout);
 
+  /**
+   * @brief Express a batch of Interests
+   *
+   * All Interests are inserted into the pending Interest table and handed to the transport
+   * together, so that a stream transport writes the whole batch with a single gather write,
+   * instead of one write per Interest.
+   *
+   * @param interests the Interests; copies will be made, so that the caller is not
+   *                  required to maintain the arguments unchanged
+   * @param afterSatisfied function to be invoked if Data is returned for any of the Interests
+   * @param afterNacked function to be invoked if Network NACK is returned for any of the Interests
+   * @param afterTimeout function to be invoked if neither Data nor Network NACK
+   *                     is returned within InterestLifetime for any of the Interests
+   * @throw OversizedPacketError encoded size of any of the Interests exceeds MAX_NDN_PACKET_SIZE;
+   *                              none of the Interests is expressed in this case
+   * @return Handles for canceling the pending Interests, in the same order as @p interests.
+   */
+  std::vector<PendingInterestHandle>
+  expressInterests(const std::vector<Interest>& interests,
+                   const DataCallback& afterSatisfied,
+                   const NackCallback& afterNacked,
+                   const TimeoutCallback& afterTimeout);
+
   /**
    * @brief Cancel all previously expressed Interests
    */
@@ -363,6 +387,87 @@ public: // producer
   void
   put(lp::Nack nack);
 
+  /**
+   * @brief Publish data packet unless the send queue is high
+   * @return whether the Data has been accepted
+   *
+   * Unlike put(), the Data is encoded and handed to the transport immediately, so that a
+   * producer calling tryPut() in a loop observes the growth of the send queue. Therefore,
+   * this method must be called from the thread running the io_service of this face.
+   * If the send queue has reached a high watermark, the Data is refused and the producer
+   * should wait for onSendQueueDrained before publishing more.
+   *
+   * @throw OversizedPacketError encoded Data size exceeds MAX_NDN_PACKET_SIZE
+   * @sa setSendQueueWatermarks()
+   */
+  bool
+  tryPut(const Data& data);
+
+public: // send queue
+  /**
+   * @brief Set watermarks of the transport send queue
+   * @throw std::invalid_argument a low watermark is greater than the corresponding high watermark
+   *
+   * By default, the high watermarks are unlimited, and onSendQueueHigh is never emitted.
+   */
+  void
+  setSendQueueWatermarks(const Transport::SendQueueWatermarks& watermarks);
+
+  /**
+   * @brief Returns the number of bytes queued in the transport but not yet written to the socket.
+   */
+  size_t
+  getSendQueueBytes() const noexcept;
+
+  /**
+   * @brief Returns the number of packets queued in the transport but not yet written to the socket.
+   */
+  size_t
+  getSendQueuePackets() const noexcept;
+
+  /**
+   * @brief Returns whether the send queue has reached a high watermark and not yet drained.
+   */
+  bool
+  isSendQueueHigh() const noexcept;
+
+public: // counters
+  /**
+   * @brief Returns packet counters and latency histograms of this face.
+   *
+   * The counters can be read from any thread. Use FaceCounters::trackLatency to collect
+   * Interest-Data latency of specific prefixes.
+   */
+  FaceCounters&
+  getCounters() noexcept
+  {
+    return m_counters;
+  }
+
+  const FaceCounters&
+  getCounters() const noexcept
+  {
+    return m_counters;
+  }
+
+  /**
+   * @brief Returns a snapshot of the counters, including the current PIT size and send queue depth.
+   * @sa makeFaceCountersDatasetHandler
+   */
+  FaceCounters::Snapshot
+  getCountersSnapshot() const;
+
+public: // signals
+  /**
+   * @brief Emitted when the send queue reaches a high watermark
+   */
+  util::Signal<Face> onSendQueueHigh;
+
+  /**
+   * @brief Emitted when the send queue drops to the low watermarks after having been high
+   */
+  util::Signal<Face> onSendQueueDrained;
+
 public: // IO routine
   /**
    * @brief Process any data to receive or call timeout callbacks.
@@ -463,6 +568,8 @@ private:
 
   shared_ptr<Transport> m_transport;
 
+  FaceCounters m_counters;
+
   /**
    * @brief If not null, a pointer to an internal KeyChain owned by this Face.
    * @note If a KeyChain is supplied to constructor, this pointer will be null,
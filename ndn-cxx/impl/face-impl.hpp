@@ -97,16 +97,65 @@ public: // consumer
     auto& entry = m_pendingInterestTable.put(id, std::move(interest), afterSatisfied, afterNacked,
                                              afterTimeout, ref(m_scheduler));
 
-    lp::Packet lpPacket;
-    addFieldFromTag<lp::NextHopFaceIdField, lp::NextHopFaceIdTag>(lpPacket, interest2);
-    addFieldFromTag<lp::CongestionMarkField, lp::CongestionMarkTag>(lpPacket, interest2);
-
     entry.recordForwarding();
-    m_face.m_transport->send(finishEncoding(std::move(lpPacket), interest2.wireEncode(),
-                                            'I', interest2.getName()));
+    sendToForwarder(encodeInterest(interest2), m_face.m_counters.nOutInterests);
     dispatchInterest(entry, interest2);
   }
 
+  /** @brief An Interest of a batch, encoded before the batch is expressed
+   */
+  struct BatchedInterest
+  {
+    detail::RecordId id;
+    shared_ptr<const Interest> interest;
+    Block wire;
+  };
+
+  /** @pre every Interest of @p batch has been encoded with encodeInterest()
+   */
+  void
+  expressInterests(const std::vector<BatchedInterest>& batch,
+                   const DataCallback& afterSatisfied,
+                   const NackCallback& afterNacked,
+                   const TimeoutCallback& afterTimeout)
+  {
+    this->ensureConnected(true);
+
+    std::vector<Block> wires;
+    wires.reserve(batch.size());
+    for (const auto& item : batch) {
+      NDN_LOG_DEBUG("<I " << *item.interest);
+      auto& entry = m_pendingInterestTable.put(item.id, item.interest, afterSatisfied, afterNacked,
+                                               afterTimeout, ref(m_scheduler));
+      entry.recordForwarding();
+      wires.push_back(item.wire);
+      m_face.m_counters.nOutBytes.increment(item.wire.size());
+    }
+    m_face.m_counters.nOutInterests.increment(wires.size());
+    m_face.m_transport->send(wires);
+
+    // local InterestFilters may erase pending Interests, so look up each entry again
+    for (const auto& item : batch) {
+      auto* entry = m_pendingInterestTable.get(item.id);
+      if (entry != nullptr) {
+        dispatchInterest(*entry, *item.interest);
+      }
+    }
+  }
+
+  /** @brief Encode an expressed Interest, including its NDNLPv2 fields
+   *  @throw Face::OversizedPacketError wire encoding exceeds limit
+   */
+  static Block
+  encodeInterest(const Interest& interest)
+  {
+    lp::Packet lpPacket;
+    addFieldFromTag<lp::NextHopFaceIdField, lp::NextHopFaceIdTag>(lpPacket, interest);
+    addFieldFromTag<lp::CongestionMarkField, lp::CongestionMarkTag>(lpPacket, interest);
+
+    return finishEncoding(std::move(lpPacket), interest.wireEncode(), 'I', interest.getName());
+  }
+
   void
   asyncRemovePendingInterest(detail::RecordId id)
   {
@@ -138,6 +187,9 @@ public: // consumer
 
       if (entry.getOrigin() == PendingInterestOrigin::APP) {
         hasAppMatch = true;
+        m_face.m_counters.nSatisfiedInterests.increment();
+        m_face.m_counters.recordLatency(entry.getInterest()->getName(),
+                                        time::steady_clock::now() - entry.getExpressTime());
         entry.invokeDataCallback(data);
       }
       else {
@@ -225,8 +277,8 @@ public: // producer
     addFieldFromTag<lp::CachePolicyField, lp::CachePolicyTag>(lpPacket, data);
     addFieldFromTag<lp::CongestionMarkField, lp::CongestionMarkTag>(lpPacket, data);
 
-    m_face.m_transport->send(finishEncoding(std::move(lpPacket), data.wireEncode(),
-                                            'D', data.getName()));
+    sendToForwarder(finishEncoding(std::move(lpPacket), data.wireEncode(), 'D', data.getName()),
+                    m_face.m_counters.nOutData);
   }
 
   void
@@ -245,8 +297,8 @@ public: // producer
     addFieldFromTag<lp::CongestionMarkField, lp::CongestionMarkTag>(lpPacket, *outNack);
 
     const Interest& interest = outNack->getInterest();
-    m_face.m_transport->send(finishEncoding(std::move(lpPacket), interest.wireEncode(),
-                                            'N', interest.getName()));
+    sendToForwarder(finishEncoding(std::move(lpPacket), interest.wireEncode(), 'N', interest.getName()),
+                    m_face.m_counters.nOutNacks);
   }
 
 public: // prefix registration
@@ -330,7 +382,7 @@ private:
    *  @return wire encoding of either NDNLP or bare network packet
    *  @throw Face::OversizedPacketError wire encoding exceeds limit
    */
-  Block
+  static Block
   finishEncoding(lp::Packet&& lpPacket, Block wire, char pktType, const Name& name)
   {
     if (!lpPacket.empty()) {
@@ -345,6 +397,14 @@ private:
     return wire;
   }
 
+  void
+  sendToForwarder(const Block& wire, FaceCounters::Counter& packetCounter)
+  {
+    packetCounter.increment();
+    m_face.m_counters.nOutBytes.increment(wire.size());
+    m_face.m_transport->send(wire);
+  }
+
   void
   dispatchInterest(PendingInterest& entry, const Interest& interest)
   {
@@ -354,6 +414,7 @@ private:
       }
       NDN_LOG_DEBUG("   matches " << filter.getFilter());
       entry.recordForwarding();
+      m_face.m_counters.nDispatchedInterests.increment();
       filter.invokeInterestCallback(interest);
     });
   }
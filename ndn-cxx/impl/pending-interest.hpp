@@ -69,6 +69,7 @@ public:
                   Scheduler& scheduler)
     : m_interest(std::move(interest))
     , m_origin(PendingInterestOrigin::APP)
+    , m_expressTime(time::steady_clock::now())
     , m_dataCallback(dataCallback)
     , m_nackCallback(nackCallback)
     , m_timeoutCallback(timeoutCallback)
@@ -98,6 +99,16 @@ public:
     return m_origin;
   }
 
+  /**
+   * @brief Returns when the Interest was expressed by the application
+   * @note Meaningful only if origin is PendingInterestOrigin::APP
+   */
+  time::steady_clock::TimePoint
+  getExpressTime() const
+  {
+    return m_expressTime;
+  }
+
   /**
    * @brief Record that the Interest has been forwarded to one destination
    *
@@ -175,6 +186,7 @@ private:
 private:
   shared_ptr<const Interest> m_interest;
   PendingInterestOrigin m_origin;
+  time::steady_clock::TimePoint m_expressTime;
   DataCallback m_dataCallback;
   NackCallback m_nackCallback;
   TimeoutCallback m_timeoutCallback;
@@ -0,0 +1,494 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/disk-storage.hpp"
+#include "ndn-cxx/encoding/block-helpers.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ndn {
+
+/// magic number at the start of the file
+const uint8_t FILE_MAGIC[] = {'N', 'D', 'N', 'D', 'S', 'L', 'O', 'G'};
+/// version of the record format, written after the magic number
+const uint32_t FORMAT_VERSION = 1;
+/// size of the file header: magic number and 32-bit big-endian format version
+const size_t HEADER_SIZE = sizeof(FILE_MAGIC) + 4;
+/// TLV-TYPE of a tombstone that erases the packet with the enclosed Name
+const uint32_t TLV_ERASE_NAME = 128;
+/// TLV-TYPE of a tombstone that erases the packets under the enclosed Name
+const uint32_t TLV_ERASE_PREFIX = 129;
+/// granularity of the memory mapping, so that it is not remapped after every append
+const size_t MAP_GRANULARITY = 1 << 20;
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+static void
+readAt(int fd, uint8_t* buf, size_t size, uint64_t offset)
+{
+  while (size > 0) {
+    ssize_t n = ::pread(fd, buf, size, static_cast<off_t>(offset));
+    if (n <= 0) {
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      NDN_THROW(DiskStorage::Error(n == 0 ? "Unexpected end of file" : makeErrorMessage("Cannot read")));
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+}
+
+static void
+writeAt(int fd, const uint8_t* buf, size_t size, uint64_t offset)
+{
+  while (size > 0) {
+    ssize_t n = ::pwrite(fd, buf, size, static_cast<off_t>(offset));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      NDN_THROW(DiskStorage::Error(makeErrorMessage("Cannot write")));
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+}
+
+static std::array<uint8_t, HEADER_SIZE>
+makeHeader(uint32_t version)
+{
+  std::array<uint8_t, HEADER_SIZE> header;
+  auto pos = std::copy(std::begin(FILE_MAGIC), std::end(FILE_MAGIC), header.begin());
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    *pos++ = static_cast<uint8_t>(version >> shift);
+  }
+  return header;
+}
+
+static void
+copyRecord(int fromFd, uint64_t fromOffset, size_t size, int toFd, uint64_t toOffset)
+{
+  std::vector<uint8_t> buf(size);
+  readAt(fromFd, buf.data(), size, fromOffset);
+  writeAt(toFd, buf.data(), size, toOffset);
+}
+
+DiskStorage::DiskStorage(const std::string& filename)
+  : m_filename(filename)
+{
+  m_fd = ::open(m_filename.data(), O_RDWR | O_CREAT, 0644);
+  if (m_fd < 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot open " + m_filename)));
+  }
+
+  try {
+    rebuildIndex();
+  }
+  catch (const Error&) {
+    unmap();
+    ::close(m_fd);
+    throw;
+  }
+}
+
+DiskStorage::~DiskStorage()
+{
+  unmap();
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+void
+DiskStorage::rebuildIndex()
+{
+  struct stat st;
+  if (::fstat(m_fd, &st) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot stat " + m_filename)));
+  }
+  m_fileSize = static_cast<uint64_t>(st.st_size);
+
+  const auto header = makeHeader(FORMAT_VERSION);
+  if (m_fileSize < HEADER_SIZE) {
+    // a new file, or one whose header was left incomplete by a crash when it was created
+    std::array<uint8_t, HEADER_SIZE> existing;
+    readAt(m_fd, existing.data(), static_cast<size_t>(m_fileSize), 0);
+    if (!std::equal(existing.begin(), existing.begin() + static_cast<ptrdiff_t>(m_fileSize),
+                    header.begin())) {
+      NDN_THROW(Error(m_filename + " is not a DiskStorage file"));
+    }
+    writeAt(m_fd, header.data(), header.size(), 0);
+    m_fileSize = HEADER_SIZE;
+    return;
+  }
+
+  ensureMapped(m_fileSize);
+  if (!std::equal(std::begin(FILE_MAGIC), std::end(FILE_MAGIC), m_map)) {
+    NDN_THROW(Error(m_filename + " is not a DiskStorage file"));
+  }
+  if (!std::equal(header.begin(), header.end(), m_map)) {
+    uint32_t version = 0;
+    for (size_t i = sizeof(FILE_MAGIC); i < HEADER_SIZE; ++i) {
+      version = (version << 8) | m_map[i];
+    }
+    NDN_THROW(Error(m_filename + " has unsupported format version " + to_string(version)));
+  }
+
+  uint64_t offset = HEADER_SIZE;
+  while (offset < m_fileSize) {
+    const uint8_t* pos = m_map + offset;
+    const uint8_t* end = m_map + m_fileSize;
+    uint64_t type = 0;
+    uint64_t length = 0;
+    if (!tlv::readVarNumber(pos, end, type) || !tlv::readVarNumber(pos, end, length) ||
+        length > static_cast<uint64_t>(end - pos)) {
+      // the last record runs past the end of the file, e.g., left incomplete by a crash during
+      // an append; it is discarded
+      if (::ftruncate(m_fd, static_cast<off_t>(offset)) != 0) {
+        NDN_THROW(Error(makeErrorMessage("Cannot truncate " + m_filename)));
+      }
+      m_fileSize = offset;
+      break;
+    }
+
+    auto recordSize = static_cast<size_t>(pos - (m_map + offset) + length);
+    try {
+      Block block(m_map + offset, recordSize);
+      if (block.type() == tlv::Data) {
+        block.parse();
+        Record record{offset, block.size()};
+        auto result = m_index.emplace(Name(block.get(tlv::Name)), record);
+        if (!result.second) {
+          m_nGarbageBytes += result.first->second.size;
+          result.first->second = record;
+        }
+      }
+      else if (block.type() == TLV_ERASE_NAME || block.type() == TLV_ERASE_PREFIX) {
+        Name name(block.blockFromValue());
+        auto first = m_index.find(name);
+        auto last = first == m_index.end() ? first : std::next(first);
+        if (block.type() == TLV_ERASE_PREFIX) {
+          first = m_index.lower_bound(name);
+          for (last = first; last != m_index.end() && name.isPrefixOf(last->first); ++last) {
+          }
+        }
+        for (auto it = first; it != last; ++it) {
+          m_nGarbageBytes += it->second.size;
+        }
+        m_index.erase(first, last);
+        m_nGarbageBytes += block.size();
+      }
+      else {
+        NDN_THROW(Error("Unknown record type " + to_string(type) + " at offset " +
+                        to_string(offset) + " of " + m_filename));
+      }
+    }
+    catch (const tlv::Error&) {
+      NDN_THROW_NESTED(Error("Malformed record at offset " + to_string(offset) + " of " +
+                             m_filename));
+    }
+    offset += recordSize;
+  }
+}
+
+void
+DiskStorage::ensureMapped(uint64_t size)
+{
+  if (size <= m_mapSize) {
+    return;
+  }
+
+  unmap();
+  // the mapping may extend past the end of the file, but only offsets within it are read
+  size_t mapSize = static_cast<size_t>((size + MAP_GRANULARITY - 1) / MAP_GRANULARITY * MAP_GRANULARITY);
+  void* map = ::mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    NDN_THROW(Error(makeErrorMessage("Cannot map " + m_filename)));
+  }
+  m_map = static_cast<const uint8_t*>(map);
+  m_mapSize = mapSize;
+}
+
+void
+DiskStorage::unmap()
+{
+  if (m_map != nullptr) {
+    ::munmap(const_cast<uint8_t*>(m_map), m_mapSize);
+    m_map = nullptr;
+    m_mapSize = 0;
+  }
+}
+
+shared_ptr<const Data>
+DiskStorage::read(const Record& record)
+{
+  ensureMapped(record.offset + record.size);
+  auto buffer = make_shared<Buffer>(m_map + record.offset, record.size);
+  return make_shared<Data>(Block(std::move(buffer)));
+}
+
+uint64_t
+DiskStorage::append(const Block& wire)
+{
+  writeAt(m_fd, wire.wire(), wire.size(), m_fileSize);
+  uint64_t offset = m_fileSize;
+  m_fileSize += wire.size();
+  return offset;
+}
+
+DiskStorage::Index::iterator
+DiskStorage::findExact(const Name& name, shared_ptr<const Data>* data)
+{
+  auto it = m_index.find(name);
+  if (it != m_index.end()) {
+    if (data != nullptr) {
+      *data = read(it->second);
+    }
+    return it;
+  }
+
+  if (!name.empty() && name[-1].isImplicitSha256Digest()) {
+    it = m_index.find(name.getPrefix(-1));
+    if (it != m_index.end()) {
+      auto found = read(it->second);
+      if (found->getFullName() == name) {
+        if (data != nullptr) {
+          *data = std::move(found);
+        }
+        return it;
+      }
+    }
+  }
+  return m_index.end();
+}
+
+void
+DiskStorage::insert(const Data& data)
+{
+  const Block& wire = data.wireEncode();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Record record{append(wire), wire.size()};
+  auto result = m_index.emplace(data.getName(), record);
+  if (!result.second) {
+    m_nGarbageBytes += result.first->second.size;
+    result.first->second = record;
+  }
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Interest& interest)
+{
+  if (interest.getMustBeFresh()) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const Name& name = interest.getName();
+  if (!interest.getCanBePrefix() || (!name.empty() && name[-1].isImplicitSha256Digest())) {
+    shared_ptr<const Data> data;
+    if (findExact(name, &data) != m_index.end() && interest.matchesData(*data)) {
+      return data;
+    }
+    if (!interest.getCanBePrefix()) {
+      return nullptr;
+    }
+  }
+
+  // without MustBeFresh, any packet under the Interest name satisfies it
+  auto it = m_index.lower_bound(name);
+  if (it != m_index.end() && name.isPrefixOf(it->first)) {
+    return read(it->second);
+  }
+  return nullptr;
+}
+
+shared_ptr<const Data>
+DiskStorage::find(const Name& name)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  shared_ptr<const Data> data;
+  if (findExact(name, &data) != m_index.end()) {
+    return data;
+  }
+
+  auto it = m_index.lower_bound(name);
+  if (it != m_index.end() && name.isPrefixOf(it->first)) {
+    return read(it->second);
+  }
+  return nullptr;
+}
+
+void
+DiskStorage::erase(const Name& prefix, bool isPrefix)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  Index::iterator first, last;
+  Block tombstone;
+  if (isPrefix) {
+    first = m_index.lower_bound(prefix);
+    for (last = first; last != m_index.end() && prefix.isPrefixOf(last->first); ++last) {
+    }
+    tombstone = makeNestedBlock(TLV_ERASE_PREFIX, prefix);
+  }
+  else {
+    first = findExact(prefix);
+    last = first == m_index.end() ? first : std::next(first);
+    if (first != m_index.end()) {
+      tombstone = makeNestedBlock(TLV_ERASE_NAME, first->first);
+    }
+  }
+  if (first == last) {
+    return;
+  }
+
+  // the tombstone is appended first, so that the index is unchanged if the write fails
+  append(tombstone);
+  m_nGarbageBytes += tombstone.size();
+  for (auto it = first; it != last; ++it) {
+    m_nGarbageBytes += it->second.size;
+  }
+  m_index.erase(first, last);
+}
+
+void
+DiskStorage::compact()
+{
+  std::lock_guard<std::mutex> compactLock(m_compactMutex);
+
+  // take a snapshot of the index; records before its end offset are never modified
+  std::vector<std::pair<Name, Record>> snapshot;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    snapshot.assign(m_index.begin(), m_index.end());
+  }
+
+  std::string newFilename = m_filename + ".compact";
+  int newFd = ::open(newFilename.data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (newFd < 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot open " + newFilename)));
+  }
+
+  try {
+    const auto header = makeHeader(FORMAT_VERSION);
+    writeAt(newFd, header.data(), header.size(), 0);
+
+    // copy the live records without holding the lock
+    std::map<Name, std::pair<uint64_t, Record>> copied; // name => (old offset, new record)
+    uint64_t newSize = HEADER_SIZE;
+    for (const auto& item : snapshot) {
+      copyRecord(m_fd, item.second.offset, item.second.size, newFd, newSize);
+      copied.emplace_hint(copied.end(), item.first,
+                          std::make_pair(item.second.offset, Record{newSize, item.second.size}));
+      newSize += item.second.size;
+    }
+    if (m_afterCompactCopy) {
+      m_afterCompactCopy();
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint64_t nGarbageBytes = 0;
+    for (const auto& item : copied) {
+      auto it = m_index.find(item.first);
+      if (it == m_index.end()) {
+        // erased since the snapshot: the copy must not come back when the index is rebuilt
+        Block tombstone = makeNestedBlock(TLV_ERASE_NAME, item.first);
+        writeAt(newFd, tombstone.wire(), tombstone.size(), newSize);
+        newSize += tombstone.size();
+        nGarbageBytes += item.second.second.size + tombstone.size();
+      }
+      else if (it->second.offset != item.second.first) {
+        // replaced since the snapshot by a record that is copied below
+        nGarbageBytes += item.second.second.size;
+      }
+    }
+
+    // records appended since the snapshot are copied now
+    Index newIndex;
+    for (const auto& item : m_index) {
+      auto it = copied.find(item.first);
+      if (it != copied.end() && it->second.first == item.second.offset) {
+        newIndex.emplace_hint(newIndex.end(), item.first, it->second.second);
+      }
+      else {
+        copyRecord(m_fd, item.second.offset, item.second.size, newFd, newSize);
+        newIndex.emplace_hint(newIndex.end(), item.first, Record{newSize, item.second.size});
+        newSize += item.second.size;
+      }
+    }
+    if (::ftruncate(newFd, static_cast<off_t>(newSize)) != 0 || ::fsync(newFd) != 0) {
+      NDN_THROW(Error(makeErrorMessage("Cannot write " + newFilename)));
+    }
+    if (::rename(newFilename.data(), m_filename.data()) != 0) {
+      NDN_THROW(Error(makeErrorMessage("Cannot rename " + newFilename)));
+    }
+
+    unmap();
+    ::close(m_fd);
+    m_fd = newFd;
+    m_fileSize = newSize;
+    m_nGarbageBytes = nGarbageBytes;
+    m_index = std::move(newIndex);
+  }
+  catch (const Error&) {
+    ::close(newFd);
+    ::unlink(newFilename.data());
+    throw;
+  }
+}
+
+size_t
+DiskStorage::size() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_index.size();
+}
+
+uint64_t
+DiskStorage::getFileSize() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_fileSize;
+}
+
+uint64_t
+DiskStorage::getNGarbageBytes() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nGarbageBytes;
+}
+
+} // namespace ndn
@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_IMS_DISK_STORAGE_HPP
+#define NDN_IMS_DISK_STORAGE_HPP
+
+#include "ndn-cxx/data.hpp"
+#include "ndn-cxx/interest.hpp"
+
+#include <map>
+#include <mutex>
+
+namespace ndn {
+
+/** @brief Stores Data packets in an append-only log file, to serve as the second tier of an
+ *  InMemoryStorage.
+ *
+ *  The file starts with a header that identifies it and the version of its format. Each packet
+ *  is appended to the file as its wire encoding, and an in-memory index maps its name to the
+ *  offset of the record. A packet with the same name as a stored one replaces it. Erasures
+ *  append a tombstone record, so that the index can be rebuilt by scanning the file when it is
+ *  opened again: the storage survives a restart. A last record that runs past the end of the
+ *  file, as left by a crash during an append, is discarded at that time; any other malformed
+ *  record makes opening the file fail, without modifying it.
+ *
+ *  Packets are read through a shared memory mapping of the file. Replaced and erased records
+ *  waste space in the file until compact() rewrites it with the live records only.
+ *
+ *  Packets read from the file carry no freshness state, so they never satisfy an Interest
+ *  with MustBeFresh.
+ *
+ *  All methods can be called concurrently from several threads.
+ */
+class DiskStorage : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /** @brief Open the log file @p filename, or create it if it does not exist.
+   *  @throw Error file cannot be opened or read, is not a DiskStorage file, has an unsupported
+   *               format version, or contains a malformed record
+   */
+  explicit
+  DiskStorage(const std::string& filename);
+
+  ~DiskStorage();
+
+  /** @brief Appends a Data packet to the file
+   *  @param data the packet to insert, must have wire encoding
+   *  @throw Error I/O error
+   */
+  void
+  insert(const Data& data);
+
+  /** @brief Finds the best match Data for an Interest
+   *  @return{ the leftmost match, if any; otherwise a null shared_ptr }
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest);
+
+  /** @brief Finds a Data whose name or full name is, or starts with, @p name
+   */
+  shared_ptr<const Data>
+  find(const Name& name);
+
+  /** @brief Deletes entries from the index and records the erasure in the file
+   *  @param prefix prefix of the packets to remove
+   *  @param isPrefix If false, only remove the packet whose name, or full name, is @p prefix.
+   *  @throw Error I/O error
+   */
+  void
+  erase(const Name& prefix, bool isPrefix = true);
+
+  /** @brief Rewrites the file with the live records only.
+   *
+   *  The live records are copied to a new file without holding the lock that other methods
+   *  take, so this method can run on a background thread while the storage is in use. Records
+   *  appended and erasures made in the meantime are applied before the new file replaces the
+   *  old one.
+   *
+   *  @throw Error I/O error; the storage keeps using the old file
+   */
+  void
+  compact();
+
+  /** @return{ number of packets stored }
+   */
+  size_t
+  size() const;
+
+  /** @return{ size of the file in bytes }
+   */
+  uint64_t
+  getFileSize() const;
+
+  /** @return{ bytes of the file taken by replaced or erased records, and tombstones }
+   */
+  uint64_t
+  getNGarbageBytes() const;
+
+private:
+  struct Record
+  {
+    uint64_t offset;
+    size_t size;
+  };
+
+  using Index = std::map<Name, Record>;
+
+  void
+  rebuildIndex();
+
+  /** @brief Read the packet of a record.
+   *  @pre m_mutex is held
+   */
+  shared_ptr<const Data>
+  read(const Record& record);
+
+  /** @brief Append @p wire at the end of the file.
+   *  @pre m_mutex is held
+   *  @return{ the offset of the record }
+   */
+  uint64_t
+  append(const Block& wire);
+
+  /** @brief Find the index entry of the packet whose name or full name is @p name.
+   *  @pre m_mutex is held
+   */
+  Index::iterator
+  findExact(const Name& name, shared_ptr<const Data>* data = nullptr);
+
+  /** @brief Map the file up to at least @p size bytes.
+   *  @pre m_mutex is held
+   */
+  void
+  ensureMapped(uint64_t size);
+
+  void
+  unmap();
+
+private:
+  const std::string m_filename;
+  mutable std::mutex m_mutex;
+  /// serializes compactions
+  std::mutex m_compactMutex;
+  int m_fd = -1;
+  uint64_t m_fileSize = 0;
+  uint64_t m_nGarbageBytes = 0;
+  const uint8_t* m_map = nullptr;
+  size_t m_mapSize = 0;
+  Index m_index;
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /// called by compact() after the live records are copied, before the lock is taken
+  std::function<void()> m_afterCompactCopy;
+};
+
+} // namespace ndn
+
+#endif // NDN_IMS_DISK_STORAGE_HPP
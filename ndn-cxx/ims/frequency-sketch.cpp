@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/frequency-sketch.hpp"
+
+namespace ndn {
+
+constexpr uint8_t FrequencySketch::MAX_FREQUENCY;
+
+// odd multipliers of a multiplicative hash, one per row
+static const uint64_t ROW_SEEDS[] = {
+  0x9e3779b97f4a7c15, 0xc2b2ae3d27d4eb4f, 0x165667b19e3779f9, 0xd6e8feb86659fd93,
+};
+
+FrequencySketch::FrequencySketch(size_t capacity)
+{
+  ensureCapacity(capacity);
+}
+
+void
+FrequencySketch::ensureCapacity(size_t capacity)
+{
+  size_t size = 8;
+  while (size < capacity) {
+    size *= 2;
+  }
+  if (size <= m_table.size()) {
+    return;
+  }
+
+  m_table.assign(size, 0);
+  m_sampleSize = 10 * std::max<size_t>(capacity, 1);
+  m_nIncrements = 0;
+}
+
+std::pair<size_t, unsigned>
+FrequencySketch::locate(size_t hash, size_t row) const
+{
+  // mix the hash with the seed of the row, so that consecutive hashes spread over the table
+  uint64_t h = (static_cast<uint64_t>(hash) + ROW_SEEDS[row]) * ROW_SEEDS[row];
+  h ^= h >> 29;
+  h *= 0xbf58476d1ce4e5b9;
+  h ^= h >> 32;
+  // the table size is a power of two; the top bits select one of the 16 counters in the word
+  return {static_cast<size_t>(h & (m_table.size() - 1)), static_cast<unsigned>(h >> 60) * 4};
+}
+
+void
+FrequencySketch::increment(size_t hash)
+{
+  bool isIncremented = false;
+  for (size_t row = 0; row < 4; ++row) {
+    size_t index;
+    unsigned offset;
+    std::tie(index, offset) = locate(hash, row);
+    if (((m_table[index] >> offset) & 0xF) < MAX_FREQUENCY) {
+      m_table[index] += uint64_t(1) << offset;
+      isIncremented = true;
+    }
+  }
+
+  if (isIncremented && ++m_nIncrements >= m_sampleSize) {
+    halve();
+  }
+}
+
+uint8_t
+FrequencySketch::getFrequency(size_t hash) const
+{
+  uint8_t frequency = MAX_FREQUENCY;
+  for (size_t row = 0; row < 4; ++row) {
+    size_t index;
+    unsigned offset;
+    std::tie(index, offset) = locate(hash, row);
+    frequency = std::min(frequency, static_cast<uint8_t>((m_table[index] >> offset) & 0xF));
+  }
+  return frequency;
+}
+
+void
+FrequencySketch::halve()
+{
+  for (auto& word : m_table) {
+    word = (word >> 1) & 0x7777777777777777;
+  }
+  m_nIncrements /= 2;
+}
+
+} // namespace ndn
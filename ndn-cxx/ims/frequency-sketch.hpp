@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_IMS_FREQUENCY_SKETCH_HPP
+#define NDN_IMS_FREQUENCY_SKETCH_HPP
+
+#include "ndn-cxx/detail/common.hpp"
+
+namespace ndn {
+
+/** @brief Estimates the recent access frequency of items with a count-min sketch.
+ *
+ *  Each item is counted in four 4-bit counters, selected by its hash, and its frequency is the
+ *  smallest of them. Sixteen counters are packed in a 64-bit word, so the sketch uses 8 bytes
+ *  per expected item. Once the number of increments reaches a sample size of ten times the
+ *  expected number of items, all counters are halved, so that the estimates favor recent
+ *  accesses.
+ *
+ *  @sa Einziger et al., "TinyLFU: A Highly Efficient Cache Admission Policy", ACM ToS 2017
+ */
+class FrequencySketch
+{
+public:
+  /** @brief Create a sketch for about @p capacity distinct items.
+   */
+  explicit
+  FrequencySketch(size_t capacity = 16);
+
+  /** @brief Grow the sketch to hold about @p capacity distinct items.
+   *
+   *  Counters are reset if the sketch is resized. The sketch never shrinks.
+   */
+  void
+  ensureCapacity(size_t capacity);
+
+  void
+  increment(size_t hash);
+
+  /** @return{ estimated frequency of the item, at most 15 }
+   */
+  uint8_t
+  getFrequency(size_t hash) const;
+
+  size_t
+  getSampleSize() const
+  {
+    return m_sampleSize;
+  }
+
+private:
+  /** @brief Get the index of the word and the bit offset of the counter of row @p row.
+   */
+  std::pair<size_t, unsigned>
+  locate(size_t hash, size_t row) const;
+
+  void
+  halve();
+
+public:
+  static constexpr uint8_t MAX_FREQUENCY = 15;
+
+private:
+  std::vector<uint64_t> m_table;
+  size_t m_sampleSize = 0;
+  size_t m_nIncrements = 0;
+};
+
+} // namespace ndn
+
+#endif // NDN_IMS_FREQUENCY_SKETCH_HPP
@@ -1,6 +1,6 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 /*
- * Copyright (c) 2013-2019 Regents of the University of California.
+ * Copyright (c) 2013-2020 Regents of the University of California.
  *
  * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
  *
@@ -20,11 +20,12 @@
  */
 
 #include "ndn-cxx/ims/in-memory-storage-entry.hpp"
+#include "ndn-cxx/util/sha256.hpp"
 
 namespace ndn {
 
 InMemoryStorageEntry::InMemoryStorageEntry()
-  : m_isFresh(true)
+  : m_staleTime(time::steady_clock::TimePoint::max())
 {
 }
 
@@ -32,20 +33,90 @@ void
 InMemoryStorageEntry::release()
 {
   m_dataPacket.reset();
-  m_markStaleEventId.cancel();
+  m_compact.reset();
+}
+
+const Name&
+InMemoryStorageEntry::getFullName() const
+{
+  if (m_compact == nullptr) {
+    return m_dataPacket->getFullName();
+  }
+
+  if (m_compact->fullName == nullptr) {
+    const Block& wire = m_compact->wire;
+    m_compact->fullName = make_unique<Name>(m_compact->name);
+    m_compact->fullName->appendImplicitSha256Digest(util::Sha256::computeDigest(wire.wire(), wire.size()));
+  }
+  return *m_compact->fullName;
+}
+
+const Data&
+InMemoryStorageEntry::getData() const
+{
+  if (m_compact == nullptr) {
+    return *m_dataPacket;
+  }
+
+  if (m_compact->data == nullptr) {
+    m_compact->data = make_shared<Data>(m_compact->wire);
+  }
+  return *m_compact->data;
+}
+
+shared_ptr<const Data>
+InMemoryStorageEntry::getSharedData() const
+{
+  if (m_compact == nullptr) {
+    return m_dataPacket;
+  }
+  if (m_compact->data != nullptr) {
+    return m_compact->data;
+  }
+  return make_shared<Data>(m_compact->wire);
+}
+
+bool
+InMemoryStorageEntry::canSatisfy(const Interest& interest) const
+{
+  if (m_compact == nullptr) {
+    return interest.matchesData(*m_dataPacket);
+  }
+
+  // same as Interest::matchesData
+  const Name& interestName = interest.getName();
+  const Name& dataName = m_compact->name;
+  if (interestName.size() == dataName.size() + 1) {
+    if (!interestName[-1].isImplicitSha256Digest() || interestName != getFullName()) {
+      return false;
+    }
+  }
+  else if (interest.getCanBePrefix() ? !interestName.isPrefixOf(dataName) : interestName != dataName) {
+    return false;
+  }
+
+  return !interest.getMustBeFresh() || m_compact->freshnessPeriod > 0_ms;
 }
 
 void
 InMemoryStorageEntry::setData(const Data& data)
 {
   m_dataPacket = data.shared_from_this();
-  m_isFresh = true;
+  m_compact.reset();
+  m_staleTime = time::steady_clock::TimePoint::max();
 }
 
 void
-InMemoryStorageEntry::scheduleMarkStale(Scheduler& sched, time::nanoseconds after)
+InMemoryStorageEntry::setCompactData(const Data& data)
 {
-  m_markStaleEventId = sched.schedule(after, [this] { m_isFresh = false; });
+  const Block& wire = data.wireEncode();
+  m_dataPacket.reset();
+  // a new Block of the same buffer does not keep the parsed elements of the packet
+  m_compact = make_unique<CompactData>();
+  m_compact->wire = Block(wire.getBuffer(), wire.begin(), wire.end(), false);
+  m_compact->name = data.getName();
+  m_compact->freshnessPeriod = data.getFreshnessPeriod();
+  m_staleTime = time::steady_clock::TimePoint::max();
 }
 
 } // namespace ndn
@@ -1,6 +1,6 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 /*
- * Copyright (c) 2013-2019 Regents of the University of California.
+ * Copyright (c) 2013-2020 Regents of the University of California.
  *
  * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
  *
@@ -24,7 +24,7 @@
 
 #include "ndn-cxx/data.hpp"
 #include "ndn-cxx/interest.hpp"
-#include "ndn-cxx/util/scheduler.hpp"
+#include "ndn-cxx/util/time.hpp"
 
 namespace ndn {
 
@@ -47,51 +47,129 @@ public:
   const Name&
   getName() const
   {
-    return m_dataPacket->getName();
+    return m_compact != nullptr ? m_compact->name : m_dataPacket->getName();
   }
 
   /** @brief Returns the full name (including implicit digest) of the Data packet stored
    *         in the in-memory storage entry
    */
   const Name&
-  getFullName() const
-  {
-    return m_dataPacket->getFullName();
-  }
+  getFullName() const;
 
   /** @brief Returns the Data packet stored in the in-memory storage entry
+   *
+   *  A compact entry decodes the packet on first use, and keeps the decoded packet until the
+   *  entry is released, which gives up the memory saved by the compact entry. Use
+   *  getSharedData() where the packet is not needed past the lifetime of the entry.
    */
   const Data&
-  getData() const
+  getData() const;
+
+  /** @brief Returns the Data packet stored in the in-memory storage entry, as a shared pointer
+   *
+   *  A compact entry decodes a new Data from its wire encoding, unless getData() has already
+   *  decoded it.
+   */
+  shared_ptr<const Data>
+  getSharedData() const;
+
+  /** @brief Returns the wire encoding of the Data packet stored in the in-memory storage entry
+   */
+  const Block&
+  getWire() const
   {
-    return *m_dataPacket;
+    return m_compact != nullptr ? m_compact->wire : m_dataPacket->wireEncode();
   }
 
+  /** @brief Check if the Data packet satisfies @p interest, as Interest::matchesData would.
+   *
+   *  Whether the entry is fresh is not checked. A compact entry is matched without decoding
+   *  the packet.
+   */
+  bool
+  canSatisfy(const Interest& interest) const;
+
   /** @brief Changes the content of in-memory storage entry
    *
-   *  This method also allows data to satisfy Interest with MustBeFresh
+   *  The entry shares @p data.
+   *  This method also allows data to satisfy Interest with MustBeFresh, until the stale time
+   *  is set.
    */
   void
   setData(const Data& data);
 
-  /** @brief Schedule an event to mark this entry as non-fresh.
+  /** @brief Changes the content of in-memory storage entry, making it compact
+   *
+   *  The entry keeps the wire encoding of @p data, sharing its buffer, with the name and
+   *  FreshnessPeriod needed to match Interests, but not @p data itself, so that the decoded
+   *  fields of the packet can be freed.
+   *  This method also allows data to satisfy Interest with MustBeFresh, until the stale time
+   *  is set.
+   */
+  void
+  setCompactData(const Data& data);
+
+  /** @brief Check if the entry is compact
+   */
+  bool
+  isCompact() const
+  {
+    return m_compact != nullptr;
+  }
+
+  /** @brief Set the time from which the data cannot satisfy an interest with MustBeFresh.
+   *
+   *  Freshness is checked against the clock when the entry is looked up, so that no timer is
+   *  needed per entry.
+   */
+  void
+  setStaleTime(const time::steady_clock::TimePoint& staleTime)
+  {
+    m_staleTime = staleTime;
+  }
+
+  /** @brief Mark this entry as non-fresh immediately.
    */
   void
-  scheduleMarkStale(Scheduler& sched, time::nanoseconds after);
+  markStale()
+  {
+    m_staleTime = time::steady_clock::TimePoint::min();
+  }
+
+  /** @brief Check if the data can satisfy an interest with MustBeFresh at time @p now
+   */
+  bool
+  isFresh(const time::steady_clock::TimePoint& now) const
+  {
+    return now < m_staleTime;
+  }
 
   /** @brief Check if the data can satisfy an interest with MustBeFresh
    */
   bool
-  isFresh()
+  isFresh() const
   {
-    return m_isFresh;
+    return isFresh(time::steady_clock::now());
   }
 
 private:
-  shared_ptr<const Data> m_dataPacket;
+  /** @brief Fields of a compact entry, allocated separately so that they take no space in
+   *         entries that share a Data
+   */
+  struct CompactData
+  {
+    Block wire;
+    Name name;
+    time::milliseconds freshnessPeriod;
+    /// computed on first use
+    mutable unique_ptr<Name> fullName;
+    /// decoded on first use of getData()
+    mutable shared_ptr<const Data> data;
+  };
 
-  bool m_isFresh;
-  scheduler::ScopedEventId m_markStaleEventId;
+  shared_ptr<const Data> m_dataPacket;
+  unique_ptr<CompactData> m_compact;
+  time::steady_clock::TimePoint m_staleTime;
 };
 
 } // namespace ndn
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/in-memory-storage-tinylfu.hpp"
+
+namespace ndn {
+
+InMemoryStorageTinyLfu::InMemoryStorageTinyLfu(size_t limit)
+  : InMemoryStorage(limit)
+{
+}
+
+InMemoryStorageTinyLfu::InMemoryStorageTinyLfu(boost::asio::io_service& ioService, size_t limit)
+  : InMemoryStorage(ioService, limit)
+{
+}
+
+size_t
+InMemoryStorageTinyLfu::getWindowCapacity() const
+{
+  size_t limit = getLimit() != std::numeric_limits<size_t>::max() ? getLimit() : getCapacity();
+  return std::max<size_t>(1, limit / 100);
+}
+
+void
+InMemoryStorageTinyLfu::afterInsert(InMemoryStorageEntry* entry)
+{
+  // sized to the limit when there is one, so that the counters are not reset as the storage grows
+  m_sketch.ensureCapacity(getLimit() != std::numeric_limits<size_t>::max() ? getLimit() : getCapacity());
+  m_sketch.increment(std::hash<Name>()(entry->getName()));
+
+  m_window.push_back(entry);
+  m_locations[entry] = {true, std::prev(m_window.end()), 0};
+
+  // until the storage is full, the window overflows into the main segment
+  if (m_window.size() > getWindowCapacity()) {
+    size_t slot = m_clock.size();
+    if (!m_freeSlots.empty()) {
+      slot = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    }
+    else {
+      m_clock.emplace_back();
+    }
+    promoteFromWindow(slot);
+  }
+}
+
+bool
+InMemoryStorageTinyLfu::evictItem()
+{
+  if (m_locations.empty()) {
+    return false;
+  }
+
+  InMemoryStorageEntry* victim = nullptr;
+  if (getMainSize() == 0) {
+    victim = m_window.front();
+  }
+  else {
+    size_t slot = findClockVictim();
+    victim = m_clock[slot].entry;
+
+    if (m_window.size() >= getWindowCapacity()) {
+      // the oldest packet of the window must leave it to make room for the new one; it is
+      // admitted into the main segment only if it is more popular than the main victim
+      InMemoryStorageEntry* candidate = m_window.front();
+      if (getFrequency(candidate) > getFrequency(victim)) {
+        m_locations.erase(victim);
+        promoteFromWindow(slot);
+        eraseImpl(victim);
+        return true;
+      }
+      victim = candidate;
+    }
+  }
+
+  removeEntry(victim);
+  eraseImpl(victim);
+  return true;
+}
+
+void
+InMemoryStorageTinyLfu::beforeErase(InMemoryStorageEntry* entry)
+{
+  if (m_locations.count(entry) > 0) {
+    removeEntry(entry);
+  }
+}
+
+void
+InMemoryStorageTinyLfu::afterAccess(InMemoryStorageEntry* entry)
+{
+  m_sketch.increment(std::hash<Name>()(entry->getName()));
+
+  auto it = m_locations.find(entry);
+  BOOST_ASSERT(it != m_locations.end());
+  if (it->second.isInWindow) {
+    m_window.splice(m_window.end(), m_window, it->second.windowIt);
+  }
+  else {
+    m_clock[it->second.slot].isReferenced = true;
+  }
+}
+
+void
+InMemoryStorageTinyLfu::promoteFromWindow(size_t slot)
+{
+  BOOST_ASSERT(!m_window.empty());
+  InMemoryStorageEntry* entry = m_window.front();
+  m_window.pop_front();
+
+  m_clock[slot].entry = entry;
+  m_clock[slot].isReferenced = false;
+  m_locations[entry] = {false, m_window.end(), slot};
+}
+
+size_t
+InMemoryStorageTinyLfu::findClockVictim()
+{
+  BOOST_ASSERT(getMainSize() > 0);
+  while (true) {
+    if (m_hand >= m_clock.size()) {
+      m_hand = 0;
+    }
+    ClockSlot& slot = m_clock[m_hand];
+    if (slot.entry != nullptr) {
+      if (!slot.isReferenced) {
+        return m_hand++;
+      }
+      // second chance
+      slot.isReferenced = false;
+    }
+    ++m_hand;
+  }
+}
+
+void
+InMemoryStorageTinyLfu::removeEntry(InMemoryStorageEntry* entry)
+{
+  auto it = m_locations.find(entry);
+  BOOST_ASSERT(it != m_locations.end());
+  if (it->second.isInWindow) {
+    m_window.erase(it->second.windowIt);
+  }
+  else {
+    m_clock[it->second.slot] = ClockSlot();
+    m_freeSlots.push_back(it->second.slot);
+  }
+  m_locations.erase(it);
+}
+
+} // namespace ndn
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_IMS_IN_MEMORY_STORAGE_TINYLFU_HPP
+#define NDN_IMS_IN_MEMORY_STORAGE_TINYLFU_HPP
+
+#include "ndn-cxx/ims/frequency-sketch.hpp"
+#include "ndn-cxx/ims/in-memory-storage.hpp"
+
+#include <list>
+#include <unordered_map>
+
+namespace ndn {
+
+/** @brief Provides in-memory storage employing the W-TinyLFU replacement policy.
+ *
+ *  New packets enter a small window segment, about 1% of the limit, managed in LRU order. When
+ *  a packet must leave the window, it is admitted into the main segment only if its estimated
+ *  access frequency is higher than that of the packet the main segment would evict; otherwise
+ *  it is evicted itself. Frequencies are estimated by a FrequencySketch, which ages its counters
+ *  so that formerly popular packets are eventually evicted.
+ *
+ *  The main segment is managed by the CLOCK algorithm: its entries are kept in an array of slots
+ *  with a reference bit, which a hand sweeps to find a packet not accessed since its last pass.
+ *
+ *  A sequential scan of packets that are accessed once therefore only cycles through the window,
+ *  and does not flush the main segment.
+ *
+ *  @sa Einziger et al., "TinyLFU: A Highly Efficient Cache Admission Policy", ACM ToS 2017
+ */
+class InMemoryStorageTinyLfu : public InMemoryStorage
+{
+public:
+  explicit
+  InMemoryStorageTinyLfu(size_t limit = 16);
+
+  explicit
+  InMemoryStorageTinyLfu(boost::asio::io_service& ioService, size_t limit = 16);
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
+  /** @brief Removes one Data packet from in-memory storage based on W-TinyLFU, i.e. evict either
+   *  the oldest packet of the window or the CLOCK victim of the main segment, whichever is
+   *  estimated to be less frequently accessed
+   *  @return{ whether the Data was removed }
+   */
+  bool
+  evictItem() override;
+
+  /** @brief Update the entry when the entry is returned by the find() function,
+   *  count the access and mark it as recently used
+   */
+  void
+  afterAccess(InMemoryStorageEntry* entry) override;
+
+  /** @brief Update the entry after a entry is successfully inserted, add it to the window
+   */
+  void
+  afterInsert(InMemoryStorageEntry* entry) override;
+
+  /** @brief Update the entry or other data structures before a entry is successfully erased,
+   *  remove it from its segment
+   */
+  void
+  beforeErase(InMemoryStorageEntry* entry) override;
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @return{ number of packets the window segment holds when the storage is full }
+   */
+  size_t
+  getWindowCapacity() const;
+
+  size_t
+  getWindowSize() const
+  {
+    return m_window.size();
+  }
+
+  size_t
+  getMainSize() const
+  {
+    return m_locations.size() - m_window.size();
+  }
+
+  uint8_t
+  getFrequency(const InMemoryStorageEntry* entry) const
+  {
+    return m_sketch.getFrequency(std::hash<Name>()(entry->getName()));
+  }
+
+private:
+  /** @brief Move the oldest entry of the window into a free slot of the main segment.
+   */
+  void
+  promoteFromWindow(size_t slot);
+
+  /** @brief Advance the CLOCK hand to the next entry of the main segment that is not referenced,
+   *  clearing the reference bits of the entries it passes.
+   *  @pre the main segment is not empty
+   *  @return{ the slot of the victim }
+   */
+  size_t
+  findClockVictim();
+
+  /** @brief Remove an entry from its segment.
+   */
+  void
+  removeEntry(InMemoryStorageEntry* entry);
+
+private:
+  struct ClockSlot
+  {
+    InMemoryStorageEntry* entry = nullptr;
+    bool isReferenced = false;
+  };
+
+  using Window = std::list<InMemoryStorageEntry*>;
+
+  struct Location
+  {
+    bool isInWindow;
+    Window::iterator windowIt; ///< position in the window, if isInWindow
+    size_t slot; ///< slot in the main segment, if !isInWindow
+  };
+
+  FrequencySketch m_sketch;
+  /// window segment, in LRU order
+  Window m_window;
+  /// main segment
+  std::vector<ClockSlot> m_clock;
+  std::vector<size_t> m_freeSlots;
+  size_t m_hand = 0;
+  std::unordered_map<const InMemoryStorageEntry*, Location> m_locations;
+};
+
+} // namespace ndn
+
+#endif // NDN_IMS_IN_MEMORY_STORAGE_TINYLFU_HPP
@@ -26,24 +26,30 @@ namespace ndn {
 
 const time::milliseconds InMemoryStorage::INFINITE_WINDOW(-1);
 const time::milliseconds InMemoryStorage::ZERO_WINDOW(0);
+constexpr size_t InMemoryStorage::ENTRY_OVERHEAD;
+constexpr size_t InMemoryStorage::COMPACT_ENTRY_OVERHEAD;
 
 InMemoryStorage::const_iterator::const_iterator(const Data* ptr, const Cache* cache,
-                                                Cache::index<byFullName>::type::iterator it)
-  : m_ptr(ptr)
+                                                Cache::index<byName>::type::iterator it)
+  : m_data(shared_ptr<const Data>(), ptr) // not owned
   , m_cache(cache)
   , m_it(it)
 {
+  if (ptr == nullptr && m_it != m_cache->get<byName>().end()) {
+    // a compact entry decodes a packet that only the iterator owns
+    m_data = (*m_it)->getSharedData();
+  }
 }
 
 InMemoryStorage::const_iterator&
 InMemoryStorage::const_iterator::operator++()
 {
   m_it++;
-  if (m_it != m_cache->get<byFullName>().end()) {
-    m_ptr = &((*m_it)->getData());
+  if (m_it != m_cache->get<byName>().end()) {
+    m_data = (*m_it)->getSharedData();
   }
   else {
-    m_ptr = nullptr;
+    m_data = nullptr;
   }
 
   return *this;
@@ -60,13 +66,13 @@ InMemoryStorage::const_iterator::operator++(int)
 InMemoryStorage::const_iterator::reference
 InMemoryStorage::const_iterator::operator*()
 {
-  return *m_ptr;
+  return *m_data;
 }
 
 InMemoryStorage::const_iterator::pointer
 InMemoryStorage::const_iterator::operator->()
 {
-  return m_ptr;
+  return m_data.get();
 }
 
 bool
@@ -88,11 +94,11 @@ InMemoryStorage::InMemoryStorage(size_t limit)
   init();
 }
 
-InMemoryStorage::InMemoryStorage(boost::asio::io_service& ioService, size_t limit)
+InMemoryStorage::InMemoryStorage(boost::asio::io_service&, size_t limit)
   : m_limit(limit)
   , m_nPackets(0)
+  , m_handlesMustBeFresh(true)
 {
-  m_scheduler = make_unique<Scheduler>(ioService);
   init();
 }
 
@@ -157,13 +163,58 @@ InMemoryStorage::setCapacity(size_t capacity)
   BOOST_ASSERT(size() + m_freeEntries.size() == m_capacity);
 }
 
+void
+InMemoryStorage::setByteLimit(size_t nMaxBytes)
+{
+  size_t oldByteLimit = m_byteLimit;
+  m_byteLimit = nMaxBytes;
+
+  while (m_nBytes > m_byteLimit) {
+    if (!evictItem()) {
+      // otherwise, every insertion would try in vain to evict down to the unreachable limit
+      m_byteLimit = oldByteLimit;
+      NDN_THROW(Error());
+    }
+  }
+}
+
 void
 InMemoryStorage::insert(const Data& data, const time::milliseconds& mustBeFreshProcessingWindow)
 {
-  // check if identical Data/Name already exists
-  auto it = m_cache.get<byFullName>().find(data.getFullName());
-  if (it != m_cache.get<byFullName>().end())
-    return;
+  insertImpl(data, mustBeFreshProcessingWindow);
+}
+
+void
+InMemoryStorage::insertBatchImpl(std::vector<const Data*>& packets,
+                                 const time::milliseconds& mustBeFreshProcessingWindow)
+{
+  // sorting the batch lets each index node be linked next to the previous one
+  std::stable_sort(packets.begin(), packets.end(),
+                   [] (const Data* a, const Data* b) { return a->getName() < b->getName(); });
+
+  // grow the memory pool once for the whole batch
+  size_t nNeeded = std::min(size() + packets.size(), getLimit());
+  if (nNeeded > getCapacity()) {
+    setCapacity(nNeeded);
+  }
+
+  auto hint = m_cache.get<byName>().end();
+  for (const Data* data : packets) {
+    insertImpl(*data, mustBeFreshProcessingWindow, &hint);
+  }
+}
+
+InMemoryStorageEntry*
+InMemoryStorage::insertImpl(const Data& data, const time::milliseconds& mustBeFreshProcessingWindow,
+                            Cache::index<byName>::type::iterator* hint)
+{
+  // check if identical Data/Name already exists; two packets with the same name have the same
+  // implicit digest if and only if their wire encodings are equal, which is cheaper to compare
+  auto range = m_cache.get<byNameHash>().equal_range(data.getName());
+  for (auto it = range.first; it != range.second; ++it) {
+    if ((*it)->getWire() == data.wireEncode())
+      return nullptr;
+  }
 
   //if full, double the capacity
   bool doesReachLimit = (getLimit() == getCapacity());
@@ -174,8 +225,18 @@ InMemoryStorage::insert(const Data& data, const time::milliseconds& mustBeFreshP
   }
 
   //if full and reach limitation of the capacity, employ replacement policy
+  bool hasEvicted = false;
   if (isFull() && doesReachLimit) {
-    evictItem();
+    hasEvicted = evictItem();
+  }
+
+  //if over the byte limit, employ replacement policy until the packet fits
+  size_t entrySize = getEntrySize(data.wireEncode().size(), m_isCompactMode);
+  while (size() > 0 && m_nBytes + entrySize > m_byteLimit) {
+    if (!evictItem()) {
+      break;
+    }
+    hasEvicted = true;
   }
 
   //insert to cache
@@ -184,74 +245,191 @@ InMemoryStorage::insert(const Data& data, const time::milliseconds& mustBeFreshP
   InMemoryStorageEntry* entry = m_freeEntries.top();
   m_freeEntries.pop();
   m_nPackets++;
-  entry->setData(data);
-  if (m_scheduler != nullptr && mustBeFreshProcessingWindow > ZERO_WINDOW) {
-    entry->scheduleMarkStale(*m_scheduler, mustBeFreshProcessingWindow);
+  m_nBytes += entrySize;
+  if (m_isCompactMode) {
+    entry->setCompactData(data);
+  }
+  else {
+    entry->setData(data);
+  }
+  if (m_handlesMustBeFresh && mustBeFreshProcessingWindow > ZERO_WINDOW) {
+    entry->setStaleTime(time::steady_clock::now() + mustBeFreshProcessingWindow);
+  }
+  if (hint == nullptr) {
+    m_cache.insert(entry);
+  }
+  else {
+    // an eviction may have erased the hinted node
+    auto& index = m_cache.get<byName>();
+    auto it = hasEvicted ? index.insert(entry).first : index.insert(*hint, entry);
+    *hint = std::next(it);
   }
-  m_cache.insert(entry);
 
   //let derived class do something with the entry
   afterInsert(entry);
+  return entry;
+}
+
+InMemoryStorageEntry*
+InMemoryStorage::promoteFromDisk(const shared_ptr<const Data>& data)
+{
+  // erase from the disk tier first, so that a packet evicted by the insertion is not erased
+  try {
+    m_diskTier->erase(data->getName(), false);
+  }
+  catch (const DiskStorage::Error&) {
+    // the stale copy is replaced when the packet is evicted again
+  }
+
+  InMemoryStorageEntry* entry = insertImpl(*data, INFINITE_WINDOW);
+  if (entry != nullptr && m_handlesMustBeFresh) {
+    entry->markStale();
+  }
+  return entry;
+}
+
+void
+InMemoryStorage::spillToDisk(const InMemoryStorageEntry& entry)
+{
+  if (m_diskTier == nullptr) {
+    return;
+  }
+
+  try {
+    m_diskTier->insert(*entry.getSharedData());
+  }
+  catch (const DiskStorage::Error&) {
+    // the packet is dropped, as it would be without a disk tier
+  }
 }
 
 shared_ptr<const Data>
 InMemoryStorage::find(const Name& name)
 {
-  auto it = m_cache.get<byFullName>().lower_bound(name);
+  // an exact Name or Full Name is located in the hashed index
+  InMemoryStorageEntry* entry = nullptr;
+  auto nameIt = m_cache.get<byNameHash>().find(name);
+  if (nameIt != m_cache.get<byNameHash>().end()) {
+    entry = *nameIt;
+  }
+  else if (!name.empty() && name[-1].isImplicitSha256Digest()) {
+    auto fullNameIt = findByFullName(name);
+    if (fullNameIt != m_cache.get<byNameHash>().end()) {
+      entry = *fullNameIt;
+    }
+  }
 
-  // if not found, return null
-  if (it == m_cache.get<byFullName>().end()) {
-    return nullptr;
+  if (entry == nullptr) {
+    auto it = m_cache.get<byName>().lower_bound(name);
+    if (it != m_cache.get<byName>().end() && name.isPrefixOf((*it)->getName())) {
+      entry = *it;
+    }
+  }
+
+  if (entry == nullptr && m_diskTier != nullptr) {
+    auto data = m_diskTier->find(name);
+    if (data != nullptr) {
+      entry = promoteFromDisk(data);
+    }
   }
 
-  // if the given name is not the prefix of the lower_bound, return null
-  if (!name.isPrefixOf((*it)->getFullName())) {
+  if (entry == nullptr) {
     return nullptr;
   }
 
-  afterAccess(*it);
-  return ((*it)->getData()).shared_from_this();
+  afterAccess(entry);
+  return entry->getSharedData();
 }
 
 shared_ptr<const Data>
 InMemoryStorage::find(const Interest& interest)
 {
-  // if the interest contains implicit digest, it is possible to directly locate a packet.
-  auto it = m_cache.get<byFullName>().find(interest.getName());
+  const Name& name = interest.getName();
+  InMemoryStorageEntry* ret = nullptr;
 
-  // if a packet is located by its full name, it must be the packet to return.
-  if (it != m_cache.get<byFullName>().end()) {
-    return ((*it)->getData()).shared_from_this();
+  // an Interest that cannot match longer names, or that carries an implicit digest,
+  // is satisfied only by an exact match
+  if (!interest.getCanBePrefix() || (!name.empty() && name[-1].isImplicitSha256Digest())) {
+    ret = findExact(interest);
   }
 
-  // if the packet is not discovered by last step, either the packet is not in the storage or
-  // the interest doesn't contains implicit digest.
-  it = m_cache.get<byFullName>().lower_bound(interest.getName());
+  if (ret == nullptr && interest.getCanBePrefix()) {
+    auto it = m_cache.get<byName>().lower_bound(name);
 
-  if (it == m_cache.get<byFullName>().end()) {
-    return nullptr;
+    if (it != m_cache.get<byName>().end()) {
+      // to locate the element that has a just smaller name than the interest's
+      if (it != m_cache.get<byName>().begin()) {
+        it--;
+      }
+
+      ret = selectChild(interest, it);
+    }
   }
 
-  // to locate the element that has a just smaller name than the interest's
-  if (it != m_cache.get<byFullName>().begin()) {
-    it--;
+  if (ret == nullptr && m_diskTier != nullptr) {
+    auto data = m_diskTier->find(interest);
+    if (data != nullptr) {
+      ret = promoteFromDisk(data);
+    }
   }
 
-  InMemoryStorageEntry* ret = selectChild(interest, it);
   if (ret == nullptr) {
     return nullptr;
   }
 
   // let derived class do something with the entry
   afterAccess(ret);
-  return ret->getData().shared_from_this();
+  return ret->getSharedData();
 }
 
-InMemoryStorage::Cache::index<InMemoryStorage::byFullName>::type::iterator
-InMemoryStorage::findNextFresh(Cache::index<byFullName>::type::iterator it) const
+InMemoryStorageEntry*
+InMemoryStorage::findExact(const Interest& interest) const
+{
+  const Name& name = interest.getName();
+  auto now = interest.getMustBeFresh() ? time::steady_clock::now() : time::steady_clock::TimePoint();
+  auto isMatch = [&interest, now] (InMemoryStorageEntry* entry) {
+    return (!interest.getMustBeFresh() || entry->isFresh(now)) && entry->canSatisfy(interest);
+  };
+
+  if (!name.empty() && name[-1].isImplicitSha256Digest()) {
+    auto it = findByFullName(name);
+    if (it != m_cache.get<byNameHash>().end() && isMatch(*it)) {
+      return *it;
+    }
+  }
+
+  auto range = m_cache.get<byNameHash>().equal_range(name);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (isMatch(*it)) {
+      return *it;
+    }
+  }
+
+  return nullptr;
+}
+
+InMemoryStorage::Cache::index<InMemoryStorage::byNameHash>::type::iterator
+InMemoryStorage::findByFullName(const Name& fullName) const
 {
-  for (; it != m_cache.get<byFullName>().end(); it++) {
-    if ((*it)->isFresh())
+  if (fullName.empty() || !fullName[-1].isImplicitSha256Digest()) {
+    return m_cache.get<byNameHash>().end();
+  }
+
+  auto range = m_cache.get<byNameHash>().equal_range(fullName.getPrefix(-1));
+  for (auto it = range.first; it != range.second; ++it) {
+    if ((*it)->getFullName() == fullName) {
+      return it;
+    }
+  }
+  return m_cache.get<byNameHash>().end();
+}
+
+InMemoryStorage::Cache::index<InMemoryStorage::byName>::type::iterator
+InMemoryStorage::findNextFresh(Cache::index<byName>::type::iterator it,
+                               const time::steady_clock::TimePoint& now) const
+{
+  for (; it != m_cache.get<byName>().end(); it++) {
+    if ((*it)->isFresh(now))
       return it;
   }
 
@@ -260,24 +438,25 @@ InMemoryStorage::findNextFresh(Cache::index<byFullName>::type::iterator it) cons
 
 InMemoryStorageEntry*
 InMemoryStorage::selectChild(const Interest& interest,
-                             Cache::index<byFullName>::type::iterator startingPoint) const
+                             Cache::index<byName>::type::iterator startingPoint) const
 {
-  BOOST_ASSERT(startingPoint != m_cache.get<byFullName>().end());
+  BOOST_ASSERT(startingPoint != m_cache.get<byName>().end());
 
-  if (startingPoint != m_cache.get<byFullName>().begin()) {
-    BOOST_ASSERT((*startingPoint)->getFullName() < interest.getName());
+  if (startingPoint != m_cache.get<byName>().begin()) {
+    BOOST_ASSERT((*startingPoint)->getName() < interest.getName());
   }
 
   // filter out non-fresh data
+  auto now = interest.getMustBeFresh() ? time::steady_clock::now() : time::steady_clock::TimePoint();
   if (interest.getMustBeFresh()) {
-    startingPoint = findNextFresh(startingPoint);
+    startingPoint = findNextFresh(startingPoint, now);
   }
 
-  if (startingPoint == m_cache.get<byFullName>().end()) {
+  if (startingPoint == m_cache.get<byName>().end()) {
     return nullptr;
   }
 
-  if (interest.matchesData((*startingPoint)->getData())) {
+  if ((*startingPoint)->canSatisfy(interest)) {
     return *startingPoint;
   }
 
@@ -287,15 +466,15 @@ InMemoryStorage::selectChild(const Interest& interest,
     ++rightmostCandidate;
     // filter out non-fresh data
     if (interest.getMustBeFresh()) {
-      rightmostCandidate = findNextFresh(rightmostCandidate);
+      rightmostCandidate = findNextFresh(rightmostCandidate, now);
     }
 
     bool isInPrefix = false;
-    if (rightmostCandidate != m_cache.get<byFullName>().end()) {
-      isInPrefix = interest.getName().isPrefixOf((*rightmostCandidate)->getFullName());
+    if (rightmostCandidate != m_cache.get<byName>().end()) {
+      isInPrefix = interest.getName().isPrefixOf((*rightmostCandidate)->getName());
     }
     if (isInPrefix) {
-      if (interest.matchesData((*rightmostCandidate)->getData())) {
+      if ((*rightmostCandidate)->canSatisfy(interest)) {
         return *rightmostCandidate;
       }
     }
@@ -309,60 +488,100 @@ InMemoryStorage::selectChild(const Interest& interest,
 
 InMemoryStorage::Cache::iterator
 InMemoryStorage::freeEntry(Cache::iterator it)
+{
+  InMemoryStorageEntry* entry = *it;
+  it = m_cache.erase(it);
+  recycleEntry(entry);
+  return it;
+}
+
+void
+InMemoryStorage::recycleEntry(InMemoryStorageEntry* entry)
 {
   // push the *empty* entry into mem pool
-  (*it)->release();
-  m_freeEntries.push(*it);
+  m_nBytes -= getEntrySize(entry->getWire().size(), entry->isCompact());
+  entry->release();
+  m_freeEntries.push(entry);
   m_nPackets--;
-  return m_cache.erase(it);
 }
 
 void
 InMemoryStorage::erase(const Name& prefix, const bool isPrefix)
 {
   if (isPrefix) {
-    auto it = m_cache.get<byFullName>().lower_bound(prefix);
-    while (it != m_cache.get<byFullName>().end() && prefix.isPrefixOf((*it)->getName())) {
+    auto& index = m_cache.get<byName>();
+    auto first = index.lower_bound(prefix);
+    // every name under a non-empty prefix precedes the successor of the prefix
+    auto last = prefix.empty() ? index.end() : index.lower_bound(prefix.getSuccessor());
+
+    m_erasedEntries.clear();
+    for (auto it = first; it != last; ++it) {
       // let derived class do something with the entry
       beforeErase(*it);
-      it = freeEntry(it);
+      m_erasedEntries.push_back(*it);
+    }
+    index.erase(first, last);
+
+    size_t nBytes = 0;
+    for (InMemoryStorageEntry* entry : m_erasedEntries) {
+      nBytes += getEntrySize(entry->getWire().size(), entry->isCompact());
+      entry->release();
+      m_freeEntries.push(entry);
     }
+    m_nBytes -= nBytes;
+    m_nPackets -= m_erasedEntries.size();
   }
   else {
-    auto it = m_cache.get<byFullName>().find(prefix);
-    if (it == m_cache.get<byFullName>().end())
+    auto it = findByFullName(prefix);
+    if (it == m_cache.get<byNameHash>().end())
       return;
 
     // let derived class do something with the entry
     beforeErase(*it);
-    freeEntry(it);
+    freeEntry(m_cache.project<byName>(it));
   }
 
   if (m_freeEntries.size() > (2 * size()))
     setCapacity(getCapacity() / 2);
+
+  if (m_diskTier != nullptr) {
+    m_diskTier->erase(prefix, isPrefix);
+  }
 }
 
 void
 InMemoryStorage::eraseImpl(const Name& name)
 {
-  auto it = m_cache.get<byFullName>().find(name);
-  if (it == m_cache.get<byFullName>().end())
+  auto it = findByFullName(name);
+  if (it == m_cache.get<byNameHash>().end())
+    return;
+
+  spillToDisk(**it);
+  freeEntry(m_cache.project<byName>(it));
+}
+
+void
+InMemoryStorage::eraseImpl(InMemoryStorageEntry* entry)
+{
+  auto range = m_cache.get<byNameHash>().equal_range(entry->getName());
+  auto it = std::find(range.first, range.second, entry);
+  if (it == range.second)
     return;
 
-  freeEntry(it);
+  spillToDisk(*entry);
+  freeEntry(m_cache.project<byName>(it));
 }
 
 InMemoryStorage::const_iterator
 InMemoryStorage::begin() const
 {
-  auto it = m_cache.get<byFullName>().begin();
-  return const_iterator(&((*it)->getData()), &m_cache, it);
+  return const_iterator(nullptr, &m_cache, m_cache.get<byName>().begin());
 }
 
 InMemoryStorage::const_iterator
 InMemoryStorage::end() const
 {
-  auto it = m_cache.get<byFullName>().end();
+  auto it = m_cache.get<byName>().end();
   return const_iterator(nullptr, &m_cache, it);
 }
 
@@ -385,7 +604,7 @@ void
 InMemoryStorage::printCache(std::ostream& os) const
 {
   // start from the upper layer towards bottom
-  for (const auto& elem : m_cache.get<byFullName>())
+  for (const auto& elem : m_cache.get<byName>())
     os << elem->getFullName() << std::endl;
 }
 
@@ -22,12 +22,16 @@
 #ifndef NDN_IMS_IN_MEMORY_STORAGE_HPP
 #define NDN_IMS_IN_MEMORY_STORAGE_HPP
 
+#include "ndn-cxx/detail/asio-fwd.hpp"
+#include "ndn-cxx/ims/disk-storage.hpp"
 #include "ndn-cxx/ims/in-memory-storage-entry.hpp"
 
 #include <iterator>
 #include <stack>
+#include <vector>
 
 #include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/mem_fun.hpp>
 #include <boost/multi_index/member.hpp>
@@ -42,18 +46,30 @@ class InMemoryStorage : noncopyable
 {
 public:
   // multi_index_container to implement storage
-  class byFullName;
+  //
+  // Entries are keyed by Name without implicit digest, so that inserting a packet does not
+  // require computing its digest. Packets with the same Name are adjacent in the ordered index.
+  class byName;
+  class byNameHash;
 
   typedef boost::multi_index_container<
     InMemoryStorageEntry*,
     boost::multi_index::indexed_by<
 
-      // by Full Name
-      boost::multi_index::ordered_unique<
-        boost::multi_index::tag<byFullName>,
+      // by Name, for prefix and child selection
+      boost::multi_index::ordered_non_unique<
+        boost::multi_index::tag<byName>,
         boost::multi_index::const_mem_fun<InMemoryStorageEntry, const Name&,
-                                          &InMemoryStorageEntry::getFullName>,
+                                          &InMemoryStorageEntry::getName>,
         std::less<Name>
+      >,
+
+      // by Name, for exact lookups
+      boost::multi_index::hashed_non_unique<
+        boost::multi_index::tag<byNameHash>,
+        boost::multi_index::const_mem_fun<InMemoryStorageEntry, const Name&,
+                                          &InMemoryStorageEntry::getName>,
+        std::hash<Name>
       >
 
     >
@@ -72,8 +88,11 @@ public:
     using pointer           = value_type*;
     using reference         = value_type&;
 
+    /** @param ptr the packet at @p it, which must stay valid while the iterator points to it;
+     *             or nullptr, in which case the packet is obtained from the entry at @p it
+     */
     const_iterator(const Data* ptr, const Cache* cache,
-                   Cache::index<byFullName>::type::iterator it);
+                   Cache::index<byName>::type::iterator it);
 
     const_iterator&
     operator++();
@@ -94,9 +113,9 @@ public:
     operator!=(const const_iterator& rhs);
 
   private:
-    const Data* m_ptr;
+    shared_ptr<const Data> m_data;
     const Cache* m_cache;
-    Cache::index<byFullName>::type::iterator m_it;
+    Cache::index<byName>::type::iterator m_it;
   };
 
   /** @brief Represents an error might be thrown during reduce the current capacity of the
@@ -119,6 +138,9 @@ public:
 
   /** @brief Create a InMemoryStorage with up to @p limit entries
    *  The InMemoryStorage created through this method will handle MustBeFresh in interest processing
+   *
+   *  Each entry records when it becomes stale, which is compared with time::steady_clock when
+   *  the entry is looked up; no event is scheduled on @p ioService.
    */
   explicit
   InMemoryStorage(boost::asio::io_service& ioService,
@@ -136,7 +158,9 @@ public:
    *  @param mustBeFreshProcessingWindow Beyond this time period after the data is inserted, the
    *         data can only be used to answer interest without MustBeFresh selector.
    *
-   *  @note Packets are considered duplicate if the name with implicit digest matches.
+   *  @note Packets are considered duplicate if the name with implicit digest matches, which is
+   *  checked by comparing the wire encoding of packets with the same name. The implicit digest
+   *  is not computed on insertion.
    *  The new Data packet with the identical name, but a different payload
    *  will be placed in the in-memory storage.
    *
@@ -145,13 +169,40 @@ public:
   void
   insert(const Data& data, const time::milliseconds& mustBeFreshProcessingWindow = INFINITE_WINDOW);
 
+  /** @brief Inserts several Data packets
+   *
+   *  This is equivalent to inserting the packets one by one in name order, but the capacity is
+   *  grown once for the whole batch, and each packet is linked into the ordered index next to
+   *  the previous one, which is faster when the packets have adjacent names, e.g., the segments
+   *  of an object.
+   *
+   *  @param packets a range of pointers (raw or smart) to the packets to insert, which must be
+   *         signed and have wire encoding
+   *  @param mustBeFreshProcessingWindow applies to every packet, see insert()
+   */
+  template<typename Range>
+  void
+  insertBatch(const Range& packets,
+              const time::milliseconds& mustBeFreshProcessingWindow = INFINITE_WINDOW)
+  {
+    std::vector<const Data*> batch;
+    for (const auto& data : packets) {
+      batch.push_back(&*data);
+    }
+    insertBatchImpl(batch, mustBeFreshProcessingWindow);
+  }
+
   /** @brief Finds the best match Data for an Interest
+   *
+   *  An Interest with CanBePrefix=false, or whose name ends with an implicit digest, is looked
+   *  up in the hashed index. Otherwise, the ordered index is searched from the Interest name.
+   *  The implicit digest of a stored packet is computed only if the Interest name ends with an
+   *  implicit digest and the rest of it equals the packet name.
+   *
+   *  If nothing in memory matches and a disk tier is set, the packet found there is moved back
+   *  into memory.
    *
    *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>).
-   *  As currently it is impossible to determine whether a Name contains implicit digest or not,
-   *  therefore this find function is not able to locate a packet according to an interest(
-   *  including implicit digest) whose name is not the full name of the data matching the
-   *  implicit digest.
    *
    *  @return{ the best match, if any; otherwise a null shared_ptr }
    */
@@ -165,6 +216,9 @@ public:
    *  and the Name supplied is the one without implicit digest, a packet
    *  will be arbitrarily chosen to return.
    *
+   *  If nothing in memory matches and a disk tier is set, the packet found there is moved back
+   *  into memory.
+   *
    *  @note It will invoke afterAccess(shared_ptr<InMemoryStorageEntry>).
    *
    *  @return{ the one matched the Name; otherwise a null shared_ptr }
@@ -173,10 +227,14 @@ public:
   find(const Name& name);
 
   /** @brief Deletes in-memory storage entry by prefix by default.
+   *
+   *  The packets under a prefix are delimited with two lookups in the ordered index, and
+   *  unlinked from the indexes with one range erasure.
    *  @param prefix Exact name of a prefix of the data to remove
    *  @param isPrefix If false, the function will only delete the
    *  entry completely matched with the prefix according to canonical ordering.
    *  For this case, user should substitute the prefix with full name.
+   *  The packets are erased from the disk tier as well.
    *
    *  @warning Please do not use this function directly in any derived class to erase
    *  an entry from the cache, use eraseImpl() instead.
@@ -201,6 +259,84 @@ public:
     return m_nPackets;
   }
 
+  /** @brief Limits the memory used by the packets stored in in-memory storage
+   *
+   *  Each packet is accounted for by the size of its wire encoding plus ENTRY_OVERHEAD,
+   *  or COMPACT_ENTRY_OVERHEAD in compact mode.
+   *  Before a packet is inserted, the replacement policy evicts packets until the new one fits
+   *  in the limit. A packet larger than the limit is still stored, once all others are evicted.
+   *  If the limit is lower than the current usage, packets are evicted immediately.
+   *
+   *  @throw Error the replacement policy cannot bring the usage under the new limit;
+   *               the previous limit is kept, but packets evicted in the attempt are not restored
+   */
+  void
+  setByteLimit(size_t nMaxBytes);
+
+  /** @return{ maximum number of bytes that can be used by packets in in-memory storage }
+   */
+  size_t
+  getByteLimit() const
+  {
+    return m_byteLimit;
+  }
+
+  /** @return{ number of bytes used by packets stored in in-memory storage,
+   *           including the per-entry overhead }
+   */
+  size_t
+  getNBytes() const
+  {
+    return m_nBytes;
+  }
+
+  /** @brief Enables or disables compact entries for the packets inserted afterwards
+   *
+   *  A compact entry keeps the wire encoding of its packet, with the name and FreshnessPeriod
+   *  needed to match Interests, instead of sharing the inserted Data. Once the application
+   *  releases the Data, a small packet takes a fraction of the memory it would otherwise take.
+   *  In exchange, find() and iteration decode a new Data from the wire encoding every time
+   *  they return a packet from a compact entry.
+   *
+   *  Compact entries are accounted for with COMPACT_ENTRY_OVERHEAD instead of ENTRY_OVERHEAD.
+   */
+  void
+  setCompactMode(bool isCompact)
+  {
+    m_isCompactMode = isCompact;
+  }
+
+  /** @return{ whether packets are inserted into compact entries }
+   */
+  bool
+  isCompactMode() const
+  {
+    return m_isCompactMode;
+  }
+
+  /** @brief Sets a disk tier, or unsets it if @p diskTier is null
+   *
+   *  Packets evicted by the replacement policy are written to the disk tier instead of being
+   *  dropped, and a lookup that misses in memory moves the packet found in the disk tier back
+   *  into memory. Packets moved back are stale: they do not satisfy an Interest with MustBeFresh
+   *  if the in-memory storage handles MustBeFresh.
+   *
+   *  The disk tier can be shared by several in-memory storages.
+   */
+  void
+  setDiskTier(shared_ptr<DiskStorage> diskTier)
+  {
+    m_diskTier = std::move(diskTier);
+  }
+
+  /** @return{ the disk tier, or null if none is set }
+   */
+  const shared_ptr<DiskStorage>&
+  getDiskTier() const
+  {
+    return m_diskTier;
+  }
+
   /** @brief Returns begin iterator of the in-memory storage ordering by
    *  name with digest
    *
@@ -273,19 +409,46 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PROTECTED:
 
   /** @brief deletes in-memory storage entries by the Name with implicit digest.
    *
-   *  This is the function one should use to erase entry in the cache
-   *  in derived class.
+   *  The packet is written to the disk tier, if any.
    *  It won't invoke beforeErase(shared_ptr<Entry>).
    */
   void
   eraseImpl(const Name& name);
 
+  /** @brief deletes an in-memory storage entry.
+   *
+   *  This is the function one should use to erase entry in the cache
+   *  in derived class; unlike eraseImpl(const Name&), it does not compute the implicit digest.
+   *  The packet is written to the disk tier, if any.
+   *  It won't invoke beforeErase(shared_ptr<Entry>).
+   */
+  void
+  eraseImpl(InMemoryStorageEntry* entry);
+
   /** @brief Prints contents of the in-memory storage
    */
   void
   printCache(std::ostream& os) const;
 
 NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  /** @brief Finds a Data whose name or full name equals the Interest name, using the hashed
+   *  index.
+   *
+   *  MustBeFresh is honored. If several packets have the Interest name, any of them that
+   *  satisfies the Interest may be returned.
+   *  @return{ the match, if any; otherwise nullptr }
+   */
+  InMemoryStorageEntry*
+  findExact(const Interest& interest) const;
+
+  /** @brief Finds the entry whose Name with implicit digest equals @p fullName.
+   *
+   *  Only the digests of packets whose name is @p fullName without its last component are
+   *  computed.
+   */
+  Cache::index<byNameHash>::type::iterator
+  findByFullName(const Name& fullName) const;
+
   /** @brief free in-memory storage entries by an iterator pointing to that entry.
       @return An iterator pointing to the element that followed the last element erased.
    */
@@ -308,23 +471,67 @@ NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
    */
   InMemoryStorageEntry*
   selectChild(const Interest& interest,
-              Cache::index<byFullName>::type::iterator startingPoint) const;
+              Cache::index<byName>::type::iterator startingPoint) const;
 
   /** @brief Get the next iterator (include startingPoint) that satisfies MustBeFresh requirement
    *
    *  @param startingPoint The iterator to start with.
+   *  @param now The time of the lookup.
    *  @return The next qualified iterator
    */
-  Cache::index<byFullName>::type::iterator
-  findNextFresh(Cache::index<byFullName>::type::iterator startingPoint) const;
+  Cache::index<byName>::type::iterator
+  findNextFresh(Cache::index<byName>::type::iterator startingPoint,
+                const time::steady_clock::TimePoint& now) const;
 
 private:
   void
   init();
 
+  void
+  insertBatchImpl(std::vector<const Data*>& packets,
+                  const time::milliseconds& mustBeFreshProcessingWindow);
+
+  /** @brief Inserts a Data packet.
+   *  @param hint if not null, the packet is linked into the ordered index just before @p *hint,
+   *         if that is its position, and @p *hint is set to the node following the packet
+   *  @return{ the new entry, or nullptr if the packet is already stored }
+   */
+  InMemoryStorageEntry*
+  insertImpl(const Data& data, const time::milliseconds& mustBeFreshProcessingWindow,
+             Cache::index<byName>::type::iterator* hint = nullptr);
+
+  /** @brief Returns an entry that has been unlinked from the indexes to the memory pool.
+   */
+  void
+  recycleEntry(InMemoryStorageEntry* entry);
+
+  /** @brief Moves a packet found in the disk tier into memory.
+   */
+  InMemoryStorageEntry*
+  promoteFromDisk(const shared_ptr<const Data>& data);
+
+  /** @brief Writes an evicted packet to the disk tier, if any.
+   */
+  void
+  spillToDisk(const InMemoryStorageEntry& entry);
+
+  static size_t
+  getEntrySize(size_t wireSize, bool isCompact)
+  {
+    return wireSize + (isCompact ? COMPACT_ENTRY_OVERHEAD : ENTRY_OVERHEAD);
+  }
+
 public:
   static const time::milliseconds INFINITE_WINDOW;
 
+  /// estimated memory used by an entry in addition to the wire encoding of its packet
+  static constexpr size_t ENTRY_OVERHEAD = sizeof(InMemoryStorageEntry) + sizeof(Data) +
+                                           12 * sizeof(void*);
+
+  /// estimated memory used by a compact entry in addition to the wire encoding of its packet
+  static constexpr size_t COMPACT_ENTRY_OVERHEAD = sizeof(InMemoryStorageEntry) + sizeof(Block) +
+                                                   sizeof(Name) + 16 * sizeof(void*);
+
 private:
   static const time::milliseconds ZERO_WINDOW;
 
@@ -338,10 +545,20 @@ private:
   size_t m_capacity;
   /// current number of packets in in-memory storage
   size_t m_nPackets;
+  /// user defined maximum number of bytes used by packets in in-memory storage
+  size_t m_byteLimit = std::numeric_limits<size_t>::max();
+  /// current number of bytes used by packets in in-memory storage
+  size_t m_nBytes = 0;
   /// memory pool
   std::stack<InMemoryStorageEntry*> m_freeEntries;
-  /// scheduler
-  unique_ptr<Scheduler> m_scheduler;
+  /// entries unlinked by erase(), kept to reuse its allocation
+  std::vector<InMemoryStorageEntry*> m_erasedEntries;
+  /// whether entries become stale after their MustBeFresh processing window
+  bool m_handlesMustBeFresh = false;
+  /// whether packets are inserted into compact entries
+  bool m_isCompactMode = false;
+  /// second tier for evicted packets
+  shared_ptr<DiskStorage> m_diskTier;
 };
 
 } // namespace ndn
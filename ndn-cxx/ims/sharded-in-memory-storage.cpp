@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/sharded-in-memory-storage.hpp"
+
+#include <boost/functional/hash.hpp>
+
+namespace ndn {
+
+ShardedInMemoryStorage::ShardedInMemoryStorage(size_t nShards, size_t prefixLength,
+                                               const StorageFactory& makeStorage)
+  : m_prefixLength(prefixLength)
+{
+  if (nShards == 0) {
+    NDN_THROW(std::invalid_argument("ShardedInMemoryStorage needs at least one shard"));
+  }
+  if (makeStorage == nullptr) {
+    NDN_THROW(std::invalid_argument("ShardedInMemoryStorage needs a storage factory"));
+  }
+
+  m_shards.reserve(nShards);
+  for (size_t i = 0; i < nShards; ++i) {
+    m_shards.push_back(make_unique<Shard>());
+    m_shards.back()->storage = makeStorage();
+  }
+}
+
+size_t
+ShardedInMemoryStorage::getShardIndex(const Name& name) const
+{
+  // hash the components one by one, so that no prefix Name needs to be constructed
+  size_t seed = 0;
+  size_t nComponents = std::min(m_prefixLength, name.size());
+  for (size_t i = 0; i < nComponents; ++i) {
+    boost::hash_combine(seed, name[i].type());
+    boost::hash_range(seed, name[i].value_begin(), name[i].value_end());
+  }
+  return seed % m_shards.size();
+}
+
+optional<size_t>
+ShardedInMemoryStorage::findShard(const Name& prefix, bool isWholeName) const
+{
+  if (isWholeName || prefix.size() >= m_prefixLength) {
+    return getShardIndex(prefix);
+  }
+  return nullopt;
+}
+
+template<typename F>
+void
+ShardedInMemoryStorage::forEachShard(const F& f)
+{
+  for (auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    f(*shard->storage);
+  }
+}
+
+void
+ShardedInMemoryStorage::insert(const Data& data, const time::milliseconds& mustBeFreshProcessingWindow)
+{
+  Shard& shard = *m_shards[getShardIndex(data.getName())];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.storage->insert(data, mustBeFreshProcessingWindow);
+}
+
+shared_ptr<const Data>
+ShardedInMemoryStorage::find(const Interest& interest)
+{
+  const Name& name = interest.getName();
+  bool hasDigest = !name.empty() && name[-1].isImplicitSha256Digest();
+  auto shardIndex = findShard(hasDigest ? name.getPrefix(-1) : name, !interest.getCanBePrefix());
+
+  if (shardIndex) {
+    Shard& shard = *m_shards[*shardIndex];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.storage->find(interest);
+  }
+
+  // the leftmost match among the shards, as InMemoryStorage would return from a single index
+  shared_ptr<const Data> best;
+  forEachShard([&] (InMemoryStorage& storage) {
+    auto found = storage.find(interest);
+    if (found != nullptr && (best == nullptr || found->getName() < best->getName())) {
+      best = std::move(found);
+    }
+  });
+  return best;
+}
+
+shared_ptr<const Data>
+ShardedInMemoryStorage::find(const Name& name)
+{
+  bool hasDigest = !name.empty() && name[-1].isImplicitSha256Digest();
+  auto shardIndex = findShard(hasDigest ? name.getPrefix(-1) : name, false);
+
+  if (shardIndex) {
+    Shard& shard = *m_shards[*shardIndex];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.storage->find(name);
+  }
+
+  for (auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto found = shard->storage->find(name);
+    if (found != nullptr) {
+      return found;
+    }
+  }
+  return nullptr;
+}
+
+void
+ShardedInMemoryStorage::erase(const Name& prefix, bool isPrefix)
+{
+  optional<size_t> shardIndex;
+  if (isPrefix) {
+    shardIndex = findShard(prefix, false);
+  }
+  else if (!prefix.empty()) {
+    // a full name, whose packet is in the shard of the name without digest
+    shardIndex = findShard(prefix.getPrefix(-1), true);
+  }
+
+  if (shardIndex) {
+    Shard& shard = *m_shards[*shardIndex];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.storage->erase(prefix, isPrefix);
+    return;
+  }
+
+  forEachShard([&] (InMemoryStorage& storage) {
+    storage.erase(prefix, isPrefix);
+  });
+}
+
+size_t
+ShardedInMemoryStorage::size() const
+{
+  size_t n = 0;
+  for (const auto& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    n += shard->storage->size();
+  }
+  return n;
+}
+
+} // namespace ndn
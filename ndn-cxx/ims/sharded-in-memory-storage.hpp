@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_IMS_SHARDED_IN_MEMORY_STORAGE_HPP
+#define NDN_IMS_SHARDED_IN_MEMORY_STORAGE_HPP
+
+#include "ndn-cxx/ims/in-memory-storage.hpp"
+
+#include <mutex>
+
+namespace ndn {
+
+/** @brief Provides an in-memory storage that can be used from several threads concurrently.
+ *
+ *  The storage is partitioned into shards, each an InMemoryStorage with its own replacement
+ *  policy instance and its own lock. A packet is stored in the shard selected by the hash of the
+ *  first @c prefixLength components of its name, so that threads inserting or looking up
+ *  different names rarely contend for the same lock.
+ *
+ *  An Interest or erase prefix that has at least @c prefixLength components (not counting an
+ *  implicit digest) involves a single shard. A shorter prefix may match packets in any shard,
+ *  so every shard is searched, one at a time.
+ *
+ *  Shards created with an io_service handle MustBeFresh. Freshness is checked when a packet is
+ *  looked up, under the shard lock, so the io_service does not need to run.
+ */
+class ShardedInMemoryStorage : noncopyable
+{
+public:
+  /** @brief Creates the InMemoryStorage of one shard.
+   */
+  using StorageFactory = std::function<unique_ptr<InMemoryStorage>()>;
+
+  /** @brief Create a storage of @p nShards shards.
+   *  @param nShards number of shards, must be positive
+   *  @param prefixLength number of name components that select the shard of a packet
+   *  @param makeStorage creates the storage of each shard
+   *  @throw std::invalid_argument @p nShards is zero or @p makeStorage is empty
+   */
+  ShardedInMemoryStorage(size_t nShards, size_t prefixLength, const StorageFactory& makeStorage);
+
+  /** @brief Inserts a Data packet into its shard
+   *  @sa InMemoryStorage::insert
+   */
+  void
+  insert(const Data& data,
+         const time::milliseconds& mustBeFreshProcessingWindow = InMemoryStorage::INFINITE_WINDOW);
+
+  /** @brief Finds the best match Data for an Interest
+   *
+   *  When several shards are searched, the match with the smallest name is returned.
+   *  @sa InMemoryStorage::find(const Interest&)
+   */
+  shared_ptr<const Data>
+  find(const Interest& interest);
+
+  /** @brief Finds a Data whose name, or full name, starts with @p name
+   *  @sa InMemoryStorage::find(const Name&)
+   */
+  shared_ptr<const Data>
+  find(const Name& name);
+
+  /** @brief Deletes the entries under @p prefix, or the entry with full name @p prefix
+   *  @sa InMemoryStorage::erase
+   */
+  void
+  erase(const Name& prefix, bool isPrefix = true);
+
+  /** @return{ number of packets stored in all shards }
+   *  @note The shards are counted one at a time, so the result may not reflect concurrent
+   *        insertions or erasures.
+   */
+  size_t
+  size() const;
+
+  size_t
+  getNShards() const
+  {
+    return m_shards.size();
+  }
+
+  size_t
+  getPrefixLength() const
+  {
+    return m_prefixLength;
+  }
+
+  /** @brief Get the shard that stores packets whose name is, or starts with, @p name
+   *  @pre @p name has at least getPrefixLength() components, or is the whole name of a packet
+   */
+  size_t
+  getShardIndex(const Name& name) const;
+
+private:
+  struct Shard
+  {
+    mutable std::mutex mutex;
+    unique_ptr<InMemoryStorage> storage;
+  };
+
+  /** @brief Get the shard that holds every packet under @p prefix, if there is a single one
+   *  @param prefix name without implicit digest
+   *  @param isWholeName whether @p prefix is the whole name of the packets sought
+   */
+  optional<size_t>
+  findShard(const Name& prefix, bool isWholeName) const;
+
+  template<typename F>
+  void
+  forEachShard(const F& f);
+
+private:
+  std::vector<unique_ptr<Shard>> m_shards;
+  const size_t m_prefixLength;
+};
+
+} // namespace ndn
+
+#endif // NDN_IMS_SHARDED_IN_MEMORY_STORAGE_HPP
@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/interest-template.hpp"
+#include "ndn-cxx/util/random.hpp"
+
+#include <cstring>
+
+namespace ndn {
+
+static uint8_t*
+writeVarNumber(uint8_t* pos, uint64_t number)
+{
+  if (number < 253) {
+    *pos++ = static_cast<uint8_t>(number);
+  }
+  else if (number <= std::numeric_limits<uint16_t>::max()) {
+    *pos++ = 253;
+    *pos++ = static_cast<uint8_t>(number >> 8);
+    *pos++ = static_cast<uint8_t>(number);
+  }
+  else if (number <= std::numeric_limits<uint32_t>::max()) {
+    *pos++ = 254;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+      *pos++ = static_cast<uint8_t>(number >> shift);
+    }
+  }
+  else {
+    *pos++ = 255;
+    for (int shift = 56; shift >= 0; shift -= 8) {
+      *pos++ = static_cast<uint8_t>(number >> shift);
+    }
+  }
+  return pos;
+}
+
+static uint8_t*
+writeNonNegativeInteger(uint8_t* pos, uint64_t integer)
+{
+  for (int shift = static_cast<int>(tlv::sizeOfNonNegativeInteger(integer) - 1) * 8;
+       shift >= 0; shift -= 8) {
+    *pos++ = static_cast<uint8_t>(integer >> shift);
+  }
+  return pos;
+}
+
+InterestTemplate::InterestTemplate(const Interest& prototype)
+  : m_prefix(prototype.getName())
+{
+  if (prototype.hasApplicationParameters()) {
+    NDN_THROW(Error("InterestTemplate does not support Interests with ApplicationParameters"));
+  }
+
+  m_tags.copyTagsFrom(prototype);
+
+  // encode the prototype once with an all-zero Nonce, then split the encoding at the end of Name
+  Interest interest(prototype);
+  interest.setNonce(Interest::Nonce{});
+  const Block& wire = interest.wireEncode();
+  const Block& name = wire.get(tlv::Name);
+  m_prefixComponents.assign(name.value_begin(), name.value_end());
+  m_tail.assign(name.end(), wire.end());
+
+  auto nonce = wire.find(tlv::Nonce);
+  BOOST_ASSERT(nonce != wire.elements_end());
+  m_nonceOffset = static_cast<size_t>(std::distance(name.end(), nonce->value_begin()));
+}
+
+Block
+InterestTemplate::stamp(size_t componentSize, const optional<Interest::Nonce>& nonce,
+                        uint8_t*& componentPos) const
+{
+  size_t nameValueLength = m_prefixComponents.size() + componentSize;
+  size_t nameLength = tlv::sizeOfVarNumber(tlv::Name) + tlv::sizeOfVarNumber(nameValueLength) +
+                      nameValueLength;
+  size_t valueLength = nameLength + m_tail.size();
+  size_t headerLength = tlv::sizeOfVarNumber(tlv::Interest) + tlv::sizeOfVarNumber(valueLength);
+
+  auto buffer = make_shared<Buffer>(headerLength + valueLength);
+  uint8_t* pos = buffer->data();
+  pos = writeVarNumber(pos, tlv::Interest);
+  pos = writeVarNumber(pos, valueLength);
+  pos = writeVarNumber(pos, tlv::Name);
+  pos = writeVarNumber(pos, nameValueLength);
+  pos = std::copy(m_prefixComponents.begin(), m_prefixComponents.end(), pos);
+  componentPos = pos;
+  pos += componentSize;
+
+  uint8_t* nonceSlot = std::copy(m_tail.begin(), m_tail.end(), pos) - m_tail.size() + m_nonceOffset;
+  if (nonce) {
+    std::memcpy(nonceSlot, nonce->data(), nonce->size());
+  }
+  else {
+    uint32_t r = random::generateWord32();
+    std::memcpy(nonceSlot, &r, sizeof(r));
+  }
+
+  return Block(buffer, tlv::Interest, buffer->begin(), buffer->end(),
+               buffer->begin() + headerLength, buffer->end());
+}
+
+Block
+InterestTemplate::makeWire(const name::Component& lastComponent,
+                           optional<Interest::Nonce> nonce) const
+{
+  uint8_t* pos = nullptr;
+  Block wire = stamp(lastComponent.size(), nonce, pos);
+  std::copy(lastComponent.wire(), lastComponent.wire() + lastComponent.size(), pos);
+  return wire;
+}
+
+Block
+InterestTemplate::makeSegmentWire(uint64_t segmentNo, optional<Interest::Nonce> nonce) const
+{
+  bool useMarker = name::getConventionEncoding() == name::Convention::MARKER;
+  uint32_t type = useMarker ? static_cast<uint32_t>(tlv::GenericNameComponent)
+                            : static_cast<uint32_t>(tlv::SegmentNameComponent);
+  size_t valueLength = tlv::sizeOfNonNegativeInteger(segmentNo) + (useMarker ? 1 : 0);
+  size_t componentSize = tlv::sizeOfVarNumber(type) + tlv::sizeOfVarNumber(valueLength) +
+                         valueLength;
+
+  uint8_t* pos = nullptr;
+  Block wire = stamp(componentSize, nonce, pos);
+  pos = writeVarNumber(pos, type);
+  pos = writeVarNumber(pos, valueLength);
+  if (useMarker) {
+    *pos++ = name::SEGMENT_MARKER;
+  }
+  writeNonNegativeInteger(pos, segmentNo);
+  return wire;
+}
+
+} // namespace ndn
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_INTEREST_TEMPLATE_HPP
+#define NDN_INTEREST_TEMPLATE_HPP
+
+#include "ndn-cxx/interest.hpp"
+
+namespace ndn {
+
+/** @brief Pre-encoded Interest for generating many Interests that differ only in the last
+ *         name component and the Nonce.
+ *
+ *  Segment and sequence consumers express thousands of Interests that share everything except
+ *  the last name component and the Nonce. InterestTemplate encodes the common parts once. Each
+ *  stamped Interest is assembled by copying these parts into a buffer, writing the new last
+ *  component and Nonce, and adjusting the Name and Interest TLV-LENGTH fields, without going
+ *  through EncodingEstimator and Interest::wireEncode.
+ *
+ *  @code
+ *  Interest prototype(Name("/prefix/version"));
+ *  prototype.setCanBePrefix(false);
+ *  InterestTemplate tpl(prototype);
+ *  Interest interest = tpl.makeSegmentInterest(42); // /prefix/version/seg=42 with a fresh Nonce
+ *  @endcode
+ */
+class InterestTemplate
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    using tlv::Error::Error;
+  };
+
+  /** @brief Create a template from a prototype Interest.
+   *
+   *  The Name of @p prototype is the prefix of all stamped Interests. CanBePrefix, MustBeFresh,
+   *  ForwardingHint, InterestLifetime, and HopLimit are copied into all stamped Interests.
+   *  The tags of @p prototype (e.g. NextHopFaceIdTag) are kept and set on the Interests
+   *  returned by makeInterest and makeSegmentInterest. The Nonce of @p prototype is ignored.
+   *
+   *  @throw Error @p prototype has ApplicationParameters, whose digest would have to be
+   *               recomputed for each stamped Interest
+   */
+  explicit
+  InterestTemplate(const Interest& prototype);
+
+  /** @brief Get the common Name prefix of stamped Interests.
+   */
+  const Name&
+  getPrefix() const
+  {
+    return m_prefix;
+  }
+
+  /** @brief Stamp the wire encoding of an Interest named `getPrefix() + lastComponent`.
+   *
+   *  The wire encoding does not carry the tags of the prototype.
+   *  @param lastComponent the last name component
+   *  @param nonce the Nonce; if nullopt, a fresh random Nonce is generated
+   */
+  Block
+  makeWire(const name::Component& lastComponent, optional<Interest::Nonce> nonce = nullopt) const;
+
+  /** @brief Stamp the wire encoding of an Interest named `getPrefix() + segment number`.
+   *
+   *  The segment component is encoded directly into the stamped wire, following the naming
+   *  convention in effect (see name::getConventionEncoding).
+   */
+  Block
+  makeSegmentWire(uint64_t segmentNo, optional<Interest::Nonce> nonce = nullopt) const;
+
+  /** @brief Stamp an Interest named `getPrefix() + lastComponent`.
+   *
+   *  The returned Interest is decoded from the stamped wire, and therefore does not need to be
+   *  encoded again when it is expressed. It carries the tags of the prototype.
+   */
+  Interest
+  makeInterest(const name::Component& lastComponent, optional<Interest::Nonce> nonce = nullopt) const
+  {
+    Interest interest(makeWire(lastComponent, nonce));
+    interest.copyTagsFrom(m_tags);
+    return interest;
+  }
+
+  /** @brief Stamp an Interest named `getPrefix() + segment number`.
+   *  @sa makeSegmentWire
+   */
+  Interest
+  makeSegmentInterest(uint64_t segmentNo, optional<Interest::Nonce> nonce = nullopt) const
+  {
+    Interest interest(makeSegmentWire(segmentNo, nonce));
+    interest.copyTagsFrom(m_tags);
+    return interest;
+  }
+
+private:
+  /** @brief Allocate a buffer and write everything except the last name component
+   *  @param componentSize TLV size of the last name component
+   *  @param[out] componentPos position in the buffer where the last name component must be written
+   */
+  Block
+  stamp(size_t componentSize, const optional<Interest::Nonce>& nonce,
+        uint8_t*& componentPos) const;
+
+private:
+  Name m_prefix;
+  Buffer m_prefixComponents; ///< TLV-VALUE of the prefix Name
+  Buffer m_tail;             ///< Interest elements after Name, including Nonce
+  size_t m_nonceOffset;      ///< offset of Nonce TLV-VALUE within m_tail
+  TagHost m_tags;            ///< tags of the prototype
+};
+
+} // namespace ndn
+
+#endif // NDN_INTEREST_TEMPLATE_HPP
@@ -188,6 +188,9 @@ Controller::processDatasetFetchError(const DatasetFailCallback& onFailure,
     case SegmentFetcher::ErrorCode::NACK_ERROR:
       onFailure(ERROR_NACK, msg);
       break;
+    case SegmentFetcher::ErrorCode::FILE_ERROR:
+      // datasets are never fetched in 'file' mode
+      NDN_CXX_UNREACHABLE;
   }
 }
 
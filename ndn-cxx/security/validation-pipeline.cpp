@@ -0,0 +1,352 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/security/validation-pipeline.hpp"
+#include "ndn-cxx/security/verification-helpers.hpp"
+#include "ndn-cxx/util/logger.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+namespace security {
+inline namespace v2 {
+
+NDN_LOG_INIT(ndn.security.ValidationPipeline);
+
+void
+ValidationPipeline::Options::validate()
+{
+  if (maxBatchSize == 0) {
+    NDN_THROW(std::invalid_argument("maxBatchSize must be positive"));
+  }
+
+  if (trustLifetime < 0_ns) {
+    NDN_THROW(std::invalid_argument("trustLifetime must not be negative"));
+  }
+}
+
+class ValidationPipeline::Impl : public std::enable_shared_from_this<Impl>
+{
+public:
+  /// Data name without its last component, and KeyLocator name
+  using TrustKey = std::pair<Name, Name>;
+
+  class Job
+  {
+  public:
+    Data data;
+    DataValidationSuccessCallback successCb;
+    DataValidationFailureCallback failureCb;
+    /// public key of the trusted certificate, if the signature is verified by a worker
+    shared_ptr<const Buffer> publicKey;
+    bool isSignatureValid = false; ///< written by the worker before posting the result
+    bool isDone = false;
+    optional<ValidationError> error;
+  };
+
+  class TrustedKey
+  {
+  public:
+    shared_ptr<const Buffer> publicKey;
+    time::system_clock::TimePoint notAfter; ///< end of the certificate validity period
+    time::steady_clock::TimePoint expiry; ///< when the key must go through the Validator again
+  };
+
+  Impl(boost::asio::io_service& io, Validator& validator, const Options& options)
+    : m_io(io)
+    , m_validator(validator)
+    , m_options(options)
+  {
+  }
+
+  void
+  start()
+  {
+    m_weakSelf = shared_from_this();
+    for (size_t i = 0; i < m_options.nThreads; ++i) {
+      m_threads.emplace_back([this] { runWorker(); });
+    }
+  }
+
+  void
+  stop()
+  {
+    m_isStopped = true;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_shouldExit = true;
+    }
+    m_cv.notify_all();
+    for (auto& thread : m_threads) {
+      thread.join();
+    }
+    m_threads.clear();
+  }
+
+  void
+  validate(const Data& data, const DataValidationSuccessCallback& successCb,
+           const DataValidationFailureCallback& failureCb)
+  {
+    auto job = make_shared<Job>();
+    job->data = data;
+    job->successCb = successCb;
+    job->failureCb = failureCb;
+    m_jobs.push_back(job);
+
+    optional<TrustKey> key = getTrustKey(data);
+    if (key) {
+      auto it = m_trustedKeys.find(*key);
+      if (it != m_trustedKeys.end()) {
+        if (it->second.expiry > time::steady_clock::now() &&
+            it->second.notAfter > time::system_clock::now()) {
+          job->publicKey = it->second.publicKey;
+          return verify(job);
+        }
+        m_trustedKeys.erase(it);
+      }
+    }
+    validateFully(job, key);
+  }
+
+private:
+  static optional<TrustKey>
+  getTrustKey(const Data& data)
+  {
+    const SignatureInfo& info = data.getSignatureInfo();
+    if (!info.hasKeyLocator() || info.getKeyLocator().getType() != tlv::Name) {
+      return nullopt;
+    }
+    return TrustKey(data.getName().getPrefix(-1), info.getKeyLocator().getName());
+  }
+
+  void
+  validateFully(const shared_ptr<Job>& job, const optional<TrustKey>& key)
+  {
+    weak_ptr<Impl> weakSelf = m_weakSelf;
+    m_validator.validate(job->data,
+      [weakSelf, job, key] (const Data&) {
+        auto self = weakSelf.lock();
+        if (self == nullptr) {
+          return;
+        }
+        if (key) {
+          // the Validator caches the certificate chain after invoking this callback
+          self->m_io.post([weakSelf, key = *key] {
+            auto self = weakSelf.lock();
+            if (self != nullptr) {
+              self->learnKey(key);
+            }
+          });
+        }
+        job->isDone = true;
+        self->releaseInOrder();
+      },
+      [weakSelf, job] (const Data&, const ValidationError& error) {
+        auto self = weakSelf.lock();
+        if (self == nullptr) {
+          return;
+        }
+        job->error = error;
+        job->isDone = true;
+        self->releaseInOrder();
+      });
+  }
+
+  void
+  learnKey(const TrustKey& key)
+  {
+    if (m_trustedKeys.count(key) > 0) {
+      return;
+    }
+
+    const Certificate* cert = m_validator.findTrustedCert(Interest(key.second).setCanBePrefix(true));
+    if (cert == nullptr) {
+      return;
+    }
+
+    auto now = time::steady_clock::now();
+    for (auto it = m_trustedKeys.begin(); it != m_trustedKeys.end();) {
+      if (it->second.expiry <= now) {
+        it = m_trustedKeys.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+
+    NDN_LOG_DEBUG("Verifying " << key.first << " signed by " << key.second << " with " << cert->getName());
+    const Buffer& publicKey = cert->getPublicKey();
+    m_trustedKeys[key] = {make_shared<const Buffer>(publicKey.begin(), publicKey.end()),
+                          cert->getValidityPeriod().getPeriod().second,
+                          now + m_options.trustLifetime};
+  }
+
+  void
+  verify(const shared_ptr<Job>& job)
+  {
+    if (m_options.nThreads == 0) {
+      job->isSignatureValid = verifySignature(job->data, job->publicKey->data(), job->publicKey->size());
+      return afterVerified({job});
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_queue.push_back(job);
+    }
+    m_cv.notify_one();
+  }
+
+  void
+  runWorker()
+  {
+    std::vector<shared_ptr<Job>> batch;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this] { return m_shouldExit || !m_queue.empty(); });
+        if (m_shouldExit) {
+          return;
+        }
+        // spread a burst over all workers, but in batches no larger than maxBatchSize
+        size_t batchSize = (m_queue.size() + m_options.nThreads - 1) / m_options.nThreads;
+        batchSize = std::min(batchSize, m_options.maxBatchSize);
+        batch.assign(m_queue.begin(), m_queue.begin() + batchSize);
+        m_queue.erase(m_queue.begin(), m_queue.begin() + batchSize);
+      }
+
+      for (const auto& job : batch) {
+        job->isSignatureValid = verifySignature(job->data, job->publicKey->data(), job->publicKey->size());
+      }
+
+      m_io.post([weakSelf = m_weakSelf, batch = std::move(batch)] {
+        auto self = weakSelf.lock();
+        if (self != nullptr) {
+          self->afterVerified(batch);
+        }
+      });
+      batch.clear();
+    }
+  }
+
+  void
+  afterVerified(const std::vector<shared_ptr<Job>>& batch)
+  {
+    for (const auto& job : batch) {
+      if (job->isSignatureValid) {
+        ++m_nFastVerified;
+      }
+      else {
+        job->error = ValidationError(ValidationError::INVALID_SIGNATURE,
+                                     "Invalid signature of data `" + job->data.getName().toUri() + "`");
+      }
+      job->isDone = true;
+    }
+    releaseInOrder();
+  }
+
+  void
+  releaseInOrder()
+  {
+    // a callback may submit more packets or destroy the pipeline
+    if (m_isReleasing) {
+      return;
+    }
+    m_isReleasing = true;
+    auto self = shared_from_this();
+
+    while (!m_isStopped && !m_jobs.empty() && m_jobs.front()->isDone) {
+      auto job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+      if (job->error) {
+        if (job->failureCb) {
+          job->failureCb(job->data, *job->error);
+        }
+      }
+      else if (job->successCb) {
+        job->successCb(job->data);
+      }
+    }
+    m_isReleasing = false;
+  }
+
+public:
+  std::deque<shared_ptr<Job>> m_jobs; ///< submitted packets in order, accessed on the io thread
+  uint64_t m_nFastVerified = 0;
+
+private:
+  boost::asio::io_service& m_io;
+  Validator& m_validator;
+  const Options m_options;
+  weak_ptr<Impl> m_weakSelf;
+  std::map<TrustKey, TrustedKey> m_trustedKeys;
+  bool m_isReleasing = false;
+  bool m_isStopped = false;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::deque<shared_ptr<Job>> m_queue; ///< packets awaiting a worker, protected by m_mutex
+  bool m_shouldExit = false; ///< protected by m_mutex
+  std::vector<std::thread> m_threads;
+};
+
+ValidationPipeline::ValidationPipeline(boost::asio::io_service& io, Validator& validator,
+                                       const Options& options)
+{
+  Options validatedOptions(options);
+  validatedOptions.validate();
+  m_impl = make_shared<Impl>(io, validator, validatedOptions);
+  m_impl->start();
+}
+
+ValidationPipeline::~ValidationPipeline()
+{
+  m_impl->stop();
+}
+
+void
+ValidationPipeline::validate(const Data& data,
+                             const DataValidationSuccessCallback& successCb,
+                             const DataValidationFailureCallback& failureCb)
+{
+  m_impl->validate(data, successCb, failureCb);
+}
+
+size_t
+ValidationPipeline::getNPending() const
+{
+  return m_impl->m_jobs.size();
+}
+
+uint64_t
+ValidationPipeline::getNFastVerified() const
+{
+  return m_impl->m_nFastVerified;
+}
+
+} // inline namespace v2
+} // namespace security
+} // namespace ndn
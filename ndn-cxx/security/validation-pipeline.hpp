@@ -0,0 +1,122 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_SECURITY_VALIDATION_PIPELINE_HPP
+#define NDN_SECURITY_VALIDATION_PIPELINE_HPP
+
+#include "ndn-cxx/security/validator.hpp"
+#include "ndn-cxx/detail/asio-fwd.hpp"
+
+namespace ndn {
+namespace security {
+inline namespace v2 {
+
+/**
+ * @brief Validates a stream of Data packets, verifying signatures on a pool of worker threads.
+ *
+ * The first packet signed by a given key under a given name prefix (the Data name without its
+ * last component, e.g., the versioned name of a segmented object) is validated by the Validator
+ * on the calling thread. If it is accepted and the Validator holds a trusted certificate for the
+ * KeyLocator, the certificate is remembered, and subsequent packets with the same prefix and
+ * KeyLocator only need their signature verified against it. These verifications are independent
+ * of each other and are performed in batches on the worker threads.
+ *
+ * This relies on the trust policy reaching the same decision for all packets that share the name
+ * prefix and the KeyLocator, which holds for hierarchical and most configured policies. Packets
+ * without a KeyLocator name, or signed by a key for which no trusted certificate is found (e.g.,
+ * when the policy bypasses validation), are always handed to the Validator.
+ *
+ * Results are delivered on the thread running @p io, in the order in which the packets were
+ * submitted, regardless of which of them finished first.
+ *
+ * @warning validate() must be called on the thread running @p io.
+ */
+class ValidationPipeline : noncopyable
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+    void
+    validate();
+
+  public:
+    /// number of worker threads; if 0, signatures are verified on the thread running the io_service
+    size_t nThreads = 2;
+    size_t maxBatchSize = 16; ///< maximum number of signatures verified per batch
+    /// how long a certificate is used without going through the Validator again
+    time::nanoseconds trustLifetime = 1_h;
+  };
+
+  /**
+   * @brief Create the pipeline and start its worker threads.
+   *
+   * The caller must ensure that @p validator outlives the pipeline.
+   * @throw std::invalid_argument @p options are invalid
+   */
+  ValidationPipeline(boost::asio::io_service& io, Validator& validator,
+                     const Options& options = Options());
+
+  /**
+   * @brief Stop the worker threads.
+   *
+   * Callbacks of packets that are still being validated are not invoked.
+   */
+  ~ValidationPipeline();
+
+  /**
+   * @brief Asynchronously validate @p data.
+   *
+   * Exactly one of @p successCb and @p failureCb is invoked, after the callbacks of all
+   * previously submitted packets.
+   */
+  void
+  validate(const Data& data,
+           const DataValidationSuccessCallback& successCb,
+           const DataValidationFailureCallback& failureCb);
+
+  /**
+   * @brief Get the number of packets whose callbacks have not been invoked yet.
+   */
+  size_t
+  getNPending() const;
+
+  /**
+   * @brief Get the number of packets whose signatures were verified by the worker threads
+   *        instead of the Validator.
+   */
+  uint64_t
+  getNFastVerified() const;
+
+private:
+  class Impl;
+  shared_ptr<Impl> m_impl;
+};
+
+} // inline namespace v2
+} // namespace security
+} // namespace ndn
+
+#endif // NDN_SECURITY_VALIDATION_PIPELINE_HPP
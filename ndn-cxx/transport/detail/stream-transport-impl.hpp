@@ -43,7 +43,14 @@ class StreamTransportImpl : public std::enable_shared_from_this<StreamTransportI
 public:
   using Impl = StreamTransportImpl<BaseTransport, Protocol>;
   using BlockSequence = std::list<Block>;
-  using TransmissionQueue = std::list<BlockSequence>;
+
+  struct QueueItem
+  {
+    BlockSequence blocks;
+    size_t nBytes;
+    size_t nPackets;
+  };
+  using TransmissionQueue = std::list<QueueItem>;
 
   StreamTransportImpl(BaseTransport& transport, boost::asio::io_service& ioService)
     : m_transport(transport)
@@ -86,6 +93,7 @@ public:
     m_transport.m_isConnected = false;
     m_transport.m_isReceiving = false;
     m_transmissionQueue.clear();
+    m_transport.afterQueueCleared();
   }
 
   void
@@ -118,7 +126,7 @@ public:
   {
     BlockSequence sequence;
     sequence.push_back(wire);
-    send(std::move(sequence));
+    send(std::move(sequence), 1);
   }
 
   void
@@ -127,7 +135,17 @@ public:
     BlockSequence sequence;
     sequence.push_back(header);
     sequence.push_back(payload);
-    send(std::move(sequence));
+    send(std::move(sequence), 1);
+  }
+
+  void
+  send(const std::vector<Block>& wires)
+  {
+    if (wires.empty()) {
+      return;
+    }
+    // the whole sequence is passed to one async_write, i.e., written with a single gather write
+    send(BlockSequence(wires.begin(), wires.end()), wires.size());
   }
 
 protected:
@@ -162,9 +180,13 @@ protected:
   }
 
   void
-  send(BlockSequence&& sequence)
+  send(BlockSequence&& sequence, size_t nPackets)
   {
-    m_transmissionQueue.emplace_back(sequence);
+    size_t nBytes = 0;
+    for (const auto& block : sequence) {
+      nBytes += block.size();
+    }
+    m_transmissionQueue.push_back({std::move(sequence), nBytes, nPackets});
 
     if (m_transport.m_isConnected && m_transmissionQueue.size() == 1) {
       asyncWrite();
@@ -172,19 +194,22 @@ protected:
 
     // if not connected or there is transmission in progress (m_transmissionQueue.size() > 1),
     // next write will be scheduled either in connectHandler or in asyncWriteHandler
+
+    // accounting is done last, because the watermark callback may call send() again
+    m_transport.afterEnqueue(nBytes, nPackets);
   }
 
   void
   asyncWrite()
   {
     BOOST_ASSERT(!m_transmissionQueue.empty());
-    boost::asio::async_write(m_socket, m_transmissionQueue.front(),
+    boost::asio::async_write(m_socket, m_transmissionQueue.front().blocks,
                              bind(&Impl::handleAsyncWrite, this->shared_from_this(), _1,
                                   m_transmissionQueue.begin()));
   }
 
   void
-  handleAsyncWrite(const boost::system::error_code& error, TransmissionQueue::iterator queueItem)
+  handleAsyncWrite(const boost::system::error_code& error, typename TransmissionQueue::iterator queueItem)
   {
     if (error) {
       if (error == boost::system::errc::operation_canceled) {
@@ -199,11 +224,15 @@ protected:
       return; // queue has been already cleared
     }
 
+    size_t nBytes = queueItem->nBytes;
+    size_t nPackets = queueItem->nPackets;
     m_transmissionQueue.erase(queueItem);
 
     if (!m_transmissionQueue.empty()) {
       asyncWrite();
     }
+
+    m_transport.afterDequeue(nBytes, nPackets);
   }
 
   void
@@ -105,6 +105,13 @@ TcpTransport::send(const Block& header, const Block& payload)
   m_impl->send(header, payload);
 }
 
+void
+TcpTransport::send(const std::vector<Block>& wires)
+{
+  BOOST_ASSERT(m_impl != nullptr);
+  m_impl->send(wires);
+}
+
 void
 TcpTransport::close()
 {
@@ -67,6 +67,9 @@ public:
   void
   send(const Block& header, const Block& payload) override;
 
+  void
+  send(const std::vector<Block>& wires) override;
+
   /** \brief Create transport with parameters defined in URI
    *  \throw Transport::Error incorrect URI or unsupported protocol is specified
    */
@@ -37,4 +37,70 @@ Transport::connect(boost::asio::io_service& ioService, ReceiveCallback receiveCa
   m_receiveCallback = std::move(receiveCallback);
 }
 
+void
+Transport::setSendQueueWatermarks(const SendQueueWatermarks& watermarks)
+{
+  if (watermarks.lowBytes > watermarks.highBytes || watermarks.lowPackets > watermarks.highPackets) {
+    NDN_THROW(std::invalid_argument("Send queue low watermark must not exceed high watermark"));
+  }
+
+  m_sendQueueWatermarks = watermarks;
+  updateSendQueueState();
+}
+
+void
+Transport::afterEnqueue(size_t nBytes, size_t nPackets)
+{
+  m_sendQueueBytes += nBytes;
+  m_sendQueuePackets += nPackets;
+  updateSendQueueState();
+}
+
+void
+Transport::afterDequeue(size_t nBytes, size_t nPackets)
+{
+  BOOST_ASSERT(m_sendQueueBytes >= nBytes);
+  BOOST_ASSERT(m_sendQueuePackets >= nPackets);
+  m_sendQueueBytes -= nBytes;
+  m_sendQueuePackets -= nPackets;
+  updateSendQueueState();
+}
+
+void
+Transport::afterQueueCleared()
+{
+  m_sendQueueBytes = 0;
+  m_sendQueuePackets = 0;
+  updateSendQueueState();
+}
+
+void
+Transport::updateSendQueueState()
+{
+  bool wasHigh = m_isSendQueueHigh;
+  if (!m_isSendQueueHigh) {
+    m_isSendQueueHigh = m_sendQueueBytes >= m_sendQueueWatermarks.highBytes ||
+                        m_sendQueuePackets >= m_sendQueueWatermarks.highPackets;
+  }
+  else {
+    constexpr size_t DISABLED = std::numeric_limits<size_t>::max();
+    m_isSendQueueHigh = (m_sendQueueWatermarks.highBytes != DISABLED &&
+                         m_sendQueueBytes > m_sendQueueWatermarks.lowBytes) ||
+                        (m_sendQueueWatermarks.highPackets != DISABLED &&
+                         m_sendQueuePackets > m_sendQueueWatermarks.lowPackets);
+  }
+
+  if (m_isSendQueueHigh != wasHigh && m_sendQueueStateCallback) {
+    m_sendQueueStateCallback(m_isSendQueueHigh);
+  }
+}
+
+void
+Transport::send(const std::vector<Block>& wires)
+{
+  for (const auto& wire : wires) {
+    send(wire);
+  }
+}
+
 } // namespace ndn
@@ -46,6 +46,26 @@ public:
   using ReceiveCallback = std::function<void(const Block& wire)>;
   using ErrorCallback = std::function<void()>;
 
+  /** \brief Watermarks of the send queue
+   *
+   *  The send queue becomes "high" when either its size in bytes reaches \p highBytes or its
+   *  size in packets reaches \p highPackets. It becomes "drained" again when its size in bytes
+   *  has dropped to \p lowBytes or below, and its size in packets to \p lowPackets or below.
+   *  A dimension whose high watermark is the maximum value is disabled and does not delay
+   *  draining.
+   */
+  struct SendQueueWatermarks
+  {
+    size_t highBytes = std::numeric_limits<size_t>::max();
+    size_t lowBytes = 0;
+    size_t highPackets = std::numeric_limits<size_t>::max();
+    size_t lowPackets = 0;
+  };
+
+  /** \brief Callback invoked when the send queue becomes high (true) or drained (false)
+   */
+  using SendQueueStateCallback = std::function<void(bool isHigh)>;
+
   virtual
   ~Transport() = default;
 
@@ -75,6 +95,14 @@ public:
   virtual void
   send(const Block& header, const Block& payload) = 0;
 
+  /** \brief send a sequence of TLV blocks through the transport
+   *
+   *  Stream-oriented transports hand the whole sequence to the socket in a single gather write.
+   *  The default implementation sends each block separately.
+   */
+  virtual void
+  send(const std::vector<Block>& wires);
+
   /** \brief pause the transport
    *  \post the receive callback will not be invoked
    *  \note This operation has no effect if transport has been paused,
@@ -109,11 +137,85 @@ public:
     return m_isReceiving;
   }
 
+  /** \brief Set watermarks of the send queue
+   *  \throw std::invalid_argument a low watermark is greater than the corresponding high watermark
+   */
+  void
+  setSendQueueWatermarks(const SendQueueWatermarks& watermarks);
+
+  const SendQueueWatermarks&
+  getSendQueueWatermarks() const noexcept
+  {
+    return m_sendQueueWatermarks;
+  }
+
+  /** \brief Set the callback invoked when the send queue crosses a watermark
+   */
+  void
+  setSendQueueStateCallback(SendQueueStateCallback cb)
+  {
+    m_sendQueueStateCallback = std::move(cb);
+  }
+
+  /** \return total size of packets that have been passed to send() but not yet written
+   *          to the underlying socket, in bytes
+   *  \note A transport without a send queue always reports zero.
+   */
+  size_t
+  getSendQueueBytes() const noexcept
+  {
+    return m_sendQueueBytes;
+  }
+
+  /** \return number of packets that have been passed to send() but not yet written
+   *          to the underlying socket
+   */
+  size_t
+  getSendQueuePackets() const noexcept
+  {
+    return m_sendQueuePackets;
+  }
+
+  /** \retval true the send queue has reached a high watermark and has not drained since
+   */
+  bool
+  isSendQueueHigh() const noexcept
+  {
+    return m_isSendQueueHigh;
+  }
+
+protected:
+  /** \brief Account for packets entering the send queue
+   */
+  void
+  afterEnqueue(size_t nBytes, size_t nPackets);
+
+  /** \brief Account for packets leaving the send queue
+   */
+  void
+  afterDequeue(size_t nBytes, size_t nPackets);
+
+  /** \brief Account for the send queue being discarded, e.g., upon close
+   */
+  void
+  afterQueueCleared();
+
+private:
+  void
+  updateSendQueueState();
+
 protected:
   boost::asio::io_service* m_ioService = nullptr;
   ReceiveCallback m_receiveCallback;
   bool m_isConnected = false;
   bool m_isReceiving = false;
+
+private:
+  SendQueueWatermarks m_sendQueueWatermarks;
+  SendQueueStateCallback m_sendQueueStateCallback;
+  size_t m_sendQueueBytes = 0;
+  size_t m_sendQueuePackets = 0;
+  bool m_isSendQueueHigh = false;
 };
 
 } // namespace ndn
@@ -103,6 +103,13 @@ UnixTransport::send(const Block& header, const Block& payload)
   m_impl->send(header, payload);
 }
 
+void
+UnixTransport::send(const std::vector<Block>& wires)
+{
+  BOOST_ASSERT(m_impl != nullptr);
+  m_impl->send(wires);
+}
+
 void
 UnixTransport::close()
 {
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/congestion-control.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ndn {
+namespace util {
+
+static double
+toSeconds(time::nanoseconds d)
+{
+  return time::duration<double>(d).count();
+}
+
+CongestionControl::CongestionControl(double initCwnd, double initSsthresh)
+  : m_cwnd(initCwnd)
+  , m_ssthresh(initSsthresh)
+{
+}
+
+CongestionControl::~CongestionControl() = default;
+
+constexpr double AimdCongestionControl::MIN_SSTHRESH;
+
+AimdCongestionControl::AimdCongestionControl(const Options& options)
+  : CongestionControl(options.initCwnd, options.initSsthresh)
+  , m_options(options)
+{
+}
+
+void
+AimdCongestionControl::afterAck(const AckSample& sample)
+{
+  if (sample.isCongestionMarked) {
+    return;
+  }
+
+  if (m_cwnd < m_ssthresh) {
+    m_cwnd += m_options.aiStep; // additive increase
+  }
+  else {
+    m_cwnd += m_options.aiStep / std::floor(m_cwnd); // congestion avoidance
+  }
+}
+
+void
+AimdCongestionControl::afterCongestionEvent(time::steady_clock::TimePoint)
+{
+  // Refer to RFC 5681, Section 3.1 for the rationale behind the code below
+  m_ssthresh = std::max(MIN_SSTHRESH, m_cwnd * m_options.mdCoef); // multiplicative decrease
+  m_cwnd = m_options.resetCwndToInit ? m_options.initCwnd : m_ssthresh;
+}
+
+CubicCongestionControl::CubicCongestionControl(const Options& options)
+  : CongestionControl(options.initCwnd, options.initSsthresh)
+  , m_options(options)
+  , m_lastDecrease(time::steady_clock::now())
+{
+}
+
+void
+CubicCongestionControl::afterAck(const AckSample& sample)
+{
+  if (sample.isCongestionMarked) {
+    return;
+  }
+
+  if (m_cwnd < m_ssthresh) {
+    m_cwnd += m_options.aiStep; // slow start
+    return;
+  }
+
+  // Time since the last congestion event, in seconds
+  double t = toSeconds(sample.now - m_lastDecrease);
+  // Time it takes to grow the window back to W_max: K = cubic_root(W_max * (1 - beta) / C) (Eq. 2)
+  double k = std::cbrt(m_wMax * (1.0 - m_options.beta) / m_options.c);
+  // W_cubic(t) = C * (t - K)^3 + W_max (Eq. 1)
+  double target = m_options.c * std::pow(t - k, 3.0) + m_wMax;
+
+  // TCP-friendly window: W_est(t) = W_max * beta + 3 * (1 - beta) / (1 + beta) * t / RTT (Eq. 4)
+  double rtt = toSeconds(sample.smoothedRtt);
+  if (rtt > 0.0) {
+    double est = m_wMax * m_options.beta +
+                 3.0 * (1.0 - m_options.beta) / (1.0 + m_options.beta) * (t / rtt);
+    target = std::max(target, est);
+  }
+
+  // Each of the about cwnd acks in a round trip contributes 1/cwnd of the difference
+  m_cwnd += std::max(0.0, target - m_cwnd) / m_cwnd;
+}
+
+void
+CubicCongestionControl::afterCongestionEvent(time::steady_clock::TimePoint now)
+{
+  if (m_options.enableFastConvergence && m_cwnd < m_lastWMax) {
+    // another flow is taking a larger share of the bottleneck
+    m_lastWMax = m_cwnd;
+    m_wMax = m_cwnd * (1.0 + m_options.beta) / 2.0;
+  }
+  else {
+    m_lastWMax = m_cwnd;
+    m_wMax = m_cwnd;
+  }
+
+  m_ssthresh = std::max(AimdCongestionControl::MIN_SSTHRESH, m_cwnd * m_options.beta);
+  m_cwnd = m_ssthresh;
+  m_lastDecrease = now;
+}
+
+/// window gains of the PROBE_BW cycle, one per round
+static const double PROBE_BW_GAINS[] = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+/// bandwidth growth below which a STARTUP round does not count as growing
+static const double STARTUP_GROWTH_THRESHOLD = 1.25;
+/// STARTUP ends after this many rounds without bandwidth growth
+static const int STARTUP_FULL_ROUNDS = 3;
+
+BbrCongestionControl::BbrCongestionControl(const Options& options)
+  : CongestionControl(options.initCwnd, std::numeric_limits<double>::max())
+  , m_options(options)
+{
+  BOOST_ASSERT(m_options.bandwidthWindow > 0);
+}
+
+void
+BbrCongestionControl::afterAck(const AckSample& sample)
+{
+  if (sample.rtt) {
+    updateMinRtt(*sample.rtt, sample.now);
+  }
+
+  // A round lasts one (propagation) RTT; its delivery rate is the number of segments acked in it
+  // divided by its duration.
+  if (!m_isRoundStarted) {
+    m_isRoundStarted = true;
+    m_roundStart = sample.now;
+  }
+  ++m_nAckedInRound;
+  time::nanoseconds roundLength = m_minRtt != time::nanoseconds::max() ? m_minRtt : sample.smoothedRtt;
+  if (roundLength > 0_ns && sample.now - m_roundStart >= roundLength) {
+    startRound(sample.now);
+  }
+
+  switch (m_mode) {
+    case Mode::STARTUP:
+      m_cwnd += m_options.startupGain - 1.0;
+      break;
+    case Mode::DRAIN:
+      m_cwnd = std::max(m_options.minCwnd, getBdp());
+      break;
+    case Mode::PROBE_BW:
+      m_cwnd = std::max(m_options.minCwnd,
+                        PROBE_BW_GAINS[m_cycleIndex] * m_options.cwndGain * getBdp());
+      break;
+    case Mode::PROBE_RTT:
+      if (sample.now >= m_probeRttEnd) {
+        m_minRttStamp = sample.now;
+        m_cwnd = m_cwndBeforeProbeRtt;
+        m_mode = m_isPipeFull ? Mode::PROBE_BW : Mode::STARTUP;
+      }
+      break;
+  }
+}
+
+void
+BbrCongestionControl::afterCongestionEvent(time::steady_clock::TimePoint)
+{
+  // the bottleneck queue is overflowing, so bandwidth cannot grow further
+  if (m_mode == Mode::STARTUP && m_bandwidth > 0.0) {
+    enterDrain();
+  }
+}
+
+void
+BbrCongestionControl::updateMinRtt(time::nanoseconds rtt, time::steady_clock::TimePoint now)
+{
+  bool isExpired = m_minRtt != time::nanoseconds::max() &&
+                   now - m_minRttStamp > m_options.minRttWindow;
+  if (rtt <= m_minRtt || isExpired) {
+    m_minRtt = rtt;
+    m_minRttStamp = now;
+  }
+  if (isExpired && m_mode != Mode::PROBE_RTT) {
+    enterProbeRtt(now);
+  }
+}
+
+void
+BbrCongestionControl::startRound(time::steady_clock::TimePoint now)
+{
+  double elapsed = toSeconds(now - m_roundStart);
+  m_rateSamples.push_back(m_nAckedInRound / elapsed);
+  if (m_rateSamples.size() > m_options.bandwidthWindow) {
+    m_rateSamples.pop_front();
+  }
+  m_bandwidth = *std::max_element(m_rateSamples.begin(), m_rateSamples.end());
+  m_roundStart = now;
+  m_nAckedInRound = 0;
+
+  switch (m_mode) {
+    case Mode::STARTUP:
+      if (m_bandwidth >= m_fullBandwidth * STARTUP_GROWTH_THRESHOLD) {
+        m_fullBandwidth = m_bandwidth;
+        m_nRoundsWithoutGrowth = 0;
+      }
+      else if (++m_nRoundsWithoutGrowth >= STARTUP_FULL_ROUNDS) {
+        enterDrain();
+      }
+      break;
+    case Mode::DRAIN:
+      // the queue built in STARTUP drains within one round at a window of one BDP
+      m_mode = Mode::PROBE_BW;
+      m_cycleIndex = 2;
+      break;
+    case Mode::PROBE_BW:
+      m_cycleIndex = (m_cycleIndex + 1) % (sizeof(PROBE_BW_GAINS) / sizeof(PROBE_BW_GAINS[0]));
+      break;
+    case Mode::PROBE_RTT:
+      break;
+  }
+}
+
+void
+BbrCongestionControl::enterDrain()
+{
+  m_isPipeFull = true;
+  m_mode = Mode::DRAIN;
+  m_cwnd = std::max(m_options.minCwnd, getBdp());
+}
+
+void
+BbrCongestionControl::enterProbeRtt(time::steady_clock::TimePoint now)
+{
+  m_mode = Mode::PROBE_RTT;
+  m_cwndBeforeProbeRtt = m_cwnd;
+  m_cwnd = m_options.minCwnd;
+  m_probeRttEnd = now + m_options.probeRttDuration + m_minRtt;
+}
+
+double
+BbrCongestionControl::getBdp() const
+{
+  if (m_minRtt == time::nanoseconds::max()) {
+    return m_cwnd;
+  }
+  return m_bandwidth * toSeconds(m_minRtt);
+}
+
+std::ostream&
+operator<<(std::ostream& os, BbrCongestionControl::Mode mode)
+{
+  switch (mode) {
+    case BbrCongestionControl::Mode::STARTUP:
+      return os << "STARTUP";
+    case BbrCongestionControl::Mode::DRAIN:
+      return os << "DRAIN";
+    case BbrCongestionControl::Mode::PROBE_BW:
+      return os << "PROBE_BW";
+    case BbrCongestionControl::Mode::PROBE_RTT:
+      return os << "PROBE_RTT";
+  }
+  return os << static_cast<int>(mode);
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_CONGESTION_CONTROL_HPP
+#define NDN_UTIL_CONGESTION_CONTROL_HPP
+
+#include "ndn-cxx/util/time.hpp"
+
+#include <deque>
+#include <limits>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief Window-based congestion control algorithm of a SegmentFetcher.
+ *
+ * The fetcher reports every received segment via afterAck(), and every congestion event (a
+ * timeout, a Nack, or a congestion mark; at most one per round trip unless Conservative Window
+ * Adaptation is disabled) via afterCongestionEvent(). It keeps at most getCwnd() Interests in
+ * flight.
+ */
+class CongestionControl : noncopyable
+{
+public:
+  /**
+   * @brief Information about a received segment.
+   */
+  struct AckSample
+  {
+    time::steady_clock::TimePoint now;
+    /// RTT of the segment; not set if its Interest was retransmitted (Karn's algorithm)
+    optional<time::nanoseconds> rtt;
+    /// smoothed RTT of the fetcher's RttEstimator, or zero if there are no samples yet
+    time::nanoseconds smoothedRtt = 0_ns;
+    /// whether the segment carried a congestion mark that the fetcher did not ignore
+    bool isCongestionMarked = false;
+  };
+
+  virtual
+  ~CongestionControl();
+
+  /**
+   * @brief Returns the congestion window, in segments.
+   */
+  double
+  getCwnd() const
+  {
+    return m_cwnd;
+  }
+
+  /**
+   * @brief Returns the slow start threshold, in segments.
+   */
+  double
+  getSsthresh() const
+  {
+    return m_ssthresh;
+  }
+
+  virtual void
+  afterAck(const AckSample& sample) = 0;
+
+  virtual void
+  afterCongestionEvent(time::steady_clock::TimePoint now) = 0;
+
+protected:
+  CongestionControl(double initCwnd, double initSsthresh);
+
+protected:
+  double m_cwnd;
+  double m_ssthresh;
+};
+
+/**
+ * @brief Additive-increase/multiplicative-decrease, as in TCP Reno (RFC 5681).
+ */
+class AimdCongestionControl final : public CongestionControl
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+  public:
+    double initCwnd = 1.0; ///< initial congestion window size
+    double initSsthresh = std::numeric_limits<double>::max(); ///< initial slow start threshold
+    double aiStep = 1.0; ///< additive increase step (in segments)
+    double mdCoef = 0.5; ///< multiplicative decrease coefficient
+    bool resetCwndToInit = false; ///< reduce cwnd to initCwnd when loss event occurs
+  };
+
+  explicit
+  AimdCongestionControl(const Options& options = Options());
+
+  void
+  afterAck(const AckSample& sample) final;
+
+  void
+  afterCongestionEvent(time::steady_clock::TimePoint now) final;
+
+public:
+  static constexpr double MIN_SSTHRESH = 2.0;
+
+private:
+  const Options m_options;
+};
+
+/**
+ * @brief CUBIC congestion control (RFC 8312).
+ *
+ * After a congestion event, the window grows as a cubic function of the time elapsed since then,
+ * independently of the RTT, which lets it refill a large bandwidth-delay product much faster than
+ * AIMD. The window never grows slower than the TCP-friendly estimate of RFC 8312, Section 4.2.
+ */
+class CubicCongestionControl final : public CongestionControl
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+  public:
+    double initCwnd = 1.0; ///< initial congestion window size
+    double initSsthresh = std::numeric_limits<double>::max(); ///< initial slow start threshold
+    double aiStep = 1.0; ///< window increase per segment in slow start
+    double beta = 0.7; ///< multiplicative decrease factor
+    double c = 0.4; ///< scaling constant of the cubic function
+    bool enableFastConvergence = true; ///< release bandwidth faster to new flows (Section 4.6)
+  };
+
+  explicit
+  CubicCongestionControl(const Options& options = Options());
+
+  void
+  afterAck(const AckSample& sample) final;
+
+  void
+  afterCongestionEvent(time::steady_clock::TimePoint now) final;
+
+private:
+  const Options m_options;
+  double m_wMax = 0.0; ///< window before the last congestion event
+  double m_lastWMax = 0.0; ///< m_wMax before the last congestion event
+  time::steady_clock::TimePoint m_lastDecrease;
+};
+
+/**
+ * @brief Congestion control that sizes the window from bandwidth and delay estimates, after BBR.
+ *
+ * The bottleneck bandwidth is the maximum delivery rate measured over the last few rounds, and
+ * the propagation delay is the minimum RTT measured over the last few seconds; the window is
+ * a multiple of their product (the bandwidth-delay product, BDP). Like BBR, it goes through
+ * STARTUP (exponential growth until the bandwidth stops increasing), DRAIN, PROBE_BW (gains
+ * cycling around 1 to probe for more bandwidth), and periodic PROBE_RTT phases. Since the fetcher
+ * does not pace its Interests, the pacing gains of BBR are applied to the window instead.
+ * Losses and congestion marks are ignored, except that they end STARTUP.
+ */
+class BbrCongestionControl final : public CongestionControl
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+  public:
+    double initCwnd = 1.0; ///< initial congestion window size
+    double minCwnd = 4.0; ///< lower bound of the window after STARTUP
+    double startupGain = 2.885; ///< window growth factor per round in STARTUP (2/ln 2)
+    double cwndGain = 2.0; ///< window as a multiple of BDP in PROBE_BW, before cycle gains
+    size_t bandwidthWindow = 10; ///< rounds over which the maximum delivery rate is taken
+    time::nanoseconds minRttWindow = 10_s; ///< period over which the minimum RTT is taken
+    time::nanoseconds probeRttDuration = 200_ms; ///< time spent with minCwnd in PROBE_RTT
+  };
+
+  enum class Mode {
+    STARTUP,
+    DRAIN,
+    PROBE_BW,
+    PROBE_RTT,
+  };
+
+  explicit
+  BbrCongestionControl(const Options& options = Options());
+
+  void
+  afterAck(const AckSample& sample) final;
+
+  void
+  afterCongestionEvent(time::steady_clock::TimePoint now) final;
+
+  Mode
+  getMode() const
+  {
+    return m_mode;
+  }
+
+  /**
+   * @brief Returns the estimated bottleneck bandwidth, in segments per second.
+   */
+  double
+  getBandwidth() const
+  {
+    return m_bandwidth;
+  }
+
+  /**
+   * @brief Returns the estimated propagation RTT, or time::nanoseconds::max() if unknown.
+   */
+  time::nanoseconds
+  getMinRtt() const
+  {
+    return m_minRtt;
+  }
+
+private:
+  void
+  updateMinRtt(time::nanoseconds rtt, time::steady_clock::TimePoint now);
+
+  void
+  startRound(time::steady_clock::TimePoint now);
+
+  void
+  enterDrain();
+
+  void
+  enterProbeRtt(time::steady_clock::TimePoint now);
+
+  double
+  getBdp() const;
+
+private:
+  const Options m_options;
+  Mode m_mode = Mode::STARTUP;
+
+  bool m_isRoundStarted = false;
+  time::steady_clock::TimePoint m_roundStart;
+  uint64_t m_nAckedInRound = 0;
+  std::deque<double> m_rateSamples; ///< delivery rate of each of the last rounds
+  double m_bandwidth = 0.0;
+
+  double m_fullBandwidth = 0.0;
+  int m_nRoundsWithoutGrowth = 0;
+  bool m_isPipeFull = false;
+  size_t m_cycleIndex = 0;
+
+  time::nanoseconds m_minRtt = time::nanoseconds::max();
+  time::steady_clock::TimePoint m_minRttStamp;
+  time::steady_clock::TimePoint m_probeRttEnd;
+  double m_cwndBeforeProbeRtt = 0.0;
+};
+
+std::ostream&
+operator<<(std::ostream& os, BbrCongestionControl::Mode mode);
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_CONGESTION_CONTROL_HPP
@@ -0,0 +1,287 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/face-pool.hpp"
+#include "ndn-cxx/util/logger.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <atomic>
+
+namespace ndn {
+namespace util {
+
+NDN_LOG_INIT(ndn.FacePool);
+
+class FacePool::Shard : noncopyable
+{
+public:
+  Shard(const FacePool& pool, size_t index, const FaceFactory& makeFace)
+    : pool(pool)
+    , index(index)
+    , work(make_unique<boost::asio::io_service::work>(io))
+  {
+    if (makeFace) {
+      face = makeFace(io);
+    }
+    else {
+      face = make_unique<Face>(nullptr, io);
+    }
+    BOOST_ASSERT(face != nullptr);
+  }
+
+  void
+  start()
+  {
+    thread = std::thread([this] { run(); });
+  }
+
+  void
+  stop()
+  {
+    io.post([this] {
+      face->shutdown();
+      work.reset();
+    });
+    thread.join();
+  }
+
+  /** \brief Post @p f to this shard's io_service, skipping it if the shard is gone.
+   */
+  template<typename F>
+  static void
+  post(const weak_ptr<Shard>& weakShard, F&& f)
+  {
+    auto shard = weakShard.lock();
+    if (shard != nullptr) {
+      shard->io.post(std::forward<F>(f));
+    }
+  }
+
+private:
+  void
+  run()
+  {
+    s_current = this;
+    while (true) {
+      try {
+        io.run();
+        break;
+      }
+      catch (const std::exception& e) {
+        NDN_LOG_ERROR("shard " << index << " error: " << e.what());
+      }
+    }
+    s_current = nullptr;
+  }
+
+public:
+  const FacePool& pool;
+  const size_t index;
+  boost::asio::io_service io;
+  unique_ptr<boost::asio::io_service::work> work;
+  unique_ptr<Face> face;
+  std::thread thread;
+
+  /// the shard whose io_service is running on the calling thread, if any
+  static thread_local const Shard* s_current;
+};
+
+thread_local const FacePool::Shard* FacePool::Shard::s_current = nullptr;
+
+FacePool::FacePool(size_t nShards, const FaceFactory& makeFace)
+{
+  if (nShards == 0) {
+    NDN_THROW(std::invalid_argument("FacePool must have at least one shard"));
+  }
+
+  m_shards.reserve(nShards);
+  for (size_t i = 0; i < nShards; ++i) {
+    m_shards.push_back(make_shared<Shard>(*this, i, makeFace));
+  }
+  for (const auto& shard : m_shards) {
+    shard->start();
+  }
+  NDN_LOG_DEBUG("started " << nShards << " shards");
+}
+
+FacePool::~FacePool()
+{
+  shutdown();
+}
+
+void
+FacePool::shutdown()
+{
+  if (m_isShutdown) {
+    return;
+  }
+  m_isShutdown = true;
+
+  for (const auto& shard : m_shards) {
+    shard->stop();
+  }
+  NDN_LOG_DEBUG("stopped " << m_shards.size() << " shards");
+}
+
+Face&
+FacePool::getFace(size_t shardIndex) const
+{
+  return *m_shards.at(shardIndex)->face;
+}
+
+size_t
+FacePool::getShardIndex(const Name& name) const
+{
+  return std::hash<Name>()(name) % m_shards.size();
+}
+
+size_t
+FacePool::getPutShardIndex(const Name& name) const
+{
+  const Shard* current = Shard::s_current;
+  if (current != nullptr && &current->pool == this) {
+    return current->index;
+  }
+  return getShardIndex(name);
+}
+
+PendingInterestHandle
+FacePool::expressInterest(const Interest& interest,
+                          const DataCallback& afterSatisfied,
+                          const NackCallback& afterNacked,
+                          const TimeoutCallback& afterTimeout)
+{
+  // Face::expressInterest only allocates an atomic record ID and posts the work to the Face's
+  // io_service, so it is safe to invoke from any thread
+  return getFace(getShardIndex(interest.getName()))
+           .expressInterest(interest, afterSatisfied, afterNacked, afterTimeout);
+}
+
+FacePool::MultiShardHandle
+FacePool::setInterestFilter(const InterestFilter& filter, const InterestCallback& onInterest,
+                            const RegisterPrefixSuccessCallback& onSuccess,
+                            const RegisterPrefixFailureCallback& onFailure,
+                            const security::SigningInfo& signingInfo, uint64_t flags)
+{
+  return registerOnAllShards(filter.getPrefix(), filter, onInterest, onSuccess, onFailure,
+                             signingInfo, flags);
+}
+
+FacePool::MultiShardHandle
+FacePool::setInterestFilter(const InterestFilter& filter, const InterestCallback& onInterest)
+{
+  // like expressInterest, this overload of Face::setInterestFilter is thread-safe
+  auto handles = make_shared<std::vector<InterestFilterHandle>>();
+  handles->reserve(m_shards.size());
+  for (const auto& shard : m_shards) {
+    handles->push_back(shard->face->setInterestFilter(filter, onInterest));
+  }
+
+  return MultiShardHandle([handles] {
+    for (const auto& hdl : *handles) {
+      hdl.cancel();
+    }
+  });
+}
+
+FacePool::MultiShardHandle
+FacePool::registerPrefix(const Name& prefix,
+                         const RegisterPrefixSuccessCallback& onSuccess,
+                         const RegisterPrefixFailureCallback& onFailure,
+                         const security::SigningInfo& signingInfo, uint64_t flags)
+{
+  return registerOnAllShards(prefix, nullopt, nullptr, onSuccess, onFailure, signingInfo, flags);
+}
+
+FacePool::MultiShardHandle
+FacePool::registerOnAllShards(const Name& prefix, const optional<InterestFilter>& filter,
+                              const InterestCallback& onInterest,
+                              const RegisterPrefixSuccessCallback& onSuccess,
+                              const RegisterPrefixFailureCallback& onFailure,
+                              const security::SigningInfo& signingInfo, uint64_t flags)
+{
+  struct Registration
+  {
+    explicit
+    Registration(size_t nShards)
+      : nRemaining(nShards)
+      , handles(nShards)
+    {
+    }
+
+    std::atomic<size_t> nRemaining;
+    std::atomic_flag hasFailed = ATOMIC_FLAG_INIT;
+    /// handles[i] is only accessed on the thread of shard i
+    std::vector<RegisteredPrefixHandle> handles;
+  };
+  auto reg = make_shared<Registration>(m_shards.size());
+
+  // Face::registerPrefix signs and sends the command on the calling thread,
+  // so it must run on the thread of the shard that owns the Face
+  std::vector<weak_ptr<Shard>> shards(m_shards.begin(), m_shards.end());
+  for (const auto& shard : m_shards) {
+    Face& face = *shard->face;
+    size_t i = shard->index;
+    shard->io.post([=, &face] {
+      auto succeeded = [=] (const Name& name) {
+        if (--reg->nRemaining == 0 && onSuccess) {
+          onSuccess(name);
+        }
+      };
+      auto failed = [=] (const Name& name, const std::string& reason) {
+        NDN_LOG_DEBUG("shard " << i << " failed to register " << name << ": " << reason);
+        if (!reg->hasFailed.test_and_set() && onFailure) {
+          onFailure(name, reason);
+        }
+      };
+
+      if (filter) {
+        reg->handles[i] = face.setInterestFilter(*filter, onInterest, succeeded, failed,
+                                                 signingInfo, flags);
+      }
+      else {
+        reg->handles[i] = face.registerPrefix(prefix, succeeded, failed, signingInfo, flags);
+      }
+    });
+  }
+
+  return MultiShardHandle([reg, shards] {
+    for (size_t i = 0; i < shards.size(); ++i) {
+      Shard::post(shards[i], [reg, i] { reg->handles[i].unregister(); });
+    }
+  });
+}
+
+void
+FacePool::put(const Data& data)
+{
+  getFace(getPutShardIndex(data.getName())).put(data);
+}
+
+void
+FacePool::put(const lp::Nack& nack)
+{
+  getFace(getPutShardIndex(nack.getInterest().getName())).put(nack);
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_FACE_POOL_HPP
+#define NDN_UTIL_FACE_POOL_HPP
+
+#include "ndn-cxx/face.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief A set of Faces, each running on its own io_service thread.
+ *
+ * A single Face owns one transport and is driven by one io_service, which limits packet
+ * processing to a single core. FacePool owns N such Faces ("shards"), each with a dedicated
+ * io_service, transport, and thread, and exposes an API that mirrors Face:
+ *
+ * - expressInterest() selects a shard by hashing the Interest name, so that Interests for
+ *   different names (e.g., different segments of an object) are spread across shards.
+ * - setInterestFilter() and registerPrefix() are replicated to every shard, so that Interests
+ *   arriving on any shard's connection are dispatched.
+ * - put() sends the packet on the shard that owns the calling thread, i.e., Data produced from
+ *   within an InterestCallback goes out on the connection the Interest came from. When called
+ *   from a thread outside the pool, the shard is selected by name hash.
+ *
+ * @warning Callbacks are invoked on the thread of the shard that received the packet. Different
+ *          callbacks may therefore run concurrently, and the application must synchronize any
+ *          state they share.
+ */
+class FacePool : noncopyable
+{
+public:
+  /**
+   * @brief Creates the Face of one shard on the given io_service.
+   */
+  using FaceFactory = std::function<unique_ptr<Face>(boost::asio::io_service&)>;
+
+  /**
+   * @brief Handle for an operation that has been replicated to every shard.
+   */
+  using MultiShardHandle = ndn::detail::CancelHandle;
+
+  /**
+   * @brief Create a pool of @p nShards Faces and start their threads.
+   * @param nShards number of shards, must be positive
+   * @param makeFace creates the Face of each shard; if empty, each shard uses a Face with the
+   *                 default transport and its own KeyChain
+   * @throw std::invalid_argument @p nShards is zero
+   */
+  explicit
+  FacePool(size_t nShards, const FaceFactory& makeFace = nullptr);
+
+  /**
+   * @brief Shut down all shards and join their threads.
+   */
+  ~FacePool();
+
+  /**
+   * @brief Get the number of shards.
+   */
+  size_t
+  size() const
+  {
+    return m_shards.size();
+  }
+
+  /**
+   * @brief Get the Face of a shard.
+   * @warning The Face must only be accessed from its own io_service thread, unless the Face
+   *          method is documented as thread-safe.
+   */
+  Face&
+  getFace(size_t shardIndex) const;
+
+  /**
+   * @brief Get the index of the shard that handles @p name.
+   */
+  size_t
+  getShardIndex(const Name& name) const;
+
+public: // consumer
+  /**
+   * @brief Express Interest on the shard selected by the Interest name.
+   * @sa Face::expressInterest
+   */
+  PendingInterestHandle
+  expressInterest(const Interest& interest,
+                  const DataCallback& afterSatisfied,
+                  const NackCallback& afterNacked,
+                  const TimeoutCallback& afterTimeout);
+
+public: // producer
+  /**
+   * @brief Set InterestFilter and register its prefix on every shard.
+   *
+   * @p onSuccess is invoked once, after all shards have registered the prefix.
+   * @p onFailure is invoked at most once, upon the first failing shard.
+   *
+   * @sa Face::setInterestFilter
+   * @return A handle for unregistering the prefix and unsetting the Interest filter on all shards.
+   */
+  MultiShardHandle
+  setInterestFilter(const InterestFilter& filter, const InterestCallback& onInterest,
+                    const RegisterPrefixSuccessCallback& onSuccess,
+                    const RegisterPrefixFailureCallback& onFailure,
+                    const security::SigningInfo& signingInfo = security::SigningInfo(),
+                    uint64_t flags = nfd::ROUTE_FLAG_CHILD_INHERIT);
+
+  /**
+   * @brief Set InterestFilter on every shard, without registering the prefix.
+   * @sa Face::setInterestFilter
+   * @return A handle for unsetting the Interest filter on all shards.
+   */
+  MultiShardHandle
+  setInterestFilter(const InterestFilter& filter, const InterestCallback& onInterest);
+
+  /**
+   * @brief Register prefix on every shard.
+   *
+   * @p onSuccess is invoked once, after all shards have registered the prefix.
+   * @p onFailure is invoked at most once, upon the first failing shard.
+   *
+   * @sa Face::registerPrefix
+   * @return A handle for unregistering the prefix on all shards.
+   */
+  MultiShardHandle
+  registerPrefix(const Name& prefix,
+                 const RegisterPrefixSuccessCallback& onSuccess,
+                 const RegisterPrefixFailureCallback& onFailure,
+                 const security::SigningInfo& signingInfo = security::SigningInfo(),
+                 uint64_t flags = nfd::ROUTE_FLAG_CHILD_INHERIT);
+
+  /**
+   * @brief Publish Data packet on the shard owning the calling thread.
+   * @sa Face::put(Data)
+   */
+  void
+  put(const Data& data);
+
+  /**
+   * @brief Send a network NACK on the shard owning the calling thread.
+   * @sa Face::put(lp::Nack)
+   */
+  void
+  put(const lp::Nack& nack);
+
+public: // IO routine
+  /**
+   * @brief Shut down all shards and join their threads.
+   *
+   * This method must not be invoked from a shard thread. It is safe to call more than once.
+   */
+  void
+  shutdown();
+
+private:
+  class Shard;
+
+  size_t
+  getPutShardIndex(const Name& name) const;
+
+  MultiShardHandle
+  registerOnAllShards(const Name& prefix, const optional<InterestFilter>& filter,
+                      const InterestCallback& onInterest,
+                      const RegisterPrefixSuccessCallback& onSuccess,
+                      const RegisterPrefixFailureCallback& onFailure,
+                      const security::SigningInfo& signingInfo, uint64_t flags);
+
+private:
+  std::vector<shared_ptr<Shard>> m_shards;
+  bool m_isShutdown = false;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_FACE_POOL_HPP
@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2019 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-checkpoint.hpp"
+#include "ndn-cxx/encoding/block-helpers.hpp"
+#include "ndn-cxx/encoding/encoding-buffer.hpp"
+
+namespace ndn {
+namespace util {
+
+namespace {
+
+enum : uint32_t {
+  TLV_FETCH_CHECKPOINT = 200,
+  TLV_N_SEGMENTS = 201,
+  TLV_SEGMENT_SIZE = 202,
+  TLV_LAST_SEGMENT_SIZE = 203,
+  TLV_RECEIVED_RANGE = 204,
+  TLV_RANGE_START = 205,
+  TLV_RANGE_END = 206,
+};
+
+} // namespace
+
+FetchCheckpoint::FetchCheckpoint(const Block& wire)
+{
+  this->wireDecode(wire);
+}
+
+template<encoding::Tag TAG>
+size_t
+FetchCheckpoint::wireEncode(EncodingImpl<TAG>& encoder) const
+{
+  size_t totalLength = 0;
+
+  for (auto it = receivedRanges.rbegin(); it != receivedRanges.rend(); ++it) {
+    size_t rangeLength = 0;
+    rangeLength += prependNonNegativeIntegerBlock(encoder, TLV_RANGE_END, it->second);
+    rangeLength += prependNonNegativeIntegerBlock(encoder, TLV_RANGE_START, it->first);
+    rangeLength += encoder.prependVarNumber(rangeLength);
+    rangeLength += encoder.prependVarNumber(TLV_RECEIVED_RANGE);
+    totalLength += rangeLength;
+  }
+
+  totalLength += prependNonNegativeIntegerBlock(encoder, TLV_LAST_SEGMENT_SIZE, lastSegmentSize);
+  totalLength += prependNonNegativeIntegerBlock(encoder, TLV_SEGMENT_SIZE, segmentSize);
+  totalLength += prependNonNegativeIntegerBlock(encoder, TLV_N_SEGMENTS, nSegments);
+  totalLength += versionedName.wireEncode(encoder);
+
+  totalLength += encoder.prependVarNumber(totalLength);
+  totalLength += encoder.prependVarNumber(TLV_FETCH_CHECKPOINT);
+  return totalLength;
+}
+
+NDN_CXX_DEFINE_WIRE_ENCODE_INSTANTIATIONS(FetchCheckpoint);
+
+Block
+FetchCheckpoint::wireEncode() const
+{
+  EncodingEstimator estimator;
+  size_t estimatedSize = wireEncode(estimator);
+
+  EncodingBuffer buffer(estimatedSize, 0);
+  wireEncode(buffer);
+  return buffer.block();
+}
+
+void
+FetchCheckpoint::wireDecode(const Block& wire)
+{
+  if (wire.type() != TLV_FETCH_CHECKPOINT) {
+    NDN_THROW(Error("FetchCheckpoint", wire.type()));
+  }
+
+  Block block = wire;
+  block.parse();
+  auto val = block.elements_begin();
+
+  auto readRequired = [&] (uint32_t type, const char* field) -> const Block& {
+    if (val == block.elements_end() || val->type() != type) {
+      NDN_THROW(Error("Missing required "s + field + " field"));
+    }
+    return *val++;
+  };
+
+  versionedName.wireDecode(readRequired(tlv::Name, "Name"));
+  nSegments = readNonNegativeInteger(readRequired(TLV_N_SEGMENTS, "NSegments"));
+  segmentSize = readNonNegativeInteger(readRequired(TLV_SEGMENT_SIZE, "SegmentSize"));
+  lastSegmentSize = readNonNegativeInteger(readRequired(TLV_LAST_SEGMENT_SIZE, "LastSegmentSize"));
+
+  receivedRanges.clear();
+  for (; val != block.elements_end() && val->type() == TLV_RECEIVED_RANGE; ++val) {
+    val->parse();
+    if (val->elements_size() != 2 ||
+        val->elements()[0].type() != TLV_RANGE_START ||
+        val->elements()[1].type() != TLV_RANGE_END) {
+      NDN_THROW(Error("Malformed ReceivedRange"));
+    }
+    uint64_t first = readNonNegativeInteger(val->elements()[0]);
+    uint64_t last = readNonNegativeInteger(val->elements()[1]);
+    if (first >= last || (!receivedRanges.empty() && first <= receivedRanges.back().second)) {
+      NDN_THROW(Error("ReceivedRange is empty, overlapping, or out of order"));
+    }
+    if (nSegments > 0 && last > nSegments) {
+      NDN_THROW(Error("ReceivedRange extends beyond NSegments"));
+    }
+    receivedRanges.emplace_back(first, last);
+  }
+
+  if (val != block.elements_end()) {
+    NDN_THROW(Error("Unrecognized element of TLV-TYPE " + to_string(val->type()) +
+                    " in FetchCheckpoint"));
+  }
+}
+
+bool
+FetchCheckpoint::contains(uint64_t segNum) const
+{
+  auto it = std::upper_bound(receivedRanges.begin(), receivedRanges.end(), segNum,
+                             [] (uint64_t n, const std::pair<uint64_t, uint64_t>& range) {
+                               return n < range.first;
+                             });
+  return it != receivedRanges.begin() && segNum < std::prev(it)->second;
+}
+
+uint64_t
+FetchCheckpoint::getNSegmentsReceived() const
+{
+  uint64_t n = 0;
+  for (const auto& range : receivedRanges) {
+    n += range.second - range.first;
+  }
+  return n;
+}
+
+bool
+operator==(const FetchCheckpoint& a, const FetchCheckpoint& b)
+{
+  return a.versionedName == b.versionedName &&
+         a.nSegments == b.nSegments &&
+         a.segmentSize == b.segmentSize &&
+         a.lastSegmentSize == b.lastSegmentSize &&
+         a.receivedRanges == b.receivedRanges;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FetchCheckpoint& checkpoint)
+{
+  os << "FetchCheckpoint(Name: " << checkpoint.versionedName
+     << ", NSegments: " << checkpoint.nSegments
+     << ", SegmentSize: " << checkpoint.segmentSize
+     << ", LastSegmentSize: " << checkpoint.lastSegmentSize
+     << ", ReceivedRanges: [";
+  std::string sep;
+  for (const auto& range : checkpoint.receivedRanges) {
+    os << sep << "[" << range.first << ", " << range.second << ")";
+    sep = ", ";
+  }
+  return os << "])";
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,115 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_FETCH_CHECKPOINT_HPP
+#define NDN_UTIL_FETCH_CHECKPOINT_HPP
+
+#include "ndn-cxx/name.hpp"
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief State of a segmented transfer from which SegmentFetcher can resume.
+ *
+ * It records the version being fetched and the segments that the application has already
+ * stored, so that a failed or interrupted transfer does not start over.
+ *
+ * The checkpoint can be persisted in its TLV encoding:
+ *
+ *     FetchCheckpoint = FETCH-CHECKPOINT-TYPE TLV-LENGTH
+ *                         Name
+ *                         NSegments
+ *                         SegmentSize
+ *                         LastSegmentSize
+ *                         *ReceivedRange
+ *     ReceivedRange = RECEIVED-RANGE-TYPE TLV-LENGTH
+ *                       RangeStart
+ *                       RangeEnd
+ *
+ * The TLV-TYPE numbers are in the application-specific range (200 to 206).
+ */
+class FetchCheckpoint
+{
+public:
+  class Error : public tlv::Error
+  {
+  public:
+    using tlv::Error::Error;
+  };
+
+  FetchCheckpoint() = default;
+
+  /**
+   * @brief Decode a checkpoint from its TLV encoding.
+   */
+  explicit
+  FetchCheckpoint(const Block& wire);
+
+  template<encoding::Tag TAG>
+  size_t
+  wireEncode(EncodingImpl<TAG>& encoder) const;
+
+  Block
+  wireEncode() const;
+
+  void
+  wireDecode(const Block& wire);
+
+  /**
+   * @brief Returns whether segment @p segNum has been received.
+   */
+  bool
+  contains(uint64_t segNum) const;
+
+  /**
+   * @brief Returns the number of received segments.
+   */
+  uint64_t
+  getNSegmentsReceived() const;
+
+public:
+  Name versionedName; ///< name of the object, including the version
+  uint64_t nSegments = 0; ///< number of segments in the object, or 0 if unknown
+  uint64_t segmentSize = 0; ///< size of the segments except the last one, or 0 if unknown
+  uint64_t lastSegmentSize = 0; ///< size of the last segment, if it has been received
+  /// received segments, as sorted and disjoint half-open ranges [first, last) below nSegments
+  std::vector<std::pair<uint64_t, uint64_t>> receivedRanges;
+};
+
+NDN_CXX_DECLARE_WIRE_ENCODE_INSTANTIATIONS(FetchCheckpoint);
+
+bool
+operator==(const FetchCheckpoint& a, const FetchCheckpoint& b);
+
+inline bool
+operator!=(const FetchCheckpoint& a, const FetchCheckpoint& b)
+{
+  return !(a == b);
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FetchCheckpoint& checkpoint);
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_FETCH_CHECKPOINT_HPP
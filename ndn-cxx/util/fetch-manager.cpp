@@ -0,0 +1,492 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-manager.hpp"
+#include "ndn-cxx/lp/nack.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+namespace ndn {
+namespace util {
+
+void
+FetchManager::Options::validate()
+{
+  if (maxTimeout < 1_ms) {
+    NDN_THROW(std::invalid_argument("maxTimeout must be greater than or equal to 1 millisecond"));
+  }
+
+  if (maxConcurrentFetches < 1) {
+    NDN_THROW(std::invalid_argument("maxConcurrentFetches must be greater than or equal to 1"));
+  }
+}
+
+FetchManager::Path::Path(const Options& options)
+  : rttEstimator(make_shared<RttEstimator::Options>(options.rttOptions))
+{
+  if (options.congestionControl) {
+    congestionControl = options.congestionControl();
+    BOOST_ASSERT(congestionControl != nullptr);
+  }
+  else {
+    congestionControl = make_unique<AimdCongestionControl>();
+  }
+}
+
+FetchManager::FetchManager(Face& face, security::v2::Validator& validator, const Options& options)
+  : m_options(options)
+  , m_face(face)
+  , m_scheduler(m_face.getIoService())
+  , m_validator(validator)
+{
+  m_options.validate();
+}
+
+FetchManager::~FetchManager() = default;
+
+FetchManager::FetchId
+FetchManager::fetch(const Interest& baseInterest, const CompleteCallback& onComplete,
+                    const ErrorCallback& onError)
+{
+  auto fetch = make_shared<Fetch>();
+  fetch->id = ++m_lastId;
+  fetch->baseInterest = baseInterest;
+  fetch->onComplete = onComplete;
+  fetch->onError = onError;
+  m_queue.push_back(std::move(fetch));
+
+  activateQueuedFetches();
+  return m_lastId;
+}
+
+bool
+FetchManager::cancel(FetchId id)
+{
+  auto queued = std::find_if(m_queue.begin(), m_queue.end(),
+                             [id] (const auto& fetch) { return fetch->id == id; });
+  if (queued != m_queue.end()) {
+    m_queue.erase(queued);
+    return true;
+  }
+
+  for (auto& path : m_paths) {
+    for (auto& fetch : path.second->fetches) {
+      if (fetch->id == id) {
+        removeFetch(*fetch);
+        activateQueuedFetches();
+        fillWindow(*path.second);
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+optional<double>
+FetchManager::getPathCwnd(const Name& name) const
+{
+  auto it = m_paths.find(getPathPrefix(name));
+  if (it == m_paths.end()) {
+    return nullopt;
+  }
+  return it->second->congestionControl->getCwnd();
+}
+
+Name
+FetchManager::getPathPrefix(const Name& name) const
+{
+  return name.getPrefix(static_cast<ssize_t>(std::min(m_options.pathPrefixLength, name.size())));
+}
+
+void
+FetchManager::activateQueuedFetches()
+{
+  while (m_nActive < m_options.maxConcurrentFetches && !m_queue.empty()) {
+    auto fetch = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    auto& path = m_paths[getPathPrefix(fetch->baseInterest.getName())];
+    if (path == nullptr) {
+      path = make_unique<Path>(m_options);
+    }
+    fetch->path = path.get();
+    fetch->timeLastSegmentReceived = time::steady_clock::now();
+    path->fetches.push_back(std::move(fetch));
+    ++m_nActive;
+
+    fillWindow(*path);
+  }
+}
+
+void
+FetchManager::fillWindow(Path& path)
+{
+  // a full round without any Interest sent means that no fetch has anything to request
+  size_t nIdle = 0;
+  while (path.nInFlight < path.getWindow() && nIdle < path.fetches.size()) {
+    // rotate the fetch at the front to the back
+    path.fetches.splice(path.fetches.end(), path.fetches, path.fetches.begin());
+    if (requestNext(*path.fetches.back())) {
+      nIdle = 0;
+    }
+    else {
+      ++nIdle;
+    }
+  }
+}
+
+bool
+FetchManager::requestNext(Fetch& fetch)
+{
+  if (fetch.versionedName.empty()) {
+    if (fetch.discovery) {
+      return false;
+    }
+    sendInterest(fetch, nullopt, !fetch.isDiscoveryRetx);
+    return true;
+  }
+
+  while (!fetch.retxQueue.empty()) {
+    uint64_t segNum = *fetch.retxQueue.begin();
+    fetch.retxQueue.erase(fetch.retxQueue.begin());
+    if (!fetch.receivedSegments.contains(segNum) && (fetch.nSegments == 0 || segNum < fetch.nSegments)) {
+      sendInterest(fetch, segNum, false);
+      return true;
+    }
+  }
+
+  while (fetch.nSegments == 0 || fetch.nextSegmentNum < fetch.nSegments) {
+    uint64_t segNum = fetch.nextSegmentNum++;
+    // The segment may have been received in response to the discovery Interest
+    if (!fetch.receivedSegments.contains(segNum)) {
+      sendInterest(fetch, segNum, true);
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+FetchManager::sendInterest(Fetch& fetch, optional<uint64_t> segNum, bool isFirstRequest)
+{
+  Interest interest;
+  if (!segNum) {
+    interest = fetch.baseInterest;
+    interest.setCanBePrefix(true);
+    interest.setMustBeFresh(true);
+    interest.setInterestLifetime(m_options.interestLifetime);
+    interest.refreshNonce();
+  }
+  else if (fetch.baseInterest.hasApplicationParameters()) {
+    interest = fetch.baseInterest; // to preserve Interest elements
+    interest.setName(Name(fetch.versionedName).appendSegment(*segNum));
+    interest.setCanBePrefix(false);
+    interest.setMustBeFresh(false);
+    interest.setInterestLifetime(m_options.interestLifetime);
+    interest.refreshNonce();
+  }
+  else {
+    if (!fetch.interestTemplate) {
+      Interest prototype(fetch.baseInterest); // to preserve Interest elements
+      prototype.setName(fetch.versionedName);
+      prototype.setCanBePrefix(false);
+      prototype.setMustBeFresh(false);
+      prototype.setInterestLifetime(m_options.interestLifetime);
+      fetch.interestTemplate.emplace(prototype);
+    }
+    interest = fetch.interestTemplate->makeSegmentInterest(*segNum);
+  }
+
+  Path& path = *fetch.path;
+  weak_ptr<Fetch> weakFetch = fetch.shared_from_this();
+  auto pendingInterest = m_face.expressInterest(interest,
+    [this, weakFetch, segNum] (const Interest&, const Data& data) {
+      afterDataReceived(weakFetch, segNum, data);
+    },
+    [this, weakFetch, segNum] (const Interest&, const lp::Nack& nack) {
+      afterNack(weakFetch, segNum, nack);
+    },
+    nullptr);
+
+  auto timeout = std::min(m_options.maxTimeout,
+                          time::duration_cast<time::milliseconds>(path.rttEstimator.getEstimatedRto()));
+  auto timeoutEvent = m_scheduler.schedule(timeout, [this, weakFetch, segNum] {
+    auto fetch = weakFetch.lock();
+    if (fetch != nullptr) {
+      afterLoss(*fetch, segNum);
+    }
+  });
+
+  if (!segNum) {
+    fetch.discovery.emplace();
+  }
+  InFlightInterest& inFlight = segNum ? fetch.inFlight[*segNum] : *fetch.discovery;
+  inFlight.sendTime = time::steady_clock::now();
+  inFlight.isFirstRequest = isFirstRequest;
+  inFlight.hdl = pendingInterest;
+  inFlight.timeoutEvent = timeoutEvent;
+  ++path.nInFlight;
+}
+
+void
+FetchManager::afterDataReceived(const weak_ptr<Fetch>& weakFetch, optional<uint64_t> segNum,
+                                const Data& data)
+{
+  auto fetch = weakFetch.lock();
+  if (fetch == nullptr) {
+    return;
+  }
+
+  auto now = time::steady_clock::now();
+  optional<time::nanoseconds> rtt;
+  if (!segNum) {
+    BOOST_ASSERT(fetch->discovery);
+    if (fetch->discovery->isFirstRequest) {
+      rtt = now - fetch->discovery->sendTime;
+    }
+    fetch->discovery = nullopt;
+  }
+  else {
+    auto it = fetch->inFlight.find(*segNum);
+    if (it == fetch->inFlight.end()) {
+      return;
+    }
+    if (it->second.isFirstRequest) {
+      rtt = now - it->second.sendTime;
+    }
+    fetch->inFlight.erase(it);
+  }
+  BOOST_ASSERT(fetch->path->nInFlight > 0);
+  --fetch->path->nInFlight;
+
+  if (data.getName().empty() || !data.getName()[-1].isSegment()) {
+    return failFetch(*fetch, DATA_HAS_NO_SEGMENT, "Data Name has no segment number");
+  }
+  if (!segNum) {
+    if (data.getName().size() < 2) {
+      return failFetch(*fetch, DATA_HAS_NO_SEGMENT, "Data Name has no version");
+    }
+    // no further discovery Interest is needed, unless validation fails and the fetch with it
+    fetch->versionedName = data.getName().getPrefix(-1);
+  }
+
+  m_validator.validate(data,
+    [this, weakFetch, rtt] (const Data& data) {
+      afterValidationSuccess(weakFetch, data, rtt);
+    },
+    [this, weakFetch] (const Data&, const security::v2::ValidationError& error) {
+      auto fetch = weakFetch.lock();
+      if (fetch != nullptr) {
+        failFetch(*fetch, SEGMENT_VALIDATION_FAIL, "Segment validation failed: " +
+                  boost::lexical_cast<std::string>(error));
+      }
+    });
+}
+
+void
+FetchManager::afterValidationSuccess(const weak_ptr<Fetch>& weakFetch, const Data& data,
+                                     optional<time::nanoseconds> rtt)
+{
+  auto fetch = weakFetch.lock();
+  if (fetch == nullptr) {
+    return;
+  }
+
+  Path& path = *fetch->path;
+  fetch->timeLastSegmentReceived = time::steady_clock::now();
+
+  if (rtt) {
+    path.rttEstimator.addMeasurement(*rtt, path.nInFlight + 1);
+  }
+
+  CongestionControl::AckSample sample;
+  sample.now = fetch->timeLastSegmentReceived;
+  sample.rtt = rtt;
+  if (path.rttEstimator.hasSamples()) {
+    sample.smoothedRtt = path.rttEstimator.getSmoothedRtt();
+  }
+  sample.isCongestionMarked = data.getCongestionMark() > 0;
+  if (sample.isCongestionMarked) {
+    congestionEvent(path);
+  }
+  path.congestionControl->afterAck(sample);
+
+  // It was verified in afterDataReceived that the last Data name component is a segment number
+  uint64_t segNum = data.getName()[-1].toSegment();
+  if (data.getFinalBlock()) {
+    if (!data.getFinalBlock()->isSegment()) {
+      return failFetch(*fetch, FINALBLOCKID_NOT_SEGMENT,
+                       "Received FinalBlockId did not contain a segment component");
+    }
+
+    uint64_t nSegments = data.getFinalBlock()->toSegment() + 1;
+    if (nSegments != fetch->nSegments) {
+      fetch->nSegments = nSegments;
+      auto excess = fetch->inFlight.lower_bound(nSegments);
+      path.nInFlight -= static_cast<size_t>(std::distance(excess, fetch->inFlight.end()));
+      fetch->inFlight.erase(excess, fetch->inFlight.end());
+      fetch->retxQueue.erase(fetch->retxQueue.lower_bound(nSegments), fetch->retxQueue.end());
+      fetch->segmentEnds.reserve(static_cast<size_t>(std::min(nSegments,
+                                                              ndn::detail::MAX_RESERVED_SEGMENTS)));
+    }
+  }
+
+  // segments at or beyond the end of the object are dropped
+  if ((fetch->nSegments == 0 || segNum < fetch->nSegments) && fetch->receivedSegments.insert(segNum)) {
+    fetch->retxQueue.erase(segNum);
+    fetch->segmentBuffer.emplace(segNum, data.getContent());
+  }
+
+  while (fetch->nSegments == 0 || fetch->nextSegmentInOrder < fetch->nSegments) {
+    auto it = fetch->segmentBuffer.find(fetch->nextSegmentInOrder);
+    if (it == fetch->segmentBuffer.end()) {
+      break;
+    }
+    const Block& content = it->second;
+    fetch->contentBuffer->insert(fetch->contentBuffer->end(), content.value_begin(), content.value_end());
+    fetch->segmentEnds.push_back(fetch->contentBuffer->size());
+    fetch->segmentBuffer.erase(it);
+    ++fetch->nextSegmentInOrder;
+  }
+
+  // a lower FinalBlockId may complete the fetch without a new segment
+  if (fetch->nSegments > 0 && fetch->nextSegmentInOrder >= fetch->nSegments) {
+    return finishFetch(*fetch);
+  }
+
+  fillWindow(path);
+}
+
+void
+FetchManager::afterNack(const weak_ptr<Fetch>& weakFetch, optional<uint64_t> segNum,
+                        const lp::Nack& nack)
+{
+  auto fetch = weakFetch.lock();
+  if (fetch == nullptr) {
+    return;
+  }
+
+  switch (nack.getReason()) {
+    case lp::NackReason::DUPLICATE:
+    case lp::NackReason::CONGESTION:
+      afterLoss(*fetch, segNum);
+      break;
+    default:
+      failFetch(*fetch, NACK_ERROR, "Nack Error");
+      break;
+  }
+}
+
+void
+FetchManager::afterLoss(Fetch& fetch, optional<uint64_t> segNum)
+{
+  Path& path = *fetch.path;
+  if (!segNum) {
+    if (!fetch.discovery) {
+      return;
+    }
+    fetch.discovery = nullopt; // cancels the pending Interest and the timeout event
+    fetch.isDiscoveryRetx = true;
+  }
+  else {
+    auto it = fetch.inFlight.find(*segNum);
+    if (it == fetch.inFlight.end()) {
+      return;
+    }
+    fetch.inFlight.erase(it);
+    fetch.retxQueue.insert(*segNum);
+  }
+  BOOST_ASSERT(path.nInFlight > 0);
+  --path.nInFlight;
+
+  if (time::steady_clock::now() >= fetch.timeLastSegmentReceived + m_options.maxTimeout) {
+    // Fail transfer due to exceeding the maximum timeout between the successful receipt of segments
+    return failFetch(fetch, INTEREST_TIMEOUT, "Timeout exceeded");
+  }
+
+  path.rttEstimator.backoffRto();
+  congestionEvent(path);
+  fillWindow(path);
+}
+
+void
+FetchManager::congestionEvent(Path& path)
+{
+  // at most one window decrease per round trip of the path
+  auto now = time::steady_clock::now();
+  auto rtt = path.rttEstimator.hasSamples() ? path.rttEstimator.getSmoothedRtt() :
+                                              path.rttEstimator.getEstimatedRto();
+  if (now - path.lastDecrease >= rtt) {
+    path.congestionControl->afterCongestionEvent(now);
+    path.lastDecrease = now;
+  }
+}
+
+void
+FetchManager::removeFetch(Fetch& fetch)
+{
+  Path& path = *fetch.path;
+  size_t nInFlight = fetch.inFlight.size() + (fetch.discovery ? 1 : 0);
+  BOOST_ASSERT(path.nInFlight >= nInFlight);
+  path.nInFlight -= nInFlight;
+  // cancels pending Interests and timeout events
+  fetch.inFlight.clear();
+  fetch.discovery = nullopt;
+
+  path.fetches.remove_if([&fetch] (const auto& f) { return f.get() == &fetch; });
+  BOOST_ASSERT(m_nActive > 0);
+  --m_nActive;
+}
+
+void
+FetchManager::finishFetch(Fetch& fetch)
+{
+  auto self = fetch.shared_from_this(); // keep alive during the callback
+  Path& path = *fetch.path;
+  removeFetch(fetch);
+
+  BOOST_ASSERT(fetch.segmentEnds.size() >= fetch.nSegments);
+  fetch.contentBuffer->resize(fetch.segmentEnds[fetch.nSegments - 1]);
+  if (fetch.onComplete) {
+    fetch.onComplete(fetch.contentBuffer);
+  }
+
+  activateQueuedFetches();
+  fillWindow(path);
+}
+
+void
+FetchManager::failFetch(Fetch& fetch, uint32_t code, const std::string& msg)
+{
+  auto self = fetch.shared_from_this(); // keep alive during the callback
+  Path& path = *fetch.path;
+  removeFetch(fetch);
+
+  if (fetch.onError) {
+    fetch.onError(code, msg);
+  }
+
+  activateQueuedFetches();
+  fillWindow(path);
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,309 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_FETCH_MANAGER_HPP
+#define NDN_UTIL_FETCH_MANAGER_HPP
+
+#include "ndn-cxx/face.hpp"
+#include "ndn-cxx/detail/segment-window.hpp"
+#include "ndn-cxx/interest-template.hpp"
+#include "ndn-cxx/security/validator.hpp"
+#include "ndn-cxx/util/congestion-control.hpp"
+#include "ndn-cxx/util/rtt-estimator.hpp"
+#include "ndn-cxx/util/scheduler.hpp"
+
+#include <list>
+#include <map>
+#include <set>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief Fetches many segmented objects concurrently over shared congestion windows.
+ *
+ * Each object is fetched as by SegmentFetcher in 'block' mode: the latest version is discovered
+ * with an Interest `/<prefix>?CanBePrefix&MustBeFresh`, then segments `/<prefix>/<version>/<segment>`
+ * are requested until the FinalBlockId is reached, and the reassembled content is passed to the
+ * completion callback.
+ *
+ * Unlike a SegmentFetcher per object, the congestion window and the RTT estimator belong to a
+ * path, which is identified by the first Options::pathPrefixLength components of the object name.
+ * All objects on a path share them, so that objects fetched after the first one start with a
+ * warm window instead of slow start. Within a path, free window slots are handed out round-robin
+ * among the objects being fetched, one segment at a time.
+ *
+ * At most Options::maxConcurrentFetches objects are fetched at a time; further requests wait in
+ * a FIFO queue.
+ *
+ * Example:
+ *     @code
+ *     FetchManager manager(face, validator);
+ *     for (const Name& name : names) {
+ *       manager.fetch(Interest(name),
+ *                     [] (ConstBufferPtr content) { ... },
+ *                     [] (uint32_t errorCode, const std::string& errorMsg) { ... });
+ *     }
+ *     @endcode
+ */
+class FetchManager : noncopyable
+{
+public:
+  /**
+   * @brief Error codes passed to ErrorCallback.
+   *
+   * The values are the same as in SegmentFetcher::ErrorCode.
+   */
+  enum ErrorCode {
+    /// No segment of the object was received within the maximum timeout
+    INTEREST_TIMEOUT = 1,
+    /// One of the retrieved Data packets lacked a segment number in the last Name component (excl. implicit digest)
+    DATA_HAS_NO_SEGMENT = 2,
+    /// One of the retrieved segments failed user-provided validation
+    SEGMENT_VALIDATION_FAIL = 3,
+    /// An unrecoverable Nack was received during retrieval
+    NACK_ERROR = 4,
+    /// A received FinalBlockId did not contain a segment component
+    FINALBLOCKID_NOT_SEGMENT = 5,
+  };
+
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+    void
+    validate();
+
+  public:
+    time::milliseconds interestLifetime = 4_s; ///< lifetime of sent Interests - independent of Interest timeout
+    time::milliseconds maxTimeout = 60_s; ///< maximum allowed time between successful receipt of segments of an object
+    size_t maxConcurrentFetches = 64; ///< maximum number of objects fetched at the same time
+    /// number of leading name components that identify a path; objects whose names share them
+    /// share a congestion window and an RTT estimator
+    size_t pathPrefixLength = 1;
+    RttEstimator::Options rttOptions; ///< options for the RTT estimator of each path
+
+    /**
+     * @brief Creates the congestion control algorithm of each path.
+     *
+     * If empty, AimdCongestionControl with default options is used.
+     */
+    std::function<unique_ptr<CongestionControl>()> congestionControl;
+  };
+
+  using FetchId = uint64_t;
+  using CompleteCallback = std::function<void(ConstBufferPtr content)>;
+  using ErrorCallback = std::function<void(uint32_t errorCode, const std::string& errorMsg)>;
+
+  /**
+   * @param face      Face used to fetch the objects.
+   * @param validator Validator of the segments; it must remain valid as long as the manager.
+   * @param options   Options controlling the transfers.
+   */
+  FetchManager(Face& face, security::v2::Validator& validator, const Options& options = Options());
+
+  /**
+   * @brief Cancels all fetches without invoking their callbacks.
+   * @note The manager must not be destroyed from within one of its callbacks.
+   */
+  ~FetchManager();
+
+  /**
+   * @brief Requests an object.
+   *
+   * @param baseInterest Interest for the object. Its name is the prefix of the object; other
+   *                     elements propagate to all Interests of the object, except that
+   *                     CanBePrefix and MustBeFresh are only set on the discovery Interest.
+   * @param onComplete   Invoked with the content of the object.
+   * @param onError      Invoked with one of the error codes from ErrorCode.
+   * @return identifier of the fetch, for cancel()
+   */
+  FetchId
+  fetch(const Interest& baseInterest, const CompleteCallback& onComplete,
+        const ErrorCallback& onError);
+
+  /**
+   * @brief Stops fetching an object without invoking its callbacks.
+   * @return whether the fetch was still queued or in progress
+   */
+  bool
+  cancel(FetchId id);
+
+  /**
+   * @brief Returns the number of objects being fetched.
+   */
+  size_t
+  getNActiveFetches() const
+  {
+    return m_nActive;
+  }
+
+  /**
+   * @brief Returns the number of objects waiting for a fetch slot.
+   */
+  size_t
+  getNQueuedFetches() const
+  {
+    return m_queue.size();
+  }
+
+  /**
+   * @brief Returns the congestion window of the path of @p name, if any object on it has been
+   *        fetched.
+   */
+  optional<double>
+  getPathCwnd(const Name& name) const;
+
+private:
+  class Fetch;
+  class Path;
+
+  Name
+  getPathPrefix(const Name& name) const;
+
+  /**
+   * @brief Starts queued fetches while there are free fetch slots.
+   */
+  void
+  activateQueuedFetches();
+
+  /**
+   * @brief Hands out the free window slots of @p path round-robin among its fetches.
+   */
+  void
+  fillWindow(Path& path);
+
+  /**
+   * @brief Sends the next Interest of @p fetch, if any.
+   * @return whether an Interest was sent
+   */
+  bool
+  requestNext(Fetch& fetch);
+
+  void
+  sendInterest(Fetch& fetch, optional<uint64_t> segNum, bool isFirstRequest);
+
+  void
+  afterDataReceived(const weak_ptr<Fetch>& weakFetch, optional<uint64_t> segNum, const Data& data);
+
+  void
+  afterValidationSuccess(const weak_ptr<Fetch>& weakFetch, const Data& data,
+                         optional<time::nanoseconds> rtt);
+
+  void
+  afterNack(const weak_ptr<Fetch>& weakFetch, optional<uint64_t> segNum, const lp::Nack& nack);
+
+  /**
+   * @brief Handles a timeout or a congestion Nack of an Interest of @p fetch.
+   */
+  void
+  afterLoss(Fetch& fetch, optional<uint64_t> segNum);
+
+  void
+  congestionEvent(Path& path);
+
+  /**
+   * @brief Removes @p fetch and cancels its Interests.
+   */
+  void
+  removeFetch(Fetch& fetch);
+
+  void
+  finishFetch(Fetch& fetch);
+
+  void
+  failFetch(Fetch& fetch, uint32_t code, const std::string& msg);
+
+private:
+  class InFlightInterest
+  {
+  public:
+    time::steady_clock::TimePoint sendTime;
+    bool isFirstRequest; ///< no other Interest has been sent for the segment (Karn's algorithm)
+    ScopedPendingInterestHandle hdl;
+    scheduler::ScopedEventId timeoutEvent;
+  };
+
+  class Fetch : public std::enable_shared_from_this<Fetch>, noncopyable
+  {
+  public:
+    FetchId id;
+    Interest baseInterest;
+    CompleteCallback onComplete;
+    ErrorCallback onError;
+    Path* path = nullptr; ///< set when the fetch becomes active
+
+    Name versionedName; ///< set once the version has been discovered
+    optional<InterestTemplate> interestTemplate;
+    optional<InFlightInterest> discovery; ///< outstanding discovery Interest
+    bool isDiscoveryRetx = false;
+    std::map<uint64_t, InFlightInterest> inFlight;
+    std::set<uint64_t> retxQueue; ///< segments to request again, lowest first
+    uint64_t nSegments = 0; ///< number of segments, or 0 if unknown
+    uint64_t nextSegmentNum = 0; ///< next segment that has never been requested
+    time::steady_clock::TimePoint timeLastSegmentReceived;
+
+    ndn::detail::SegmentBitmap receivedSegments;
+    std::map<uint64_t, Block> segmentBuffer; ///< validated segments awaiting in-order delivery
+    uint64_t nextSegmentInOrder = 0;
+    shared_ptr<Buffer> contentBuffer = make_shared<Buffer>();
+    std::vector<size_t> segmentEnds; ///< end offset of each segment in contentBuffer
+  };
+
+  class Path : noncopyable
+  {
+  public:
+    explicit
+    Path(const Options& options);
+
+    size_t
+    getWindow() const
+    {
+      return std::max<size_t>(1, static_cast<size_t>(congestionControl->getCwnd()));
+    }
+
+  public:
+    RttEstimator rttEstimator;
+    unique_ptr<CongestionControl> congestionControl;
+    time::steady_clock::TimePoint lastDecrease;
+    size_t nInFlight = 0;
+    std::list<shared_ptr<Fetch>> fetches; ///< active fetches, in round-robin order
+  };
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  Options m_options;
+  Face& m_face;
+  Scheduler m_scheduler;
+  security::v2::Validator& m_validator;
+
+  FetchId m_lastId = 0;
+  std::list<shared_ptr<Fetch>> m_queue; ///< fetches waiting for a slot
+  size_t m_nActive = 0;
+  std::map<Name, unique_ptr<Path>> m_paths;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_FETCH_MANAGER_HPP
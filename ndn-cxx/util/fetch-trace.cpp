@@ -0,0 +1,311 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-trace.hpp"
+
+#include <boost/io/ios_state.hpp>
+
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace ndn {
+namespace util {
+
+constexpr size_t FetchTrace::RTT_SUB_BUCKETS;
+
+FetchTrace::FetchTrace(size_t capacity)
+  : m_ring(capacity)
+{
+  if (capacity == 0) {
+    NDN_THROW(std::invalid_argument("FetchTrace capacity must be positive"));
+  }
+  reset();
+}
+
+void
+FetchTrace::reset()
+{
+  m_nRecorded = 0;
+  m_start = time::steady_clock::now();
+  m_end = nullopt;
+  m_lastEventTime = 0_ns;
+  m_stats = Statistics();
+  m_rttHistogram.fill(0);
+}
+
+void
+FetchTrace::finish()
+{
+  m_end = time::steady_clock::now();
+}
+
+void
+FetchTrace::record(EventType type, uint64_t segment, double value, double value2)
+{
+  m_lastEventTime = time::steady_clock::now() - m_start;
+  m_ring[m_nRecorded % m_ring.size()] = {m_lastEventTime, segment, value, value2, type};
+  ++m_nRecorded;
+
+  switch (type) {
+    case EventType::RETRANSMIT:
+      ++m_stats.nRetransmissions;
+      NDN_CXX_FALLTHROUGH;
+    case EventType::SEND:
+      ++m_stats.nInterests;
+      break;
+    case EventType::VALIDATE:
+      ++m_stats.nSegments;
+      m_stats.nBytes += static_cast<uint64_t>(value);
+      break;
+    case EventType::TIMEOUT:
+      ++m_stats.nTimeouts;
+      break;
+    case EventType::NACK:
+      ++m_stats.nNacks;
+      break;
+    case EventType::CONGESTION_MARK:
+      ++m_stats.nCongestionMarks;
+      break;
+    default:
+      break;
+  }
+}
+
+void
+FetchTrace::recordRtt(uint64_t segment, time::nanoseconds rtt, time::nanoseconds rto)
+{
+  using FpMilliseconds = time::duration<double, time::milliseconds::period>;
+  record(EventType::RTT, segment,
+         time::duration_cast<FpMilliseconds>(rtt).count(),
+         time::duration_cast<FpMilliseconds>(rto).count());
+
+  if (m_stats.nRttSamples == 0 || rtt < m_stats.minRtt) {
+    m_stats.minRtt = rtt;
+  }
+  if (m_stats.nRttSamples == 0 || rtt > m_stats.maxRtt) {
+    m_stats.maxRtt = rtt;
+  }
+  ++m_stats.nRttSamples;
+  ++m_rttHistogram[getRttBucket(rtt)];
+}
+
+std::vector<FetchTrace::Event>
+FetchTrace::getEvents() const
+{
+  std::vector<Event> events;
+  if (m_nRecorded <= m_ring.size()) {
+    events.assign(m_ring.begin(), m_ring.begin() + static_cast<ptrdiff_t>(m_nRecorded));
+  }
+  else {
+    auto oldest = m_ring.begin() + static_cast<ptrdiff_t>(m_nRecorded % m_ring.size());
+    events.reserve(m_ring.size());
+    events.insert(events.end(), oldest, m_ring.end());
+    events.insert(events.end(), m_ring.begin(), oldest);
+  }
+  return events;
+}
+
+FetchTrace::Statistics
+FetchTrace::getStatistics() const
+{
+  Statistics stats = m_stats;
+  stats.duration = m_end ? *m_end - m_start : m_lastEventTime;
+  if (stats.duration > 0_ns) {
+    stats.goodput = static_cast<double>(stats.nBytes) /
+                    time::duration_cast<time::duration<double>>(stats.duration).count();
+  }
+  if (stats.nInterests > 0) {
+    stats.retxRatio = static_cast<double>(stats.nRetransmissions) / stats.nInterests;
+  }
+  stats.rttP50 = getRttPercentile(0.50);
+  stats.rttP99 = getRttPercentile(0.99);
+  return stats;
+}
+
+size_t
+FetchTrace::getRttBucket(time::nanoseconds rtt)
+{
+  auto value = static_cast<uint64_t>(std::max<time::nanoseconds::rep>(rtt.count(), 0));
+  if (value < RTT_SUB_BUCKETS) {
+    return static_cast<size_t>(value);
+  }
+
+  size_t exponent = 0;
+  while ((value >> exponent) >= 2 * RTT_SUB_BUCKETS) {
+    ++exponent;
+  }
+  // value >> exponent is in [16, 32): the leading bit and 4 more significant bits
+  return (exponent + 1) * RTT_SUB_BUCKETS + static_cast<size_t>((value >> exponent) - RTT_SUB_BUCKETS);
+}
+
+time::nanoseconds
+FetchTrace::getRttBucketValue(size_t bucket)
+{
+  if (bucket < RTT_SUB_BUCKETS) {
+    return time::nanoseconds(bucket);
+  }
+
+  size_t exponent = bucket / RTT_SUB_BUCKETS - 1;
+  uint64_t lower = (RTT_SUB_BUCKETS + bucket % RTT_SUB_BUCKETS) << exponent;
+  uint64_t width = uint64_t(1) << exponent;
+  return time::nanoseconds(static_cast<time::nanoseconds::rep>(lower + width / 2));
+}
+
+time::nanoseconds
+FetchTrace::getRttPercentile(double percentile) const
+{
+  if (m_stats.nRttSamples == 0) {
+    return 0_ns;
+  }
+
+  auto target = static_cast<uint64_t>(std::ceil(percentile * m_stats.nRttSamples));
+  target = std::max<uint64_t>(target, 1);
+  uint64_t count = 0;
+  for (size_t bucket = 0; bucket < m_rttHistogram.size(); ++bucket) {
+    count += m_rttHistogram[bucket];
+    if (count >= target) {
+      return std::min(std::max(getRttBucketValue(bucket), m_stats.minRtt), m_stats.maxRtt);
+    }
+  }
+  return m_stats.maxRtt;
+}
+
+static double
+toMilliseconds(time::nanoseconds duration)
+{
+  return static_cast<double>(duration.count()) / 1e6;
+}
+
+void
+FetchTrace::writeCsv(std::ostream& os) const
+{
+  boost::io::ios_all_saver saver(os);
+  os << "time,event,segment,value,value2\n";
+  for (const auto& event : getEvents()) {
+    os << std::fixed << std::setprecision(3) << toMilliseconds(event.time) << ','
+       << event.type << ',' << event.segment << ','
+       << std::defaultfloat << std::setprecision(6) << event.value << ',' << event.value2 << '\n';
+  }
+}
+
+void
+FetchTrace::writeJson(std::ostream& os) const
+{
+  boost::io::ios_all_saver saver(os);
+  Statistics stats = getStatistics();
+
+  os << "{\"statistics\":{"
+     << "\"duration\":" << toMilliseconds(stats.duration)
+     << ",\"nInterests\":" << stats.nInterests
+     << ",\"nRetransmissions\":" << stats.nRetransmissions
+     << ",\"nTimeouts\":" << stats.nTimeouts
+     << ",\"nNacks\":" << stats.nNacks
+     << ",\"nCongestionMarks\":" << stats.nCongestionMarks
+     << ",\"nSegments\":" << stats.nSegments
+     << ",\"nBytes\":" << stats.nBytes
+     << ",\"goodput\":" << stats.goodput
+     << ",\"retxRatio\":" << stats.retxRatio
+     << ",\"nRttSamples\":" << stats.nRttSamples
+     << ",\"minRtt\":" << toMilliseconds(stats.minRtt)
+     << ",\"maxRtt\":" << toMilliseconds(stats.maxRtt)
+     << ",\"rttP50\":" << toMilliseconds(stats.rttP50)
+     << ",\"rttP99\":" << toMilliseconds(stats.rttP99)
+     << "},\"nRecorded\":" << m_nRecorded
+     << ",\"events\":[";
+
+  bool isFirst = true;
+  for (const auto& event : getEvents()) {
+    os << (isFirst ? "" : ",")
+       << "{\"time\":" << std::fixed << std::setprecision(3) << toMilliseconds(event.time)
+       << std::defaultfloat << std::setprecision(6)
+       << ",\"event\":\"" << event.type << "\",\"segment\":" << event.segment;
+    switch (event.type) {
+      case EventType::SEND:
+      case EventType::RETRANSMIT:
+        os << ",\"timeout\":" << event.value;
+        break;
+      case EventType::RECEIVE:
+      case EventType::VALIDATE:
+        os << ",\"size\":" << event.value;
+        break;
+      case EventType::RTT:
+        os << ",\"rtt\":" << event.value << ",\"rto\":" << event.value2;
+        break;
+      case EventType::CWND:
+        os << ",\"cwnd\":" << event.value << ",\"ssthresh\":" << event.value2;
+        break;
+      default:
+        break;
+    }
+    os << '}';
+    isFirst = false;
+  }
+  os << "]}";
+}
+
+std::ostream&
+operator<<(std::ostream& os, FetchTrace::EventType type)
+{
+  switch (type) {
+    case FetchTrace::EventType::SEND:
+      return os << "send";
+    case FetchTrace::EventType::RETRANSMIT:
+      return os << "retransmit";
+    case FetchTrace::EventType::RECEIVE:
+      return os << "receive";
+    case FetchTrace::EventType::VALIDATE:
+      return os << "validate";
+    case FetchTrace::EventType::VALIDATION_FAILURE:
+      return os << "validation-failure";
+    case FetchTrace::EventType::TIMEOUT:
+      return os << "timeout";
+    case FetchTrace::EventType::NACK:
+      return os << "nack";
+    case FetchTrace::EventType::CONGESTION_MARK:
+      return os << "congestion-mark";
+    case FetchTrace::EventType::RTT:
+      return os << "rtt";
+    case FetchTrace::EventType::CWND:
+      return os << "cwnd";
+  }
+  return os << "unknown";
+}
+
+std::ostream&
+operator<<(std::ostream& os, const FetchTrace::Statistics& stats)
+{
+  return os << "duration=" << time::duration_cast<time::milliseconds>(stats.duration)
+            << " segments=" << stats.nSegments
+            << " bytes=" << stats.nBytes
+            << " goodput=" << stats.goodput << "B/s"
+            << " interests=" << stats.nInterests
+            << " retx=" << stats.nRetransmissions
+            << " retxRatio=" << stats.retxRatio
+            << " timeouts=" << stats.nTimeouts
+            << " nacks=" << stats.nNacks
+            << " marks=" << stats.nCongestionMarks
+            << " rttP50=" << time::duration_cast<time::microseconds>(stats.rttP50)
+            << " rttP99=" << time::duration_cast<time::microseconds>(stats.rttP99);
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,191 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_FETCH_TRACE_HPP
+#define NDN_UTIL_FETCH_TRACE_HPP
+
+#include "ndn-cxx/util/time.hpp"
+
+#include <array>
+#include <vector>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief Timeline of the events of a segmented transfer, and statistics about it.
+ *
+ * A trace is attached to a SegmentFetcher through SegmentFetcher::Options::trace. The fetcher
+ * records when each segment is requested, retransmitted, received, and validated, along with
+ * timeouts, Nacks, congestion marks, RTT samples, and changes of the congestion window.
+ *
+ * The events are kept in a ring of fixed capacity: once it is full, the oldest events are
+ * overwritten. The statistics are accumulated separately and cover the whole transfer, whatever
+ * the capacity. The timeline can be written as CSV or JSON for offline analysis.
+ *
+ * A trace records a single transfer; reset() prepares it for another one.
+ */
+class FetchTrace
+{
+public:
+  enum class EventType : uint8_t {
+    SEND,               ///< Interest sent; value is the timeout in milliseconds
+    RETRANSMIT,         ///< Interest retransmitted; value is the timeout in milliseconds
+    RECEIVE,            ///< Data received; value is the size of the content
+    VALIDATE,           ///< segment validated; value is the size of the content
+    VALIDATION_FAILURE, ///< segment failed validation
+    TIMEOUT,            ///< Interest timed out
+    NACK,               ///< Nack received
+    CONGESTION_MARK,    ///< Data carried a congestion mark
+    RTT,                ///< RTT sample; value is the RTT and value2 the new RTO, in milliseconds
+    CWND,               ///< window changed; value is the congestion window and value2 the threshold
+  };
+
+  class Event
+  {
+  public:
+    time::nanoseconds time; ///< time since the start of the trace
+    uint64_t segment;
+    double value;
+    double value2;
+    EventType type;
+  };
+
+  class Statistics
+  {
+  public:
+    time::nanoseconds duration = 0_ns; ///< from the start of the trace to its end or last event
+    uint64_t nInterests = 0; ///< Interests sent, including retransmissions
+    uint64_t nRetransmissions = 0;
+    uint64_t nTimeouts = 0;
+    uint64_t nNacks = 0;
+    uint64_t nCongestionMarks = 0;
+    uint64_t nSegments = 0; ///< validated segments
+    uint64_t nBytes = 0; ///< content bytes in validated segments
+    uint64_t nRttSamples = 0;
+    double goodput = 0.0; ///< validated content, in bytes per second
+    double retxRatio = 0.0; ///< fraction of the Interests that are retransmissions
+    time::nanoseconds minRtt = 0_ns;
+    time::nanoseconds maxRtt = 0_ns;
+    /// median RTT, within the resolution of the histogram (1/16 of the value)
+    time::nanoseconds rttP50 = 0_ns;
+    /// 99th percentile RTT, within the resolution of the histogram
+    time::nanoseconds rttP99 = 0_ns;
+  };
+
+  /**
+   * @brief Create a trace that keeps the last @p capacity events.
+   * @throw std::invalid_argument @p capacity is zero
+   */
+  explicit
+  FetchTrace(size_t capacity = 65536);
+
+  /**
+   * @brief Discard all events and statistics, and start the trace now.
+   */
+  void
+  reset();
+
+  /**
+   * @brief Mark the end of the transfer, which ends the duration used in the statistics.
+   */
+  void
+  finish();
+
+  void
+  record(EventType type, uint64_t segment, double value = 0.0, double value2 = 0.0);
+
+  void
+  recordRtt(uint64_t segment, time::nanoseconds rtt, time::nanoseconds rto);
+
+  /**
+   * @brief Get the events still in the ring, from the oldest to the newest.
+   */
+  std::vector<Event>
+  getEvents() const;
+
+  size_t
+  getCapacity() const
+  {
+    return m_ring.size();
+  }
+
+  /**
+   * @brief Get the number of events recorded, including those that have been overwritten.
+   */
+  uint64_t
+  getNRecorded() const
+  {
+    return m_nRecorded;
+  }
+
+  Statistics
+  getStatistics() const;
+
+  /**
+   * @brief Write the events as CSV, with a header line.
+   *
+   * The columns are: time (milliseconds since the start), event, segment, value, value2.
+   */
+  void
+  writeCsv(std::ostream& os) const;
+
+  /**
+   * @brief Write the statistics and the events as a JSON object.
+   */
+  void
+  writeJson(std::ostream& os) const;
+
+private:
+  /// RTT histogram with 16 sub-buckets per power of two of nanoseconds
+  static constexpr size_t RTT_SUB_BUCKETS = 16;
+  using RttHistogram = std::array<uint64_t, 64 * RTT_SUB_BUCKETS>;
+
+  static size_t
+  getRttBucket(time::nanoseconds rtt);
+
+  static time::nanoseconds
+  getRttBucketValue(size_t bucket);
+
+  time::nanoseconds
+  getRttPercentile(double percentile) const;
+
+private:
+  std::vector<Event> m_ring;
+  uint64_t m_nRecorded = 0;
+  time::steady_clock::TimePoint m_start;
+  optional<time::steady_clock::TimePoint> m_end;
+  time::nanoseconds m_lastEventTime = 0_ns;
+
+  Statistics m_stats;
+  RttHistogram m_rttHistogram;
+};
+
+std::ostream&
+operator<<(std::ostream& os, FetchTrace::EventType type);
+
+std::ostream&
+operator<<(std::ostream& os, const FetchTrace::Statistics& stats);
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_FETCH_TRACE_HPP
@@ -50,7 +50,7 @@ public:
     HASHCHAIN_ERROR = 6,
   };
 
-  shared_ptr<HCSegmentFetcher>
+  static shared_ptr<HCSegmentFetcher>
   start(Face &face,
       const Interest &baseInterest,
       security::v2::Validator &validator,
@@ -85,8 +85,8 @@ private:
   std::map<int, std::shared_ptr<Block>> nextHash_map;
   std::map<int, std::shared_ptr<Data>> data_map;
   std::shared_ptr<Block> before_signature;
-  int before_segment;
-  int success_count;
+  int before_segment = -1;
+  int success_count = 0;
 }; 
 
 }
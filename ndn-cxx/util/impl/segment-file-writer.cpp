@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/impl/segment-file-writer.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace util {
+namespace detail {
+
+static std::string
+makeErrorMessage(const std::string& what)
+{
+  return what + ": " + std::strerror(errno);
+}
+
+SegmentFileWriter::SegmentFileWriter(const std::string& filename, bool useMmap, uint64_t fsyncInterval,
+                                     bool truncate)
+  : m_useMmap(useMmap)
+  , m_fsyncInterval(fsyncInterval)
+{
+  // O_RDWR is required by shared memory mappings
+  m_fd = ::open(filename.data(), O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+  if (m_fd < 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot open " + filename)));
+  }
+}
+
+SegmentFileWriter::~SegmentFileWriter()
+{
+  unmap();
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+void
+SegmentFileWriter::setNSegments(uint64_t nSegments)
+{
+  if (nSegments == m_nSegments) {
+    return;
+  }
+
+  m_nSegments = nSegments;
+  ensureMapped();
+
+  // segments held back because their offset or role was unknown may be writable now
+  auto buffered = std::move(m_buffered);
+  m_buffered.clear();
+  for (const auto& item : buffered) {
+    write(item.first, item.second);
+  }
+}
+
+void
+SegmentFileWriter::resume(size_t segmentSize, uint64_t highSegNum, size_t highSegmentSize)
+{
+  BOOST_ASSERT(m_nBytesWritten == 0 && m_buffered.empty());
+
+  m_segmentSize = segmentSize;
+  m_lastSegNum = highSegNum;
+  m_lastSegmentSize = highSegmentSize;
+  ensureMapped();
+}
+
+void
+SegmentFileWriter::write(uint64_t segNum, const Block& content)
+{
+  BOOST_ASSERT(m_fd >= 0);
+
+  if (m_nSegments > 0 && segNum >= m_nSegments) {
+    return; // beyond the end of the object
+  }
+
+  bool isLast = m_nSegments > 0 && segNum + 1 == m_nSegments;
+  size_t size = content.value_size();
+
+  if (m_segmentSize == 0) {
+    if (isLast) {
+      if (segNum > 0) {
+        // the offset of the last segment depends on the size of the others
+        m_buffered.emplace(segNum, content);
+        return;
+      }
+      // the only segment of the object is written at offset 0
+    }
+    else {
+      if (size == 0) {
+        NDN_THROW(Error("Segment " + to_string(segNum) + " is empty but not the last segment"));
+      }
+      m_segmentSize = size;
+      ensureMapped();
+
+      auto buffered = std::move(m_buffered);
+      m_buffered.clear();
+      writeAt(segNum, content);
+      for (const auto& item : buffered) {
+        write(item.first, item.second);
+      }
+      return;
+    }
+  }
+  else if (!isLast && size < m_segmentSize && m_nSegments == 0) {
+    // possibly the last segment, whose FinalBlockId is not yet known
+    m_buffered.emplace(segNum, content);
+    return;
+  }
+
+  writeAt(segNum, content);
+}
+
+void
+SegmentFileWriter::writeAt(uint64_t segNum, const Block& content)
+{
+  bool isLast = m_nSegments > 0 && segNum + 1 == m_nSegments;
+  size_t size = content.value_size();
+  if (m_segmentSize > 0 && (isLast ? size > m_segmentSize : size != m_segmentSize)) {
+    NDN_THROW(Error("Segment " + to_string(segNum) + " has " + to_string(size) +
+                    " octets, but segments of this object have " + to_string(m_segmentSize)));
+  }
+
+  uint64_t offset = segNum * m_segmentSize;
+  if (m_map != nullptr && offset + size <= m_mapSize) {
+    std::memcpy(m_map + offset, content.value(), size);
+  }
+  else {
+    const uint8_t* buf = content.value();
+    size_t remaining = size;
+    while (remaining > 0) {
+      ssize_t n = ::pwrite(m_fd, buf, remaining, static_cast<off_t>(offset));
+      if (n < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        NDN_THROW(Error(makeErrorMessage("Cannot write segment " + to_string(segNum))));
+      }
+      buf += n;
+      offset += static_cast<uint64_t>(n);
+      remaining -= static_cast<size_t>(n);
+    }
+  }
+
+  m_nBytesWritten += size;
+  if (segNum >= m_lastSegNum) {
+    m_lastSegNum = segNum;
+    m_lastSegmentSize = size;
+  }
+
+  m_nBytesSinceSync += size;
+  if (m_fsyncInterval > 0 && m_nBytesSinceSync >= m_fsyncInterval) {
+    sync();
+  }
+}
+
+uint64_t
+SegmentFileWriter::finish(bool wantSync)
+{
+  BOOST_ASSERT(m_fd >= 0);
+
+  if (!m_buffered.empty()) {
+    NDN_THROW(Error(to_string(m_buffered.size()) + " segments could not be placed in the file"));
+  }
+
+  uint64_t size = m_lastSegNum * m_segmentSize + m_lastSegmentSize;
+
+  if (wantSync) {
+    sync();
+  }
+  unmap();
+
+  if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot truncate output file")));
+  }
+  if (wantSync && ::fsync(m_fd) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot flush output file")));
+  }
+
+  ::close(m_fd);
+  m_fd = -1;
+  return size;
+}
+
+std::vector<uint64_t>
+SegmentFileWriter::getBufferedSegments() const
+{
+  std::vector<uint64_t> segNums;
+  segNums.reserve(m_buffered.size());
+  for (const auto& item : m_buffered) {
+    segNums.push_back(item.first);
+  }
+  return segNums;
+}
+
+void
+SegmentFileWriter::ensureMapped()
+{
+  if (!m_useMmap || m_nSegments == 0 || m_segmentSize == 0) {
+    return;
+  }
+
+  size_t mapSize = static_cast<size_t>(m_nSegments) * m_segmentSize;
+  if (m_map != nullptr && m_mapSize == mapSize) {
+    return;
+  }
+  unmap();
+
+  if (::ftruncate(m_fd, static_cast<off_t>(mapSize)) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot extend output file")));
+  }
+  void* map = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    NDN_THROW(Error(makeErrorMessage("Cannot map output file")));
+  }
+  m_map = static_cast<uint8_t*>(map);
+  m_mapSize = mapSize;
+}
+
+void
+SegmentFileWriter::unmap()
+{
+  if (m_map != nullptr) {
+    ::munmap(m_map, m_mapSize);
+    m_map = nullptr;
+    m_mapSize = 0;
+  }
+}
+
+void
+SegmentFileWriter::sync()
+{
+  if (m_map != nullptr && ::msync(m_map, m_mapSize, MS_SYNC) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot flush mapped output file")));
+  }
+  if (::fsync(m_fd) != 0) {
+    NDN_THROW(Error(makeErrorMessage("Cannot flush output file")));
+  }
+  m_nBytesSinceSync = 0;
+}
+
+} // namespace detail
+} // namespace util
+} // namespace ndn
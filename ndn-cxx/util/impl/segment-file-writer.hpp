@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_IMPL_SEGMENT_FILE_WRITER_HPP
+#define NDN_UTIL_IMPL_SEGMENT_FILE_WRITER_HPP
+
+#include "ndn-cxx/encoding/block.hpp"
+
+#include <map>
+#include <vector>
+
+namespace ndn {
+namespace util {
+namespace detail {
+
+/** \brief Writes segments of an object into a file at their offsets, in any order.
+ *
+ *  All segments except the last one must have the same size, which is learned from the first
+ *  segment known not to be the last one. Segments received before that are held in memory.
+ *  A segment is written at offset `segment number * segment size`, either with pwrite(2), or
+ *  through a shared memory mapping of the file once the number of segments is known.
+ */
+class SegmentFileWriter : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /** \param filename output file, created if it does not exist
+   *  \param useMmap whether to write through a memory mapping once the file size is known
+   *  \param fsyncInterval flush written data to storage after this many bytes; 0 to disable
+   *  \param truncate whether to truncate an existing file; false to resume a previous transfer
+   *  \throw Error file cannot be opened
+   */
+  SegmentFileWriter(const std::string& filename, bool useMmap, uint64_t fsyncInterval,
+                    bool truncate = true);
+
+  ~SegmentFileWriter();
+
+  /** \brief Set the number of segments in the object, or 0 if unknown
+   *  \throw Error
+   */
+  void
+  setNSegments(uint64_t nSegments);
+
+  /** \brief Restore the state of a previous transfer into the same file
+   *  \param segmentSize size of the segments except the last one, or 0 if unknown
+   *  \param highSegNum highest segment number already in the file
+   *  \param highSegmentSize size of segment \p highSegNum
+   *  \pre no segment has been written
+   */
+  void
+  resume(size_t segmentSize, uint64_t highSegNum, size_t highSegmentSize);
+
+  /** \brief Write the payload of segment \p segNum
+   *  \param content Content element of the segment
+   *  \throw Error segment size is inconsistent, or I/O error
+   */
+  void
+  write(uint64_t segNum, const Block& content);
+
+  /** \brief Truncate the file after the highest segment, optionally flush it to storage, and close it
+   *  \pre all segments have been written
+   *  \return size of the file, which is the size of the object if all its segments were written
+   *  \throw Error
+   */
+  uint64_t
+  finish(bool wantSync);
+
+  /** \return total number of payload bytes written to the file
+   */
+  uint64_t
+  getNBytesWritten() const
+  {
+    return m_nBytesWritten;
+  }
+
+  /** \return number of segments held in memory because their offset is not yet known
+   */
+  size_t
+  getNBufferedSegments() const
+  {
+    return m_buffered.size();
+  }
+
+  /** \return segment numbers held in memory, in ascending order
+   */
+  std::vector<uint64_t>
+  getBufferedSegments() const;
+
+  /** \return size of the segments except the last one, or 0 if not yet known
+   */
+  size_t
+  getSegmentSize() const
+  {
+    return m_segmentSize;
+  }
+
+  /** \return size of the last segment of the object if it has been written, otherwise 0
+   */
+  size_t
+  getLastSegmentSize() const
+  {
+    return m_nSegments > 0 && m_lastSegNum + 1 == m_nSegments ? m_lastSegmentSize : 0;
+  }
+
+private:
+  void
+  writeAt(uint64_t segNum, const Block& content);
+
+  void
+  ensureMapped();
+
+  void
+  unmap();
+
+  void
+  sync();
+
+private:
+  int m_fd = -1;
+  bool m_useMmap;
+  uint8_t* m_map = nullptr;
+  size_t m_mapSize = 0;
+  uint64_t m_fsyncInterval;
+  uint64_t m_nBytesSinceSync = 0;
+
+  uint64_t m_nSegments = 0;
+  size_t m_segmentSize = 0; ///< 0 if not yet known
+  uint64_t m_lastSegNum = 0; ///< highest segment number written
+  size_t m_lastSegmentSize = 0; ///< size of segment m_lastSegNum
+  uint64_t m_nBytesWritten = 0;
+  std::map<uint64_t, Block> m_buffered;
+};
+
+} // namespace detail
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_IMPL_SEGMENT_FILE_WRITER_HPP
@@ -0,0 +1,564 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/multi-source-segment-fetcher.hpp"
+#include "ndn-cxx/lp/nack.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <algorithm>
+
+namespace ndn {
+namespace util {
+
+void
+MultiSourceSegmentFetcher::Options::validate()
+{
+  if (maxTimeout < 1_ms) {
+    NDN_THROW(std::invalid_argument("maxTimeout must be greater than or equal to 1 millisecond"));
+  }
+
+  if (maxSourceFailures < 1) {
+    NDN_THROW(std::invalid_argument("maxSourceFailures must be greater than or equal to 1"));
+  }
+
+  if (stallFactor <= 0.0) {
+    NDN_THROW(std::invalid_argument("stallFactor must be positive"));
+  }
+}
+
+MultiSourceSegmentFetcher::SourceState::SourceState(size_t index, const Source& source,
+                                                    const Options& options)
+  : index(index)
+  , source(source)
+  , rttEstimator(make_shared<RttEstimator::Options>(options.rttOptions))
+{
+  if (options.congestionControl) {
+    congestionControl = options.congestionControl();
+    BOOST_ASSERT(congestionControl != nullptr);
+  }
+  else {
+    congestionControl = make_unique<AimdCongestionControl>();
+  }
+}
+
+time::nanoseconds
+MultiSourceSegmentFetcher::SourceState::getRtt() const
+{
+  return rttEstimator.hasSamples() ? rttEstimator.getSmoothedRtt() : rttEstimator.getEstimatedRto();
+}
+
+double
+MultiSourceSegmentFetcher::SourceState::getRate() const
+{
+  return congestionControl->getCwnd() / time::duration<double>(getRtt()).count();
+}
+
+MultiSourceSegmentFetcher::MultiSourceSegmentFetcher(Face& face, const std::vector<Source>& sources,
+                                                     security::v2::Validator& validator,
+                                                     const Options& options)
+  : m_options(options)
+  , m_face(face)
+  , m_scheduler(m_face.getIoService())
+  , m_validator(validator)
+  , m_timeLastSegmentReceived(time::steady_clock::now())
+  , m_contentBuffer(make_shared<Buffer>())
+{
+  m_options.validate();
+
+  if (sources.empty()) {
+    NDN_THROW(std::invalid_argument("At least one source must be specified"));
+  }
+
+  for (size_t i = 0; i < sources.size(); ++i) {
+    m_sources.push_back(make_unique<SourceState>(i, sources[i], m_options));
+  }
+}
+
+MultiSourceSegmentFetcher::~MultiSourceSegmentFetcher() = default;
+
+shared_ptr<MultiSourceSegmentFetcher>
+MultiSourceSegmentFetcher::start(Face& face,
+                                 const std::vector<Source>& sources,
+                                 security::v2::Validator& validator,
+                                 const Options& options)
+{
+  shared_ptr<MultiSourceSegmentFetcher> fetcher(new MultiSourceSegmentFetcher(face, sources,
+                                                                              validator, options));
+  fetcher->m_this = fetcher;
+  fetcher->sendDiscoveryInterest(0, false);
+  return fetcher;
+}
+
+void
+MultiSourceSegmentFetcher::stop()
+{
+  if (!m_this) {
+    return;
+  }
+
+  // cancels pending Interests and timeout events
+  m_discoveryHdl.cancel();
+  m_discoveryTimeout.cancel();
+  for (auto& source : m_sources) {
+    source->inFlight.clear();
+  }
+  m_face.getIoService().post([self = std::move(m_this)] {});
+}
+
+uint64_t
+MultiSourceSegmentFetcher::getNSegmentsReceived(size_t index) const
+{
+  return m_sources.at(index)->nReceived;
+}
+
+bool
+MultiSourceSegmentFetcher::shouldStop(const weak_ptr<MultiSourceSegmentFetcher>& weakSelf)
+{
+  auto self = weakSelf.lock();
+  return self == nullptr || self->m_this == nullptr;
+}
+
+void
+MultiSourceSegmentFetcher::sendDiscoveryInterest(size_t index, bool isRetransmission)
+{
+  SourceState& source = *m_sources[index];
+  m_discoverySource = index;
+  m_isDiscoveryRetx = isRetransmission;
+
+  Interest interest(source.source.prefix);
+  interest.setCanBePrefix(true);
+  interest.setMustBeFresh(true);
+  interest.setInterestLifetime(m_options.interestLifetime);
+  if (!source.source.forwardingHint.empty()) {
+    interest.setForwardingHint(source.source.forwardingHint);
+  }
+
+  weak_ptr<MultiSourceSegmentFetcher> weakSelf = m_this;
+  m_discoverySendTime = time::steady_clock::now();
+  m_discoveryHdl = m_face.expressInterest(interest,
+    [this, index, weakSelf] (const Interest& interest, const Data& data) {
+      afterDataReceived(index, interest, data, weakSelf);
+    },
+    [this, index, weakSelf] (const Interest& interest, const lp::Nack& nack) {
+      afterNack(index, interest, nack, weakSelf);
+    },
+    nullptr);
+
+  auto timeout = std::min(m_options.maxTimeout,
+                          time::duration_cast<time::milliseconds>(source.rttEstimator.getEstimatedRto()));
+  m_discoveryTimeout = m_scheduler.schedule(timeout, [this, index, interest, weakSelf] {
+    afterTimeout(index, interest, weakSelf);
+  });
+}
+
+size_t
+MultiSourceSegmentFetcher::getNextSource(size_t index) const
+{
+  for (size_t i = 0; i < m_sources.size(); ++i) {
+    size_t next = (index + i) % m_sources.size();
+    if (!m_sources[next]->isFailed) {
+      return next;
+    }
+  }
+  BOOST_ASSERT_MSG(false, "all sources have failed");
+  return index;
+}
+
+void
+MultiSourceSegmentFetcher::fetchSegments()
+{
+  if (!m_this) {
+    return;
+  }
+
+  if (m_nSegments > 0 && m_nextSegmentInOrder >= m_nSegments) {
+    // All segments have been retrieved
+    BOOST_ASSERT(m_segmentEnds.size() >= m_nSegments);
+    m_contentBuffer->resize(m_segmentEnds[m_nSegments - 1]);
+    onComplete(m_contentBuffer);
+    return stop();
+  }
+
+  std::vector<SourceState*> sources;
+  for (auto& source : m_sources) {
+    if (source->isUsable() && source->inFlight.size() < source->getWindow()) {
+      sources.push_back(source.get());
+    }
+  }
+  std::stable_sort(sources.begin(), sources.end(), [] (const SourceState* a, const SourceState* b) {
+    return a->getRate() > b->getRate();
+  });
+
+  for (SourceState* source : sources) {
+    while (source->inFlight.size() < source->getWindow()) {
+      auto segment = pickSegment(*source);
+      if (!segment) {
+        break;
+      }
+      sendInterest(*source, segment->first, segment->second);
+    }
+  }
+}
+
+optional<std::pair<uint64_t, bool>>
+MultiSourceSegmentFetcher::pickSegment(SourceState& source)
+{
+  while (!m_unassigned.empty()) {
+    uint64_t segNum = *m_unassigned.begin();
+    m_unassigned.erase(m_unassigned.begin());
+    if (!m_receivedSegments.contains(segNum) && (m_nSegments == 0 || segNum < m_nSegments)) {
+      return std::make_pair(segNum, false);
+    }
+  }
+
+  while (m_nSegments == 0 || m_nextSegmentNum < m_nSegments) {
+    uint64_t segNum = m_nextSegmentNum++;
+    // The segment may have been received in response to a discovery Interest
+    if (!m_receivedSegments.contains(segNum)) {
+      return std::make_pair(segNum, true);
+    }
+  }
+
+  // Every segment has been requested: take over the oldest segment that is stalled at another source
+  auto now = time::steady_clock::now();
+  SourceState* stalledSource = nullptr;
+  std::map<uint64_t, InFlightSegment>::iterator stalledSegment;
+  for (auto& other : m_sources) {
+    if (other.get() == &source) {
+      continue;
+    }
+    // without RTT samples from the other source, its RTT is assumed to be the same as this one's
+    auto rtt = other->rttEstimator.hasSamples() ? other->getRtt() : source.getRtt();
+    auto stallTime = time::duration_cast<time::nanoseconds>(rtt * m_options.stallFactor);
+    for (auto it = other->inFlight.begin(); it != other->inFlight.end(); ++it) {
+      if (now - it->second.sendTime >= stallTime &&
+          (stalledSource == nullptr || it->second.sendTime < stalledSegment->second.sendTime)) {
+        stalledSource = other.get();
+        stalledSegment = it;
+      }
+    }
+  }
+
+  if (stalledSource == nullptr) {
+    return nullopt;
+  }
+
+  // The Face would deliver the Data to both Interests, so the one at the stalled source is canceled
+  uint64_t segNum = stalledSegment->first;
+  stalledSource->inFlight.erase(stalledSegment);
+  congestionEvent(*stalledSource);
+  return std::make_pair(segNum, false);
+}
+
+void
+MultiSourceSegmentFetcher::sendInterest(SourceState& source, uint64_t segNum, bool isFirstRequest)
+{
+  Interest interest(Name(source.versionedName).appendSegment(segNum));
+  interest.setCanBePrefix(false);
+  interest.setMustBeFresh(false);
+  interest.setInterestLifetime(m_options.interestLifetime);
+  if (!source.source.forwardingHint.empty()) {
+    interest.setForwardingHint(source.source.forwardingHint);
+  }
+
+  size_t index = source.index;
+  weak_ptr<MultiSourceSegmentFetcher> weakSelf = m_this;
+  auto pendingInterest = m_face.expressInterest(interest,
+    [this, index, weakSelf] (const Interest& interest, const Data& data) {
+      afterDataReceived(index, interest, data, weakSelf);
+    },
+    [this, index, weakSelf] (const Interest& interest, const lp::Nack& nack) {
+      afterNack(index, interest, nack, weakSelf);
+    },
+    nullptr);
+
+  auto timeout = std::min(m_options.maxTimeout,
+                          time::duration_cast<time::milliseconds>(source.rttEstimator.getEstimatedRto()));
+  auto timeoutEvent = m_scheduler.schedule(timeout, [this, index, interest, weakSelf] {
+    afterTimeout(index, interest, weakSelf);
+  });
+
+  InFlightSegment& segment = source.inFlight[segNum];
+  segment.sendTime = time::steady_clock::now();
+  segment.isFirstRequest = isFirstRequest;
+  segment.hdl = pendingInterest;
+  segment.timeoutEvent = timeoutEvent;
+}
+
+void
+MultiSourceSegmentFetcher::afterDataReceived(size_t index, const Interest& interest, const Data& data,
+                                             const weak_ptr<MultiSourceSegmentFetcher>& weakSelf)
+{
+  if (shouldStop(weakSelf))
+    return;
+
+  SourceState& source = *m_sources[index];
+  auto now = time::steady_clock::now();
+
+  if (data.getName().empty() || !data.getName()[-1].isSegment()) {
+    return signalError(DATA_HAS_NO_SEGMENT, "Data Name has no segment number");
+  }
+
+  optional<time::nanoseconds> rtt;
+  if (interest.getCanBePrefix()) {
+    // reply to the discovery Interest
+    m_discoveryTimeout.cancel();
+    if (!m_isDiscoveryRetx) {
+      rtt = now - m_discoverySendTime;
+    }
+
+    if (data.getName().size() < 2) {
+      return signalError(DATA_HAS_NO_SEGMENT, "Data Name has no version");
+    }
+    source.versionedName = data.getName().getPrefix(-1);
+    for (auto& other : m_sources) {
+      if (other.get() != &source) {
+        other->versionedName = Name(other->source.prefix).append(data.getName()[-2]);
+      }
+    }
+  }
+  else {
+    auto it = source.inFlight.find(data.getName()[-1].toSegment());
+    if (it == source.inFlight.end()) {
+      return;
+    }
+    if (it->second.isFirstRequest) {
+      rtt = now - it->second.sendTime;
+    }
+    source.inFlight.erase(it);
+  }
+  source.nConsecutiveFailures = 0;
+
+  m_validator.validate(data,
+    [this, index, rtt, weakSelf] (const Data& data) {
+      afterValidationSuccess(index, data, rtt, weakSelf);
+    },
+    [this, weakSelf] (const Data&, const security::v2::ValidationError& error) {
+      if (shouldStop(weakSelf))
+        return;
+      signalError(SEGMENT_VALIDATION_FAIL, "Segment validation failed: " +
+                  boost::lexical_cast<std::string>(error));
+    });
+}
+
+void
+MultiSourceSegmentFetcher::afterValidationSuccess(size_t index, const Data& data,
+                                                  optional<time::nanoseconds> rtt,
+                                                  const weak_ptr<MultiSourceSegmentFetcher>& weakSelf)
+{
+  if (shouldStop(weakSelf))
+    return;
+
+  SourceState& source = *m_sources[index];
+  m_timeLastSegmentReceived = time::steady_clock::now();
+  ++source.nReceived;
+
+  if (rtt) {
+    source.rttEstimator.addMeasurement(*rtt, source.inFlight.size() + 1);
+  }
+
+  CongestionControl::AckSample sample;
+  sample.now = m_timeLastSegmentReceived;
+  sample.rtt = rtt;
+  if (source.rttEstimator.hasSamples()) {
+    sample.smoothedRtt = source.rttEstimator.getSmoothedRtt();
+  }
+  sample.isCongestionMarked = data.getCongestionMark() > 0;
+  if (sample.isCongestionMarked) {
+    congestionEvent(source);
+  }
+  source.congestionControl->afterAck(sample);
+
+  afterSegmentValidated(data);
+
+  // It was verified in afterDataReceived that the last Data name component is a segment number
+  uint64_t segNum = data.getName()[-1].toSegment();
+  if (data.getFinalBlock()) {
+    if (!data.getFinalBlock()->isSegment()) {
+      return signalError(FINALBLOCKID_NOT_SEGMENT,
+                         "Received FinalBlockId did not contain a segment component");
+    }
+
+    uint64_t nSegments = data.getFinalBlock()->toSegment() + 1;
+    if (nSegments != m_nSegments) {
+      m_nSegments = nSegments;
+      for (auto& other : m_sources) {
+        other->inFlight.erase(other->inFlight.lower_bound(m_nSegments), other->inFlight.end());
+      }
+      m_unassigned.erase(m_unassigned.lower_bound(m_nSegments), m_unassigned.end());
+      m_segmentEnds.reserve(static_cast<size_t>(std::min(m_nSegments,
+                                                          ndn::detail::MAX_RESERVED_SEGMENTS)));
+    }
+  }
+
+  // segments at or beyond the end of the object are dropped
+  if ((m_nSegments == 0 || segNum < m_nSegments) && m_receivedSegments.insert(segNum)) {
+    m_unassigned.erase(segNum);
+    m_segmentBuffer.emplace(segNum, data.getContent());
+  }
+  deliverInOrderSegments();
+
+  fetchSegments();
+}
+
+void
+MultiSourceSegmentFetcher::afterNack(size_t index, const Interest& interest, const lp::Nack& nack,
+                                     const weak_ptr<MultiSourceSegmentFetcher>& weakSelf)
+{
+  if (shouldStop(weakSelf))
+    return;
+
+  SourceState& source = *m_sources[index];
+  switch (nack.getReason()) {
+    case lp::NackReason::DUPLICATE:
+    case lp::NackReason::CONGESTION:
+      afterLoss(source, interest);
+      break;
+    default:
+      failSource(source, "Nack: " + boost::lexical_cast<std::string>(nack.getReason()));
+      break;
+  }
+}
+
+void
+MultiSourceSegmentFetcher::afterTimeout(size_t index, const Interest& interest,
+                                        const weak_ptr<MultiSourceSegmentFetcher>& weakSelf)
+{
+  if (shouldStop(weakSelf))
+    return;
+
+  afterLoss(*m_sources[index], interest);
+}
+
+void
+MultiSourceSegmentFetcher::afterLoss(SourceState& source, const Interest& interest)
+{
+  if (time::steady_clock::now() >= m_timeLastSegmentReceived + m_options.maxTimeout) {
+    // Fail transfer due to exceeding the maximum timeout between the successful receipt of segments
+    return signalError(INTEREST_TIMEOUT, "Timeout exceeded");
+  }
+
+  source.rttEstimator.backoffRto();
+  if (++source.nConsecutiveFailures >= m_options.maxSourceFailures) {
+    return failSource(source, "Too many consecutive timeouts or Nacks");
+  }
+
+  if (interest.getCanBePrefix()) {
+    m_discoveryTimeout.cancel();
+    // try the next source
+    return sendDiscoveryInterest(getNextSource(source.index + 1), true);
+  }
+
+  uint64_t segNum = interest.getName()[-1].toSegment();
+  auto it = source.inFlight.find(segNum);
+  if (it == source.inFlight.end()) {
+    return;
+  }
+  it->second.timeoutEvent.cancel();
+  source.inFlight.erase(it);
+
+  congestionEvent(source);
+  requeueSegment(segNum);
+  fetchSegments();
+}
+
+void
+MultiSourceSegmentFetcher::congestionEvent(SourceState& source)
+{
+  // at most one window decrease per round trip of the source
+  auto now = time::steady_clock::now();
+  if (now - source.lastDecrease >= source.getRtt()) {
+    source.congestionControl->afterCongestionEvent(now);
+    source.lastDecrease = now;
+  }
+}
+
+void
+MultiSourceSegmentFetcher::failSource(SourceState& source, const std::string& reason)
+{
+  source.isFailed = true;
+
+  std::vector<uint64_t> segments;
+  for (const auto& segment : source.inFlight) {
+    segments.push_back(segment.first);
+  }
+  source.inFlight.clear();
+  for (uint64_t segNum : segments) {
+    requeueSegment(segNum);
+  }
+
+  afterSourceFailed(source.index, reason);
+  if (!m_this) {
+    return;
+  }
+
+  bool hasUsableSource = std::any_of(m_sources.begin(), m_sources.end(),
+                                     [] (const auto& s) { return !s->isFailed; });
+  if (!hasUsableSource) {
+    return signalError(NO_USABLE_SOURCE, "All sources have failed");
+  }
+
+  if (source.versionedName.empty() && m_discoverySource == source.index) {
+    m_discoveryHdl.cancel();
+    m_discoveryTimeout.cancel();
+    return sendDiscoveryInterest(getNextSource(source.index + 1), true);
+  }
+
+  fetchSegments();
+}
+
+void
+MultiSourceSegmentFetcher::requeueSegment(uint64_t segNum)
+{
+  if (m_receivedSegments.contains(segNum) || (m_nSegments > 0 && segNum >= m_nSegments)) {
+    return;
+  }
+  m_unassigned.insert(segNum);
+}
+
+void
+MultiSourceSegmentFetcher::deliverInOrderSegments()
+{
+  while (m_nSegments == 0 || m_nextSegmentInOrder < m_nSegments) {
+    auto it = m_segmentBuffer.find(m_nextSegmentInOrder);
+    if (it == m_segmentBuffer.end()) {
+      break;
+    }
+
+    const Block& content = it->second;
+    m_contentBuffer->insert(m_contentBuffer->end(), content.value_begin(), content.value_end());
+    m_segmentEnds.push_back(m_contentBuffer->size());
+    m_segmentBuffer.erase(it);
+    ++m_nextSegmentInOrder;
+  }
+}
+
+void
+MultiSourceSegmentFetcher::signalError(uint32_t code, const std::string& msg)
+{
+  onError(code, msg);
+  stop();
+}
+
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,372 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_MULTI_SOURCE_SEGMENT_FETCHER_HPP
+#define NDN_UTIL_MULTI_SOURCE_SEGMENT_FETCHER_HPP
+
+#include "ndn-cxx/delegation-list.hpp"
+#include "ndn-cxx/face.hpp"
+#include "ndn-cxx/detail/segment-window.hpp"
+#include "ndn-cxx/security/validator.hpp"
+#include "ndn-cxx/util/congestion-control.hpp"
+#include "ndn-cxx/util/rtt-estimator.hpp"
+#include "ndn-cxx/util/scheduler.hpp"
+#include "ndn-cxx/util/signal.hpp"
+
+#include <map>
+#include <set>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief Utility class to fetch the latest version of a segmented object from several replicas
+ *        in parallel.
+ *
+ * Each source is a replica of the object, identified by its name prefix and an optional
+ * forwarding hint. Replicas reached through forwarding hints usually share the same prefix;
+ * replicas published under different prefixes must use the same version and segmentation, i.e.,
+ * segments are named `/<prefix>/<version>/<segment>` at every source.
+ *
+ * MultiSourceSegmentFetcher implements the following logic:
+ *
+ * 1. Express an Interest `/<prefix>?CanBePrefix&MustBeFresh` to the first source to discover the
+ *    latest version. If it times out or is nacked, try the next source.
+ *
+ * 2. Keep a separate congestion window and RTT estimator for every source. Whenever a source has
+ *    room in its window, assign it the lowest segment that is neither received nor requested;
+ *    if several sources have room, the one with the highest estimated rate (window divided by
+ *    smoothed RTT) goes first.
+ *
+ * 3. Once every segment has been requested, a source with room in its window takes over the
+ *    oldest segment that is outstanding at another source for longer than Options::stallFactor
+ *    times that source's smoothed RTT (or its own, if that source has no RTT samples yet). The Interest at the stalled source is canceled, which
+ *    counts as a congestion event for that source. Since the Face delivers a Data packet to all
+ *    matching Interests regardless of their forwarding hints, a segment is never outstanding at
+ *    more than one source.
+ *
+ * 4. An Interest that times out or is nacked for congestion reduces the window of its source,
+ *    and the segment goes back to the pool of segments to assign. A source that fails
+ *    Options::maxSourceFailures times in a row, or that returns a Nack of another reason, is no
+ *    longer used; #afterSourceFailed is signaled.
+ *
+ * 5. Validate each segment and signal #onComplete with the content of all segments once the
+ *    number of segments indicated by FinalBlockId has been received.
+ *
+ * If no usable source remains, or no segment has been received for Options::maxTimeout, #onError
+ * is signaled with one of the error codes from ErrorCode.
+ *
+ * Example:
+ *     @code
+ *     std::vector<MultiSourceSegmentFetcher::Source> sources{
+ *       {"/difs/file", DelegationList{{0, "/node-a"}}},
+ *       {"/difs/file", DelegationList{{0, "/node-b"}}},
+ *     };
+ *     auto fetcher = MultiSourceSegmentFetcher::start(face, sources, validator);
+ *     fetcher->onComplete.connect([] (ConstBufferPtr content) { ... });
+ *     fetcher->onError.connect([] (uint32_t errorCode, const std::string& errorMsg) { ... });
+ *     @endcode
+ */
+class MultiSourceSegmentFetcher : noncopyable
+{
+public:
+  /**
+   * @brief Error codes passed to #onError.
+   *
+   * Where applicable, the values are the same as in SegmentFetcher::ErrorCode.
+   */
+  enum ErrorCode {
+    /// No segment was received within the maximum timeout
+    INTEREST_TIMEOUT = 1,
+    /// One of the retrieved Data packets lacked a segment number in the last Name component (excl. implicit digest)
+    DATA_HAS_NO_SEGMENT = 2,
+    /// One of the retrieved segments failed user-provided validation
+    SEGMENT_VALIDATION_FAIL = 3,
+    /// A received FinalBlockId did not contain a segment component
+    FINALBLOCKID_NOT_SEGMENT = 5,
+    /// All sources have failed
+    NO_USABLE_SOURCE = 7,
+  };
+
+  /**
+   * @brief A replica of the object.
+   */
+  class Source
+  {
+  public:
+    Source(const Name& prefix, const DelegationList& forwardingHint = DelegationList())
+      : prefix(prefix)
+      , forwardingHint(forwardingHint)
+    {
+    }
+
+  public:
+    Name prefix; ///< name of the object at this replica, without version and segment
+    DelegationList forwardingHint; ///< forwarding hint of the Interests sent to this replica
+  };
+
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+    void
+    validate();
+
+  public:
+    time::milliseconds interestLifetime = 4_s; ///< lifetime of sent Interests - independent of Interest timeout
+    time::milliseconds maxTimeout = 60_s; ///< maximum allowed time between successful receipt of segments
+    /// consecutive timeouts or Nacks after which a source is no longer used
+    int maxSourceFailures = 3;
+    /// an outstanding segment may be taken over by another source after this many smoothed
+    /// RTTs of the source it was requested from
+    double stallFactor = 2.0;
+    RttEstimator::Options rttOptions; ///< options for the RTT estimator of each source
+
+    /**
+     * @brief Creates the congestion control algorithm of each source.
+     *
+     * If empty, AimdCongestionControl with default options is used.
+     */
+    std::function<unique_ptr<CongestionControl>()> congestionControl;
+  };
+
+  /**
+   * @brief Initiates segment fetching.
+   *
+   * Transfer completion, failure, and progress are indicated via signals.
+   *
+   * @param face      Reference to the Face that should be used to fetch data.
+   * @param sources   Replicas to fetch the object from; must not be empty.
+   * @param validator Reference to the Validator the fetcher will use to validate data.
+   *                  The caller must ensure the validator remains valid until either #onComplete
+   *                  or #onError has been signaled.
+   * @param options   Options controlling the transfer.
+   *
+   * @return A shared_ptr to the constructed fetcher, which is kept internally for the lifetime
+   *         of the transfer.
+   */
+  static shared_ptr<MultiSourceSegmentFetcher>
+  start(Face& face,
+        const std::vector<Source>& sources,
+        security::v2::Validator& validator,
+        const Options& options = Options());
+
+  /**
+   * @brief Stops fetching.
+   *
+   * This cancels all interests that are still pending.
+   */
+  void
+  stop();
+
+  ~MultiSourceSegmentFetcher();
+
+  /**
+   * @brief Returns the number of segments received from the source at @p index.
+   */
+  uint64_t
+  getNSegmentsReceived(size_t index) const;
+
+private:
+  class SourceState;
+
+  MultiSourceSegmentFetcher(Face& face, const std::vector<Source>& sources,
+                            security::v2::Validator& validator, const Options& options);
+
+  static bool
+  shouldStop(const weak_ptr<MultiSourceSegmentFetcher>& weakSelf);
+
+  void
+  sendDiscoveryInterest(size_t index, bool isRetransmission);
+
+  /**
+   * @brief Returns the index of the first source at or after @p index, in circular order, that
+   *        has not failed.
+   * @pre at least one source has not failed
+   */
+  size_t
+  getNextSource(size_t index) const;
+
+  /**
+   * @brief Fills the windows of the usable sources, fastest source first.
+   */
+  void
+  fetchSegments();
+
+  /**
+   * @brief Picks the next segment for @p source.
+   * @return the segment number and whether this is the first request for it
+   */
+  optional<std::pair<uint64_t, bool>>
+  pickSegment(SourceState& source);
+
+  void
+  sendInterest(SourceState& source, uint64_t segNum, bool isFirstRequest);
+
+  void
+  afterDataReceived(size_t index, const Interest& interest, const Data& data,
+                    const weak_ptr<MultiSourceSegmentFetcher>& weakSelf);
+
+  void
+  afterValidationSuccess(size_t index, const Data& data, optional<time::nanoseconds> rtt,
+                         const weak_ptr<MultiSourceSegmentFetcher>& weakSelf);
+
+  void
+  afterNack(size_t index, const Interest& interest, const lp::Nack& nack,
+            const weak_ptr<MultiSourceSegmentFetcher>& weakSelf);
+
+  void
+  afterTimeout(size_t index, const Interest& interest,
+               const weak_ptr<MultiSourceSegmentFetcher>& weakSelf);
+
+  /**
+   * @brief Handles a timeout or a congestion Nack of an Interest to @p source.
+   */
+  void
+  afterLoss(SourceState& source, const Interest& interest);
+
+  void
+  congestionEvent(SourceState& source);
+
+  void
+  failSource(SourceState& source, const std::string& reason);
+
+  /**
+   * @brief Returns the segment to the pool of segments to assign, unless it has been received.
+   */
+  void
+  requeueSegment(uint64_t segNum);
+
+  void
+  deliverInOrderSegments();
+
+  void
+  signalError(uint32_t code, const std::string& msg);
+
+public:
+  /**
+   * @brief Emitted upon successful retrieval of the complete object (all segments).
+   */
+  Signal<MultiSourceSegmentFetcher, ConstBufferPtr> onComplete;
+
+  /**
+   * @brief Emitted when the retrieval could not be completed due to an error.
+   *
+   * Handlers are provided with an error code and a string error message.
+   */
+  Signal<MultiSourceSegmentFetcher, uint32_t, std::string> onError;
+
+  /**
+   * @brief Emitted whenever a received data segment has been successfully validated.
+   */
+  Signal<MultiSourceSegmentFetcher, Data> afterSegmentValidated;
+
+  /**
+   * @brief Emitted when a source is no longer used, with its index and the reason.
+   */
+  Signal<MultiSourceSegmentFetcher, size_t, std::string> afterSourceFailed;
+
+private:
+  class InFlightSegment
+  {
+  public:
+    time::steady_clock::TimePoint sendTime;
+    bool isFirstRequest; ///< no other Interest has been sent for the segment (Karn's algorithm)
+    ScopedPendingInterestHandle hdl;
+    scheduler::ScopedEventId timeoutEvent;
+  };
+
+  class SourceState : noncopyable
+  {
+  public:
+    SourceState(size_t index, const Source& source, const Options& options);
+
+    bool
+    isUsable() const
+    {
+      return !isFailed && !versionedName.empty();
+    }
+
+    size_t
+    getWindow() const
+    {
+      return std::max<size_t>(1, static_cast<size_t>(congestionControl->getCwnd()));
+    }
+
+    /**
+     * @brief Returns the smoothed RTT, or the RTO if there are no samples yet.
+     */
+    time::nanoseconds
+    getRtt() const;
+
+    /**
+     * @brief Returns the estimated rate in segments per second.
+     */
+    double
+    getRate() const;
+
+  public:
+    const size_t index;
+    const Source source;
+    Name versionedName; ///< set once the version has been discovered
+    bool isFailed = false;
+    RttEstimator rttEstimator;
+    unique_ptr<CongestionControl> congestionControl;
+    std::map<uint64_t, InFlightSegment> inFlight;
+    time::steady_clock::TimePoint lastDecrease;
+    int nConsecutiveFailures = 0;
+    uint64_t nReceived = 0;
+  };
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  shared_ptr<MultiSourceSegmentFetcher> m_this;
+
+  Options m_options;
+  Face& m_face;
+  Scheduler m_scheduler;
+  security::v2::Validator& m_validator;
+  std::vector<unique_ptr<SourceState>> m_sources;
+
+  size_t m_discoverySource = 0;
+  bool m_isDiscoveryRetx = false;
+  time::steady_clock::TimePoint m_discoverySendTime;
+  ScopedPendingInterestHandle m_discoveryHdl;
+  scheduler::ScopedEventId m_discoveryTimeout;
+
+  time::steady_clock::TimePoint m_timeLastSegmentReceived;
+  uint64_t m_nSegments = 0; ///< number of segments, or 0 if unknown
+  uint64_t m_nextSegmentNum = 0; ///< next segment that has never been requested
+  std::set<uint64_t> m_unassigned; ///< segments to request again, lowest first
+  uint64_t m_nextSegmentInOrder = 0;
+
+  ndn::detail::SegmentBitmap m_receivedSegments;
+  std::map<uint64_t, Block> m_segmentBuffer; ///< validated segments awaiting in-order delivery
+  shared_ptr<Buffer> m_contentBuffer;
+  std::vector<size_t> m_segmentEnds; ///< end offset of each segment in m_contentBuffer
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_MULTI_SOURCE_SEGMENT_FETCHER_HPP
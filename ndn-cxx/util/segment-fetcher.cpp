@@ -23,9 +23,10 @@
 
 #include "ndn-cxx/util/segment-fetcher.hpp"
 #include "ndn-cxx/name-component.hpp"
-#include "ndn-cxx/encoding/buffer-stream.hpp"
 #include "ndn-cxx/lp/nack.hpp"
 #include "ndn-cxx/lp/nack-header.hpp"
+#include "ndn-cxx/security/validation-pipeline.hpp"
+#include "ndn-cxx/util/impl/segment-file-writer.hpp"
 
 #include <boost/asio/io_service.hpp>
 #include <boost/lexical_cast.hpp>
@@ -38,7 +39,13 @@
 namespace ndn {
 namespace util {
 
-constexpr double SegmentFetcher::MIN_SSTHRESH;
+/// segment number of a sent Interest, which is 0 for the Interest that discovers the version
+static uint64_t
+getSegmentNumber(const Interest& interest)
+{
+  const auto& lastComponent = interest.getName().get(-1);
+  return lastComponent.isSegment() ? lastComponent.toSegment() : 0;
+}
 
 void
 SegmentFetcher::Options::validate()
@@ -58,6 +65,23 @@ SegmentFetcher::Options::validate()
   if (mdCoef < 0.0 || mdCoef > 1.0) {
     NDN_THROW(std::invalid_argument("mdCoef must be in range [0, 1]"));
   }
+
+  if (inOrder && !outputFile.empty()) {
+    NDN_THROW(std::invalid_argument("'in order' mode and 'file' mode are mutually exclusive"));
+  }
+
+  if (endSegment <= startSegment) {
+    NDN_THROW(std::invalid_argument("endSegment must be greater than startSegment"));
+  }
+
+  if (checkpoint) {
+    if (!inOrder && outputFile.empty()) {
+      NDN_THROW(std::invalid_argument("Resuming from a checkpoint requires 'in order' or 'file' mode"));
+    }
+    if (checkpoint->versionedName.empty()) {
+      NDN_THROW(std::invalid_argument("Checkpoint has no versioned name"));
+    }
+  }
 }
 
 SegmentFetcher::SegmentFetcher(Face& face,
@@ -69,12 +93,61 @@ SegmentFetcher::SegmentFetcher(Face& face,
   , m_validator(validator)
   , m_rttEstimator(make_shared<RttEstimator::Options>(options.rttOptions))
   , m_timeLastSegmentReceived(time::steady_clock::now())
-  , m_cwnd(options.initCwnd)
-  , m_ssthresh(options.initSsthresh)
+  , m_nextSegmentNum(options.startSegment)
+  , m_endSegment(options.endSegment)
+  , m_nextSegmentInOrder(options.startSegment)
+  , m_segmentBuffer(options.flowControlWindow)
+  , m_pendingSegments(options.flowControlWindow)
 {
   m_options.validate();
+
+  if (m_options.congestionControl) {
+    m_congestionControl = m_options.congestionControl();
+    BOOST_ASSERT(m_congestionControl != nullptr);
+  }
+  else {
+    AimdCongestionControl::Options aimdOptions;
+    aimdOptions.initCwnd = m_options.initCwnd;
+    aimdOptions.initSsthresh = m_options.initSsthresh;
+    aimdOptions.aiStep = m_options.aiStep;
+    aimdOptions.mdCoef = m_options.mdCoef;
+    aimdOptions.resetCwndToInit = m_options.resetCwndToInit;
+    m_congestionControl = make_unique<AimdCongestionControl>(aimdOptions);
+  }
+  m_cwnd = m_congestionControl->getCwnd();
+  m_ssthresh = m_congestionControl->getSsthresh();
+
+  if (m_options.trace != nullptr) {
+    m_options.trace->reset();
+    m_options.trace->record(FetchTrace::EventType::CWND, 0, m_cwnd, m_ssthresh);
+  }
+
+  if (!m_options.outputFile.empty()) {
+    m_fileWriter = make_unique<detail::SegmentFileWriter>(m_options.outputFile, m_options.useMmap,
+                                                          m_options.fsyncInterval,
+                                                          !m_options.checkpoint);
+  }
+  else if (!m_options.inOrder) {
+    m_contentBuffer = make_shared<Buffer>();
+  }
+
+  if (m_options.nValidationThreads > 0) {
+    security::v2::ValidationPipeline::Options pipelineOptions;
+    pipelineOptions.nThreads = m_options.nValidationThreads;
+    m_validationPipeline = make_unique<security::v2::ValidationPipeline>(m_face.getIoService(),
+                                                                         m_validator, pipelineOptions);
+  }
+
+  // segments before the range are never requested
+  m_receivedSegments.skipTo(m_options.startSegment);
+
+  if (m_options.checkpoint) {
+    resumeFromCheckpoint(*m_options.checkpoint);
+  }
 }
 
+SegmentFetcher::~SegmentFetcher() = default;
+
 shared_ptr<SegmentFetcher>
 SegmentFetcher::start(Face& face,
                       const Interest& baseInterest,
@@ -83,7 +156,19 @@ SegmentFetcher::start(Face& face,
 {
   shared_ptr<SegmentFetcher> fetcher(new SegmentFetcher(face, validator, options));
   fetcher->m_this = fetcher;
-  fetcher->fetchFirstSegment(baseInterest, false);
+
+  if (fetcher->m_versionedDataName.empty()) {
+    fetcher->fetchFirstSegment(baseInterest, false);
+  }
+  else {
+    // the version is known from the checkpoint; deferred so that signals can be connected first
+    weak_ptr<SegmentFetcher> weakSelf = fetcher;
+    face.getIoService().post([weakSelf, baseInterest] {
+      if (!shouldStop(weakSelf)) {
+        weakSelf.lock()->fetchSegmentsInWindow(baseInterest);
+      }
+    });
+  }
   return fetcher;
 }
 
@@ -95,9 +180,77 @@ SegmentFetcher::stop()
   }
 
   m_pendingSegments.clear(); // cancels pending Interests and timeout events
+  if (m_options.trace != nullptr) {
+    m_options.trace->finish();
+  }
   m_face.getIoService().post([self = std::move(m_this)] {});
 }
 
+FetchCheckpoint
+SegmentFetcher::getCheckpoint() const
+{
+  FetchCheckpoint checkpoint;
+  checkpoint.versionedName = m_versionedDataName;
+  checkpoint.nSegments = static_cast<uint64_t>(m_nSegments);
+
+  // segments still held in memory would be lost if the transfer were interrupted
+  uint64_t end = m_endSegment;
+  std::vector<uint64_t> buffered;
+  if (m_fileWriter != nullptr) {
+    checkpoint.segmentSize = m_fileWriter->getSegmentSize();
+    checkpoint.lastSegmentSize = m_fileWriter->getLastSegmentSize();
+    buffered = m_fileWriter->getBufferedSegments();
+  }
+  else {
+    end = std::min(end, m_nextSegmentInOrder);
+  }
+
+  auto nextBuffered = buffered.begin();
+  for (const auto& range : m_receivedSegments.getRanges()) {
+    uint64_t first = std::max(range.first, m_options.startSegment);
+    uint64_t last = std::min(range.second, end);
+    for (; nextBuffered != buffered.end() && *nextBuffered < last; ++nextBuffered) {
+      if (*nextBuffered >= first) {
+        if (*nextBuffered > first) {
+          checkpoint.receivedRanges.emplace_back(first, *nextBuffered);
+        }
+        first = *nextBuffered + 1;
+      }
+    }
+    if (first < last) {
+      checkpoint.receivedRanges.emplace_back(first, last);
+    }
+  }
+  return checkpoint;
+}
+
+void
+SegmentFetcher::resumeFromCheckpoint(const FetchCheckpoint& checkpoint)
+{
+  m_versionedDataName = checkpoint.versionedName;
+  if (checkpoint.nSegments > 0) {
+    m_nSegments = static_cast<int64_t>(checkpoint.nSegments);
+    m_endSegment = std::min(m_options.endSegment, checkpoint.nSegments);
+  }
+
+  for (const auto& range : checkpoint.receivedRanges) {
+    m_nReceived += static_cast<int64_t>(m_receivedSegments.insertRange(
+                     std::max(range.first, m_options.startSegment), std::min(range.second, m_endSegment)));
+  }
+  m_nReceivedAtLastCheckpoint = m_nReceived;
+
+  if (m_fileWriter == nullptr) {
+    deliverInOrderSegments(); // skips the segments received before
+  }
+  else if (!checkpoint.receivedRanges.empty()) {
+    uint64_t highSegNum = checkpoint.receivedRanges.back().second - 1;
+    bool isLast = checkpoint.nSegments > 0 && highSegNum + 1 == checkpoint.nSegments;
+    m_fileWriter->resume(checkpoint.segmentSize, highSegNum,
+                         isLast ? checkpoint.lastSegmentSize : checkpoint.segmentSize);
+    m_fileWriter->setNSegments(checkpoint.nSegments);
+  }
+}
+
 bool
 SegmentFetcher::shouldStop(const weak_ptr<SegmentFetcher>& weakSelf)
 {
@@ -140,17 +293,18 @@ SegmentFetcher::fetchSegmentsInWindow(const Interest& origInterest)
 
   while (availableWindowSize > 0) {
     if (!m_retxQueue.empty()) {
-      auto pendingSegmentIt = m_pendingSegments.find(m_retxQueue.front());
+      uint64_t segNum = m_retxQueue.front();
       m_retxQueue.pop();
-      if (pendingSegmentIt == m_pendingSegments.end()) {
+      PendingSegment* pendingSegment = m_pendingSegments.find(segNum);
+      if (pendingSegment == nullptr) {
         // Skip re-requesting this segment, since it was received after RTO timeout
         continue;
       }
-      BOOST_ASSERT(pendingSegmentIt->second.state == SegmentState::InRetxQueue);
-      segmentsToRequest.emplace_back(pendingSegmentIt->first, true);
+      BOOST_ASSERT(pendingSegment->state == SegmentState::InRetxQueue);
+      segmentsToRequest.emplace_back(segNum, true);
     }
-    else if (m_nSegments == 0 || m_nextSegmentNum < static_cast<uint64_t>(m_nSegments)) {
-      if (m_segmentBuffer.count(m_nextSegmentNum) > 0) {
+    else if (m_nextSegmentNum < m_endSegment) {
+      if (m_receivedSegments.contains(m_nextSegmentNum)) {
         // Don't request a segment a second time if received in response to first "discovery" Interest
         m_nextSegmentNum++;
         continue;
@@ -163,15 +317,56 @@ SegmentFetcher::fetchSegmentsInWindow(const Interest& origInterest)
     availableWindowSize--;
   }
 
+  if (segmentsToRequest.empty()) {
+    return;
+  }
+
+  std::vector<Interest> interests;
+  interests.reserve(segmentsToRequest.size());
   for (const auto& segment : segmentsToRequest) {
+    interests.push_back(makeSegmentInterest(origInterest, segment.first));
+  }
+
+  // the whole window is handed to the Face at once, to be sent with a single transport write
+  weak_ptr<SegmentFetcher> weakSelf = m_this;
+  auto pendingInterests = m_face.expressInterests(interests,
+    [this, weakSelf] (const Interest& interest, const Data& data) {
+      afterSegmentReceivedCb(interest, data, weakSelf);
+    },
+    [this, weakSelf] (const Interest& interest, const lp::Nack& nack) {
+      afterNackReceivedCb(interest, nack, weakSelf);
+    },
+    nullptr);
+
+  for (size_t i = 0; i < segmentsToRequest.size(); ++i) {
+    afterInterestSent(segmentsToRequest[i].first, interests[i], segmentsToRequest[i].second,
+                      pendingInterests[i]);
+  }
+}
+
+Interest
+SegmentFetcher::makeSegmentInterest(const Interest& origInterest, uint64_t segNum)
+{
+  if (origInterest.hasApplicationParameters()) {
     Interest interest(origInterest); // to preserve Interest elements
-    interest.setName(Name(m_versionedDataName).appendSegment(segment.first));
+    interest.setName(Name(m_versionedDataName).appendSegment(segNum));
     interest.setCanBePrefix(false);
     interest.setMustBeFresh(false);
     interest.setInterestLifetime(m_options.interestLifetime);
     interest.refreshNonce();
-    sendInterest(segment.first, interest, segment.second);
+    return interest;
   }
+
+  if (!m_segmentInterestTemplate) {
+    Interest prototype(origInterest); // to preserve Interest elements
+    prototype.setName(m_versionedDataName);
+    prototype.setCanBePrefix(false);
+    prototype.setMustBeFresh(false);
+    prototype.setInterestLifetime(m_options.interestLifetime);
+    m_segmentInterestTemplate.emplace(prototype);
+  }
+
+  return m_segmentInterestTemplate->makeSegmentInterest(segNum);
 }
 
 void
@@ -179,7 +374,6 @@ SegmentFetcher::sendInterest(uint64_t segNum, const Interest& interest, bool isR
 {
   weak_ptr<SegmentFetcher> weakSelf = m_this;
 
-  ++m_nSegmentsInFlight;
   auto pendingInterest = m_face.expressInterest(interest,
     [this, weakSelf] (const Interest& interest, const Data& data) {
       afterSegmentReceivedCb(interest, data, weakSelf);
@@ -189,7 +383,22 @@ SegmentFetcher::sendInterest(uint64_t segNum, const Interest& interest, bool isR
     },
     nullptr);
 
+  afterInterestSent(segNum, interest, isRetransmission, pendingInterest);
+}
+
+void
+SegmentFetcher::afterInterestSent(uint64_t segNum, const Interest& interest, bool isRetransmission,
+                                  const PendingInterestHandle& pendingInterest)
+{
+  weak_ptr<SegmentFetcher> weakSelf = m_this;
+
+  ++m_nSegmentsInFlight;
   auto timeout = m_options.useConstantInterestTimeout ? m_options.maxTimeout : getEstimatedRto();
+  if (m_options.trace != nullptr) {
+    m_options.trace->record(isRetransmission ? FetchTrace::EventType::RETRANSMIT :
+                                               FetchTrace::EventType::SEND,
+                            segNum, static_cast<double>(timeout.count()));
+  }
   auto timeoutEvent = m_scheduler.schedule(timeout, [this, interest, weakSelf] {
     afterTimeoutCb(interest, weakSelf);
   });
@@ -201,8 +410,7 @@ SegmentFetcher::sendInterest(uint64_t segNum, const Interest& interest, bool isR
 
   PendingSegment pendingSegment{SegmentState::FirstInterest, time::steady_clock::now(),
                                 pendingInterest, timeoutEvent};
-  bool isNew = m_pendingSegments.emplace(segNum, std::move(pendingSegment)).second;
-  BOOST_VERIFY(isNew);
+  m_pendingSegments.emplace(segNum, std::move(pendingSegment));
   m_highInterest = segNum;
 }
 
@@ -222,33 +430,55 @@ SegmentFetcher::afterSegmentReceivedCb(const Interest& origInterest, const Data&
   }
 
   uint64_t currentSegment = currentSegmentComponent.toSegment();
+  if (m_options.trace != nullptr) {
+    m_options.trace->record(FetchTrace::EventType::RECEIVE, currentSegment,
+                            static_cast<double>(data.getContent().value_size()));
+    if (data.getCongestionMark() > 0) {
+      m_options.trace->record(FetchTrace::EventType::CONGESTION_MARK, currentSegment);
+    }
+  }
 
   // The first received Interest could have any segment ID
-  std::map<uint64_t, PendingSegment>::iterator pendingSegmentIt;
-  if (m_receivedSegments.size() > 0) {
-    pendingSegmentIt = m_pendingSegments.find(currentSegment);
-  }
-  else {
-    pendingSegmentIt = m_pendingSegments.begin();
+  uint64_t pendingSegmentNum = currentSegment;
+  if (m_versionedDataName.empty() && !m_pendingSegments.empty()) {
+    pendingSegmentNum = m_pendingSegments.front();
   }
 
-  if (pendingSegmentIt == m_pendingSegments.end()) {
+  PendingSegment* pendingSegment = m_pendingSegments.find(pendingSegmentNum);
+  if (pendingSegment == nullptr) {
     return;
   }
 
-  pendingSegmentIt->second.timeoutEvent.cancel();
+  pendingSegment->timeoutEvent.cancel();
 
   afterSegmentReceived(data);
 
+  if (m_validationPipeline != nullptr) {
+    // the window advances on arrival, so that it is not limited by verification throughput
+    auto now = time::steady_clock::now();
+    auto rtt = completePendingSegment(pendingSegmentNum, now);
+    updateWindow(data, currentSegment, rtt, now);
+
+    m_validationPipeline->validate(data,
+                                   bind(&SegmentFetcher::afterValidationSuccess, this, _1, origInterest,
+                                        pendingSegmentNum, weakSelf),
+                                   bind(&SegmentFetcher::afterValidationFailure, this, _1, _2, weakSelf));
+    // the versioned name is only known after the first segment has been validated
+    if (!shouldStop(weakSelf) && !m_versionedDataName.empty()) {
+      fetchSegmentsInWindow(origInterest);
+    }
+    return;
+  }
+
   m_validator.validate(data,
                        bind(&SegmentFetcher::afterValidationSuccess, this, _1, origInterest,
-                            pendingSegmentIt, weakSelf),
+                            pendingSegmentNum, weakSelf),
                        bind(&SegmentFetcher::afterValidationFailure, this, _1, _2, weakSelf));
 }
 
 void
 SegmentFetcher::afterValidationSuccess(const Data& data, const Interest& origInterest,
-                                       std::map<uint64_t, PendingSegment>::iterator pendingSegmentIt,
+                                       uint64_t pendingSegmentNum,
                                        const weak_ptr<SegmentFetcher>& weakSelf)
 {
   if (shouldStop(weakSelf))
@@ -258,29 +488,17 @@ SegmentFetcher::afterValidationSuccess(const Data& data, const Interest& origInt
   // transfer will not fail to terminate if we only received invalid Data packets.
   m_timeLastSegmentReceived = time::steady_clock::now();
 
-  m_nReceived++;
-
   // It was verified in afterSegmentReceivedCb that the last Data name component is a segment number
   uint64_t currentSegment = data.getName().get(-1).toSegment();
-  m_receivedSegments.insert(currentSegment);
 
-  // Add measurement to RTO estimator (if not retransmission)
-  if (pendingSegmentIt->second.state == SegmentState::FirstInterest) {
-    BOOST_ASSERT(m_nSegmentsInFlight >= 0);
-    m_rttEstimator.addMeasurement(m_timeLastSegmentReceived - pendingSegmentIt->second.sendTime,
-                                  static_cast<size_t>(m_nSegmentsInFlight) + 1);
+  // with a validation pipeline, the segment was accounted for when it arrived
+  optional<time::nanoseconds> rtt;
+  if (m_validationPipeline == nullptr) {
+    rtt = completePendingSegment(pendingSegmentNum, m_timeLastSegmentReceived);
   }
 
-  // Remove from pending segments map
-  m_pendingSegments.erase(pendingSegmentIt);
-
-  // Copy data in segment to temporary buffer
-  auto receivedSegmentIt = m_segmentBuffer.emplace(std::piecewise_construct,
-                                                   std::forward_as_tuple(currentSegment),
-                                                   std::forward_as_tuple(data.getContent().value_size()));
-  std::copy(data.getContent().value_begin(), data.getContent().value_end(),
-            receivedSegmentIt.first->second.begin());
-  m_nBytesReceived += data.getContent().value_size();
+  const Block& content = data.getContent();
+  m_maxSegmentSize = std::max(m_maxSegmentSize, content.value_size());
   afterSegmentValidated(data);
 
   if (data.getFinalBlock()) {
@@ -291,39 +509,100 @@ SegmentFetcher::afterValidationSuccess(const Data& data, const Interest& origInt
 
     if (data.getFinalBlock()->toSegment() + 1 != static_cast<uint64_t>(m_nSegments)) {
       m_nSegments = data.getFinalBlock()->toSegment() + 1;
+      m_endSegment = std::min(m_options.endSegment, static_cast<uint64_t>(m_nSegments));
       cancelExcessInFlightSegments();
+
+      if (m_contentBuffer != nullptr && m_endSegment > m_options.startSegment) {
+        // all segments except the last one are expected to be as large as the largest seen so far
+        auto nSegmentsInRange = static_cast<size_t>(std::min(m_endSegment - m_options.startSegment,
+                                                             ndn::detail::MAX_RESERVED_SEGMENTS));
+        m_contentBuffer->reserve(nSegmentsInRange * m_maxSegmentSize);
+        m_segmentEnds.reserve(nSegmentsInRange);
+      }
     }
   }
 
-  if (m_options.inOrder && m_nextSegmentInOrder == currentSegment) {
-    do {
-      onInOrderData(std::make_shared<const Buffer>(m_segmentBuffer[m_nextSegmentInOrder]));
-      m_segmentBuffer.erase(m_nextSegmentInOrder++);
-    } while (m_segmentBuffer.count(m_nextSegmentInOrder) > 0);
+  // segments before the range are already in m_receivedSegments
+  bool isNewSegment = currentSegment < m_endSegment && m_receivedSegments.insert(currentSegment);
+  if (isNewSegment) {
+    m_nReceived++;
   }
 
-  if (m_receivedSegments.size() == 1) {
-    m_versionedDataName = data.getName().getPrefix(-1);
-    if (currentSegment == 0) {
-      // We received the first segment in response, so we can increment the next segment number
-      m_nextSegmentNum++;
+  // Keep the Content element, which shares the buffer of the received Data
+  if (m_fileWriter == nullptr && isNewSegment) {
+    m_segmentBuffer.emplace(currentSegment, content);
+  }
+  m_nBytesReceived += content.value_size();
+  if (m_options.trace != nullptr && isNewSegment) {
+    m_options.trace->record(FetchTrace::EventType::VALIDATE, currentSegment,
+                            static_cast<double>(content.value_size()));
+  }
+
+  if (m_fileWriter != nullptr) {
+    if (isNewSegment && !writeSegmentToFile(currentSegment, content)) {
+      return;
     }
   }
+  else if (m_nextSegmentInOrder == currentSegment) {
+    deliverInOrderSegments();
+  }
 
-  if (m_highData < currentSegment) {
-    m_highData = currentSegment;
+  if (m_versionedDataName.empty()) {
+    m_versionedDataName = data.getName().getPrefix(-1);
   }
 
-  if (data.getCongestionMark() > 0 && !m_options.ignoreCongMarks) {
-    windowDecrease();
+  if (isNewSegment && m_options.checkpointInterval > 0 &&
+      m_nReceived - m_nReceivedAtLastCheckpoint >= static_cast<int64_t>(m_options.checkpointInterval)) {
+    m_nReceivedAtLastCheckpoint = m_nReceived;
+    onProgress(getCheckpoint());
+    if (shouldStop(weakSelf)) {
+      return;
+    }
   }
-  else {
-    windowIncrease();
+
+  if (m_validationPipeline == nullptr) {
+    updateWindow(data, currentSegment, rtt, m_timeLastSegmentReceived);
   }
 
   fetchSegmentsInWindow(origInterest);
 }
 
+optional<time::nanoseconds>
+SegmentFetcher::completePendingSegment(uint64_t pendingSegmentNum, time::steady_clock::TimePoint now)
+{
+  // The pending segment may have been canceled during validation
+  optional<time::nanoseconds> rtt;
+  PendingSegment* pendingSegment = m_pendingSegments.find(pendingSegmentNum);
+  if (pendingSegment != nullptr) {
+    // Add measurement to RTO estimator (if not retransmission)
+    if (pendingSegment->state == SegmentState::FirstInterest) {
+      BOOST_ASSERT(m_nSegmentsInFlight >= 0);
+      rtt = now - pendingSegment->sendTime;
+      m_rttEstimator.addMeasurement(*rtt, static_cast<size_t>(m_nSegmentsInFlight) + 1);
+      if (m_options.trace != nullptr) {
+        m_options.trace->recordRtt(pendingSegmentNum, *rtt, m_rttEstimator.getEstimatedRto());
+      }
+    }
+    m_pendingSegments.erase(pendingSegmentNum);
+  }
+  return rtt;
+}
+
+void
+SegmentFetcher::updateWindow(const Data& data, uint64_t segNum, optional<time::nanoseconds> rtt,
+                             time::steady_clock::TimePoint now)
+{
+  if (m_highData < segNum) {
+    m_highData = segNum;
+  }
+
+  bool isCongestionMarked = data.getCongestionMark() > 0 && !m_options.ignoreCongMarks;
+  if (isCongestionMarked) {
+    windowDecrease();
+  }
+  windowIncrease(rtt, isCongestionMarked, now);
+}
+
 void
 SegmentFetcher::afterValidationFailure(const Data& data,
                                        const security::v2::ValidationError& error,
@@ -332,6 +611,9 @@ SegmentFetcher::afterValidationFailure(const Data& data,
   if (shouldStop(weakSelf))
     return;
 
+  if (m_options.trace != nullptr) {
+    m_options.trace->record(FetchTrace::EventType::VALIDATION_FAILURE, data.getName()[-1].toSegment());
+  }
   signalError(SEGMENT_VALIDATION_FAIL, "Segment validation failed: " + boost::lexical_cast<std::string>(error));
 }
 
@@ -343,6 +625,9 @@ SegmentFetcher::afterNackReceivedCb(const Interest& origInterest, const lp::Nack
     return;
 
   afterSegmentNacked();
+  if (m_options.trace != nullptr) {
+    m_options.trace->record(FetchTrace::EventType::NACK, getSegmentNumber(origInterest));
+  }
 
   BOOST_ASSERT(m_nSegmentsInFlight > 0);
   m_nSegmentsInFlight--;
@@ -366,6 +651,9 @@ SegmentFetcher::afterTimeoutCb(const Interest& origInterest,
     return;
 
   afterSegmentTimedOut();
+  if (m_options.trace != nullptr) {
+    m_options.trace->record(FetchTrace::EventType::TIMEOUT, getSegmentNumber(origInterest));
+  }
 
   BOOST_ASSERT(m_nSegmentsInFlight > 0);
   m_nSegmentsInFlight--;
@@ -381,68 +669,132 @@ SegmentFetcher::afterNackOrTimeout(const Interest& origInterest)
   }
 
   name::Component lastNameComponent = origInterest.getName().get(-1);
-  std::map<uint64_t, PendingSegment>::iterator pendingSegmentIt;
-  BOOST_ASSERT(m_pendingSegments.size() > 0);
-  if (lastNameComponent.isSegment()) {
-    BOOST_ASSERT(m_pendingSegments.count(lastNameComponent.toSegment()) > 0);
-    pendingSegmentIt = m_pendingSegments.find(lastNameComponent.toSegment());
-  }
-  else { // First Interest
-    BOOST_ASSERT(m_pendingSegments.size() > 0);
-    pendingSegmentIt = m_pendingSegments.begin();
-  }
+  BOOST_ASSERT(!m_pendingSegments.empty());
+  uint64_t pendingSegmentNum = lastNameComponent.isSegment() ?
+                               lastNameComponent.toSegment() :
+                               m_pendingSegments.front(); // First Interest
+  PendingSegment* pendingSegment = m_pendingSegments.find(pendingSegmentNum);
+  BOOST_ASSERT(pendingSegment != nullptr);
 
   // Cancel timeout event and set status to InRetxQueue
-  pendingSegmentIt->second.timeoutEvent.cancel();
-  pendingSegmentIt->second.state = SegmentState::InRetxQueue;
+  pendingSegment->timeoutEvent.cancel();
+  pendingSegment->state = SegmentState::InRetxQueue;
 
   m_rttEstimator.backoffRto();
 
-  if (m_receivedSegments.size() == 0) {
+  if (m_versionedDataName.empty()) {
     // Resend first Interest (until maximum receive timeout exceeded)
     fetchFirstSegment(origInterest, true);
   }
   else {
     windowDecrease();
-    m_retxQueue.push(pendingSegmentIt->first);
+    m_retxQueue.push(pendingSegmentNum);
     fetchSegmentsInWindow(origInterest);
   }
 }
 
+void
+SegmentFetcher::deliverInOrderSegments()
+{
+  while (m_nextSegmentInOrder < m_endSegment) {
+    const Block* segment = m_segmentBuffer.find(m_nextSegmentInOrder);
+    if (segment == nullptr) {
+      if (!m_receivedSegments.contains(m_nextSegmentInOrder)) {
+        break;
+      }
+      // handed to the application before the transfer was resumed
+      ++m_nextSegmentInOrder;
+      continue;
+    }
+
+    const Block& content = *segment;
+    if (m_options.inOrder) {
+      onInOrderContent(content);
+      if (!onInOrderData.isEmpty()) {
+        onInOrderData(make_shared<const Buffer>(content.value_begin(), content.value_end()));
+      }
+    }
+    else {
+      m_contentBuffer->insert(m_contentBuffer->end(), content.value_begin(), content.value_end());
+      m_segmentEnds.push_back(m_contentBuffer->size());
+    }
+    m_segmentBuffer.erase(m_nextSegmentInOrder);
+    ++m_nextSegmentInOrder;
+  }
+}
+
+bool
+SegmentFetcher::writeSegmentToFile(uint64_t segNum, const Block& content)
+{
+  try {
+    m_fileWriter->setNSegments(static_cast<uint64_t>(m_nSegments));
+    m_fileWriter->write(segNum, content);
+  }
+  catch (const std::exception& e) {
+    signalError(FILE_ERROR, "Cannot write to output file: "s + e.what());
+    return false;
+  }
+
+  uint64_t nBytesWritten = m_fileWriter->getNBytesWritten();
+  if (nBytesWritten > m_nBytesAtLastProgress &&
+      nBytesWritten - m_nBytesAtLastProgress >= m_options.progressInterval) {
+    m_nBytesAtLastProgress = nBytesWritten;
+    onFileProgress(nBytesWritten);
+  }
+  return true;
+}
+
 void
 SegmentFetcher::finalizeFetch()
 {
+  // We may have received more segments than exist in the object.
+  BOOST_ASSERT(m_receivedSegments.size() >= m_endSegment);
+
+  if (m_fileWriter != nullptr) {
+    uint64_t size = 0;
+    try {
+      m_fileWriter->setNSegments(static_cast<uint64_t>(m_nSegments));
+      size = m_fileWriter->finish(m_options.fsyncOnComplete);
+    }
+    catch (const std::exception& e) {
+      return signalError(FILE_ERROR, "Cannot complete output file: "s + e.what());
+    }
+    onFileComplete(size);
+    return stop();
+  }
+
+  BOOST_ASSERT(m_nextSegmentInOrder >= m_endSegment);
   if (m_options.inOrder) {
     onInOrderComplete();
   }
   else {
-    // Combine segments into final buffer
-    OBufferStream buf;
-    // We may have received more segments than exist in the object.
-    BOOST_ASSERT(m_receivedSegments.size() >= static_cast<uint64_t>(m_nSegments));
-
-    for (int64_t i = 0; i < m_nSegments; i++) {
-      buf.write(m_segmentBuffer[i].get<const char>(), m_segmentBuffer[i].size());
-    }
-    onComplete(buf.buf());
+    size_t nSegmentsInRange = m_endSegment > m_options.startSegment ?
+                              static_cast<size_t>(m_endSegment - m_options.startSegment) : 0;
+    BOOST_ASSERT(m_segmentEnds.size() >= nSegmentsInRange);
+    m_contentBuffer->resize(nSegmentsInRange > 0 ? m_segmentEnds[nSegmentsInRange - 1] : 0);
+    onComplete(m_contentBuffer);
   }
   stop();
 }
 
 void
-SegmentFetcher::windowIncrease()
+SegmentFetcher::windowIncrease(optional<time::nanoseconds> rtt, bool isCongestionMarked,
+                               time::steady_clock::TimePoint now)
 {
   if (m_options.useConstantCwnd) {
-    BOOST_ASSERT(m_cwnd == m_options.initCwnd);
+    BOOST_ASSERT(m_cwnd == m_congestionControl->getCwnd());
     return;
   }
 
-  if (m_cwnd < m_ssthresh) {
-    m_cwnd += m_options.aiStep; // additive increase
-  }
-  else {
-    m_cwnd += m_options.aiStep / std::floor(m_cwnd); // congestion avoidance
+  CongestionControl::AckSample sample;
+  sample.now = now;
+  sample.rtt = rtt;
+  if (m_rttEstimator.hasSamples()) {
+    sample.smoothedRtt = m_rttEstimator.getSmoothedRtt();
   }
+  sample.isCongestionMarked = isCongestionMarked;
+  m_congestionControl->afterAck(sample);
+  updateCwnd();
 }
 
 void
@@ -452,14 +804,25 @@ SegmentFetcher::windowDecrease()
     m_recPoint = m_highInterest;
 
     if (m_options.useConstantCwnd) {
-      BOOST_ASSERT(m_cwnd == m_options.initCwnd);
+      BOOST_ASSERT(m_cwnd == m_congestionControl->getCwnd());
       return;
     }
 
-    // Refer to RFC 5681, Section 3.1 for the rationale behind the code below
-    m_ssthresh = std::max(MIN_SSTHRESH, m_cwnd * m_options.mdCoef); // multiplicative decrease
-    m_cwnd = m_options.resetCwndToInit ? m_options.initCwnd : m_ssthresh;
+    m_congestionControl->afterCongestionEvent(time::steady_clock::now());
+    updateCwnd();
+  }
+}
+
+void
+SegmentFetcher::updateCwnd()
+{
+  double cwnd = m_congestionControl->getCwnd();
+  double ssthresh = m_congestionControl->getSsthresh();
+  if (m_options.trace != nullptr && (cwnd != m_cwnd || ssthresh != m_ssthresh)) {
+    m_options.trace->record(FetchTrace::EventType::CWND, m_highData, cwnd, ssthresh);
   }
+  m_cwnd = cwnd;
+  m_ssthresh = ssthresh;
 }
 
 void
@@ -474,27 +837,21 @@ SegmentFetcher::updateRetransmittedSegment(uint64_t segmentNum,
                                            const PendingInterestHandle& pendingInterest,
                                            scheduler::EventId timeoutEvent)
 {
-  auto pendingSegmentIt = m_pendingSegments.find(segmentNum);
-  BOOST_ASSERT(pendingSegmentIt != m_pendingSegments.end());
-  BOOST_ASSERT(pendingSegmentIt->second.state == SegmentState::InRetxQueue);
-  pendingSegmentIt->second.state = SegmentState::Retransmitted;
-  pendingSegmentIt->second.hdl = pendingInterest; // cancels previous pending Interest via scoped handle
-  pendingSegmentIt->second.timeoutEvent = timeoutEvent;
+  PendingSegment* pendingSegment = m_pendingSegments.find(segmentNum);
+  BOOST_ASSERT(pendingSegment != nullptr);
+  BOOST_ASSERT(pendingSegment->state == SegmentState::InRetxQueue);
+  pendingSegment->state = SegmentState::Retransmitted;
+  pendingSegment->hdl = pendingInterest; // cancels previous pending Interest via scoped handle
+  pendingSegment->timeoutEvent = timeoutEvent;
 }
 
 void
 SegmentFetcher::cancelExcessInFlightSegments()
 {
-  for (auto it = m_pendingSegments.begin(); it != m_pendingSegments.end();) {
-    if (it->first >= static_cast<uint64_t>(m_nSegments)) {
-      it = m_pendingSegments.erase(it); // cancels pending Interest and timeout event
-      BOOST_ASSERT(m_nSegmentsInFlight > 0);
-      m_nSegmentsInFlight--;
-    }
-    else {
-      ++it;
-    }
-  }
+  // cancels pending Interests and timeout events
+  auto nCanceled = static_cast<int64_t>(m_pendingSegments.eraseFrom(m_endSegment));
+  BOOST_ASSERT(m_nSegmentsInFlight >= nCanceled);
+  m_nSegmentsInFlight -= nCanceled;
 }
 
 bool
@@ -502,11 +859,16 @@ SegmentFetcher::checkAllSegmentsReceived()
 {
   bool haveReceivedAllSegments = false;
 
-  if (m_nSegments != 0 && m_nReceived >= m_nSegments) {
+  if (m_endSegment <= m_options.startSegment) {
+    return true; // the range is beyond the end of the object
+  }
+
+  if (m_endSegment != std::numeric_limits<uint64_t>::max() &&
+      static_cast<uint64_t>(m_nReceived) >= m_endSegment - m_options.startSegment) {
     haveReceivedAllSegments = true;
     // Verify that all segments in window have been received. If not, send Interests for missing segments.
-    for (uint64_t i = 0; i < static_cast<uint64_t>(m_nSegments); i++) {
-      if (m_receivedSegments.count(i) == 0) {
+    for (uint64_t i = m_receivedSegments.getFirstMissing(); i < m_endSegment; i++) {
+      if (!m_receivedSegments.contains(i)) {
         m_retxQueue.push(i);
         haveReceivedAllSegments = false;
       }
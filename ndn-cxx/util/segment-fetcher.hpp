@@ -23,17 +23,32 @@
 #define NDN_UTIL_SEGMENT_FETCHER_HPP
 
 #include "ndn-cxx/face.hpp"
+#include "ndn-cxx/detail/segment-window.hpp"
+#include "ndn-cxx/interest-template.hpp"
 #include "ndn-cxx/security/validator.hpp"
+#include "ndn-cxx/util/congestion-control.hpp"
+#include "ndn-cxx/util/fetch-checkpoint.hpp"
+#include "ndn-cxx/util/fetch-trace.hpp"
 #include "ndn-cxx/util/rtt-estimator.hpp"
 #include "ndn-cxx/util/scheduler.hpp"
 #include "ndn-cxx/util/signal.hpp"
 
 #include <queue>
-#include <set>
 
 namespace ndn {
+
+namespace security {
+inline namespace v2 {
+class ValidationPipeline;
+} // inline namespace v2
+} // namespace security
+
 namespace util {
 
+namespace detail {
+class SegmentFileWriter;
+} // namespace detail
+
 /**
  * @brief Utility class to fetch the latest version of a segmented object.
  *
@@ -60,15 +75,44 @@ namespace util {
  *    format: `/<prefix>/<version>/<segment=(N)>`.
  *
  * 4. If set to 'block' mode, signal #onComplete passing a memory buffer that combines the content
- *    of all segments in the object. If set to 'in order' mode, signal #onInOrderData is triggered
- *    upon validation of each segment in segment order, storing later segments that arrived out of
- *    order internally until all earlier segments have arrived and have been validated.
+ *    of all segments in the object. If set to 'in order' mode, signals #onInOrderContent and
+ *    #onInOrderData are triggered upon validation of each segment in segment order, storing later
+ *    segments that arrived out of order internally until all earlier segments have arrived and
+ *    have been validated.
+ *
+ * If an output file is set in Options, SegmentFetcher operates in 'file' mode instead: each
+ * validated segment is written into the file at its offset as soon as it arrives, #onFileProgress
+ * reports the number of bytes written, and #onFileComplete is signaled at the end. This mode
+ * requires all segments except the last one to have the same size, as produced by common
+ * segmenters. Memory usage does not depend on the size of the object.
+ *
+ * Segments that arrive out of order are kept as the Content element of the received Data, without
+ * copying the payload. In both modes, each segment is released as soon as all earlier segments
+ * have arrived: in 'block' mode its payload is appended to the output buffer, which is allocated
+ * for the whole object once the FinalBlockId is known. Therefore, memory usage is bounded by the
+ * size of the object plus the reorder window.
+ *
+ * Options::startSegment and Options::endSegment restrict the transfer to a range of segments. The
+ * version is still discovered with the Interest in step 1, but its reply is ignored if it falls
+ * outside of the range. In 'block' mode the output buffer contains only the segments in the range;
+ * in 'file' mode they are written at their offsets in the object.
+ *
+ * An interrupted transfer in 'in order' or 'file' mode can be resumed from a FetchCheckpoint,
+ * which is obtained from #onProgress or getCheckpoint() and set in Options::checkpoint. The
+ * resumed transfer skips version discovery and does not request the segments already received.
  *
  * If an error occurs during the fetching process, #onError is signaled with one of the error codes
  * from SegmentFetcher::ErrorCode.
  *
  * A Validator instance must be specified to validate individual segments. Every time a segment has
- * been successfully validated, #afterSegmentValidated will be signaled.
+ * been successfully validated, #afterSegmentValidated will be signaled. If
+ * Options::nValidationThreads is positive, segments are validated through a
+ * security::ValidationPipeline, which verifies their signatures on worker threads and signals the
+ * results in arrival order. The congestion window is then updated when a segment arrives rather
+ * than after it has been validated, so that the transfer rate is not limited by verification.
+ *
+ * If a FetchTrace is set in Options::trace, the fetcher records the timeline of the transfer in
+ * it, which remains available, along with its statistics, after the transfer has ended.
  *
  * Example:
  *     @code
@@ -107,6 +151,8 @@ public:
     NACK_ERROR = 4,
     /// A received FinalBlockId did not contain a segment component
     FINALBLOCKID_NOT_SEGMENT = 5,
+    /// A segment could not be written to the output file in 'file' mode
+    FILE_ERROR = 6,
   };
 
   class Options
@@ -128,12 +174,50 @@ public:
     bool disableCwa = false; ///< disable Conservative Window Adaptation
     bool resetCwndToInit = false; ///< reduce cwnd to initCwnd when loss event occurs
     bool ignoreCongMarks = false; ///< disable window decrease after congestion mark received
-    double initCwnd = 1.0; ///< initial congestion window size
-    double initSsthresh = std::numeric_limits<double>::max(); ///< initial slow start threshold
-    double aiStep = 1.0; ///< additive increase step (in segments)
-    double mdCoef = 0.5; ///< multiplicative decrease coefficient
+    double initCwnd = 1.0; ///< initial congestion window size of AIMD
+    double initSsthresh = std::numeric_limits<double>::max(); ///< initial slow start threshold of AIMD
+    double aiStep = 1.0; ///< additive increase step of AIMD (in segments)
+    double mdCoef = 0.5; ///< multiplicative decrease coefficient of AIMD
     RttEstimator::Options rttOptions; ///< options for RTT estimator
-    size_t flowControlWindow = 25000; ///< maximum number of segments stored in the reorder buffer
+
+    /**
+     * @brief Creates the congestion control algorithm of the fetcher.
+     *
+     * If empty, AimdCongestionControl is used, configured with initCwnd, initSsthresh, aiStep,
+     * mdCoef, and resetCwndToInit. Example:
+     * @code
+     * options.congestionControl = [] { return make_unique<CubicCongestionControl>(); };
+     * @endcode
+     */
+    std::function<unique_ptr<CongestionControl>()> congestionControl;
+    /// maximum number of segments stored in the reorder buffer; also bounds the span of segment
+    /// numbers tracked in the circular window state
+    size_t flowControlWindow = 25000;
+
+    /// if not empty, 'file' mode: segments are written into this file, which is created or truncated
+    std::string outputFile;
+    bool useMmap = false; ///< in 'file' mode, write through a memory mapping once FinalBlockId is known
+    uint64_t fsyncInterval = 0; ///< in 'file' mode, flush to storage after this many bytes (0 = never)
+    bool fsyncOnComplete = true; ///< in 'file' mode, flush to storage before #onFileComplete
+    uint64_t progressInterval = 0; ///< in 'file' mode, minimum bytes between #onFileProgress signals
+
+    uint64_t startSegment = 0; ///< first segment to fetch
+    /// segment after the last one to fetch; the transfer also stops at the end of the object
+    uint64_t endSegment = std::numeric_limits<uint64_t>::max();
+    /**
+     * @brief Resume a previous transfer of the same range.
+     *
+     * Requires 'in order' or 'file' mode. In 'file' mode, the output file is not truncated.
+     */
+    optional<FetchCheckpoint> checkpoint;
+    uint64_t checkpointInterval = 0; ///< number of new segments between #onProgress signals (0 = never)
+
+    /// number of threads verifying segment signatures; if 0, segments are validated synchronously
+    /// on the Face thread
+    size_t nValidationThreads = 0;
+
+    /// if set, records the events of the transfer; it is reset when the fetcher is started
+    shared_ptr<FetchTrace> trace;
   };
 
   /**
@@ -157,6 +241,7 @@ public:
    *                     This shared_ptr is kept internally for the lifetime of the transfer.
    *                     Therefore, it does not need to be saved and is provided here so that the
    *                     SegmentFetcher's signals can be connected to.
+   * @throw std::runtime_error the output file in @p options cannot be opened
    */
   static shared_ptr<SegmentFetcher>
   start(Face& face,
@@ -172,6 +257,17 @@ public:
   void
   stop();
 
+  ~SegmentFetcher();
+
+  /**
+   * @brief Returns the state from which the transfer can be resumed.
+   *
+   * The checkpoint only includes the segments that have been handed to the application or
+   * written to the output file, but not those still held in memory.
+   */
+  FetchCheckpoint
+  getCheckpoint() const;
+
 private:
   class PendingSegment;
 
@@ -183,19 +279,39 @@ private:
   void
   fetchFirstSegment(const Interest& baseInterest, bool isRetransmission);
 
+  /**
+   * @brief Restore the state of a previous transfer from Options::checkpoint.
+   * @throw std::runtime_error the output file in 'file' mode cannot be prepared
+   */
+  void
+  resumeFromCheckpoint(const FetchCheckpoint& checkpoint);
+
   void
   fetchSegmentsInWindow(const Interest& origInterest);
 
+  /**
+   * @brief Make the Interest for a segment of the versioned object.
+   *
+   * Unless @p origInterest carries ApplicationParameters, the Interest is stamped from a
+   * pre-encoded template instead of being encoded from scratch.
+   */
+  Interest
+  makeSegmentInterest(const Interest& origInterest, uint64_t segNum);
+
   void
   sendInterest(uint64_t segNum, const Interest& interest, bool isRetransmission);
 
+  void
+  afterInterestSent(uint64_t segNum, const Interest& interest, bool isRetransmission,
+                    const PendingInterestHandle& pendingInterest);
+
   void
   afterSegmentReceivedCb(const Interest& origInterest, const Data& data,
                          const weak_ptr<SegmentFetcher>& weakSelf);
 
   void
   afterValidationSuccess(const Data& data, const Interest& origInterest,
-                         std::map<uint64_t, PendingSegment>::iterator pendingSegmentIt,
+                         uint64_t pendingSegmentNum,
                          const weak_ptr<SegmentFetcher>& weakSelf);
 
   void
@@ -214,15 +330,52 @@ private:
   void
   afterNackOrTimeout(const Interest& origInterest);
 
+  /**
+   * @brief Release buffered segments that are next in segment order.
+   *
+   * In 'in order' mode, the segments are signaled to the application.
+   * In 'block' mode, their payload is appended to the output buffer.
+   */
+  void
+  deliverInOrderSegments();
+
+  /**
+   * @brief Write a segment in 'file' mode.
+   * @return false if an error has been signaled
+   */
+  bool
+  writeSegmentToFile(uint64_t segNum, const Block& content);
+
   void
   finalizeFetch();
 
+  /**
+   * @brief Stop tracking the Interest of a received segment.
+   * @return RTT sample, if the segment was not retransmitted
+   */
+  optional<time::nanoseconds>
+  completePendingSegment(uint64_t pendingSegmentNum, time::steady_clock::TimePoint now);
+
+  /**
+   * @brief Update the congestion window upon receipt of a segment.
+   */
+  void
+  updateWindow(const Data& data, uint64_t segNum, optional<time::nanoseconds> rtt,
+               time::steady_clock::TimePoint now);
+
   void
-  windowIncrease();
+  windowIncrease(optional<time::nanoseconds> rtt, bool isCongestionMarked,
+                 time::steady_clock::TimePoint now);
 
   void
   windowDecrease();
 
+  /**
+   * @brief Update the window from the congestion control algorithm, and trace any change.
+   */
+  void
+  updateCwnd();
+
   void
   signalError(uint32_t code, const std::string& msg);
 
@@ -276,10 +429,42 @@ public:
 
   /**
    * @brief Emitted after each data segment in segment order has been validated.
+   *
+   * The payload is copied into a new buffer for every segment, but only if this signal has
+   * handlers; prefer #onInOrderContent to avoid the copy.
    * @note Emitted only if SegmentFetcher is operating in 'in order' mode.
    */
   Signal<SegmentFetcher, ConstBufferPtr> onInOrderData;
 
+  /**
+   * @brief Emitted after each data segment in segment order has been validated.
+   *
+   * The argument is the Content element of the segment, which shares memory with the received
+   * Data packet; use Block::value() and Block::value_size() to access the payload.
+   * @note Emitted only if SegmentFetcher is operating in 'in order' mode.
+   */
+  Signal<SegmentFetcher, Block> onInOrderContent;
+
+  /**
+   * @brief Emitted after segments have been written, with the total number of bytes written.
+   *
+   * Consecutive signals are at least Options::progressInterval bytes apart.
+   * @note Emitted only if SegmentFetcher is operating in 'file' mode.
+   */
+  Signal<SegmentFetcher, uint64_t> onFileProgress;
+
+  /**
+   * @brief Emitted when all segments have been written, with the size of the object.
+   * @note Emitted only if SegmentFetcher is operating in 'file' mode.
+   */
+  Signal<SegmentFetcher, uint64_t> onFileComplete;
+
+  /**
+   * @brief Emitted every Options::checkpointInterval new segments, with a checkpoint from which
+   *        the transfer can be resumed.
+   */
+  Signal<SegmentFetcher, FetchCheckpoint> onProgress;
+
   /**
    * @brief Emitted on successful retrieval of all segments in 'in order' mode.
    * @note Emitted only if SegmentFetcher is operating in 'in order' mode.
@@ -303,34 +488,50 @@ private:
   };
 
 NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
-  static constexpr double MIN_SSTHRESH = 2.0;
-
   shared_ptr<SegmentFetcher> m_this;
 
   Options m_options;
   Face& m_face;
   Scheduler m_scheduler;
   security::v2::Validator& m_validator;
+  /// validates segments on worker threads if Options::nValidationThreads is positive
+  unique_ptr<security::v2::ValidationPipeline> m_validationPipeline;
   RttEstimator m_rttEstimator;
+  unique_ptr<CongestionControl> m_congestionControl;
 
   time::steady_clock::TimePoint m_timeLastSegmentReceived;
   std::queue<uint64_t> m_retxQueue;
   Name m_versionedDataName;
   uint64_t m_nextSegmentNum = 0;
-  double m_cwnd;
-  double m_ssthresh;
+  double m_cwnd; ///< congestion window, as of the last update of m_congestionControl
+  double m_ssthresh; ///< slow start threshold, as of the last update of m_congestionControl
   int64_t m_nSegmentsInFlight = 0;
   int64_t m_nSegments = 0;
+  /// end of the range of segments to fetch, limited to m_nSegments once known
+  uint64_t m_endSegment;
   uint64_t m_highInterest = 0;
   uint64_t m_highData = 0;
   uint64_t m_recPoint = 0;
-  int64_t m_nReceived = 0;
+  int64_t m_nReceived = 0; ///< number of segments received in the range
+  int64_t m_nReceivedAtLastCheckpoint = 0;
   int64_t m_nBytesReceived = 0;
   uint64_t m_nextSegmentInOrder = 0;
 
-  std::map<uint64_t, Buffer> m_segmentBuffer;
-  std::map<uint64_t, PendingSegment> m_pendingSegments;
-  std::set<uint64_t> m_receivedSegments;
+  optional<InterestTemplate> m_segmentInterestTemplate;
+
+  size_t m_maxSegmentSize = 0;
+
+  /// validated segments awaiting in-order delivery
+  ndn::detail::SegmentRing<Block> m_segmentBuffer;
+  shared_ptr<Buffer> m_contentBuffer; ///< reassembled object in 'block' mode
+  /// end offset of each segment in m_contentBuffer, to drop segments beyond a FinalBlockId
+  /// that became known after they were appended
+  std::vector<size_t> m_segmentEnds;
+
+  unique_ptr<detail::SegmentFileWriter> m_fileWriter; ///< output file in 'file' mode
+  uint64_t m_nBytesAtLastProgress = 0;
+  ndn::detail::SegmentRing<PendingSegment> m_pendingSegments;
+  ndn::detail::SegmentBitmap m_receivedSegments;
   
   ndn::Block nextHash;
 };
@@ -0,0 +1,351 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/segment-publisher.hpp"
+#include "ndn-cxx/encoding/block-helpers.hpp"
+#include "ndn-cxx/ims/in-memory-storage-persistent.hpp"
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+namespace ndn {
+namespace util {
+
+constexpr uint32_t SegmentPublisher::NEXT_SIGNATURE_TYPE;
+
+void
+SegmentPublisher::Options::validate()
+{
+  if (maxSegmentSize == 0) {
+    NDN_THROW(std::invalid_argument("maxSegmentSize must be positive"));
+  }
+
+  if (hashChain && window > 0) {
+    NDN_THROW(std::invalid_argument("Hash chaining requires all segments to be produced upfront"));
+  }
+}
+
+SegmentPublisher::SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix,
+                                   const security::SigningInfo& signingInfo, const Options& options)
+  : m_face(face)
+  , m_keyChain(keyChain)
+  , m_prefix(prefix)
+  , m_signingInfo(signingInfo)
+  , m_options(options)
+{
+  m_options.validate();
+
+  uint64_t version = m_options.version ? *m_options.version :
+                     static_cast<uint64_t>(time::toUnixTimestamp(time::system_clock::now()).count());
+  m_versionedName = Name(m_prefix).appendVersion(version);
+
+  if (m_options.storage != nullptr) {
+    m_storage = m_options.storage;
+  }
+  else {
+    m_ownStorage = make_unique<InMemoryStoragePersistent>();
+    m_storage = m_ownStorage.get();
+  }
+}
+
+SegmentPublisher::SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix,
+                                   ConstBufferPtr content, const security::SigningInfo& signingInfo,
+                                   const Options& options)
+  : SegmentPublisher(face, keyChain, prefix, signingInfo, options)
+{
+  BOOST_ASSERT(content != nullptr);
+  m_buffer = std::move(content);
+  m_nSegments = std::max<uint64_t>(1, (m_buffer->size() + m_options.maxSegmentSize - 1) /
+                                      m_options.maxSegmentSize);
+  start();
+}
+
+SegmentPublisher::SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix,
+                                   std::istream& is, const security::SigningInfo& signingInfo,
+                                   const Options& options)
+  : SegmentPublisher(face, keyChain, prefix, signingInfo, options)
+{
+  m_stream = &is;
+  start();
+}
+
+unique_ptr<SegmentPublisher>
+SegmentPublisher::fromFile(Face& face, KeyChain& keyChain, const Name& prefix,
+                           const std::string& filename, const security::SigningInfo& signingInfo,
+                           const Options& options)
+{
+  auto file = make_unique<std::ifstream>(filename, std::ios::binary);
+  if (!*file) {
+    NDN_THROW(std::runtime_error("Cannot open " + filename));
+  }
+  file->seekg(0, std::ios::end);
+  auto size = static_cast<uint64_t>(file->tellg());
+  file->seekg(0);
+
+  unique_ptr<SegmentPublisher> publisher(new SegmentPublisher(face, keyChain, prefix,
+                                                              signingInfo, options));
+  publisher->m_nSegments = std::max<uint64_t>(1, (size + publisher->m_options.maxSegmentSize - 1) /
+                                                 publisher->m_options.maxSegmentSize);
+  publisher->m_stream = file.get();
+  publisher->m_file = std::move(file);
+  publisher->start();
+  return publisher;
+}
+
+SegmentPublisher::~SegmentPublisher() = default;
+
+void
+SegmentPublisher::start()
+{
+  produceUntil(m_options.window > 0 ? m_options.window : std::numeric_limits<uint64_t>::max());
+
+  auto onInterest = [this] (const InterestFilter&, const Interest& interest) {
+    this->onInterest(interest);
+  };
+  if (m_options.registerPrefix) {
+    m_registeredPrefix = m_face.setInterestFilter(m_prefix, onInterest,
+      [this] (const Name&, const std::string& reason) {
+        onError("Failed to register prefix: " + reason);
+      });
+  }
+  else {
+    m_interestFilter = m_face.setInterestFilter(m_prefix, onInterest);
+  }
+}
+
+optional<uint64_t>
+SegmentPublisher::getNSegments() const
+{
+  return m_nSegments;
+}
+
+uint64_t
+SegmentPublisher::getLead() const
+{
+  if (!m_highestRequested) {
+    return m_nProduced;
+  }
+  return m_nProduced > *m_highestRequested + 1 ? m_nProduced - *m_highestRequested - 1 : 0;
+}
+
+std::pair<ConstBufferPtr, bool>
+SegmentPublisher::readSegment(uint64_t segNum)
+{
+  uint64_t offset = segNum * m_options.maxSegmentSize;
+
+  if (m_buffer != nullptr) {
+    auto begin = std::min<uint64_t>(offset, m_buffer->size());
+    auto end = std::min<uint64_t>(begin + m_options.maxSegmentSize, m_buffer->size());
+    return {make_shared<Buffer>(m_buffer->begin() + begin, m_buffer->begin() + end),
+            segNum + 1 >= *m_nSegments};
+  }
+
+  if (m_file != nullptr) {
+    m_file->clear();
+    m_file->seekg(static_cast<std::streamoff>(offset));
+  }
+  auto content = make_shared<Buffer>(m_options.maxSegmentSize);
+  m_stream->read(reinterpret_cast<char*>(content->data()), static_cast<std::streamsize>(content->size()));
+  content->resize(static_cast<size_t>(m_stream->gcount()));
+
+  if (m_nSegments) {
+    return {content, segNum + 1 >= *m_nSegments};
+  }
+  // peek() fails at the end of the stream, or if the stream cannot be read any further
+  bool isLast = m_stream->peek() == std::istream::traits_type::eof();
+  return {content, isLast};
+}
+
+void
+SegmentPublisher::produceUntil(uint64_t end)
+{
+  std::vector<std::pair<uint64_t, ConstBufferPtr>> contents;
+  while (m_nProduced < end && (!m_nSegments || m_nProduced < *m_nSegments)) {
+    ConstBufferPtr content;
+    bool isLast = false;
+    std::tie(content, isLast) = readSegment(m_nProduced);
+    if (isLast) {
+      m_nSegments = m_nProduced + 1;
+    }
+    contents.emplace_back(m_nProduced, std::move(content));
+    ++m_nProduced;
+  }
+
+  if (contents.empty()) {
+    return;
+  }
+
+  // the segments are made after reading, so that the end of a stream read in this batch is known
+  std::vector<shared_ptr<Data>> segments;
+  segments.reserve(contents.size());
+  for (auto& content : contents) {
+    segments.push_back(makeSegment(content.first, std::move(content.second)));
+  }
+
+  if (m_options.hashChain) {
+    signHashChain(segments);
+  }
+  else {
+    signSegments(segments);
+  }
+
+  m_storage->insertBatch(segments);
+  if (m_firstSegment == nullptr) {
+    m_firstSegment = segments.front();
+  }
+}
+
+shared_ptr<Data>
+SegmentPublisher::makeSegment(uint64_t segNum, ConstBufferPtr content) const
+{
+  auto data = make_shared<Data>(Name(m_versionedName).appendSegment(segNum));
+  data->setFreshnessPeriod(m_options.freshnessPeriod);
+  data->setContent(std::move(content));
+  if (m_nSegments) {
+    data->setFinalBlock(name::Component::fromSegment(*m_nSegments - 1));
+  }
+  return data;
+}
+
+void
+SegmentPublisher::signSegment(Data& data) const
+{
+  m_keyChain.sign(data, m_signingInfo);
+}
+
+void
+SegmentPublisher::signSegments(const std::vector<shared_ptr<Data>>& segments)
+{
+  // the first signature is made on this thread, so that the PIB and the TPM have loaded the key
+  // before it is used concurrently
+  signSegment(*segments.front());
+  if (segments.size() == 1) {
+    return;
+  }
+
+  if (m_options.nSigningThreads == 0) {
+    for (size_t i = 1; i < segments.size(); ++i) {
+      signSegment(*segments[i]);
+    }
+    return;
+  }
+
+  std::atomic<size_t> next{1};
+  std::mutex mutex;
+  std::exception_ptr error;
+  std::vector<std::thread> threads;
+  size_t nThreads = std::min(m_options.nSigningThreads, segments.size() - 1);
+  for (size_t t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&] {
+      try {
+        for (size_t i = next++; i < segments.size(); i = next++) {
+          signSegment(*segments[i]);
+        }
+      }
+      catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error == nullptr) {
+          error = std::current_exception();
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+void
+SegmentPublisher::signHashChain(const std::vector<shared_ptr<Data>>& segments)
+{
+  // each segment carries the signature of the next one, so they are signed from the last one,
+  // as HCKeyChain::sign() would sign them
+  for (size_t i = segments.size(); i-- > 0;) {
+    Data& data = *segments[i];
+    MetaInfo metaInfo = data.getMetaInfo();
+    if (i + 1 < segments.size()) {
+      const Block& nextSignature = segments[i + 1]->getSignatureValue();
+      metaInfo.addAppMetaInfo(makeBinaryBlock(NEXT_SIGNATURE_TYPE, nextSignature.value(),
+                                              nextSignature.value_size()));
+    }
+    else {
+      metaInfo.addAppMetaInfo(makeEmptyBlock(NEXT_SIGNATURE_TYPE));
+    }
+    data.setMetaInfo(metaInfo);
+    signSegment(data);
+  }
+}
+
+void
+SegmentPublisher::onInterest(const Interest& interest)
+{
+  const Name& name = interest.getName();
+  uint64_t segNum = 0;
+  bool isDiscovery = false;
+  if (name.size() > m_versionedName.size() && m_versionedName.isPrefixOf(name) &&
+      name[m_versionedName.size()].isSegment()) {
+    segNum = name[m_versionedName.size()].toSegment();
+  }
+  else if (interest.getCanBePrefix() && name.isPrefixOf(m_versionedName)) {
+    isDiscovery = true;
+  }
+  else {
+    return;
+  }
+
+  if (!m_highestRequested || segNum > *m_highestRequested) {
+    m_highestRequested = segNum;
+  }
+  if (m_options.window > 0) {
+    constexpr auto maxEnd = std::numeric_limits<uint64_t>::max();
+    produceUntil(segNum < maxEnd - m_options.window ? segNum + 1 + m_options.window : maxEnd);
+  }
+
+  shared_ptr<const Data> data;
+  if (isDiscovery) {
+    data = m_firstSegment;
+  }
+  else {
+    data = m_storage->find(interest);
+    if (data == nullptr && segNum < m_nProduced && canReadAgain() && !m_options.hashChain) {
+      // the segment has been evicted from the storage
+      ConstBufferPtr content;
+      std::tie(content, std::ignore) = readSegment(segNum);
+      auto segment = makeSegment(segNum, std::move(content));
+      signSegments({segment});
+      m_storage->insert(*segment);
+      data = segment;
+    }
+  }
+
+  if (data != nullptr) {
+    m_face.put(*data);
+  }
+}
+
+} // namespace util
+} // namespace ndn
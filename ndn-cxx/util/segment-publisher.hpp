@@ -0,0 +1,253 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#ifndef NDN_UTIL_SEGMENT_PUBLISHER_HPP
+#define NDN_UTIL_SEGMENT_PUBLISHER_HPP
+
+#include "ndn-cxx/face.hpp"
+#include "ndn-cxx/ims/in-memory-storage.hpp"
+#include "ndn-cxx/security/key-chain.hpp"
+#include "ndn-cxx/util/signal.hpp"
+
+#include <iosfwd>
+
+namespace ndn {
+namespace util {
+
+/**
+ * @brief Utility class to publish a segmented object, the producer counterpart of SegmentFetcher.
+ *
+ * SegmentPublisher splits the content of a buffer, file, or input stream into Data packets named
+ * `/<prefix>/<version>/<segment>`, with a FinalBlockId that identifies the last segment. The
+ * segments are signed and inserted into an InMemoryStorage, from which Interests under
+ * `/<prefix>` are answered. An Interest for `/<prefix>` itself, as expressed by SegmentFetcher
+ * to discover the version, is answered with the first segment.
+ *
+ * By default, all segments are produced when the publisher is created. If Options::window is
+ * positive, segments are instead produced on demand, at most Options::window segments beyond the
+ * highest segment requested so far, so that memory usage and signing work follow the progress of
+ * the consumers. getLead() reports how far ahead of the consumers the publisher is.
+ *
+ * Signing can be spread over Options::nSigningThreads threads. Alternatively, with
+ * Options::hashChain, the segments are produced in the format that HCKeyChain::sign() produces
+ * and HCSegmentFetcher verifies: every segment is signed with the given SigningInfo and carries
+ * the signature value of the next segment in an AppMetaInfo element, empty in the last segment.
+ *
+ * Example:
+ *     @code
+ *     SegmentPublisher publisher(face, keyChain, "/data/prefix", content,
+ *                                signingByIdentity("/my/identity"));
+ *     face.processEvents();
+ *     @endcode
+ */
+class SegmentPublisher : noncopyable
+{
+public:
+  class Options
+  {
+  public:
+    Options()
+    {
+    }
+
+    void
+    validate();
+
+  public:
+    optional<uint64_t> version; ///< version component; if not set, the current time is used
+    size_t maxSegmentSize = 8000; ///< maximum size of the content of each segment
+    time::milliseconds freshnessPeriod = 10_s; ///< FreshnessPeriod of the segments
+    /// if positive, segments are produced on demand, at most this many beyond the highest request
+    size_t window = 0;
+    /// number of threads signing the segments; if 0, segments are signed on the calling thread
+    /// @note The KeyChain is then used from several threads. This relies on its PIB and TPM
+    ///       allowing concurrent lookups of a key once the key has been used, as the memory
+    ///       back ends do.
+    size_t nSigningThreads = 0;
+    /// chain each segment to the next one with its signature value; the segments are then
+    /// signed one after another, from the last one, on the calling thread
+    bool hashChain = false;
+    /// if set, segments are inserted into this storage instead of an InMemoryStoragePersistent
+    InMemoryStorage* storage = nullptr;
+    bool registerPrefix = true; ///< register the prefix with the forwarder, not only set the filter
+  };
+
+  /**
+   * @brief TLV-TYPE of the AppMetaInfo element carrying the signature value of the next segment
+   *        in Options::hashChain mode; the element is empty in the last segment.
+   */
+  static constexpr uint32_t NEXT_SIGNATURE_TYPE = 128;
+
+  /**
+   * @brief Publish @p content under @p prefix.
+   * @throw std::invalid_argument @p options are invalid
+   */
+  SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix, ConstBufferPtr content,
+                   const security::SigningInfo& signingInfo = security::SigningInfo(),
+                   const Options& options = Options());
+
+  /**
+   * @brief Publish the content read from @p is under @p prefix.
+   *
+   * If segments are produced on demand, @p is must remain valid as long as the publisher,
+   * and segments evicted from the storage cannot be produced again.
+   * @throw std::invalid_argument @p options are invalid
+   */
+  SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix, std::istream& is,
+                   const security::SigningInfo& signingInfo = security::SigningInfo(),
+                   const Options& options = Options());
+
+  /**
+   * @brief Publish the content of the file @p filename under @p prefix.
+   * @throw std::runtime_error the file cannot be opened
+   * @throw std::invalid_argument @p options are invalid
+   */
+  static unique_ptr<SegmentPublisher>
+  fromFile(Face& face, KeyChain& keyChain, const Name& prefix, const std::string& filename,
+           const security::SigningInfo& signingInfo = security::SigningInfo(),
+           const Options& options = Options());
+
+  ~SegmentPublisher();
+
+  /**
+   * @brief Get the name of the object, including the version.
+   */
+  const Name&
+  getVersionedName() const
+  {
+    return m_versionedName;
+  }
+
+  /**
+   * @brief Get the number of segments in the object, if known.
+   *
+   * The number is unknown until the end of an input stream has been reached.
+   */
+  optional<uint64_t>
+  getNSegments() const;
+
+  /**
+   * @brief Get the number of segments that have been produced.
+   */
+  uint64_t
+  getNSegmentsProduced() const
+  {
+    return m_nProduced;
+  }
+
+  /**
+   * @brief Get the highest segment number that has been requested, if any.
+   */
+  optional<uint64_t>
+  getHighestRequested() const
+  {
+    return m_highestRequested;
+  }
+
+  /**
+   * @brief Get the number of segments produced beyond the highest requested segment.
+   */
+  uint64_t
+  getLead() const;
+
+public:
+  /**
+   * @brief Emitted when the prefix cannot be registered, with the reason.
+   */
+  Signal<SegmentPublisher, std::string> onError;
+
+private:
+  SegmentPublisher(Face& face, KeyChain& keyChain, const Name& prefix,
+                   const security::SigningInfo& signingInfo, const Options& options);
+
+  void
+  start();
+
+  /**
+   * @brief Read the content of segment @p segNum.
+   *
+   * Only segments in order can be read from an input stream.
+   * @return the content, and whether the segment is the last one
+   */
+  std::pair<ConstBufferPtr, bool>
+  readSegment(uint64_t segNum);
+
+  bool
+  canReadAgain() const
+  {
+    return m_stream == nullptr || m_file != nullptr;
+  }
+
+  /**
+   * @brief Produce segments up to, but excluding, @p end, or until the end of the object.
+   */
+  void
+  produceUntil(uint64_t end);
+
+  /**
+   * @brief Make the unsigned Data packet of segment @p segNum.
+   */
+  shared_ptr<Data>
+  makeSegment(uint64_t segNum, ConstBufferPtr content) const;
+
+  /**
+   * @brief Sign @p segments, spreading the work over the signing threads.
+   */
+  void
+  signSegments(const std::vector<shared_ptr<Data>>& segments);
+
+  void
+  signSegment(Data& data) const;
+
+  void
+  signHashChain(const std::vector<shared_ptr<Data>>& segments);
+
+  void
+  onInterest(const Interest& interest);
+
+NDN_CXX_PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  Face& m_face;
+  KeyChain& m_keyChain;
+  const Name m_prefix;
+  Name m_versionedName;
+  const security::SigningInfo m_signingInfo;
+  Options m_options;
+
+  unique_ptr<InMemoryStorage> m_ownStorage;
+  InMemoryStorage* m_storage;
+
+  ConstBufferPtr m_buffer; ///< content, if published from a buffer
+  unique_ptr<std::ifstream> m_file; ///< content, if published from a file
+  std::istream* m_stream = nullptr; ///< content, if published from a file or an input stream
+  optional<uint64_t> m_nSegments;
+
+  uint64_t m_nProduced = 0;
+  optional<uint64_t> m_highestRequested;
+  shared_ptr<const Data> m_firstSegment;
+
+  ScopedRegisteredPrefixHandle m_registeredPrefix;
+  ScopedInterestFilterHandle m_interestFilter;
+};
+
+} // namespace util
+} // namespace ndn
+
+#endif // NDN_UTIL_SEGMENT_PUBLISHER_HPP
@@ -0,0 +1,224 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx Congestion Control Simulation
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/util/dummy-client-face.hpp"
+#include "ndn-cxx/util/scheduler.hpp"
+#include "ndn-cxx/util/segment-fetcher.hpp"
+#include "tests/make-interest-data.hpp"
+#include "tests/unit/dummy-validator.hpp"
+#include "tests/unit/unit-test-time-fixture.hpp"
+
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+/** \brief Parameters of the simulated path between the consumer and the producer
+ */
+struct LinkParams
+{
+  std::string description;
+  time::nanoseconds delay; ///< one-way propagation delay
+  double bandwidth; ///< bottleneck capacity, in segments per second
+  double lossRate; ///< probability that a Data packet is lost after the bottleneck
+  size_t queueLimit; ///< bottleneck queue capacity, in segments; Data beyond it is dropped
+  size_t markThreshold; ///< queue length above which Data is congestion-marked; 0 to disable
+};
+
+/** \brief Emulates a producer behind a bottleneck link, using the Interests sent by a
+ *         DummyClientFace.
+ *
+ *  An Interest reaches the producer after the propagation delay. The Data is then queued at the
+ *  bottleneck, serialized at the link bandwidth, and received by the face after another
+ *  propagation delay. Time is virtual, so a transfer of several seconds is simulated quickly.
+ */
+class SimulatedLink : noncopyable
+{
+public:
+  SimulatedLink(DummyClientFace& face, const LinkParams& params,
+                uint64_t nSegments, size_t segmentSize)
+    : m_face(face)
+    , m_scheduler(face.getIoService())
+    , m_params(params)
+    , m_nSegments(nSegments)
+    , m_content(segmentSize, 'x')
+    , m_serializationTime(time::duration_cast<time::nanoseconds>(
+                            time::duration<double>(1.0 / params.bandwidth)))
+    , m_rng(12345) // same losses for every algorithm
+  {
+    m_conn = face.onSendInterest.connect([this] (const Interest& interest) { forward(interest); });
+  }
+
+private:
+  void
+  forward(const Interest& interest)
+  {
+    auto now = time::steady_clock::now();
+    auto arrival = now + m_params.delay;
+
+    auto backlogTime = std::max(m_linkFreeAt, arrival) - arrival;
+    auto backlog = static_cast<size_t>(time::duration<double>(backlogTime).count() * m_params.bandwidth);
+    if (backlog >= m_params.queueLimit) {
+      ++nQueueDrops;
+      return;
+    }
+
+    m_linkFreeAt = std::max(m_linkFreeAt, arrival) + m_serializationTime;
+    if (std::bernoulli_distribution(m_params.lossRate)(m_rng)) {
+      ++nLosses;
+      return;
+    }
+
+    auto data = makeSegment(interest);
+    if (m_params.markThreshold > 0 && backlog > m_params.markThreshold) {
+      data->setCongestionMark(1);
+      ++nMarks;
+    }
+    m_scheduler.schedule(m_linkFreeAt + m_params.delay - now, [this, data] { m_face.receive(*data); });
+  }
+
+  shared_ptr<Data>
+  makeSegment(const Interest& interest) const
+  {
+    const Name& name = interest.getName();
+    uint64_t segment = name[-1].isSegment() ? name[-1].toSegment() : 0;
+    auto data = make_shared<Data>(Name("/sim").appendVersion(1).appendSegment(segment));
+    data->setContent(reinterpret_cast<const uint8_t*>(m_content.data()), m_content.size());
+    data->setFinalBlock(name::Component::fromSegment(m_nSegments - 1));
+    return signData(data);
+  }
+
+public:
+  uint64_t nQueueDrops = 0;
+  uint64_t nLosses = 0;
+  uint64_t nMarks = 0;
+
+private:
+  DummyClientFace& m_face;
+  Scheduler m_scheduler;
+  const LinkParams m_params;
+  const uint64_t m_nSegments;
+  const std::string m_content;
+  const time::nanoseconds m_serializationTime;
+  std::mt19937 m_rng;
+  time::steady_clock::TimePoint m_linkFreeAt;
+  signal::ScopedConnection m_conn;
+};
+
+class CongestionControlSimFixture : public UnitTestTimeFixture
+{
+protected:
+  void
+  simulate(const LinkParams& link, const std::string& algorithm,
+           const std::function<unique_ptr<CongestionControl>()>& congestionControl)
+  {
+    const uint64_t nSegments = 10000;
+    const size_t segmentSize = 1000;
+
+    KeyChain keyChain("pib-memory:", "tpm-memory:");
+    DummyClientFace face(io, keyChain, DummyClientFace::Options{false, false});
+    SimulatedLink sim(face, link, nSegments, segmentSize);
+    DummyValidator validator;
+
+    SegmentFetcher::Options options;
+    options.congestionControl = congestionControl;
+    options.flowControlWindow = nSegments;
+    auto fetcher = SegmentFetcher::start(face, Interest("/sim"), validator, options);
+
+    auto start = time::steady_clock::now();
+    optional<time::nanoseconds> duration;
+    bool hasFailed = false;
+    uint64_t nTimeouts = 0;
+    fetcher->onComplete.connect([&] (ConstBufferPtr) { duration = time::steady_clock::now() - start; });
+    fetcher->onError.connect([&] (uint32_t, const std::string& msg) {
+      hasFailed = true;
+      BOOST_ERROR(algorithm << " on " << link.description << ": " << msg);
+    });
+    fetcher->afterSegmentTimedOut.connect([&] { ++nTimeouts; });
+
+    while (!duration && !hasFailed && time::steady_clock::now() - start < 10_min) {
+      advanceClocks(1_ms, 100);
+    }
+    BOOST_REQUIRE_MESSAGE(duration, algorithm << " on " << link.description << " did not complete");
+
+    double seconds = time::duration<double>(*duration).count();
+    double goodput = nSegments * segmentSize * 8 / seconds / 1e6;
+    double capacity = link.bandwidth * segmentSize * 8 / 1e6;
+    std::cout << std::setw(26) << std::left << link.description
+              << std::setw(7) << algorithm << std::right << std::fixed
+              << std::setprecision(1) << std::setw(8) << goodput << " Mbps ("
+              << std::setw(5) << goodput / capacity * 100 << "% of capacity), "
+              << std::setprecision(2) << seconds << " s, "
+              << nTimeouts << " timeouts, " << sim.nQueueDrops << " queue drops, "
+              << sim.nLosses << " losses, " << sim.nMarks << " marks" << std::endl;
+  }
+
+  void
+  simulateAll(const LinkParams& link)
+  {
+    simulate(link, "AIMD", nullptr);
+    simulate(link, "CUBIC", [] { return make_unique<CubicCongestionControl>(); });
+    simulate(link, "BBR", [] { return make_unique<BbrCongestionControl>(); });
+  }
+};
+
+BOOST_FIXTURE_TEST_SUITE(CongestionControlSim, CongestionControlSimFixture)
+
+// 80 Mbps bottleneck with 1000-octet segments
+
+BOOST_AUTO_TEST_CASE(ShortRtt)
+{
+  simulateAll({"2ms RTT", 1_ms, 10000, 0.0, 100, 0});
+}
+
+BOOST_AUTO_TEST_CASE(LongRtt)
+{
+  simulateAll({"100ms RTT", 50_ms, 10000, 0.0, 1000, 0});
+}
+
+BOOST_AUTO_TEST_CASE(LongRttLossy)
+{
+  simulateAll({"100ms RTT, 0.1% loss", 50_ms, 10000, 0.001, 1000, 0});
+}
+
+BOOST_AUTO_TEST_CASE(LongRttShallowBuffer)
+{
+  simulateAll({"100ms RTT, 100-segment queue", 50_ms, 10000, 0.0, 100, 0});
+}
+
+BOOST_AUTO_TEST_CASE(LongRttMarking)
+{
+  simulateAll({"100ms RTT, marking at 100", 50_ms, 10000, 0.0, 2000, 100});
+}
+
+BOOST_AUTO_TEST_SUITE_END() // CongestionControlSim
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
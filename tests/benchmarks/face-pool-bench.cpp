@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx FacePool Benchmark
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/util/dummy-client-face.hpp"
+#include "ndn-cxx/util/face-pool.hpp"
+#include "tests/benchmarks/timed-execute.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+/** \brief Create a DummyClientFace that acts as a local forwarder stand-in,
+ *         answering every expressed Interest with an unsigned Data packet.
+ */
+static unique_ptr<Face>
+makeForwarderStandIn(boost::asio::io_service& io, KeyChain& keyChain)
+{
+  auto face = make_unique<DummyClientFace>(io, keyChain, DummyClientFace::Options{false, false});
+  DummyClientFace* facePtr = face.get();
+  facePtr->onSendInterest.connect([facePtr] (const Interest& interest) {
+    facePtr->getIoService().post([=] {
+      Data data(interest.getName());
+      data.setContent(reinterpret_cast<const uint8_t*>("0123456789abcdef"), 16);
+      facePtr->receive(signData(data));
+    });
+  });
+  return face;
+}
+
+static void
+runFetch(size_t nShards, size_t nInterests, size_t windowSize)
+{
+  std::vector<unique_ptr<KeyChain>> keyChains;
+  for (size_t i = 0; i < nShards; ++i) {
+    keyChains.push_back(make_unique<KeyChain>("pib-memory:", "tpm-memory:"));
+  }
+  size_t nCreated = 0;
+  FacePool pool(nShards, [&] (boost::asio::io_service& io) {
+    return makeForwarderStandIn(io, *keyChains.at(nCreated++));
+  });
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::atomic<size_t> nOutstanding{0};
+  std::atomic<size_t> nReceived{0};
+
+  auto duration = timedExecute([&] {
+    for (size_t i = 0; i < nInterests; ++i) {
+      // keep at most windowSize Interests outstanding
+      std::unique_lock<std::mutex> lock(mutex);
+      cv.wait(lock, [&] { return nOutstanding < windowSize; });
+      ++nOutstanding;
+      lock.unlock();
+
+      pool.expressInterest(*makeInterest(Name("/bench").appendSegment(i)),
+        [&] (const Interest&, const Data&) {
+          ++nReceived;
+          std::lock_guard<std::mutex> lock(mutex);
+          --nOutstanding;
+          cv.notify_all();
+        },
+        nullptr, nullptr);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    cv.wait(lock, [&] { return nReceived == nInterests; });
+  });
+
+  BOOST_CHECK_EQUAL(nReceived, nInterests);
+  std::cout << "shards=" << nShards << " interests=" << nInterests << " window=" << windowSize
+            << ": " << duration << ", "
+            << static_cast<uint64_t>(nInterests / time::duration_cast<time::duration<double>>(duration).count())
+            << " Interest-Data exchanges/s" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(ExpressInterestThroughput)
+{
+  const size_t nInterests = 200000;
+  const size_t windowSize = 1000;
+  size_t maxShards = std::max(1U, std::thread::hardware_concurrency());
+
+  for (size_t nShards = 1; nShards <= maxShards; nShards *= 2) {
+    runFetch(nShards, nInterests, windowSize);
+  }
+}
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
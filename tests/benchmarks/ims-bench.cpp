@@ -0,0 +1,283 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx InMemoryStorage Benchmark
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/ims/in-memory-storage-fifo.hpp"
+#include "ndn-cxx/ims/in-memory-storage-lfu.hpp"
+#include "ndn-cxx/ims/in-memory-storage-lru.hpp"
+#include "ndn-cxx/ims/in-memory-storage-persistent.hpp"
+#include "tests/benchmarks/timed-execute.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <boost/core/demangle.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace ndn {
+namespace tests {
+
+// The storages are measured with 1k, 10k, ... entries, up to the value of the environment variable
+// NDN_IMS_BENCH_MAX_SIZE (default 100000, at most 10000000). Ten million packets take several GB.
+const size_t DEFAULT_MAX_SIZE = 100000;
+const size_t SEGMENTS_PER_OBJECT = 100;
+const size_t CONTENT_SIZE = 100;
+const size_t MIN_LOOKUPS = 100000;
+const size_t MAX_LOOKUPS = 500000;
+
+static std::vector<size_t>
+getSizes()
+{
+  size_t maxSize = DEFAULT_MAX_SIZE;
+  const char* env = std::getenv("NDN_IMS_BENCH_MAX_SIZE");
+  if (env != nullptr) {
+    maxSize = std::min<size_t>(std::strtoull(env, nullptr, 10), 10000000);
+  }
+
+  std::vector<size_t> sizes;
+  for (size_t n = 1000; n <= maxSize; n *= 10) {
+    sizes.push_back(n);
+  }
+  return sizes;
+}
+
+/** \return bytes allocated on the heap, or 0 if unknown
+ */
+static size_t
+getHeapUsage()
+{
+#ifdef __GLIBC__
+#if __GLIBC_PREREQ(2, 33)
+  return mallinfo2().uordblks;
+#endif
+#endif
+  return 0;
+}
+
+/** \brief Packets inserted into the storage, in insertion order, and the packets looked up.
+ */
+struct Workload
+{
+  std::string name;
+  std::vector<shared_ptr<Data>> packets;
+  std::vector<shared_ptr<Data>> lookups;
+};
+
+/** \brief Make @p n segments of objects with SEGMENTS_PER_OBJECT segments each.
+ */
+static std::vector<shared_ptr<Data>>
+makePackets(size_t n)
+{
+  std::vector<shared_ptr<Data>> packets;
+  packets.reserve(n);
+  auto content = make_shared<Buffer>(CONTENT_SIZE);
+  for (size_t i = 0; i < n; ++i) {
+    auto data = make_shared<Data>(Name("/bench/object").appendNumber(i / SEGMENTS_PER_OBJECT)
+                                                       .appendSegment(i % SEGMENTS_PER_OBJECT));
+    data->setFreshnessPeriod(10_s);
+    data->setContent(content);
+    signData(data);
+    data->wireEncode();
+    packets.push_back(std::move(data));
+  }
+  return packets;
+}
+
+static size_t
+getNLookups(size_t n)
+{
+  return std::max(MIN_LOOKUPS, std::min(n, MAX_LOOKUPS));
+}
+
+/** \brief Segments are inserted and looked up in order, as when objects are published and fetched.
+ */
+static Workload
+makeSequentialWorkload(const std::vector<shared_ptr<Data>>& packets)
+{
+  Workload workload{"sequential", packets, {}};
+  size_t nLookups = getNLookups(packets.size());
+  for (size_t i = 0; i < nLookups; ++i) {
+    workload.lookups.push_back(packets[i % packets.size()]);
+  }
+  return workload;
+}
+
+/** \brief Segments are inserted in random order, and looked up following a Zipf distribution
+ *         with exponent @p alpha over a random ranking of the packets.
+ */
+static Workload
+makeZipfWorkload(const std::vector<shared_ptr<Data>>& packets, double alpha)
+{
+  std::mt19937 rng(1);
+  std::ostringstream os;
+  os << "zipf(" << alpha << ")";
+  Workload workload{os.str(), packets, {}};
+  std::shuffle(workload.packets.begin(), workload.packets.end(), rng);
+
+  std::vector<double> cdf(packets.size());
+  double sum = 0;
+  for (size_t i = 0; i < cdf.size(); ++i) {
+    sum += 1.0 / std::pow(i + 1, alpha);
+    cdf[i] = sum;
+  }
+
+  // the insertion order serves as the random ranking
+  std::uniform_real_distribution<double> dist(0, sum);
+  size_t nLookups = getNLookups(packets.size());
+  for (size_t i = 0; i < nLookups; ++i) {
+    size_t rank = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    workload.lookups.push_back(workload.packets[rank]);
+  }
+  return workload;
+}
+
+template<typename Policy>
+static unique_ptr<InMemoryStorage>
+makeStorage(boost::asio::io_service& io, size_t limit)
+{
+  return make_unique<Policy>(io, limit);
+}
+
+template<>
+unique_ptr<InMemoryStorage>
+makeStorage<InMemoryStoragePersistent>(boost::asio::io_service& io, size_t)
+{
+  return make_unique<InMemoryStoragePersistent>(io);
+}
+
+static void
+report(const Workload& workload, const std::string& policy, const std::string& operation,
+       size_t nOperations, time::nanoseconds duration)
+{
+  std::cout << workload.name << " " << policy << " n=" << workload.packets.size()
+            << " " << operation << ": "
+            << static_cast<uint64_t>(nOperations / time::duration_cast<time::duration<double>>(duration).count())
+            << " ops/s" << std::endl;
+}
+
+template<typename Policy>
+static void
+run(const Workload& workload)
+{
+  const std::string policy = boost::core::demangle(typeid(Policy).name());
+  const size_t n = workload.packets.size();
+  boost::asio::io_service io;
+
+  std::vector<Interest> exactInterests;
+  std::vector<Interest> prefixInterests;
+  for (const auto& data : workload.lookups) {
+    exactInterests.emplace_back(data->getName());
+    prefixInterests.emplace_back(data->getName().getPrefix(-1));
+    prefixInterests.back().setCanBePrefix(true);
+    prefixInterests.back().setMustBeFresh(true);
+  }
+
+  size_t heapBefore = getHeapUsage();
+  auto ims = makeStorage<Policy>(io, n);
+
+  // every other packet becomes stale right after insertion, so that MustBeFresh filters them
+  auto duration = timedExecute([&] {
+    for (size_t i = 0; i < n; ++i) {
+      ims->insert(*workload.packets[i], i % 2 == 0 ? InMemoryStorage::INFINITE_WINDOW : 1_ms);
+    }
+  });
+  report(workload, policy, "insert", n, duration);
+  BOOST_CHECK_EQUAL(ims->size(), n);
+
+  size_t heapAfter = getHeapUsage();
+  if (heapAfter > heapBefore) {
+    std::cout << workload.name << " " << policy << " n=" << n << " memory: "
+              << (heapAfter - heapBefore) / n << " bytes/entry excluding packets, "
+              << workload.packets.front()->wireEncode().size() << " bytes/packet" << std::endl;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+  size_t nFound = 0;
+  duration = timedExecute([&] {
+    for (const auto& interest : exactInterests) {
+      nFound += ims->find(interest) != nullptr;
+    }
+  });
+  report(workload, policy, "find exact", exactInterests.size(), duration);
+  BOOST_CHECK_EQUAL(nFound, exactInterests.size());
+
+  nFound = 0;
+  duration = timedExecute([&] {
+    for (const auto& interest : prefixInterests) {
+      nFound += ims->find(interest) != nullptr;
+    }
+  });
+  report(workload, policy, "find CanBePrefix+MustBeFresh", prefixInterests.size(), duration);
+  BOOST_CHECK_GT(nFound, 0);
+
+  duration = timedExecute([&] {
+    for (size_t i = 0; i < n; i += SEGMENTS_PER_OBJECT) {
+      ims->erase(Name("/bench/object").appendNumber(i / SEGMENTS_PER_OBJECT));
+    }
+  });
+  report(workload, policy, "erase object prefix (packets)", n, duration);
+  BOOST_CHECK_EQUAL(ims->size(), 0);
+
+  if (std::is_same<Policy, InMemoryStoragePersistent>::value) {
+    return;
+  }
+
+  // a storage holding a tenth of the packets evicts on nearly every insertion
+  ims = makeStorage<Policy>(io, std::max<size_t>(n / 10, 1));
+  duration = timedExecute([&] {
+    for (const auto& data : workload.packets) {
+      ims->insert(*data);
+    }
+  });
+  report(workload, policy, "insert with eviction", n, duration);
+  BOOST_CHECK_LE(ims->size(), std::max<size_t>(n / 10, 1));
+}
+
+static void
+runAllPolicies(const Workload& workload)
+{
+  run<InMemoryStorageFifo>(workload);
+  run<InMemoryStorageLru>(workload);
+  run<InMemoryStorageLfu>(workload);
+  run<InMemoryStoragePersistent>(workload);
+}
+
+BOOST_AUTO_TEST_CASE(Policies)
+{
+  for (size_t n : getSizes()) {
+    auto packets = makePackets(n);
+    runAllPolicies(makeSequentialWorkload(packets));
+    runAllPolicies(makeZipfWorkload(packets, 0.8));
+  }
+}
+
+} // namespace tests
+} // namespace ndn
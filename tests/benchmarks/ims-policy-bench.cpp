@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx InMemoryStorage Policy Benchmark
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/ims/in-memory-storage-fifo.hpp"
+#include "ndn-cxx/ims/in-memory-storage-lfu.hpp"
+#include "ndn-cxx/ims/in-memory-storage-lru.hpp"
+#include "ndn-cxx/ims/in-memory-storage-tinylfu.hpp"
+#include "tests/benchmarks/timed-execute.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <boost/core/demangle.hpp>
+#include <boost/mpl/vector.hpp>
+
+#include <iostream>
+#include <random>
+
+namespace ndn {
+namespace tests {
+
+const size_t N_OBJECTS = 20000;
+const size_t CACHE_SIZE = 1000;
+const size_t N_REQUESTS = 200000;
+
+/** \brief Packets of the trace, created once for all policies.
+ */
+static const std::vector<shared_ptr<Data>>&
+getPackets()
+{
+  static std::vector<shared_ptr<Data>> packets;
+  if (packets.empty()) {
+    for (size_t i = 0; i < N_OBJECTS; ++i) {
+      packets.push_back(makeData(Name("/bench/object").appendNumber(i)));
+    }
+  }
+  return packets;
+}
+
+/** \brief Generate N_REQUESTS object indices following a Zipf distribution with exponent
+ *         @p alpha. If @p scanInterval is not zero, a sequential scan of CACHE_SIZE objects
+ *         that are not otherwise requested is inserted every @p scanInterval requests.
+ */
+static std::vector<size_t>
+makeTrace(double alpha, size_t scanInterval)
+{
+  // the least popular half of the objects is reserved for scans
+  size_t nPopular = scanInterval > 0 ? N_OBJECTS / 2 : N_OBJECTS;
+  std::vector<double> cdf(nPopular);
+  double sum = 0;
+  for (size_t i = 0; i < nPopular; ++i) {
+    sum += 1.0 / std::pow(i + 1, alpha);
+    cdf[i] = sum;
+  }
+
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<double> dist(0, sum);
+  std::vector<size_t> trace;
+  size_t scanPosition = nPopular;
+  while (trace.size() < N_REQUESTS) {
+    if (scanInterval > 0 && trace.size() % scanInterval == 0) {
+      for (size_t i = 0; i < CACHE_SIZE; ++i) {
+        trace.push_back(scanPosition);
+        scanPosition = scanPosition + 1 < N_OBJECTS ? scanPosition + 1 : nPopular;
+      }
+    }
+    trace.push_back(std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin());
+  }
+  return trace;
+}
+
+using Policies = boost::mpl::vector<InMemoryStorageFifo,
+                                    InMemoryStorageLru,
+                                    InMemoryStorageLfu,
+                                    InMemoryStorageTinyLfu>;
+
+/** \brief Replay the trace against a cache: look up each object, and insert it on a miss.
+ */
+template<typename Policy>
+static void
+replay(const std::string& workload, const std::vector<size_t>& trace)
+{
+  const auto& packets = getPackets();
+  std::vector<Interest> interests;
+  interests.reserve(N_OBJECTS);
+  for (const auto& data : packets) {
+    interests.emplace_back(data->getName());
+  }
+
+  Policy ims(CACHE_SIZE);
+  size_t nHits = 0;
+  auto duration = timedExecute([&] {
+    for (size_t index : trace) {
+      if (ims.find(interests[index]) != nullptr) {
+        ++nHits;
+      }
+      else {
+        ims.insert(*packets[index]);
+      }
+    }
+  });
+
+  BOOST_CHECK_LE(ims.size(), CACHE_SIZE);
+  std::cout << workload << " " << boost::core::demangle(typeid(Policy).name())
+            << ": hit ratio " << static_cast<double>(nHits) / trace.size()
+            << ", " << static_cast<uint64_t>(trace.size() /
+                                             time::duration_cast<time::duration<double>>(duration).count())
+            << " ops/s" << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(Zipf, Policy, Policies)
+{
+  replay<Policy>("zipf(0.8)", makeTrace(0.8, 0));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ZipfWithScans, Policy, Policies)
+{
+  replay<Policy>("zipf(0.8)+scans", makeTrace(0.8, 5000));
+}
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,79 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx InterestTemplate Benchmark
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/interest-template.hpp"
+#include "tests/benchmarks/timed-execute.hpp"
+
+#include <iostream>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_CASE(SegmentInterests)
+{
+  const uint64_t nInterests = 1000000;
+
+  Interest prototype(Name("/example/repo/object/file.bin").appendVersion(1586883360));
+  prototype.setCanBePrefix(false);
+  prototype.setMustBeFresh(false);
+  prototype.setInterestLifetime(4_s);
+  prototype.refreshNonce();
+
+  size_t totalSize = 0;
+
+  // what SegmentFetcher used to do for each segment
+  auto d1 = timedExecute([&] {
+    for (uint64_t seg = 0; seg < nInterests; ++seg) {
+      Interest interest(prototype);
+      interest.setName(Name(prototype.getName()).appendSegment(seg));
+      interest.refreshNonce();
+      totalSize += interest.wireEncode().size();
+    }
+  });
+
+  InterestTemplate tpl(prototype);
+
+  auto d2 = timedExecute([&] {
+    for (uint64_t seg = 0; seg < nInterests; ++seg) {
+      totalSize += tpl.makeSegmentWire(seg).size();
+    }
+  });
+
+  auto d3 = timedExecute([&] {
+    for (uint64_t seg = 0; seg < nInterests; ++seg) {
+      totalSize += tpl.makeSegmentInterest(seg).wireEncode().size();
+    }
+  });
+
+  BOOST_CHECK_GT(totalSize, 0);
+  std::cout << "Interest copy + setName + refreshNonce + wireEncode, " << nInterests << " segments: "
+            << d1 << std::endl;
+  std::cout << "InterestTemplate::makeSegmentWire, " << nInterests << " segments: "
+            << d2 << std::endl;
+  std::cout << "InterestTemplate::makeSegmentInterest, " << nInterests << " segments: "
+            << d3 << std::endl;
+}
+
+} // namespace tests
+} // namespace ndn
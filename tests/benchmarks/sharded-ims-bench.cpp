@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#define BOOST_TEST_MODULE ndn-cxx ShardedInMemoryStorage Benchmark
+#include "tests/boost-test.hpp"
+
+#include "ndn-cxx/ims/in-memory-storage-lru.hpp"
+#include "ndn-cxx/ims/sharded-in-memory-storage.hpp"
+#include "tests/benchmarks/timed-execute.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+/** \brief Insert then look up nPacketsPerThread packets from each of nThreads threads, each
+ *         thread publishing its own object, and report the aggregate throughput.
+ */
+static void
+runInsertFind(size_t nThreads, size_t nShards, size_t nPacketsPerThread)
+{
+  std::vector<std::vector<shared_ptr<Data>>> packets(nThreads);
+  std::vector<std::vector<shared_ptr<Interest>>> interests(nThreads);
+  for (size_t t = 0; t < nThreads; ++t) {
+    for (size_t i = 0; i < nPacketsPerThread; ++i) {
+      // one object per (thread, i / 100) pair, so that objects spread across shards
+      Name name = Name("/bench").appendNumber(t).appendNumber(i / 100).appendSegment(i % 100);
+      packets[t].push_back(makeData(name));
+      interests[t].push_back(makeInterest(name));
+    }
+  }
+
+  ShardedInMemoryStorage ims(nShards, 3, [&] {
+    return make_unique<InMemoryStorageLru>(nThreads * nPacketsPerThread);
+  });
+
+  auto runThreads = [&] (const std::function<void(size_t)>& f) {
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < nThreads; ++t) {
+      threads.emplace_back(f, t);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  };
+
+  auto insertTime = timedExecute([&] {
+    runThreads([&] (size_t t) {
+      for (const auto& data : packets[t]) {
+        ims.insert(*data);
+      }
+    });
+  });
+
+  std::atomic<size_t> nFound{0};
+  auto findTime = timedExecute([&] {
+    runThreads([&] (size_t t) {
+      size_t n = 0;
+      for (const auto& interest : interests[t]) {
+        n += ims.find(*interest) != nullptr;
+      }
+      nFound += n;
+    });
+  });
+
+  size_t nTotal = nThreads * nPacketsPerThread;
+  BOOST_CHECK_EQUAL(ims.size(), nTotal);
+  BOOST_CHECK_EQUAL(nFound, nTotal);
+
+  auto toRate = [nTotal] (time::nanoseconds d) {
+    return static_cast<uint64_t>(nTotal / time::duration_cast<time::duration<double>>(d).count());
+  };
+  std::cout << "threads=" << nThreads << " shards=" << nShards << " packets=" << nTotal
+            << ": insert " << toRate(insertTime) << "/s, find " << toRate(findTime) << "/s"
+            << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindScaling)
+{
+  const size_t nPacketsPerThread = 100000;
+  size_t maxThreads = std::max(1U, std::thread::hardware_concurrency());
+
+  for (size_t nThreads = 1; nThreads <= maxThreads; nThreads *= 2) {
+    // a single shard shows the cost of funneling every operation through one lock
+    runInsertFind(nThreads, 1, nPacketsPerThread);
+    runInsertFind(nThreads, 4 * nThreads, nPacketsPerThread);
+  }
+}
+
+} // namespace tests
+} // namespace ndn
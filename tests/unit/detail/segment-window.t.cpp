@@ -0,0 +1,215 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/detail/segment-window.hpp"
+
+#include "tests/boost-test.hpp"
+
+namespace ndn {
+namespace detail {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(Detail)
+BOOST_AUTO_TEST_SUITE(TestSegmentWindow)
+
+BOOST_AUTO_TEST_SUITE(Ring)
+
+BOOST_AUTO_TEST_CASE(Basic)
+{
+  SegmentRing<std::string> ring(16, 4);
+  BOOST_CHECK(ring.empty());
+  BOOST_CHECK(ring.find(0) == nullptr);
+  BOOST_CHECK_EQUAL(ring.erase(0), false);
+
+  ring.emplace(5, "five");
+  ring.emplace(3, "three");
+  ring.emplace(7, "seven");
+  BOOST_CHECK_EQUAL(ring.size(), 3);
+  BOOST_CHECK_EQUAL(ring.front(), 3);
+  BOOST_REQUIRE(ring.find(5) != nullptr);
+  BOOST_CHECK_EQUAL(*ring.find(5), "five");
+  BOOST_CHECK(ring.find(4) == nullptr);
+  BOOST_CHECK(ring.find(9) == nullptr);
+
+  // grows beyond the initial capacity
+  ring.emplace(12, "twelve");
+  BOOST_REQUIRE(ring.find(12) != nullptr);
+  BOOST_CHECK_EQUAL(*ring.find(12), "twelve");
+  BOOST_CHECK_EQUAL(*ring.find(3), "three");
+  BOOST_CHECK_EQUAL(*ring.find(7), "seven");
+
+  BOOST_CHECK_EQUAL(ring.erase(3), true);
+  BOOST_CHECK_EQUAL(ring.erase(3), false);
+  BOOST_CHECK_EQUAL(ring.front(), 5);
+
+  BOOST_CHECK_EQUAL(ring.eraseFrom(7), 2);
+  BOOST_CHECK_EQUAL(ring.size(), 1);
+  BOOST_CHECK(ring.find(12) == nullptr);
+
+  ring.clear();
+  BOOST_CHECK(ring.empty());
+  ring.emplace(1000, "thousand");
+  BOOST_CHECK_EQUAL(ring.front(), 1000);
+}
+
+BOOST_AUTO_TEST_CASE(Overflow)
+{
+  SegmentRing<int> ring(8, 8);
+
+  // a segment far ahead, e.g. the reply to a discovery Interest
+  ring.emplace(100, 100);
+  for (int i = 0; i < 8; ++i) {
+    ring.emplace(i, i);
+  }
+  ring.emplace(20, 20);
+  BOOST_CHECK_EQUAL(ring.size(), 10);
+  BOOST_CHECK_EQUAL(ring.front(), 0);
+  for (int i = 0; i < 8; ++i) {
+    BOOST_REQUIRE(ring.find(i) != nullptr);
+    BOOST_CHECK_EQUAL(*ring.find(i), i);
+  }
+  BOOST_REQUIRE(ring.find(20) != nullptr);
+  BOOST_CHECK_EQUAL(*ring.find(20), 20);
+  BOOST_REQUIRE(ring.find(100) != nullptr);
+  BOOST_CHECK_EQUAL(*ring.find(100), 100);
+
+  for (int i = 0; i < 8; ++i) {
+    ring.erase(i);
+  }
+  BOOST_CHECK_EQUAL(ring.front(), 20);
+  BOOST_CHECK_EQUAL(ring.eraseFrom(50), 1);
+  BOOST_CHECK_EQUAL(ring.size(), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // Ring
+
+BOOST_AUTO_TEST_CASE(Bitmap)
+{
+  SegmentBitmap bitmap;
+  BOOST_CHECK_EQUAL(bitmap.size(), 0);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), 0);
+
+  BOOST_CHECK_EQUAL(bitmap.insert(200), true);
+  BOOST_CHECK_EQUAL(bitmap.insert(200), false);
+  BOOST_CHECK_EQUAL(bitmap.contains(200), true);
+  BOOST_CHECK_EQUAL(bitmap.contains(199), false);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), 0);
+
+  for (uint64_t i = 0; i < 130; ++i) {
+    BOOST_CHECK_EQUAL(bitmap.insert(i), true);
+  }
+  BOOST_CHECK_EQUAL(bitmap.size(), 131);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), 130);
+  BOOST_CHECK_EQUAL(bitmap.contains(5), true);
+  BOOST_CHECK_EQUAL(bitmap.insert(5), false);
+  BOOST_CHECK_EQUAL(bitmap.contains(130), false);
+  BOOST_CHECK_EQUAL(bitmap.contains(200), true);
+
+  bitmap.insert(201);
+  bitmap.insert(135);
+  using Ranges = std::vector<std::pair<uint64_t, uint64_t>>;
+  Ranges ranges = bitmap.getRanges();
+  Ranges expectedRanges{{0, 130}, {135, 136}, {200, 202}};
+  BOOST_CHECK(ranges == expectedRanges);
+  BOOST_CHECK(SegmentBitmap().getRanges().empty());
+
+  SegmentBitmap skipped;
+  skipped.skipTo(70);
+  BOOST_CHECK_EQUAL(skipped.size(), 70);
+  BOOST_CHECK_EQUAL(skipped.contains(69), true);
+  BOOST_CHECK_EQUAL(skipped.getFirstMissing(), 70);
+  BOOST_CHECK_EQUAL(skipped.insert(65), false);
+  BOOST_CHECK_EQUAL(skipped.insert(72), true);
+  expectedRanges = {{0, 70}, {72, 73}};
+  BOOST_CHECK(skipped.getRanges() == expectedRanges);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapFarSegments)
+{
+  using Ranges = std::vector<std::pair<uint64_t, uint64_t>>;
+  const uint64_t huge = uint64_t(1) << 60;
+
+  SegmentBitmap bitmap;
+  BOOST_CHECK_EQUAL(bitmap.insert(huge), true);
+  BOOST_CHECK_EQUAL(bitmap.insert(huge), false);
+  BOOST_CHECK_EQUAL(bitmap.insert(std::numeric_limits<uint64_t>::max()), false);
+  BOOST_CHECK_EQUAL(bitmap.contains(huge), true);
+  BOOST_CHECK_EQUAL(bitmap.contains(huge - 1), false);
+  BOOST_CHECK_EQUAL(bitmap.size(), 1);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), 0);
+
+  // a segment just beyond the bitmap span is kept as a range, and moved into the bitmap
+  // once the lower segments are received
+  const uint64_t span = SegmentBitmap::MAX_WORDS * 64;
+  BOOST_CHECK_EQUAL(bitmap.insert(span + 1), true);
+  BOOST_CHECK_EQUAL(bitmap.insert(span + 2), true);
+  Ranges expectedRanges{{span + 1, span + 3}, {huge, huge + 1}};
+  BOOST_CHECK(bitmap.getRanges() == expectedRanges);
+
+  for (uint64_t i = 0; i < 128; ++i) {
+    bitmap.insert(i);
+  }
+  BOOST_CHECK_EQUAL(bitmap.contains(span + 2), true);
+  BOOST_CHECK_EQUAL(bitmap.contains(span + 3), false);
+  BOOST_CHECK_EQUAL(bitmap.insert(span + 2), false);
+  BOOST_CHECK_EQUAL(bitmap.size(), 128 + 3);
+  expectedRanges = {{0, 128}, {span + 1, span + 3}, {huge, huge + 1}};
+  BOOST_CHECK(bitmap.getRanges() == expectedRanges);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapInsertRange)
+{
+  using Ranges = std::vector<std::pair<uint64_t, uint64_t>>;
+
+  SegmentBitmap bitmap;
+  bitmap.insert(3);
+  bitmap.insert(100);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(10, 20), 10);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(15, 25), 5);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(25, 25), 0);
+  BOOST_CHECK_EQUAL(bitmap.size(), 2 + 15);
+  Ranges expectedRanges{{3, 4}, {10, 25}, {100, 101}};
+  BOOST_CHECK(bitmap.getRanges() == expectedRanges);
+
+  // a range covering the start of the set moves the base
+  BOOST_CHECK_EQUAL(bitmap.insertRange(0, 1000000000), 1000000000 - 17);
+  BOOST_CHECK_EQUAL(bitmap.size(), 1000000000);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), 1000000000);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(0, 1000000000), 0);
+
+  // a long range far ahead is kept as a range, then joined with the base
+  const uint64_t first = 2000000000;
+  BOOST_CHECK_EQUAL(bitmap.insertRange(first, first + 1000000000), 1000000000);
+  BOOST_CHECK_EQUAL(bitmap.insert(first + 5), false);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(first - 10, first + 10), 10);
+  BOOST_CHECK_EQUAL(bitmap.insertRange(1000000000, first - 10), first - 10 - 1000000000);
+  BOOST_CHECK_EQUAL(bitmap.size(), first + 1000000000);
+  BOOST_CHECK_EQUAL(bitmap.getFirstMissing(), first + 1000000000);
+  expectedRanges = {{0, first + 1000000000}};
+  BOOST_CHECK(bitmap.getRanges() == expectedRanges);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestSegmentWindow
+BOOST_AUTO_TEST_SUITE_END() // Detail
+
+} // namespace tests
+} // namespace detail
+} // namespace ndn
@@ -0,0 +1,212 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/face-counters.hpp"
+#include "ndn-cxx/mgmt/dispatcher.hpp"
+#include "ndn-cxx/util/dummy-client-face.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+#include "tests/unit/identity-management-time-fixture.hpp"
+
+namespace ndn {
+namespace tests {
+
+using util::DummyClientFace;
+
+class FaceCountersFixture : public IdentityManagementTimeFixture
+{
+protected:
+  FaceCountersFixture()
+    : face(io, m_keyChain, {true, true})
+  {
+  }
+
+protected:
+  DummyClientFace face;
+};
+
+BOOST_FIXTURE_TEST_SUITE(TestFaceCounters, FaceCountersFixture)
+
+BOOST_AUTO_TEST_CASE(HistogramBuckets)
+{
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(0_ns), 0);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(999_ns), 0);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(1_us), 1);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(3_us), 2);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(4_us), 3);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(1_ms), 10);
+  BOOST_CHECK_EQUAL(LatencyHistogram::getBucketIndex(time::hours(24 * 365)),
+                    LatencyHistogram::N_BUCKETS - 1);
+
+  LatencyHistogram h;
+  for (int i = 0; i < 9; ++i) {
+    h.record(3_us);
+  }
+  h.record(1_ms);
+
+  auto s = h.snapshot();
+  BOOST_CHECK_EQUAL(s.nSamples, 10);
+  BOOST_CHECK_EQUAL(s.sum, 1027_us);
+  BOOST_CHECK_EQUAL(s.buckets[2], 9);
+  BOOST_CHECK_EQUAL(s.buckets[10], 1);
+  BOOST_CHECK_EQUAL(s.getMean(), 102_us);
+  BOOST_CHECK_EQUAL(s.getQuantile(0.5), 4_us);
+  BOOST_CHECK_EQUAL(s.getQuantile(0.9), 4_us);
+  BOOST_CHECK_EQUAL(s.getQuantile(0.99), 1024_us);
+
+  BOOST_CHECK_EQUAL(LatencyHistogram::Snapshot().getQuantile(0.5), 0_us);
+}
+
+BOOST_AUTO_TEST_CASE(Consumer)
+{
+  face.getCounters().trackLatency("/A");
+  face.getCounters().trackLatency("/A"); // no effect
+  face.getCounters().trackLatency("/B");
+
+  face.expressInterest(*makeInterest("/A/1", true), nullptr, nullptr, nullptr);
+  face.expressInterest(*makeInterest("/B/1", true), nullptr, nullptr, nullptr);
+  face.expressInterest(*makeInterest("/C/1", true), nullptr, nullptr, nullptr);
+  advanceClocks(10_ms);
+
+  auto s = face.getCountersSnapshot();
+  BOOST_CHECK_EQUAL(s.nOutInterests, 3);
+  BOOST_CHECK_EQUAL(s.nPendingInterests, 3);
+  BOOST_CHECK_GT(s.nOutBytes, 0);
+
+  advanceClocks(10_ms);
+  face.receive(*makeData("/A/1"));
+  advanceClocks(40_ms);
+  face.receive(*makeData("/C/1"));
+  face.receive(lp::Nack(*makeInterest("/B/1", true)));
+  advanceClocks(10_ms);
+
+  s = face.getCountersSnapshot();
+  BOOST_CHECK_EQUAL(s.nInData, 2);
+  BOOST_CHECK_EQUAL(s.nInNacks, 1);
+  BOOST_CHECK_EQUAL(s.nSatisfiedInterests, 2);
+  BOOST_CHECK_EQUAL(s.nPendingInterests, 0);
+  BOOST_CHECK_GT(s.nInBytes, 0);
+
+  BOOST_CHECK_EQUAL(s.latency.nSamples, 2);
+  BOOST_CHECK_EQUAL(s.latency.sum, 60_ms);
+  BOOST_REQUIRE_EQUAL(s.prefixLatency.size(), 2);
+  BOOST_CHECK_EQUAL(s.prefixLatency[0].first, "/A");
+  BOOST_CHECK_EQUAL(s.prefixLatency[0].second.nSamples, 1);
+  BOOST_CHECK_EQUAL(s.prefixLatency[0].second.sum, 10_ms);
+  BOOST_CHECK_EQUAL(s.prefixLatency[1].first, "/B");
+  BOOST_CHECK_EQUAL(s.prefixLatency[1].second.nSamples, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Producer)
+{
+  face.setInterestFilter("/P", [this] (const auto&, const Interest& interest) {
+    face.put(*makeData(interest.getName()));
+  });
+  advanceClocks(10_ms);
+  auto base = face.getCountersSnapshot();
+
+  face.receive(*makeInterest("/P/1"));
+  face.receive(*makeInterest("/Q/1"));
+  advanceClocks(10_ms);
+
+  auto s = face.getCountersSnapshot();
+  BOOST_CHECK_EQUAL(s.nInInterests - base.nInInterests, 2);
+  BOOST_CHECK_EQUAL(s.nDispatchedInterests - base.nDispatchedInterests, 1);
+  BOOST_CHECK_EQUAL(s.nOutData - base.nOutData, 1);
+  BOOST_CHECK_GT(s.nOutBytes, base.nOutBytes);
+}
+
+BOOST_AUTO_TEST_CASE(EncodeDecode)
+{
+  FaceCounters::Snapshot s1;
+  s1.nInInterests = 1;
+  s1.nOutInterests = 2;
+  s1.nInData = 3;
+  s1.nOutData = 4;
+  s1.nInNacks = 5;
+  s1.nOutNacks = 6;
+  s1.nInBytes = 7;
+  s1.nOutBytes = 8;
+  s1.nSatisfiedInterests = 9;
+  s1.nDispatchedInterests = 10;
+  s1.nPendingInterests = 11;
+  s1.sendQueueBytes = 12;
+  s1.sendQueuePackets = 13;
+  s1.latency.nSamples = 2;
+  s1.latency.sum = 300_us;
+  s1.latency.buckets[8] = 2;
+  s1.prefixLatency.emplace_back("/A", s1.latency);
+  s1.prefixLatency.emplace_back("/B", LatencyHistogram::Snapshot());
+
+  Block wire = s1.wireEncode();
+  BOOST_CHECK_EQUAL(wire.type(), tlv::counters::FaceCounters);
+
+  FaceCounters::Snapshot s2(wire);
+  BOOST_CHECK_EQUAL(s2.nInInterests, 1);
+  BOOST_CHECK_EQUAL(s2.nOutInterests, 2);
+  BOOST_CHECK_EQUAL(s2.nInData, 3);
+  BOOST_CHECK_EQUAL(s2.nOutData, 4);
+  BOOST_CHECK_EQUAL(s2.nInNacks, 5);
+  BOOST_CHECK_EQUAL(s2.nOutNacks, 6);
+  BOOST_CHECK_EQUAL(s2.nInBytes, 7);
+  BOOST_CHECK_EQUAL(s2.nOutBytes, 8);
+  BOOST_CHECK_EQUAL(s2.nSatisfiedInterests, 9);
+  BOOST_CHECK_EQUAL(s2.nDispatchedInterests, 10);
+  BOOST_CHECK_EQUAL(s2.nPendingInterests, 11);
+  BOOST_CHECK_EQUAL(s2.sendQueueBytes, 12);
+  BOOST_CHECK_EQUAL(s2.sendQueuePackets, 13);
+  BOOST_CHECK_EQUAL(s2.latency.nSamples, 2);
+  BOOST_CHECK_EQUAL(s2.latency.sum, 300_us);
+  BOOST_CHECK_EQUAL_COLLECTIONS(s2.latency.buckets.begin(), s2.latency.buckets.end(),
+                                s1.latency.buckets.begin(), s1.latency.buckets.end());
+  BOOST_REQUIRE_EQUAL(s2.prefixLatency.size(), 2);
+  BOOST_CHECK_EQUAL(s2.prefixLatency[0].first, "/A");
+  BOOST_CHECK_EQUAL(s2.prefixLatency[0].second.nSamples, 2);
+  BOOST_CHECK_EQUAL(s2.prefixLatency[1].first, "/B");
+  BOOST_CHECK_EQUAL(s2.prefixLatency[1].second.nSamples, 0);
+
+  BOOST_CHECK_THROW(FaceCounters::Snapshot(Block(tlv::Name)), FaceCounters::Snapshot::Error);
+}
+
+BOOST_AUTO_TEST_CASE(StatusDataset)
+{
+  mgmt::Dispatcher dispatcher(face, m_keyChain);
+  dispatcher.addStatusDataset("counters", mgmt::makeAcceptAllAuthorization(),
+                              makeFaceCountersDatasetHandler(face));
+  dispatcher.addTopPrefix("/localhost/app", false);
+  advanceClocks(10_ms);
+  face.sentData.clear();
+
+  face.receive(*makeInterest("/localhost/app/counters", true));
+  advanceClocks(10_ms);
+
+  BOOST_REQUIRE_EQUAL(face.sentData.size(), 1);
+  Block payload = face.sentData[0].getContent().blockFromValue();
+  FaceCounters::Snapshot s(payload);
+  BOOST_CHECK_EQUAL(s.nInInterests, 1);
+  BOOST_CHECK_EQUAL(s.nDispatchedInterests, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFaceCounters
+
+} // namespace tests
+} // namespace ndn
@@ -32,6 +32,8 @@
 
 #include <boost/logic/tribool.hpp>
 
+#include <deque>
+
 namespace ndn {
 namespace tests {
 
@@ -319,6 +321,64 @@ BOOST_AUTO_TEST_CASE(Handle)
   BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE(Batch)
+{
+  std::vector<Interest> interests{*makeInterest("/A/0", false, 50_ms),
+                                  *makeInterest("/A/1", false, 50_ms),
+                                  *makeInterest("/A/2", false, 50_ms)};
+  std::vector<Name> satisfied;
+  std::vector<Name> timedOut;
+  auto hdls = face.expressInterests(interests,
+                                    [&] (const Interest& i, const Data&) { satisfied.push_back(i.getName()); },
+                                    bind([] { BOOST_FAIL("Unexpected Nack"); }),
+                                    [&] (const Interest& i) { timedOut.push_back(i.getName()); });
+  BOOST_REQUIRE_EQUAL(hdls.size(), 3);
+
+  advanceClocks(1_ms);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 3);
+  for (size_t i = 0; i < interests.size(); ++i) {
+    BOOST_CHECK_EQUAL(face.sentInterests[i].getName(), interests[i].getName());
+    BOOST_CHECK(face.sentInterests[i].hasNonce());
+  }
+  BOOST_CHECK_EQUAL(face.getNPendingInterests(), 3);
+
+  hdls[1].cancel();
+  advanceClocks(1_ms);
+  face.receive(*makeData("/A/0"));
+  face.receive(*makeData("/A/1"));
+  advanceClocks(50_ms, 2);
+
+  BOOST_REQUIRE_EQUAL(satisfied.size(), 1);
+  BOOST_CHECK_EQUAL(satisfied[0], "/A/0");
+  BOOST_REQUIRE_EQUAL(timedOut.size(), 1);
+  BOOST_CHECK_EQUAL(timedOut[0], "/A/2");
+  BOOST_CHECK_EQUAL(face.getNPendingInterests(), 0);
+
+  // empty batch
+  BOOST_CHECK_EQUAL(face.expressInterests({}, nullptr, nullptr, nullptr).size(), 0);
+  advanceClocks(1_ms);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(BatchOversized)
+{
+  std::vector<Interest> interests{*makeInterest("/A/0", false, 50_ms),
+                                  *makeInterest("/A/1", false, 50_ms),
+                                  *makeInterest("/A/2", false, 50_ms)};
+  std::vector<uint8_t> parameters(MAX_NDN_PACKET_SIZE);
+  interests.back().setApplicationParameters(parameters.data(), parameters.size());
+
+  BOOST_CHECK_THROW(face.expressInterests(interests,
+                                          bind([] { BOOST_FAIL("Unexpected Data"); }),
+                                          bind([] { BOOST_FAIL("Unexpected Nack"); }),
+                                          bind([] { BOOST_FAIL("Unexpected timeout"); })),
+                    Face::OversizedPacketError);
+  advanceClocks(1_ms);
+  BOOST_CHECK_EQUAL(face.getNPendingInterests(), 0);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 0);
+  advanceClocks(50_ms, 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // ExpressInterest
 
 BOOST_AUTO_TEST_CASE(RemoveAllPendingInterests)
@@ -982,6 +1042,145 @@ BOOST_FIXTURE_TEST_CASE(ExplicitTransport, WithEnvAndConfig)
 
 BOOST_AUTO_TEST_SUITE_END() // Transport
 
+BOOST_AUTO_TEST_SUITE(SendQueue)
+
+/** \brief A transport that holds sent packets in its send queue until flush() is called
+ */
+class QueueingTransport : public Transport
+{
+public:
+  void
+  connect(boost::asio::io_service& ioService, ReceiveCallback receiveCallback) final
+  {
+    Transport::connect(ioService, std::move(receiveCallback));
+    m_isConnected = true;
+  }
+
+  void
+  close() final
+  {
+    m_isConnected = false;
+    queue.clear();
+    afterQueueCleared();
+  }
+
+  void
+  send(const Block& wire) final
+  {
+    queue.push_back(wire);
+    afterEnqueue(wire.size(), 1);
+  }
+
+  void
+  send(const Block& header, const Block& payload) final
+  {
+    queue.push_back(payload);
+    afterEnqueue(header.size() + payload.size(), 1);
+  }
+
+  void
+  pause() final
+  {
+    m_isReceiving = false;
+  }
+
+  void
+  resume() final
+  {
+    m_isReceiving = true;
+  }
+
+  /** \brief write out the first \p n packets in the queue
+   */
+  void
+  flush(size_t n)
+  {
+    for (; n > 0 && !queue.empty(); --n) {
+      size_t nBytes = queue.front().size();
+      queue.pop_front();
+      afterDequeue(nBytes, 1);
+    }
+  }
+
+public:
+  std::deque<Block> queue;
+};
+
+BOOST_AUTO_TEST_CASE(Watermarks)
+{
+  auto transport = make_shared<QueueingTransport>();
+  Face face2(transport, io, m_keyChain);
+
+  BOOST_CHECK_THROW(face2.setSendQueueWatermarks({100, 200}), std::invalid_argument);
+  BOOST_CHECK_THROW(face2.setSendQueueWatermarks({SIZE_MAX, 0, 3, 4}), std::invalid_argument);
+  face2.setSendQueueWatermarks({SIZE_MAX, 0, 3, 1});
+
+  int nHigh = 0;
+  int nDrained = 0;
+  face2.onSendQueueHigh.connect([&] { ++nHigh; });
+  face2.onSendQueueDrained.connect([&] { ++nDrained; });
+
+  for (int i = 0; i < 3; ++i) {
+    BOOST_CHECK(face2.tryPut(*makeData(Name("/A").appendSegment(i))));
+    BOOST_CHECK_EQUAL(face2.getSendQueuePackets(), i + 1);
+  }
+  BOOST_CHECK_EQUAL(transport->queue.size(), 3);
+  BOOST_CHECK_EQUAL(face2.getSendQueueBytes(),
+                    transport->queue[0].size() + transport->queue[1].size() + transport->queue[2].size());
+  BOOST_CHECK(face2.isSendQueueHigh());
+  BOOST_CHECK_EQUAL(nHigh, 1);
+  BOOST_CHECK_EQUAL(nDrained, 0);
+
+  BOOST_CHECK(!face2.tryPut(*makeData("/A/refused")));
+  BOOST_CHECK_EQUAL(transport->queue.size(), 3);
+
+  // still above the low watermark
+  transport->flush(1);
+  BOOST_CHECK(face2.isSendQueueHigh());
+  BOOST_CHECK(!face2.tryPut(*makeData("/A/refused")));
+  BOOST_CHECK_EQUAL(nDrained, 0);
+
+  transport->flush(1);
+  BOOST_CHECK(!face2.isSendQueueHigh());
+  BOOST_CHECK_EQUAL(nDrained, 1);
+  BOOST_CHECK(face2.tryPut(*makeData("/A/accepted")));
+  BOOST_CHECK_EQUAL(face2.getSendQueuePackets(), 2);
+
+  // put() is not subject to watermarks, but still accounted for
+  face2.put(*makeData("/A/put"));
+  advanceClocks(1_ms);
+  BOOST_CHECK_EQUAL(face2.getSendQueuePackets(), 3);
+  BOOST_CHECK_EQUAL(nHigh, 2);
+
+  face2.shutdown();
+  advanceClocks(1_ms);
+  BOOST_CHECK_EQUAL(face2.getSendQueuePackets(), 0);
+  BOOST_CHECK_EQUAL(face2.getSendQueueBytes(), 0);
+  BOOST_CHECK_EQUAL(nDrained, 2);
+}
+
+BOOST_AUTO_TEST_CASE(ByteWatermark)
+{
+  auto transport = make_shared<QueueingTransport>();
+  Face face2(transport, io, m_keyChain);
+
+  auto data = makeData("/B");
+  size_t dataSize = data->wireEncode().size();
+  face2.setSendQueueWatermarks({2 * dataSize, dataSize});
+
+  BOOST_CHECK(face2.tryPut(*data));
+  BOOST_CHECK(!face2.isSendQueueHigh());
+  BOOST_CHECK(face2.tryPut(*data));
+  BOOST_CHECK(face2.isSendQueueHigh());
+  BOOST_CHECK(!face2.tryPut(*data));
+
+  transport->flush(1);
+  BOOST_CHECK(!face2.isSendQueueHigh());
+  BOOST_CHECK(face2.tryPut(*data));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // SendQueue
+
 BOOST_AUTO_TEST_SUITE_END() // TestFace
 
 } // namespace tests
@@ -0,0 +1,379 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/disk-storage.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+using namespace ndn::tests;
+
+class DiskStorageFixture
+{
+protected:
+  DiskStorageFixture()
+    : filepath(boost::filesystem::path(UNIT_TEST_CONFIG_PATH) / "TestDiskStorage" / "log")
+    , filename(filepath.string())
+  {
+    boost::filesystem::create_directories(filepath.parent_path());
+    boost::filesystem::remove(filepath);
+  }
+
+  ~DiskStorageFixture()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(filepath.parent_path(), ec); // ignore error
+  }
+
+protected:
+  const boost::filesystem::path filepath;
+  const std::string filename;
+};
+
+BOOST_AUTO_TEST_SUITE(Ims)
+BOOST_FIXTURE_TEST_SUITE(TestDiskStorage, DiskStorageFixture)
+
+BOOST_AUTO_TEST_CASE(InsertFind)
+{
+  DiskStorage storage(filename);
+  BOOST_CHECK_EQUAL(storage.size(), 0);
+  uint64_t headerSize = storage.getFileSize();
+  BOOST_CHECK_GT(headerSize, 0);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), headerSize);
+
+  auto data1 = makeData("/A/B/1");
+  auto data2 = makeData("/A/B/2");
+  storage.insert(*data1);
+  storage.insert(*data2);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  BOOST_CHECK_EQUAL(storage.getFileSize(),
+                    headerSize + data1->wireEncode().size() + data2->wireEncode().size());
+  BOOST_CHECK_EQUAL(storage.getNGarbageBytes(), 0);
+
+  auto found = storage.find(Name("/A/B/2"));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->wireEncode(), data2->wireEncode());
+
+  found = storage.find(data1->getFullName());
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->wireEncode(), data1->wireEncode());
+
+  found = storage.find(Name("/A"));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), "/A/B/1");
+
+  BOOST_CHECK(storage.find(Name("/C")) == nullptr);
+  BOOST_CHECK(storage.find(Name(data2->getName()).appendImplicitSha256Digest(
+                                  data1->getFullName()[-1].value(), 32)) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(FindInterest)
+{
+  DiskStorage storage(filename);
+  storage.insert(*makeData("/A/B/1"));
+  storage.insert(*makeData("/A/B/2"));
+
+  BOOST_CHECK(storage.find(*makeInterest("/A/B", false)) == nullptr);
+  auto found = storage.find(*makeInterest("/A/B", true));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), "/A/B/1");
+
+  found = storage.find(*makeInterest("/A/B/2", false));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), "/A/B/2");
+
+  // freshness is not kept on disk
+  auto interest = makeInterest("/A/B/2", false);
+  interest->setMustBeFresh(true);
+  BOOST_CHECK(storage.find(*interest) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Replace)
+{
+  DiskStorage storage(filename);
+  auto data1 = makeData("/A");
+  auto data2 = makeData("/A");
+  data2->setContent(reinterpret_cast<const uint8_t*>("new"), 3);
+  signData(data2);
+
+  storage.insert(*data1);
+  storage.insert(*data2);
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+  BOOST_CHECK_EQUAL(storage.getNGarbageBytes(), data1->wireEncode().size());
+
+  auto found = storage.find(Name("/A"));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->wireEncode(), data2->wireEncode());
+  BOOST_CHECK(storage.find(data1->getFullName()) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Erase)
+{
+  DiskStorage storage(filename);
+  auto data1 = makeData("/A/1");
+  storage.insert(*data1);
+  storage.insert(*makeData("/A/2"));
+  storage.insert(*makeData("/A/3"));
+  storage.insert(*makeData("/B"));
+
+  storage.erase(data1->getFullName(), false);
+  BOOST_CHECK_EQUAL(storage.size(), 3);
+  BOOST_CHECK(storage.find(Name("/A/1")) == nullptr);
+
+  storage.erase("/A/2", false);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+
+  // erasing nothing does not write a tombstone
+  uint64_t fileSize = storage.getFileSize();
+  storage.erase("/A/2", false);
+  storage.erase("/C");
+  BOOST_CHECK_EQUAL(storage.getFileSize(), fileSize);
+
+  storage.erase("/A");
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+  BOOST_CHECK(storage.find(Name("/A")) == nullptr);
+  BOOST_CHECK(storage.find(Name("/B")) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Reopen)
+{
+  auto data = makeData("/A/2");
+  {
+    DiskStorage storage(filename);
+    storage.insert(*makeData("/A/1"));
+    storage.insert(*makeData("/A/1"));
+    storage.insert(*data);
+    storage.insert(*makeData("/B/1"));
+    storage.insert(*makeData("/B/2"));
+    storage.insert(*makeData("/C"));
+    storage.erase("/A/1", false);
+    storage.erase("/B");
+  }
+
+  DiskStorage storage(filename);
+  BOOST_CHECK_EQUAL(storage.size(), 2);
+  auto found = storage.find(Name("/A"));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->wireEncode(), data->wireEncode());
+  BOOST_CHECK(storage.find(Name("/B")) == nullptr);
+  BOOST_CHECK(storage.find(Name("/C")) != nullptr);
+  BOOST_CHECK_GT(storage.getNGarbageBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedRecord)
+{
+  auto data = makeData("/A");
+  uint64_t fileSize = 0;
+  {
+    DiskStorage storage(filename);
+    storage.insert(*data);
+    fileSize = storage.getFileSize();
+    storage.insert(*makeData("/B"));
+  }
+  boost::filesystem::resize_file(filepath, fileSize + 10);
+
+  DiskStorage storage(filename);
+  BOOST_CHECK_EQUAL(storage.size(), 1);
+  BOOST_CHECK_EQUAL(storage.getFileSize(), fileSize);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), fileSize);
+
+  // the next record is appended after the last complete one
+  storage.insert(*makeData("/C"));
+  DiskStorage reopened(filename);
+  BOOST_CHECK_EQUAL(reopened.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(TruncatedHeader)
+{
+  uint64_t headerSize = DiskStorage(filename).getFileSize();
+  boost::filesystem::resize_file(filepath, headerSize / 2);
+
+  DiskStorage storage(filename);
+  BOOST_CHECK_EQUAL(storage.size(), 0);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), headerSize);
+}
+
+BOOST_AUTO_TEST_CASE(NotDiskStorageFile)
+{
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file << "This is not a DiskStorage file, and must be left untouched.";
+  }
+  uint64_t fileSize = boost::filesystem::file_size(filepath);
+  BOOST_CHECK_THROW(DiskStorage{filename}, DiskStorage::Error);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), fileSize);
+
+  // shorter than the header
+  {
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file << "XYZ";
+  }
+  BOOST_CHECK_THROW(DiskStorage{filename}, DiskStorage::Error);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), 3);
+}
+
+BOOST_AUTO_TEST_CASE(UnsupportedVersion)
+{
+  uint64_t headerSize = DiskStorage(filename).getFileSize();
+  {
+    // the format version is stored at the end of the header
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(headerSize - 1));
+    file.put(2);
+  }
+  BOOST_CHECK_THROW(DiskStorage{filename}, DiskStorage::Error);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), headerSize);
+}
+
+BOOST_AUTO_TEST_CASE(CorruptedRecord)
+{
+  uint64_t offset = 0;
+  uint64_t fileSize = 0;
+  {
+    DiskStorage storage(filename);
+    storage.insert(*makeData("/A"));
+    offset = storage.getFileSize();
+    storage.insert(*makeData("/B"));
+    storage.insert(*makeData("/C"));
+    fileSize = storage.getFileSize();
+  }
+
+  // a record of unknown type in the middle of the file
+  {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put(static_cast<char>(200));
+  }
+  BOOST_CHECK_THROW(DiskStorage{filename}, DiskStorage::Error);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), fileSize);
+
+  // a Data record without Name, followed by a valid record
+  {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.put(static_cast<char>(tlv::Data));
+    file.seekp(0, std::ios::end);
+    const char noName[] = {static_cast<char>(tlv::Data), 2, static_cast<char>(tlv::Content), 0};
+    file.write(noName, sizeof(noName));
+    auto data = makeData("/D");
+    const Block& wire = data->wireEncode();
+    file.write(reinterpret_cast<const char*>(wire.wire()), static_cast<std::streamsize>(wire.size()));
+    fileSize += sizeof(noName) + wire.size();
+  }
+  BOOST_CHECK_THROW(DiskStorage{filename}, DiskStorage::Error);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), fileSize);
+}
+
+BOOST_AUTO_TEST_CASE(Compact)
+{
+  DiskStorage storage(filename);
+  uint64_t headerSize = storage.getFileSize();
+  uint64_t liveBytes = 0;
+  for (int i = 0; i < 10; ++i) {
+    storage.insert(*makeData(Name("/A").appendNumber(i)));
+    auto data = makeData(Name("/B").appendNumber(i));
+    storage.insert(*data);
+    liveBytes += data->wireEncode().size();
+  }
+  storage.erase("/A");
+  BOOST_CHECK_GT(storage.getNGarbageBytes(), 0);
+
+  storage.compact();
+  BOOST_CHECK_EQUAL(storage.size(), 10);
+  BOOST_CHECK_EQUAL(storage.getNGarbageBytes(), 0);
+  BOOST_CHECK_EQUAL(storage.getFileSize(), headerSize + liveBytes);
+  BOOST_CHECK_EQUAL(boost::filesystem::file_size(filepath), headerSize + liveBytes);
+  BOOST_CHECK(!boost::filesystem::exists(filename + ".compact"));
+
+  for (int i = 0; i < 10; ++i) {
+    auto found = storage.find(Name("/B").appendNumber(i));
+    BOOST_REQUIRE(found != nullptr);
+    BOOST_CHECK_EQUAL(found->getName(), Name("/B").appendNumber(i));
+  }
+
+  storage.insert(*makeData("/C"));
+  DiskStorage reopened(filename);
+  BOOST_CHECK_EQUAL(reopened.size(), 11);
+}
+
+BOOST_AUTO_TEST_CASE(CompactConcurrently)
+{
+  DiskStorage storage(filename);
+  for (int i = 0; i < 200; ++i) {
+    storage.insert(*makeData(Name("/A").appendNumber(i)));
+    storage.insert(*makeData(Name("/A").appendNumber(i)));
+  }
+
+  std::thread writer([&storage] {
+    for (int i = 0; i < 200; ++i) {
+      storage.insert(*makeData(Name("/B").appendNumber(i)));
+      storage.erase(Name("/A").appendNumber(i), false);
+    }
+  });
+  storage.compact();
+  writer.join();
+
+  BOOST_CHECK_EQUAL(storage.size(), 200);
+  for (int i = 0; i < 200; ++i) {
+    BOOST_CHECK(storage.find(Name("/B").appendNumber(i)) != nullptr);
+  }
+  BOOST_CHECK(storage.find(Name("/A")) == nullptr);
+
+  DiskStorage reopened(filename);
+  BOOST_CHECK_EQUAL(reopened.size(), 200);
+  BOOST_CHECK(reopened.find(Name("/A")) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EraseDuringCompact)
+{
+  DiskStorage storage(filename);
+  for (int i = 0; i < 10; ++i) {
+    storage.insert(*makeData(Name("/A").appendNumber(i)));
+  }
+
+  // erased after being copied to the new file, before the new file is installed
+  storage.m_afterCompactCopy = [&storage] {
+    storage.erase(Name("/A").appendNumber(3), false);
+  };
+  storage.compact();
+  BOOST_CHECK_EQUAL(storage.size(), 9);
+  BOOST_CHECK(storage.find(Name("/A").appendNumber(3)) == nullptr);
+  BOOST_CHECK_GT(storage.getNGarbageBytes(), 0);
+
+  DiskStorage reopened(filename);
+  BOOST_CHECK_EQUAL(reopened.size(), 9);
+  BOOST_CHECK(reopened.find(Name("/A").appendNumber(3)) == nullptr);
+  BOOST_CHECK_EQUAL(reopened.getNGarbageBytes(), storage.getNGarbageBytes());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestDiskStorage
+BOOST_AUTO_TEST_SUITE_END() // Ims
+
+} // namespace tests
+} // namespace ndn
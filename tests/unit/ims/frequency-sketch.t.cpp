@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/frequency-sketch.hpp"
+
+#include "tests/boost-test.hpp"
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(Ims)
+BOOST_AUTO_TEST_SUITE(TestFrequencySketch)
+
+BOOST_AUTO_TEST_CASE(Increment)
+{
+  FrequencySketch sketch(64);
+  BOOST_CHECK_EQUAL(sketch.getSampleSize(), 640);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(1), 0);
+
+  for (int i = 0; i < 5; ++i) {
+    sketch.increment(1);
+  }
+  sketch.increment(2);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(1), 5);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(2), 1);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(3), 0);
+
+  // counters saturate
+  for (int i = 0; i < 100; ++i) {
+    sketch.increment(1);
+  }
+  BOOST_CHECK_EQUAL(sketch.getFrequency(1), FrequencySketch::MAX_FREQUENCY);
+}
+
+BOOST_AUTO_TEST_CASE(Aging)
+{
+  FrequencySketch sketch(16);
+  for (int i = 0; i < 10; ++i) {
+    sketch.increment(42);
+  }
+  BOOST_CHECK_EQUAL(sketch.getFrequency(42), 10);
+
+  // reaching the sample size halves every counter
+  for (size_t i = 0; i < sketch.getSampleSize(); ++i) {
+    sketch.increment(1000 + i);
+  }
+  BOOST_CHECK_LE(sketch.getFrequency(42), 6);
+  BOOST_CHECK_GE(sketch.getFrequency(42), 5);
+}
+
+BOOST_AUTO_TEST_CASE(EnsureCapacity)
+{
+  FrequencySketch sketch(16);
+  sketch.increment(7);
+  sketch.ensureCapacity(8);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(7), 1);
+
+  sketch.ensureCapacity(1024);
+  BOOST_CHECK_EQUAL(sketch.getSampleSize(), 10240);
+  BOOST_CHECK_EQUAL(sketch.getFrequency(7), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFrequencySketch
+BOOST_AUTO_TEST_SUITE_END() // Ims
+
+} // namespace tests
+} // namespace ndn
@@ -76,6 +76,26 @@ BOOST_AUTO_TEST_CASE(EraseAndShrink)
   BOOST_CHECK_EQUAL(ims.getCapacity(), capacity / 2);
 }
 
+BOOST_AUTO_TEST_CASE(ByteLimit)
+{
+  InMemoryStoragePersistent ims;
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2"));
+  size_t nBytes = ims.getNBytes();
+  BOOST_CHECK_GT(nBytes, 2 * InMemoryStorage::ENTRY_OVERHEAD);
+
+  // packets cannot be evicted to satisfy a lower limit
+  BOOST_CHECK_THROW(ims.setByteLimit(nBytes - 1), InMemoryStorage::Error);
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK_EQUAL(ims.getByteLimit(), std::numeric_limits<size_t>::max());
+
+  // nor to make room for a new packet
+  ims.insert(*makeData("/3"));
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK_GT(ims.getNBytes(), nBytes);
+}
+
 BOOST_AUTO_TEST_SUITE_END() // TestInMemoryStoragePersistent
 BOOST_AUTO_TEST_SUITE_END() // Ims
 
@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/in-memory-storage-tinylfu.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+
+namespace ndn {
+namespace tests {
+
+using namespace ndn::tests;
+
+BOOST_AUTO_TEST_SUITE(Ims)
+BOOST_AUTO_TEST_SUITE(TestInMemoryStorageTinyLfu)
+
+BOOST_AUTO_TEST_CASE(WindowOverflow)
+{
+  InMemoryStorageTinyLfu ims(200);
+  BOOST_CHECK_EQUAL(ims.getWindowCapacity(), 2);
+
+  for (int i = 0; i < 10; ++i) {
+    ims.insert(*makeData(Name("/A").appendNumber(i)));
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 10);
+  BOOST_CHECK_EQUAL(ims.getWindowSize(), 2);
+  BOOST_CHECK_EQUAL(ims.getMainSize(), 8);
+
+  ims.erase(Name("/A").appendNumber(9));
+  ims.erase(Name("/A").appendNumber(0));
+  BOOST_CHECK_EQUAL(ims.getWindowSize(), 1);
+  BOOST_CHECK_EQUAL(ims.getMainSize(), 7);
+}
+
+BOOST_AUTO_TEST_CASE(Admission)
+{
+  InMemoryStorageTinyLfu ims(2);
+  BOOST_CHECK_EQUAL(ims.getWindowCapacity(), 1);
+
+  ims.insert(*makeData("/1"));
+  ims.insert(*makeData("/2")); // /1 overflows into the main segment
+  ims.find(*makeInterest("/2"));
+  ims.find(*makeInterest("/2"));
+
+  // /2 leaves the window, and is more popular than /1
+  ims.insert(*makeData("/3"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(ims.find(*makeInterest("/1")) == nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/2")) != nullptr);
+  BOOST_CHECK_EQUAL(ims.getMainSize(), 1);
+
+  // /3 leaves the window, and is less popular than /2
+  ims.insert(*makeData("/4"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(ims.find(*makeInterest("/3")) == nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/2")) != nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/4")) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ScanResistance)
+{
+  InMemoryStorageTinyLfu ims(100);
+
+  for (int i = 0; i < 99; ++i) {
+    Name name = Name("/hot").appendNumber(i);
+    ims.insert(*makeData(name));
+    ims.find(name);
+    ims.find(name);
+  }
+
+  // a sequential scan of packets that are never accessed again, while the hot packets are
+  // accessed less often than LRU would need to keep them
+  for (int i = 0; i < 1000; ++i) {
+    ims.insert(*makeData(Name("/scan").appendSegment(i)));
+    ims.find(Name("/hot").appendNumber(i % 99));
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 100);
+
+  int nHot = 0;
+  for (int i = 0; i < 99; ++i) {
+    nHot += ims.find(Name("/hot").appendNumber(i)) != nullptr;
+  }
+  BOOST_CHECK_GE(nHot, 95);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestInMemoryStorageTinyLfu
+BOOST_AUTO_TEST_SUITE_END() // Ims
+
+} // namespace tests
+} // namespace ndn
@@ -24,12 +24,14 @@
 #include "ndn-cxx/ims/in-memory-storage-lfu.hpp"
 #include "ndn-cxx/ims/in-memory-storage-lru.hpp"
 #include "ndn-cxx/ims/in-memory-storage-persistent.hpp"
+#include "ndn-cxx/ims/in-memory-storage-tinylfu.hpp"
 #include "ndn-cxx/util/sha256.hpp"
 
 #include "tests/boost-test.hpp"
 #include "tests/make-interest-data.hpp"
 #include "tests/unit/unit-test-time-fixture.hpp"
 
+#include <boost/filesystem.hpp>
 #include <boost/mpl/vector.hpp>
 
 namespace ndn {
@@ -43,7 +45,8 @@ BOOST_AUTO_TEST_SUITE(TestInMemoryStorage)
 using InMemoryStorages = boost::mpl::vector<InMemoryStoragePersistent,
                                             InMemoryStorageFifo,
                                             InMemoryStorageLfu,
-                                            InMemoryStorageLru>;
+                                            InMemoryStorageLru,
+                                            InMemoryStorageTinyLfu>;
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(Insertion, T, InMemoryStorages)
 {
@@ -109,6 +112,18 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(DuplicateInsertion2, T, InMemoryStorages)
   BOOST_CHECK_EQUAL(ims.size(), 2);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(DuplicateInsertionSameWire, T, InMemoryStorages)
+{
+  T ims;
+
+  shared_ptr<Data> data = makeData("/insert/duplicate");
+  ims.insert(*data);
+
+  // a distinct packet with the same wire encoding is a duplicate
+  ims.insert(*make_shared<Data>(data->wireEncode()));
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndFind, T, InMemoryStorages)
 {
   T ims;
@@ -235,6 +250,31 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEraseByName, T, InMemoryStorages)
   BOOST_CHECK_EQUAL(ims.size(), 3);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(EraseByFullNameSameName, T, InMemoryStorages)
+{
+  T ims;
+
+  shared_ptr<Data> data1 = makeData("/a");
+  data1->setContent(make_shared<Buffer>(1));
+  signData(data1);
+  ims.insert(*data1);
+
+  shared_ptr<Data> data2 = makeData("/a");
+  data2->setContent(make_shared<Buffer>(2));
+  signData(data2);
+  ims.insert(*data2);
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+
+  ims.erase(data2->getFullName(), false);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(ims.find(data1->getFullName()) != nullptr);
+  BOOST_CHECK(ims.find(data2->getFullName()) == nullptr);
+
+  // without implicit digest, the name does not designate a single packet
+  ims.erase("/a", false);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEraseByPrefix, T, InMemoryStorages)
 {
   T ims;
@@ -268,6 +308,37 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEraseByPrefix, T, InMemoryStorages)
   BOOST_CHECK_EQUAL(ims.getCapacity(), 16);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertBatch, T, InMemoryStorages)
+{
+  T ims;
+  ims.insert(*makeData(Name("/batch").appendNumber(5)));
+
+  std::vector<shared_ptr<Data>> packets;
+  for (int i : {3, 1, 4, 1, 5, 9, 2, 6}) {
+    packets.push_back(makeData(Name("/batch").appendNumber(i)));
+  }
+  packets.push_back(makeData("/other"));
+  ims.insertBatch(packets);
+
+  // duplicates in the batch and in the storage are skipped
+  BOOST_CHECK_EQUAL(ims.size(), 8);
+  BOOST_CHECK_GE(ims.getCapacity(), 8);
+
+  Name previous;
+  for (const Data& data : ims) {
+    BOOST_CHECK_LT(previous, data.getName());
+    previous = data.getName();
+  }
+  for (const auto& data : packets) {
+    BOOST_CHECK(ims.find(data->getFullName()) != nullptr);
+  }
+
+  ims.erase("/batch");
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK(ims.find(Name("/other")) != nullptr);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), packets.back()->wireEncode().size() + InMemoryStorage::ENTRY_OVERHEAD);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(DigestCalculation, T, InMemoryStorages)
 {
   shared_ptr<Data> data = makeData("/digest/compute");
@@ -281,6 +352,101 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(DigestCalculation, T, InMemoryStorages)
   BOOST_CHECK_EQUAL_COLLECTIONS(digest1->begin(), digest1->end(),
                                 entry.getFullName()[-1].value_begin(),
                                 entry.getFullName()[-1].value_end());
+
+  InMemoryStorageEntry compactEntry;
+  compactEntry.setCompactData(*data);
+  BOOST_CHECK_EQUAL(compactEntry.getFullName(), data->getFullName());
+}
+
+BOOST_AUTO_TEST_CASE(CompactEntryMatching)
+{
+  auto data = makeData("/A/B");
+  data->setFreshnessPeriod(1_s);
+  signData(data);
+  auto nonFresh = makeData("/A/B");
+
+  InMemoryStorageEntry entry;
+  entry.setCompactData(*data);
+  BOOST_CHECK(entry.isCompact());
+  BOOST_CHECK_EQUAL(entry.getName(), "/A/B");
+  BOOST_CHECK_EQUAL(entry.getWire(), data->wireEncode());
+  BOOST_CHECK_EQUAL(entry.getSharedData()->wireEncode(), data->wireEncode());
+  const Data& decoded = entry.getData();
+  BOOST_CHECK_EQUAL(decoded.wireEncode(), data->wireEncode());
+  BOOST_CHECK_EQUAL(&entry.getData(), &decoded);
+  BOOST_CHECK_EQUAL(entry.getSharedData().get(), &decoded);
+  InMemoryStorageEntry nonFreshEntry;
+  nonFreshEntry.setCompactData(*nonFresh);
+
+  std::vector<shared_ptr<Interest>> interests;
+  for (const Name& name : {Name("/A"), Name("/A/B"), Name("/A/B/C"), Name("/A/C"),
+                           data->getFullName(), nonFresh->getFullName(),
+                           Name("/A").appendImplicitSha256Digest(data->getFullName()[-1].value(), 32)}) {
+    for (bool canBePrefix : {false, true}) {
+      for (bool mustBeFresh : {false, true}) {
+        interests.push_back(makeInterest(name, canBePrefix));
+        interests.back()->setMustBeFresh(mustBeFresh);
+      }
+    }
+  }
+
+  // a compact entry matches the same Interests as the packet
+  for (const auto& interest : interests) {
+    BOOST_TEST_CONTEXT(*interest) {
+      BOOST_CHECK_EQUAL(entry.canSatisfy(*interest), interest->matchesData(*data));
+      BOOST_CHECK_EQUAL(nonFreshEntry.canSatisfy(*interest), interest->matchesData(*nonFresh));
+    }
+  }
+
+  entry.release();
+  BOOST_CHECK(!entry.isCompact());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(CompactMode, T, InMemoryStorages)
+{
+  T ims;
+  BOOST_CHECK_EQUAL(ims.isCompactMode(), false);
+  auto full = makeData("/full");
+  ims.insert(*full);
+
+  ims.setCompactMode(true);
+  std::vector<shared_ptr<Data>> packets;
+  for (int i = 0; i < 4; ++i) {
+    packets.push_back(makeData(Name("/compact").appendSegment(i)));
+    ims.insert(*packets.back());
+  }
+  ims.insert(*makeData(Name("/compact").appendSegment(0)));
+  BOOST_CHECK_EQUAL(ims.size(), 5);
+  BOOST_CHECK_EQUAL(ims.getNBytes(),
+                    full->wireEncode().size() + InMemoryStorage::ENTRY_OVERHEAD +
+                    4 * (packets[0]->wireEncode().size() + InMemoryStorage::COMPACT_ENTRY_OVERHEAD));
+
+  // the storage does not keep the inserted Data
+  auto found = ims.find(*makeInterest(packets[1]->getName()));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_NE(found, packets[1]);
+  BOOST_CHECK_EQUAL(found->wireEncode(), packets[1]->wireEncode());
+  BOOST_CHECK_EQUAL(ims.find(Name("/full")), full);
+
+  found = ims.find(*makeInterest("/compact", true));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), packets[0]->getName());
+  found = ims.find(packets[3]->getFullName());
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), packets[3]->getName());
+
+  size_t nIterated = 0;
+  for (const Data& data : ims) {
+    BOOST_CHECK(data.getName() == "/full" || data.getName().getPrefix(1) == "/compact");
+    ++nIterated;
+  }
+  BOOST_CHECK_EQUAL(nIterated, 5);
+
+  ims.erase(packets[2]->getFullName(), false);
+  BOOST_CHECK(ims.find(packets[2]->getName()) == nullptr);
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 0);
 }
 
 BOOST_AUTO_TEST_CASE_TEMPLATE(Iterator, T, InMemoryStorages)
@@ -345,6 +511,32 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertCanonical, T, InMemoryStorages)
   BOOST_CHECK(true);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(EraseByPrefixBoundaries, T, InMemoryStorages)
+{
+  T ims;
+
+  for (const char* name : {"/a/0", "/a/1", "/a/1/x", "/a/1/x/y", "/a/10", "/a/2",
+                           "/a/%FF", "/a/%FF/x", "/a/%00%00", "/b"}) {
+    ims.insert(*makeData(name));
+  }
+  size_t nBytes = ims.getNBytes();
+
+  ims.erase("/a/1");
+  BOOST_CHECK_EQUAL(ims.size(), 7);
+  BOOST_CHECK(ims.find("/a/1/x") == nullptr);
+  BOOST_CHECK(ims.find("/a/10") != nullptr);
+  BOOST_CHECK(ims.find("/a/0") != nullptr);
+
+  ims.erase("/a/%FF");
+  BOOST_CHECK_EQUAL(ims.size(), 5);
+  BOOST_CHECK(ims.find("/a/%00%00") != nullptr);
+  BOOST_CHECK_LT(ims.getNBytes(), nBytes);
+
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 0);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE(EraseCanonical, T, InMemoryStorages)
 {
   T ims;
@@ -443,6 +635,121 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEvict, T, InMemoryStoragesLimited)
   BOOST_CHECK(found == nullptr);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertBatchAndEvict, T, InMemoryStoragesLimited)
+{
+  T ims(4);
+
+  std::vector<shared_ptr<Data>> packets;
+  for (int i = 0; i < 10; ++i) {
+    packets.push_back(makeData(Name("/batch").appendSegment(i)));
+  }
+  ims.insertBatch(packets);
+  BOOST_CHECK_EQUAL(ims.size(), 4);
+  BOOST_CHECK_EQUAL(ims.getCapacity(), 4);
+
+  size_t nFound = 0;
+  for (const auto& data : packets) {
+    nFound += ims.find(data->getName()) != nullptr;
+  }
+  BOOST_CHECK_EQUAL(nFound, 4);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(ByteLimit, T, InMemoryStoragesLimited)
+{
+  T ims;
+  BOOST_CHECK_EQUAL(ims.getByteLimit(), std::numeric_limits<size_t>::max());
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 0);
+
+  std::vector<shared_ptr<Data>> packets;
+  for (int i = 0; i < 10; ++i) {
+    packets.push_back(makeData("/byte/limit/" + to_string(i)));
+  }
+  size_t entrySize = packets[0]->wireEncode().size() + InMemoryStorage::ENTRY_OVERHEAD;
+
+  for (int i = 0; i < 4; ++i) {
+    ims.insert(*packets[i]);
+  }
+  BOOST_CHECK_EQUAL(ims.size(), 4);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 4 * entrySize);
+
+  // lowering the limit evicts immediately
+  ims.setByteLimit(3 * entrySize + 1);
+  BOOST_CHECK_EQUAL(ims.getByteLimit(), 3 * entrySize + 1);
+  BOOST_CHECK_EQUAL(ims.size(), 3);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 3 * entrySize);
+
+  for (int i = 4; i < 10; ++i) {
+    ims.insert(*packets[i]);
+    BOOST_CHECK_EQUAL(ims.size(), 3);
+    BOOST_CHECK_LE(ims.getNBytes(), ims.getByteLimit());
+  }
+  BOOST_CHECK(ims.find(Name("/byte/limit/9")) != nullptr);
+
+  // a packet larger than the limit replaces all others
+  auto large = makeData("/byte/limit/large");
+  large->setContent(make_shared<Buffer>(4 * entrySize));
+  signData(large);
+  ims.insert(*large);
+  BOOST_CHECK_EQUAL(ims.size(), 1);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), large->wireEncode().size() + InMemoryStorage::ENTRY_OVERHEAD);
+
+  ims.erase("/byte/limit");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(ims.getNBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(InsertAndEvictSameName, T, InMemoryStoragesLimited)
+{
+  T ims(2);
+
+  std::vector<shared_ptr<Data>> packets;
+  for (size_t i = 1; i <= 3; ++i) {
+    auto data = makeData("/insert");
+    data->setContent(make_shared<Buffer>(i));
+    signData(data);
+    ims.insert(*data);
+    packets.push_back(data);
+  }
+
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK(ims.find(packets[0]->getFullName()) == nullptr);
+  BOOST_CHECK(ims.find(packets[2]->getFullName()) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(DiskTier, T, InMemoryStoragesLimited)
+{
+  auto path = boost::filesystem::path(UNIT_TEST_CONFIG_PATH) / "TestInMemoryStorage" / "disk-tier";
+  boost::filesystem::create_directories(path.parent_path());
+  boost::filesystem::remove(path);
+  auto disk = make_shared<DiskStorage>(path.string());
+
+  T ims(2);
+  ims.setDiskTier(disk);
+  BOOST_CHECK_EQUAL(ims.getDiskTier(), disk);
+
+  ims.insert(*makeData("/A"));
+  ims.insert(*makeData("/B"));
+  ims.insert(*makeData("/C"));
+  BOOST_CHECK_EQUAL(ims.size(), 2);
+  BOOST_CHECK_EQUAL(disk->size(), 1);
+
+  // evicted packets are moved back into memory, evicting others to disk
+  for (const char* name : {"/A", "/B", "/C"}) {
+    BOOST_CHECK(ims.find(*makeInterest(name)) != nullptr);
+    BOOST_CHECK_EQUAL(ims.size(), 2);
+    BOOST_CHECK_EQUAL(disk->size(), 1);
+  }
+  BOOST_CHECK(ims.find(Name("/D")) == nullptr);
+
+  ims.erase("/");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+  BOOST_CHECK_EQUAL(disk->size(), 0);
+
+  ims.setDiskTier(nullptr);
+  disk.reset();
+  boost::filesystem::remove_all(path.parent_path());
+}
+
 // Find function is implemented at the base case, so it's sufficient to test for one derived class.
 class FindFixture : public tests::UnitTestTimeFixture
 {
@@ -549,6 +856,35 @@ BOOST_AUTO_TEST_CASE(FullName_EmptyDataName)
   BOOST_CHECK_EQUAL(find(), 2);
 }
 
+BOOST_AUTO_TEST_CASE(ExactName_SameName)
+{
+  insert(1, "/A/B", [] (Data& data) { data.setFreshnessPeriod(0_s); });
+  insert(2, "/A/B", [] (Data& data) { data.setFreshnessPeriod(1_s); });
+  insert(3, "/A/B/C", [] (Data& data) { data.setFreshnessPeriod(1_s); });
+
+  advanceClocks(500_ms);
+  startInterest("/A/B")
+    .setMustBeFresh(true);
+  BOOST_CHECK_EQUAL(find(), 2);
+
+  startInterest("/A/C");
+  BOOST_CHECK_EQUAL(find(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(FullName_CanBePrefix)
+{
+  Name n1 = insert(1, "/A");
+  Name n2 = insert(2, "/A");
+
+  startInterest(n2)
+    .setCanBePrefix(true);
+  BOOST_CHECK_EQUAL(find(), 2);
+
+  startInterest(n1)
+    .setMustBeFresh(true);
+  BOOST_CHECK_EQUAL(find(), 0);
+}
+
 BOOST_AUTO_TEST_CASE(PrefixName)
 {
   insert(1, "/A");
@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/ims/sharded-in-memory-storage.hpp"
+#include "ndn-cxx/ims/in-memory-storage-lru.hpp"
+#include "ndn-cxx/ims/in-memory-storage-persistent.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+#include "tests/unit/unit-test-time-fixture.hpp"
+
+#include <atomic>
+#include <thread>
+
+namespace ndn {
+namespace tests {
+
+using namespace ndn::tests;
+
+BOOST_AUTO_TEST_SUITE(Ims)
+BOOST_AUTO_TEST_SUITE(TestShardedInMemoryStorage)
+
+static unique_ptr<InMemoryStorage>
+makePersistent()
+{
+  return make_unique<InMemoryStoragePersistent>();
+}
+
+BOOST_AUTO_TEST_CASE(Construct)
+{
+  BOOST_CHECK_THROW(ShardedInMemoryStorage(0, 2, &makePersistent), std::invalid_argument);
+  BOOST_CHECK_THROW(ShardedInMemoryStorage(4, 2, nullptr), std::invalid_argument);
+
+  ShardedInMemoryStorage ims(4, 2, &makePersistent);
+  BOOST_CHECK_EQUAL(ims.getNShards(), 4);
+  BOOST_CHECK_EQUAL(ims.getPrefixLength(), 2);
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(ShardIndex)
+{
+  ShardedInMemoryStorage ims(16, 2, &makePersistent);
+
+  // only the first two components select the shard
+  BOOST_CHECK_EQUAL(ims.getShardIndex("/A/B"), ims.getShardIndex("/A/B/C"));
+  BOOST_CHECK_EQUAL(ims.getShardIndex(Name("/A/B").appendSegment(1)),
+                    ims.getShardIndex(Name("/A/B").appendSegment(2)));
+
+  std::set<size_t> shards;
+  for (int i = 0; i < 100; ++i) {
+    shards.insert(ims.getShardIndex(Name("/A").appendNumber(i)));
+  }
+  BOOST_CHECK_GT(shards.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  ShardedInMemoryStorage ims(8, 1, &makePersistent);
+
+  std::vector<shared_ptr<Data>> packets;
+  for (int i = 0; i < 50; ++i) {
+    packets.push_back(makeData(Name("/object").appendNumber(i).append("data")));
+    ims.insert(*packets.back());
+  }
+  ims.insert(*packets.front());
+  BOOST_CHECK_EQUAL(ims.size(), 50);
+
+  // exact name, with and without digest
+  BOOST_CHECK_EQUAL(ims.find(*makeInterest(packets[7]->getName()))->getName(), packets[7]->getName());
+  BOOST_CHECK_EQUAL(ims.find(*makeInterest(packets[8]->getFullName()))->getName(),
+                    packets[8]->getName());
+  BOOST_CHECK(ims.find(packets[9]->getFullName()) != nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/object/nonexistent")) == nullptr);
+
+  // a prefix shorter than the shard prefix searches every shard for the leftmost match
+  auto found = ims.find(*makeInterest("/object", true));
+  BOOST_REQUIRE(found != nullptr);
+  BOOST_CHECK_EQUAL(found->getName(), packets[0]->getName());
+  BOOST_CHECK(ims.find(Name("/object")) != nullptr);
+
+  ims.erase(packets[3]->getFullName(), false);
+  BOOST_CHECK_EQUAL(ims.size(), 49);
+  ims.erase(Name("/object").appendNumber(4));
+  BOOST_CHECK_EQUAL(ims.size(), 48);
+  ims.erase("/object");
+  BOOST_CHECK_EQUAL(ims.size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(PolicyPerShard)
+{
+  ShardedInMemoryStorage ims(2, 1, [] { return make_unique<InMemoryStorageLru>(4); });
+
+  for (int i = 0; i < 100; ++i) {
+    ims.insert(*makeData(Name("/A").appendNumber(i)));
+  }
+  // all packets are in the same shard, and only 4 of them are kept
+  BOOST_CHECK_EQUAL(ims.size(), 4);
+}
+
+BOOST_FIXTURE_TEST_CASE(MustBeFresh, UnitTestTimeFixture)
+{
+  ShardedInMemoryStorage ims(2, 1, [this] { return make_unique<InMemoryStoragePersistent>(io); });
+  auto data = makeData("/A");
+  data->setFreshnessPeriod(1_s);
+  ims.insert(*signData(data), 1_s);
+  auto interest = makeInterest("/A");
+  interest->setMustBeFresh(true);
+
+  // freshness is checked on lookup, without running the io_service
+  steadyClock->advance(500_ms);
+  BOOST_CHECK(ims.find(*interest) != nullptr);
+  steadyClock->advance(1_s);
+  BOOST_CHECK(ims.find(*interest) == nullptr);
+  BOOST_CHECK(ims.find(*makeInterest("/A")) != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(Concurrent)
+{
+  ShardedInMemoryStorage ims(4, 2, &makePersistent);
+  const int nThreads = 4;
+  const int nPackets = 500;
+
+  std::vector<std::vector<shared_ptr<Data>>> packets(nThreads);
+  std::vector<std::vector<shared_ptr<Interest>>> interests(nThreads);
+  for (int t = 0; t < nThreads; ++t) {
+    for (int i = 0; i < nPackets; ++i) {
+      packets[t].push_back(makeData(Name("/thread").appendNumber(t).appendSegment(i)));
+      interests[t].push_back(makeInterest(packets[t].back()->getName()));
+    }
+  }
+
+  std::atomic<int> nFound{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&, t] {
+      for (const auto& data : packets[t]) {
+        ims.insert(*data);
+      }
+      for (const auto& interest : interests[t]) {
+        if (ims.find(*interest) != nullptr) {
+          ++nFound;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  BOOST_CHECK_EQUAL(ims.size(), nThreads * nPackets);
+  BOOST_CHECK_EQUAL(nFound, nThreads * nPackets);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestShardedInMemoryStorage
+BOOST_AUTO_TEST_SUITE_END() // Ims
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/interest-template.hpp"
+#include "ndn-cxx/lp/tags.hpp"
+
+#include "tests/boost-test.hpp"
+
+#include <set>
+
+namespace ndn {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(TestInterestTemplate)
+
+static Interest
+makePrototype(const Name& prefix)
+{
+  Interest interest(prefix);
+  interest.setCanBePrefix(false);
+  interest.setMustBeFresh(true);
+  interest.setForwardingHint({{15893, "/H"}});
+  interest.setInterestLifetime(9_s);
+  interest.setHopLimit(42);
+  return interest;
+}
+
+static Interest
+makeExpected(const Interest& prototype, const name::Component& lastComponent,
+             const Interest::Nonce& nonce)
+{
+  Interest interest(prototype);
+  interest.setName(Name(prototype.getName()).append(lastComponent));
+  interest.setNonce(nonce);
+  return interest;
+}
+
+BOOST_AUTO_TEST_CASE(MakeWire)
+{
+  Interest::Nonce nonce{0x01, 0x02, 0x03, 0x04};
+  Interest prototype = makePrototype("/A/B");
+  prototype.setNonce(Interest::Nonce{0xff, 0xff, 0xff, 0xff}); // ignored
+  InterestTemplate tpl(prototype);
+  BOOST_CHECK_EQUAL(tpl.getPrefix(), "/A/B");
+
+  name::Component comp("C");
+  Block wire = tpl.makeWire(comp, nonce);
+  Block expected = makeExpected(prototype, comp, nonce).wireEncode();
+  BOOST_CHECK_EQUAL_COLLECTIONS(wire.begin(), wire.end(), expected.begin(), expected.end());
+
+  Interest interest = tpl.makeInterest(comp);
+  BOOST_CHECK_EQUAL(interest.getName(), "/A/B/C");
+  BOOST_CHECK_EQUAL(interest.getMustBeFresh(), true);
+  BOOST_CHECK_EQUAL(interest.getCanBePrefix(), false);
+  BOOST_CHECK_EQUAL(interest.getForwardingHint(), DelegationList({{15893, "/H"}}));
+  BOOST_CHECK_EQUAL(interest.getInterestLifetime(), 9_s);
+  BOOST_CHECK_EQUAL(*interest.getHopLimit(), 42);
+  BOOST_CHECK(interest.hasNonce());
+  BOOST_CHECK(interest.hasWire());
+}
+
+BOOST_AUTO_TEST_CASE(LengthChanges)
+{
+  Interest::Nonce nonce{0xa0, 0xa1, 0xa2, 0xa3};
+  // the Name and Interest TLV-LENGTH fields grow from one to three octets
+  // as the last component gets longer
+  Interest prototype = makePrototype(Name("/prefix").append(std::string(220, 'x')));
+  InterestTemplate tpl(prototype);
+
+  for (size_t size : {0, 1, 10, 20, 40, 300}) {
+    name::Component comp(std::string(size, 'c'));
+    Block wire = tpl.makeWire(comp, nonce);
+    Block expected = makeExpected(prototype, comp, nonce).wireEncode();
+    BOOST_CHECK_EQUAL_COLLECTIONS(wire.begin(), wire.end(), expected.begin(), expected.end());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Segment)
+{
+  Interest::Nonce nonce{0x10, 0x20, 0x30, 0x40};
+  Interest prototype = makePrototype("/A/%FD%01");
+  InterestTemplate tpl(prototype);
+
+  for (auto convention : {name::Convention::MARKER, name::Convention::TYPED}) {
+    name::setConventionEncoding(convention);
+    for (uint64_t seg : {0ULL, 1ULL, 252ULL, 255ULL, 256ULL, 65536ULL, 4294967296ULL}) {
+      Block wire = tpl.makeSegmentWire(seg, nonce);
+      Block expected = makeExpected(prototype, name::Component::fromSegment(seg), nonce).wireEncode();
+      BOOST_CHECK_EQUAL_COLLECTIONS(wire.begin(), wire.end(), expected.begin(), expected.end());
+      BOOST_CHECK_EQUAL(tpl.makeSegmentInterest(seg).getName().at(-1).toSegment(), seg);
+    }
+  }
+  name::setConventionEncoding(name::Convention::MARKER);
+}
+
+BOOST_AUTO_TEST_CASE(RandomNonce)
+{
+  InterestTemplate tpl(makePrototype("/A"));
+  std::set<Interest::Nonce> nonces;
+  for (int i = 0; i < 10; ++i) {
+    nonces.insert(tpl.makeSegmentInterest(1).getNonce());
+  }
+  BOOST_CHECK_GT(nonces.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Tags)
+{
+  Interest prototype = makePrototype("/A");
+  prototype.setTag(make_shared<lp::NextHopFaceIdTag>(7));
+  prototype.setCongestionMark(1);
+  InterestTemplate tpl(prototype);
+  prototype.removeTag<lp::NextHopFaceIdTag>();
+
+  Interest interest = tpl.makeSegmentInterest(3);
+  BOOST_REQUIRE(interest.getTag<lp::NextHopFaceIdTag>() != nullptr);
+  BOOST_CHECK_EQUAL(interest.getTag<lp::NextHopFaceIdTag>()->get(), 7);
+  BOOST_CHECK_EQUAL(interest.getCongestionMark(), 1);
+
+  interest = tpl.makeInterest(name::Component("B"));
+  BOOST_REQUIRE(interest.getTag<lp::NextHopFaceIdTag>() != nullptr);
+  BOOST_CHECK_EQUAL(interest.getTag<lp::NextHopFaceIdTag>()->get(), 7);
+
+  // tags set on one stamped Interest do not leak into the template
+  interest.removeTag<lp::NextHopFaceIdTag>();
+  BOOST_CHECK(tpl.makeSegmentInterest(4).getTag<lp::NextHopFaceIdTag>() != nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(ApplicationParameters)
+{
+  Interest prototype = makePrototype("/A");
+  prototype.setApplicationParameters(make_shared<Buffer>(4));
+  BOOST_CHECK_THROW(InterestTemplate{prototype}, InterestTemplate::Error);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestInterestTemplate
+
+} // namespace tests
+} // namespace ndn
@@ -0,0 +1,228 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/security/validation-pipeline.hpp"
+#include "ndn-cxx/security/validation-policy-simple-hierarchy.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/unit/security/validator-fixture.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace security {
+inline namespace v2 {
+namespace tests {
+
+using namespace ndn::tests;
+
+class ValidationPipelineFixture : public HierarchicalValidatorFixture<ValidationPolicySimpleHierarchy>
+{
+public:
+  ValidationPipelineFixture()
+  {
+    face.onSendInterest.connect([this] (const Interest& interest) {
+      io.post([=] {
+        if (processInterest != nullptr) {
+          processInterest(interest);
+        }
+      });
+    });
+  }
+
+  shared_ptr<Data>
+  makeSegment(const Identity& signer, uint64_t segment)
+  {
+    auto data = make_shared<Data>(Name("/Security/ValidatorFixture/Sub1/obj")
+                                  .appendVersion(1).appendSegment(segment));
+    m_keyChain.sign(*data, signingByIdentity(signer));
+    return data;
+  }
+
+  void
+  submit(ValidationPipeline& pipeline, const Data& data)
+  {
+    pipeline.validate(data,
+      [this] (const Data& data) { results.emplace_back(data.getName()[-1].toSegment(), true); },
+      [this] (const Data& data, const ValidationError&) {
+        results.emplace_back(data.getName()[-1].toSegment(), false);
+      });
+  }
+
+  /**
+   * @brief Process events until @p nResults results have been delivered.
+   *
+   * Results from worker threads are posted to the io_service, so this also waits in real time.
+   */
+  void
+  waitForResults(size_t nResults)
+  {
+    for (int i = 0; i < 10000 && results.size() < nResults; ++i) {
+      advanceClocks(1_ms);
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+
+public:
+  std::vector<std::pair<uint64_t, bool>> results;
+};
+
+BOOST_AUTO_TEST_SUITE(Security)
+BOOST_FIXTURE_TEST_SUITE(TestValidationPipeline, ValidationPipelineFixture)
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  ValidationPipeline::Options options;
+  options.maxBatchSize = 0;
+  BOOST_CHECK_THROW(ValidationPipeline(io, validator, options), std::invalid_argument);
+
+  options = {};
+  options.trustLifetime = -1_s;
+  BOOST_CHECK_THROW(ValidationPipeline(io, validator, options), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(InOrder)
+{
+  ValidationPipeline pipeline(io, validator);
+  for (uint64_t i = 0; i < 100; ++i) {
+    submit(pipeline, *makeSegment(subIdentity, i));
+  }
+  BOOST_CHECK_EQUAL(pipeline.getNPending(), 100);
+
+  waitForResults(100);
+  BOOST_REQUIRE_EQUAL(results.size(), 100);
+  for (uint64_t i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(results[i].first, i);
+    BOOST_CHECK_EQUAL(results[i].second, true);
+  }
+  BOOST_CHECK_EQUAL(pipeline.getNPending(), 0);
+
+  // segments submitted after the certificate had been retrieved skip the Validator
+  for (uint64_t i = 100; i < 150; ++i) {
+    submit(pipeline, *makeSegment(subIdentity, i));
+  }
+  uint64_t nFastVerified = pipeline.getNFastVerified();
+  waitForResults(150);
+  BOOST_REQUIRE_EQUAL(results.size(), 150);
+  BOOST_CHECK_EQUAL(results.back().first, 149);
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), nFastVerified + 50);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidSignature)
+{
+  ValidationPipeline pipeline(io, validator);
+  submit(pipeline, *makeSegment(subIdentity, 0));
+  waitForResults(1);
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+
+  for (uint64_t i = 1; i < 20; ++i) {
+    auto data = makeSegment(subIdentity, i);
+    if (i == 7) {
+      auto value = make_shared<Buffer>(data->getSignatureValue().value_begin(),
+                                       data->getSignatureValue().value_end());
+      (*value)[value->size() / 2] ^= 0xFF;
+      data->setSignatureValue(value);
+      data->wireEncode();
+    }
+    submit(pipeline, *data);
+  }
+
+  waitForResults(20);
+  BOOST_REQUIRE_EQUAL(results.size(), 20);
+  for (uint64_t i = 0; i < 20; ++i) {
+    BOOST_CHECK_EQUAL(results[i].first, i);
+    BOOST_CHECK_EQUAL(results[i].second, i != 7);
+  }
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), 18);
+}
+
+BOOST_AUTO_TEST_CASE(UntrustedKey)
+{
+  ValidationPipeline pipeline(io, validator);
+  // otherIdentity is not trusted for this name, so its segments always reach the Validator
+  for (uint64_t i = 0; i < 40; ++i) {
+    submit(pipeline, *makeSegment(i % 2 == 0 ? subIdentity : otherIdentity, i));
+  }
+
+  waitForResults(40);
+  BOOST_REQUIRE_EQUAL(results.size(), 40);
+  for (uint64_t i = 0; i < 40; ++i) {
+    BOOST_CHECK_EQUAL(results[i].first, i);
+    BOOST_CHECK_EQUAL(results[i].second, i % 2 == 0);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(NoWorkerThreads)
+{
+  ValidationPipeline::Options options;
+  options.nThreads = 0;
+  ValidationPipeline pipeline(io, validator, options);
+
+  submit(pipeline, *makeSegment(identity, 0));
+  // the anchor is known, so the first segment is validated immediately
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  advanceClocks(1_ms);
+  submit(pipeline, *makeSegment(identity, 1));
+  BOOST_REQUIRE_EQUAL(results.size(), 2);
+  BOOST_CHECK_EQUAL(results[1].second, true);
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TrustLifetime)
+{
+  ValidationPipeline::Options options;
+  options.nThreads = 0;
+  options.trustLifetime = 1_min;
+  ValidationPipeline pipeline(io, validator, options);
+
+  submit(pipeline, *makeSegment(identity, 0));
+  advanceClocks(1_ms);
+  submit(pipeline, *makeSegment(identity, 1));
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), 1);
+
+  advanceClocks(2_min);
+  submit(pipeline, *makeSegment(identity, 2));
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), 1);
+  advanceClocks(1_ms);
+  submit(pipeline, *makeSegment(identity, 3));
+  BOOST_CHECK_EQUAL(pipeline.getNFastVerified(), 2);
+  BOOST_CHECK_EQUAL(results.size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(Destroy)
+{
+  auto pipeline = make_unique<ValidationPipeline>(io, validator);
+  for (uint64_t i = 0; i < 50; ++i) {
+    submit(*pipeline, *makeSegment(subIdentity, i));
+  }
+  pipeline.reset();
+
+  advanceClocks(10_ms, 100);
+  BOOST_CHECK(results.empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestValidationPipeline
+BOOST_AUTO_TEST_SUITE_END() // Security
+
+} // namespace tests
+} // inline namespace v2
+} // namespace security
+} // namespace ndn
@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/congestion-control.hpp"
+
+#include "tests/boost-test.hpp"
+
+#include <cmath>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_AUTO_TEST_SUITE(TestCongestionControl)
+
+static CongestionControl::AckSample
+makeAck(time::steady_clock::TimePoint now, optional<time::nanoseconds> rtt = nullopt,
+        bool isCongestionMarked = false)
+{
+  CongestionControl::AckSample sample;
+  sample.now = now;
+  sample.rtt = rtt;
+  if (rtt) {
+    sample.smoothedRtt = *rtt;
+  }
+  sample.isCongestionMarked = isCongestionMarked;
+  return sample;
+}
+
+BOOST_AUTO_TEST_CASE(Aimd)
+{
+  AimdCongestionControl::Options options;
+  options.initSsthresh = 4.0;
+  AimdCongestionControl cc(options);
+  auto now = time::steady_clock::now();
+
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 1.0);
+  for (int i = 0; i < 3; ++i) {
+    cc.afterAck(makeAck(now));
+  }
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 4.0); // slow start
+
+  cc.afterAck(makeAck(now));
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 4.25); // congestion avoidance
+
+  cc.afterAck(makeAck(now, nullopt, true));
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 4.25); // marked acks do not increase the window
+
+  cc.afterCongestionEvent(now);
+  BOOST_CHECK_EQUAL(cc.getSsthresh(), 2.125);
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 2.125);
+
+  cc.afterCongestionEvent(now);
+  BOOST_CHECK_EQUAL(cc.getSsthresh(), AimdCongestionControl::MIN_SSTHRESH);
+}
+
+BOOST_AUTO_TEST_CASE(Cubic)
+{
+  CubicCongestionControl::Options options;
+  options.initCwnd = 10.0;
+  options.initSsthresh = 10.0;
+  CubicCongestionControl cc(options);
+  auto t0 = time::steady_clock::now();
+
+  cc.afterCongestionEvent(t0);
+  BOOST_CHECK_CLOSE(cc.getCwnd(), 7.0, 0.001);
+  BOOST_CHECK_CLOSE(cc.getSsthresh(), 7.0, 0.001);
+
+  // right after the decrease, the cubic function is below the window
+  cc.afterAck(makeAck(t0));
+  BOOST_CHECK_CLOSE(cc.getCwnd(), 7.0, 0.001);
+
+  // K = cbrt(10 * 0.3 / 0.4) seconds after the decrease, the window is back at W_max;
+  // one second later, the cubic function is at 10.4
+  auto k = time::duration_cast<time::nanoseconds>(time::duration<double>(std::cbrt(7.5)));
+  for (int i = 0; i < 1000; ++i) {
+    cc.afterAck(makeAck(t0 + k + 1_s));
+  }
+  BOOST_CHECK_GT(cc.getCwnd(), 10.0);
+  BOOST_CHECK_LE(cc.getCwnd(), 10.4);
+
+  // with fast convergence, a loss below the previous W_max lowers the new W_max further,
+  // so that the window stays below it for longer
+  cc.afterCongestionEvent(t0 + 10_s);
+  double cwnd = cc.getCwnd();
+  cc.afterCongestionEvent(t0 + 11_s);
+  BOOST_CHECK_CLOSE(cc.getCwnd(), cwnd * 0.7, 0.001);
+  cc.afterAck(makeAck(t0 + 11_s + k));
+  BOOST_CHECK_LT(cc.getCwnd(), cwnd);
+}
+
+BOOST_AUTO_TEST_CASE(Bbr)
+{
+  BbrCongestionControl cc;
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::STARTUP);
+
+  // one ack every 10 ms with 100 ms RTT: 100 segments per second, BDP of 10 segments
+  auto now = time::steady_clock::now();
+  auto rtt = 100_ms;
+  auto ack = [&] {
+    now += 10_ms;
+    cc.afterAck(makeAck(now, rtt));
+  };
+
+  double prevCwnd = cc.getCwnd();
+  for (int i = 0; i < 11; ++i) {
+    ack();
+  }
+  BOOST_CHECK_GT(cc.getCwnd(), prevCwnd);
+  BOOST_CHECK_EQUAL(cc.getMinRtt(), 100_ms);
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::STARTUP);
+
+  // three rounds without bandwidth growth end STARTUP
+  for (int i = 0; i < 30; ++i) {
+    ack();
+  }
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::DRAIN);
+  double bandwidth = cc.getBandwidth();
+  BOOST_CHECK_CLOSE(bandwidth, 110.0, 1.0); // the first round also counts its starting ack
+  BOOST_CHECK_CLOSE(cc.getCwnd(), bandwidth * 0.1, 1.0);
+
+  for (int i = 0; i < 10; ++i) {
+    ack();
+  }
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::PROBE_BW);
+  BOOST_CHECK_CLOSE(cc.getCwnd(), 2.0 * bandwidth * 0.1, 1.0);
+
+  // losses are ignored after STARTUP
+  cc.afterCongestionEvent(now);
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::PROBE_BW);
+
+  // the minimum RTT expires if it is not measured again within 10 seconds
+  rtt = 110_ms;
+  auto probeBwStart = now;
+  while (cc.getMode() != BbrCongestionControl::Mode::PROBE_RTT) {
+    BOOST_REQUIRE_LT(now - probeBwStart, 11_s);
+    ack();
+  }
+  BOOST_CHECK_GT(now - probeBwStart, 10_s);
+  BOOST_CHECK_EQUAL(cc.getMinRtt(), 110_ms);
+  BOOST_CHECK_EQUAL(cc.getCwnd(), 4.0);
+
+  // PROBE_RTT lasts 200 ms plus one round
+  auto probeRttStart = now;
+  while (cc.getMode() == BbrCongestionControl::Mode::PROBE_RTT) {
+    BOOST_REQUIRE_LT(now - probeRttStart, 1_s);
+    ack();
+  }
+  BOOST_CHECK_GE(now - probeRttStart, 310_ms);
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::PROBE_BW);
+  BOOST_CHECK_GT(cc.getCwnd(), 4.0);
+}
+
+BOOST_AUTO_TEST_CASE(BbrLossEndsStartup)
+{
+  BbrCongestionControl cc;
+  auto now = time::steady_clock::now();
+  for (int i = 0; i < 15; ++i) {
+    now += 10_ms;
+    cc.afterAck(makeAck(now, 100_ms));
+  }
+  BOOST_REQUIRE_GT(cc.getBandwidth(), 0.0);
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::STARTUP);
+
+  cc.afterCongestionEvent(now);
+  BOOST_CHECK_EQUAL(cc.getMode(), BbrCongestionControl::Mode::DRAIN);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestCongestionControl
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
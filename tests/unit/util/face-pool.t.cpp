@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/face-pool.hpp"
+#include "ndn-cxx/util/dummy-client-face.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+
+#include <boost/asio/io_service.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+class FacePoolFixture
+{
+protected:
+  /** \brief Create a pool whose shards are DummyClientFaces that answer every Interest with Data.
+   */
+  unique_ptr<FacePool>
+  makePool(size_t nShards)
+  {
+    for (size_t i = 0; i < nShards; ++i) {
+      keyChains.push_back(make_unique<KeyChain>("pib-memory:", "tpm-memory:"));
+    }
+
+    return make_unique<FacePool>(nShards, [this] (boost::asio::io_service& io) {
+      auto face = make_unique<DummyClientFace>(io, *keyChains.at(faces.size()),
+                                               DummyClientFace::Options{false, true});
+      DummyClientFace* facePtr = face.get();
+      facePtr->onSendInterest.connect([facePtr] (const Interest& interest) {
+        if (interest.getName().size() > 0 && interest.getName()[0] == name::Component("localhost")) {
+          return; // prefix registration command, answered by DummyClientFace itself
+        }
+        facePtr->getIoService().post([=] { facePtr->receive(*makeData(interest.getName())); });
+      });
+      facePtr->onSendData.connect([this, facePtr] (const Data&) {
+        ++nDataSent[std::distance(faces.begin(), std::find(faces.begin(), faces.end(), facePtr))];
+      });
+      faces.push_back(facePtr);
+      return face;
+    });
+  }
+
+  template<typename Predicate>
+  static bool
+  waitFor(const Predicate& pred)
+  {
+    for (int i = 0; i < 5000; ++i) {
+      if (pred()) {
+        return true;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return pred();
+  }
+
+protected:
+  std::vector<unique_ptr<KeyChain>> keyChains;
+  std::vector<DummyClientFace*> faces;
+  std::atomic<int> nDataSent[8] = {};
+};
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_FIXTURE_TEST_SUITE(TestFacePool, FacePoolFixture)
+
+BOOST_AUTO_TEST_CASE(Construct)
+{
+  BOOST_CHECK_THROW(FacePool(0), std::invalid_argument);
+
+  auto pool = makePool(4);
+  BOOST_CHECK_EQUAL(pool->size(), 4);
+  BOOST_CHECK_EQUAL(faces.size(), 4);
+  BOOST_CHECK_EQUAL(&pool->getFace(2), faces[2]);
+  BOOST_CHECK_THROW(pool->getFace(4), std::out_of_range);
+
+  pool->shutdown();
+  pool->shutdown(); // no effect
+}
+
+BOOST_AUTO_TEST_CASE(ShardIndex)
+{
+  auto pool = makePool(4);
+
+  std::set<size_t> usedShards;
+  for (uint64_t seg = 0; seg < 200; ++seg) {
+    Name name = Name("/A").appendSegment(seg);
+    size_t index = pool->getShardIndex(name);
+    BOOST_CHECK_LT(index, 4);
+    BOOST_CHECK_EQUAL(index, pool->getShardIndex(name));
+    usedShards.insert(index);
+  }
+  BOOST_CHECK_EQUAL(usedShards.size(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(ExpressInterest)
+{
+  auto pool = makePool(4);
+  auto mainThread = std::this_thread::get_id();
+
+  const int nInterests = 100;
+  std::atomic<int> nData{0};
+  std::atomic<int> nOnMainThread{0};
+  // Boost.Test assertions are not thread-safe, so the callbacks only count mismatches
+  std::atomic<int> nNameMismatches{0};
+  for (uint64_t seg = 0; seg < nInterests; ++seg) {
+    pool->expressInterest(*makeInterest(Name("/A").appendSegment(seg)),
+                          [&] (const Interest& interest, const Data& data) {
+                            if (interest.getName() != data.getName()) {
+                              ++nNameMismatches;
+                            }
+                            if (std::this_thread::get_id() == mainThread) {
+                              ++nOnMainThread;
+                            }
+                            ++nData;
+                          },
+                          nullptr, nullptr);
+  }
+
+  BOOST_CHECK(waitFor([&] { return nData == nInterests; }));
+  BOOST_CHECK_EQUAL(nNameMismatches, 0);
+  BOOST_CHECK_EQUAL(nOnMainThread, 0);
+}
+
+BOOST_AUTO_TEST_CASE(InterestFilter)
+{
+  const size_t nShards = 4;
+  auto pool = makePool(nShards);
+
+  std::atomic<int> nRegSuccess{0};
+  std::atomic<int> nRegFailure{0};
+  std::atomic<int> nInterests{0};
+  auto hdl = pool->setInterestFilter("/P",
+    [&] (const ndn::InterestFilter&, const Interest& interest) {
+      ++nInterests;
+      pool->put(*makeData(interest.getName()));
+    },
+    [&] (const Name&) { ++nRegSuccess; },
+    [&] (const Name&, const std::string&) { ++nRegFailure; });
+
+  BOOST_REQUIRE(waitFor([&] { return nRegSuccess + nRegFailure > 0; }));
+  BOOST_CHECK_EQUAL(nRegSuccess, 1);
+  BOOST_CHECK_EQUAL(nRegFailure, 0);
+
+  // an Interest arriving on any shard is dispatched, and the Data goes out on the same shard
+  for (size_t i = 0; i < nShards; ++i) {
+    faces[i]->getIoService().post([face = faces[i], i] {
+      face->receive(*makeInterest(Name("/P").appendNumber(i)));
+    });
+  }
+  BOOST_CHECK(waitFor([&] { return nInterests == static_cast<int>(nShards); }));
+  BOOST_CHECK(waitFor([&] {
+    return std::all_of(nDataSent, nDataSent + nShards, [] (const auto& n) { return n == 1; });
+  }));
+
+  hdl.cancel();
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFacePool
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
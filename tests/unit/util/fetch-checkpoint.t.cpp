@@ -0,0 +1,118 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2018 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-checkpoint.hpp"
+
+#include "tests/boost-test.hpp"
+#include <boost/lexical_cast.hpp>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_AUTO_TEST_SUITE(TestFetchCheckpoint)
+
+static FetchCheckpoint
+makeCheckpoint()
+{
+  FetchCheckpoint checkpoint;
+  checkpoint.versionedName = "/A/v=1";
+  checkpoint.nSegments = 300;
+  checkpoint.segmentSize = 4096;
+  checkpoint.lastSegmentSize = 10;
+  checkpoint.receivedRanges = {{0, 128}, {200, 201}, {299, 300}};
+  return checkpoint;
+}
+
+BOOST_AUTO_TEST_CASE(EncodeDecode)
+{
+  FetchCheckpoint checkpoint1 = makeCheckpoint();
+  Block wire = checkpoint1.wireEncode();
+  BOOST_CHECK_EQUAL(wire.type(), 200);
+
+  FetchCheckpoint checkpoint2(wire);
+  BOOST_CHECK_EQUAL(checkpoint1, checkpoint2);
+
+  FetchCheckpoint empty;
+  BOOST_CHECK_EQUAL(FetchCheckpoint(empty.wireEncode()), empty);
+}
+
+BOOST_AUTO_TEST_CASE(DecodeError)
+{
+  BOOST_CHECK_THROW(FetchCheckpoint(Block(tlv::Name)), FetchCheckpoint::Error);
+
+  // missing required fields
+  BOOST_CHECK_THROW(FetchCheckpoint(Block(200)), FetchCheckpoint::Error);
+
+  // ranges out of order
+  FetchCheckpoint checkpoint = makeCheckpoint();
+  checkpoint.receivedRanges = {{200, 201}, {0, 128}};
+  BOOST_CHECK_THROW(FetchCheckpoint(checkpoint.wireEncode()), FetchCheckpoint::Error);
+
+  // empty range
+  checkpoint.receivedRanges = {{5, 5}};
+  BOOST_CHECK_THROW(FetchCheckpoint(checkpoint.wireEncode()), FetchCheckpoint::Error);
+
+  // range beyond NSegments
+  checkpoint.receivedRanges = {{0, 128}, {299, 301}};
+  BOOST_CHECK_THROW(FetchCheckpoint(checkpoint.wireEncode()), FetchCheckpoint::Error);
+  checkpoint.nSegments = 0;
+  BOOST_CHECK_NO_THROW(FetchCheckpoint(checkpoint.wireEncode()));
+}
+
+BOOST_AUTO_TEST_CASE(Contains)
+{
+  FetchCheckpoint checkpoint = makeCheckpoint();
+  BOOST_CHECK_EQUAL(checkpoint.contains(0), true);
+  BOOST_CHECK_EQUAL(checkpoint.contains(127), true);
+  BOOST_CHECK_EQUAL(checkpoint.contains(128), false);
+  BOOST_CHECK_EQUAL(checkpoint.contains(200), true);
+  BOOST_CHECK_EQUAL(checkpoint.contains(298), false);
+  BOOST_CHECK_EQUAL(checkpoint.contains(299), true);
+  BOOST_CHECK_EQUAL(checkpoint.contains(300), false);
+  BOOST_CHECK_EQUAL(checkpoint.getNSegmentsReceived(), 130);
+  BOOST_CHECK_EQUAL(FetchCheckpoint().contains(0), false);
+}
+
+BOOST_AUTO_TEST_CASE(Equality)
+{
+  FetchCheckpoint checkpoint1 = makeCheckpoint();
+  FetchCheckpoint checkpoint2 = checkpoint1;
+  BOOST_CHECK_EQUAL(checkpoint1, checkpoint2);
+
+  checkpoint2.receivedRanges.pop_back();
+  BOOST_CHECK_NE(checkpoint1, checkpoint2);
+}
+
+BOOST_AUTO_TEST_CASE(Print)
+{
+  BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(makeCheckpoint()),
+                    "FetchCheckpoint(Name: /A/v=1, NSegments: 300, SegmentSize: 4096, "
+                    "LastSegmentSize: 10, ReceivedRanges: [[0, 128), [200, 201), [299, 300)])");
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFetchCheckpoint
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -0,0 +1,342 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-manager.hpp"
+
+#include "ndn-cxx/data.hpp"
+#include "ndn-cxx/lp/nack.hpp"
+#include "ndn-cxx/lp/tags.hpp"
+#include "ndn-cxx/util/dummy-client-face.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+#include "tests/unit/dummy-validator.hpp"
+#include "tests/unit/identity-management-time-fixture.hpp"
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+class FetchManagerFixture : public IdentityManagementTimeFixture
+{
+public:
+  FetchManagerFixture()
+    : face(io, m_keyChain)
+  {
+  }
+
+  static std::string
+  getSegmentContent(const Name& object, uint64_t segment)
+  {
+    return object.toUri() + "#" + to_string(segment) + ";";
+  }
+
+  static std::string
+  getObjectContent(const Name& object, uint64_t nSegments)
+  {
+    std::string content;
+    for (uint64_t i = 0; i < nSegments; ++i) {
+      content += getSegmentContent(object, i);
+    }
+    return content;
+  }
+
+  /**
+   * @brief Returns the name of the object requested by @p interest.
+   */
+  static Name
+  getObject(const Interest& interest)
+  {
+    return interest.getCanBePrefix() ? interest.getName() : interest.getName().getPrefix(-2);
+  }
+
+  void
+  reply(const Interest& interest)
+  {
+    Name name = interest.getName();
+    if (interest.getCanBePrefix()) {
+      name.appendVersion(1).appendSegment(0);
+    }
+    Name object = name.getPrefix(-2);
+    uint64_t segment = name[-1].toSegment();
+
+    auto data = make_shared<Data>(name);
+    data->setFreshnessPeriod(1_s);
+    std::string content = getSegmentContent(object, segment);
+    data->setContent(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+    data->setFinalBlock(name::Component::fromSegment(nSegments - 1));
+    face.receive(*signData(data));
+  }
+
+  /**
+   * @brief Replies to the Interests sent by the manager for @p duration.
+   */
+  void
+  run(time::nanoseconds duration)
+  {
+    for (auto elapsed = 0_ns; elapsed < duration; elapsed += 1_ms) {
+      while (nProcessed < face.sentInterests.size()) {
+        reply(face.sentInterests[nProcessed++]);
+      }
+      advanceClocks(1_ms);
+    }
+  }
+
+  FetchManager::FetchId
+  fetch(FetchManager& manager, const Name& object)
+  {
+    return manager.fetch(Interest(object),
+      [this, object] (ConstBufferPtr content) {
+        results[object].assign(content->begin(), content->end());
+      },
+      [this] (uint32_t code, const std::string&) {
+        errors.push_back(code);
+      });
+  }
+
+  static unique_ptr<CongestionControl>
+  makeConstantWindow(double cwnd)
+  {
+    AimdCongestionControl::Options options;
+    options.initCwnd = cwnd;
+    options.aiStep = 0.0;
+    return make_unique<AimdCongestionControl>(options);
+  }
+
+public:
+  DummyClientFace face;
+  DummyValidator acceptValidator;
+  uint64_t nSegments = 5;
+  size_t nProcessed = 0;
+
+  std::map<Name, std::string> results;
+  std::vector<uint32_t> errors;
+};
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_FIXTURE_TEST_SUITE(TestFetchManager, FetchManagerFixture)
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  FetchManager::Options options;
+  options.maxConcurrentFetches = 0;
+  BOOST_CHECK_THROW(FetchManager(face, acceptValidator, options), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(ManyObjects)
+{
+  FetchManager manager(face, acceptValidator);
+  for (int i = 0; i < 20; ++i) {
+    fetch(manager, Name("/app/obj").appendNumber(i));
+  }
+  run(1_s);
+
+  BOOST_CHECK(errors.empty());
+  BOOST_REQUIRE_EQUAL(results.size(), 20);
+  for (const auto& result : results) {
+    BOOST_CHECK_EQUAL(result.second, getObjectContent(result.first, nSegments));
+  }
+  BOOST_CHECK_EQUAL(manager.getNActiveFetches(), 0);
+  // no segment was requested twice
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 20 * nSegments);
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrencyLimit)
+{
+  FetchManager::Options options;
+  options.maxConcurrentFetches = 2;
+  options.congestionControl = [] { return makeConstantWindow(10.0); };
+  FetchManager manager(face, acceptValidator, options);
+  for (int i = 0; i < 5; ++i) {
+    fetch(manager, Name("/app/obj").appendNumber(i));
+  }
+  advanceClocks(1_ms);
+
+  BOOST_CHECK_EQUAL(manager.getNActiveFetches(), 2);
+  BOOST_CHECK_EQUAL(manager.getNQueuedFetches(), 3);
+  std::set<Name> objects;
+  for (const auto& interest : face.sentInterests) {
+    objects.insert(getObject(interest));
+  }
+  BOOST_CHECK_EQUAL(objects.size(), 2);
+
+  run(1_s);
+  BOOST_CHECK(errors.empty());
+  BOOST_CHECK_EQUAL(results.size(), 5);
+  BOOST_CHECK_EQUAL(manager.getNQueuedFetches(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(SharedWindow)
+{
+  nSegments = 50;
+  FetchManager manager(face, acceptValidator);
+  BOOST_CHECK(!manager.getPathCwnd("/app/obj1"));
+  fetch(manager, "/app/obj1");
+  run(1_s);
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+
+  // the window grown by the first object is used by the next one on the same path
+  auto cwnd = manager.getPathCwnd("/app/obj2");
+  BOOST_REQUIRE(cwnd);
+  BOOST_CHECK_GT(*cwnd, 10.0);
+
+  fetch(manager, "/app/obj2");
+  advanceClocks(1_ms);
+  size_t nSent = face.sentInterests.size();
+  reply(face.sentInterests.back()); // discovery
+  advanceClocks(1_ms);
+  BOOST_CHECK_GT(face.sentInterests.size() - nSent, 10);
+
+  // another path starts with its own window
+  BOOST_CHECK(!manager.getPathCwnd("/other/obj"));
+}
+
+BOOST_AUTO_TEST_CASE(RoundRobin)
+{
+  nSegments = 100;
+  FetchManager::Options options;
+  options.congestionControl = [] { return makeConstantWindow(4.0); };
+  FetchManager manager(face, acceptValidator, options);
+  fetch(manager, "/app/a");
+  fetch(manager, "/app/b");
+  advanceClocks(1_ms);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 2);
+
+  // a gets the free slots while b has nothing to request
+  reply(face.sentInterests[0]);
+  advanceClocks(1_ms);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 5);
+  reply(face.sentInterests[1]);
+  advanceClocks(1_ms);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 6);
+
+  // then slots alternate between the objects
+  std::map<Name, int> nInterests;
+  for (size_t i = 2; i < 20; ++i) {
+    reply(face.sentInterests[i]);
+    advanceClocks(1_ms);
+    ++nInterests[getObject(face.sentInterests.back())];
+  }
+  BOOST_CHECK_EQUAL(nInterests["/app/a"], 9);
+  BOOST_CHECK_EQUAL(nInterests["/app/b"], 9);
+}
+
+BOOST_AUTO_TEST_CASE(Cancel)
+{
+  FetchManager::Options options;
+  options.maxConcurrentFetches = 1;
+  FetchManager manager(face, acceptValidator, options);
+  auto id1 = fetch(manager, "/app/obj1");
+  auto id2 = fetch(manager, "/app/obj2");
+  fetch(manager, "/app/obj3");
+
+  BOOST_CHECK_EQUAL(manager.cancel(id2), true); // queued
+  BOOST_CHECK_EQUAL(manager.cancel(id1), true); // active
+  BOOST_CHECK_EQUAL(manager.cancel(id1), false);
+  BOOST_CHECK_EQUAL(manager.getNActiveFetches(), 1);
+  BOOST_CHECK_EQUAL(manager.getNQueuedFetches(), 0);
+
+  run(1_s);
+  BOOST_CHECK(errors.empty());
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  BOOST_CHECK_EQUAL(results.begin()->first, "/app/obj3");
+}
+
+BOOST_AUTO_TEST_CASE(Errors)
+{
+  FetchManager::Options options;
+  options.maxTimeout = 1_s;
+  FetchManager manager(face, acceptValidator, options);
+  fetch(manager, "/app/nack");
+  fetch(manager, "/app/timeout");
+  fetch(manager, "/app/ok");
+
+  for (int i = 0; i < 3000; ++i) {
+    while (nProcessed < face.sentInterests.size()) {
+      const Interest& interest = face.sentInterests[nProcessed++];
+      Name object = getObject(interest);
+      if (object == "/app/nack") {
+        face.receive(makeNack(interest, lp::NackReason::NO_ROUTE));
+      }
+      else if (object == "/app/ok") {
+        reply(interest);
+      }
+    }
+    advanceClocks(1_ms);
+  }
+
+  std::vector<uint32_t> expectedErrors{FetchManager::NACK_ERROR, FetchManager::INTEREST_TIMEOUT};
+  BOOST_CHECK_EQUAL_COLLECTIONS(errors.begin(), errors.end(), expectedErrors.begin(), expectedErrors.end());
+  BOOST_CHECK_EQUAL(results.size(), 1);
+  BOOST_CHECK_EQUAL(manager.getNActiveFetches(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Tags)
+{
+  FetchManager manager(face, acceptValidator);
+  Interest interest("/app/obj");
+  interest.setTag(make_shared<lp::NextHopFaceIdTag>(42));
+  manager.fetch(interest,
+    [this] (ConstBufferPtr content) {
+      results["/app/obj"].assign(content->begin(), content->end());
+    },
+    [this] (uint32_t code, const std::string&) {
+      errors.push_back(code);
+    });
+  run(1_s);
+
+  BOOST_CHECK(errors.empty());
+  BOOST_CHECK_EQUAL(results.size(), 1);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), nSegments);
+  for (const auto& sent : face.sentInterests) {
+    auto tag = sent.getTag<lp::NextHopFaceIdTag>();
+    BOOST_REQUIRE(tag != nullptr);
+    BOOST_CHECK_EQUAL(tag->get(), 42);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HugeSegmentNumber)
+{
+  FetchManager manager(face, acceptValidator);
+  fetch(manager, "/app/obj");
+  advanceClocks(1_ms);
+
+  // the discovery Interest is answered with a very large segment number
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 1);
+  Name name = Name(face.sentInterests[nProcessed++].getName()).appendVersion(1);
+  auto data = make_shared<Data>(Name(name).appendSegment(uint64_t(1) << 60));
+  data->setFreshnessPeriod(1_s);
+  face.receive(*signData(data));
+  run(1_s);
+
+  BOOST_CHECK(errors.empty());
+  BOOST_REQUIRE_EQUAL(results.size(), 1);
+  BOOST_CHECK_EQUAL(results.begin()->second, getObjectContent("/app/obj", nSegments));
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFetchManager
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
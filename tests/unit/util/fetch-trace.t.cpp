@@ -0,0 +1,177 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/fetch-trace.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/unit/unit-test-time-fixture.hpp"
+
+#include <boost/lexical_cast.hpp>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+using EventType = FetchTrace::EventType;
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_FIXTURE_TEST_SUITE(TestFetchTrace, UnitTestTimeFixture)
+
+BOOST_AUTO_TEST_CASE(EventTypeToString)
+{
+  BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(EventType::SEND), "send");
+  BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(EventType::VALIDATION_FAILURE), "validation-failure");
+  BOOST_CHECK_EQUAL(boost::lexical_cast<std::string>(EventType::CWND), "cwnd");
+}
+
+BOOST_AUTO_TEST_CASE(Ring)
+{
+  BOOST_CHECK_THROW(FetchTrace(0), std::invalid_argument);
+
+  FetchTrace trace(4);
+  BOOST_CHECK_EQUAL(trace.getCapacity(), 4);
+  BOOST_CHECK(trace.getEvents().empty());
+
+  for (uint64_t i = 0; i < 3; ++i) {
+    advanceClocks(1_ms);
+    trace.record(EventType::SEND, i);
+  }
+  auto events = trace.getEvents();
+  BOOST_REQUIRE_EQUAL(events.size(), 3);
+  BOOST_CHECK_EQUAL(events[0].segment, 0);
+  BOOST_CHECK_EQUAL(events[0].time, 1_ms);
+  BOOST_CHECK_EQUAL(events[2].segment, 2);
+
+  for (uint64_t i = 3; i < 10; ++i) {
+    advanceClocks(1_ms);
+    trace.record(EventType::SEND, i);
+  }
+  BOOST_CHECK_EQUAL(trace.getNRecorded(), 10);
+  events = trace.getEvents();
+  BOOST_REQUIRE_EQUAL(events.size(), 4);
+  for (size_t i = 0; i < 4; ++i) {
+    BOOST_CHECK_EQUAL(events[i].segment, 6 + i);
+    BOOST_CHECK_EQUAL(events[i].time, time::milliseconds(7 + i));
+  }
+
+  // statistics are not limited by the capacity
+  BOOST_CHECK_EQUAL(trace.getStatistics().nInterests, 10);
+
+  trace.reset();
+  BOOST_CHECK_EQUAL(trace.getNRecorded(), 0);
+  BOOST_CHECK(trace.getEvents().empty());
+  BOOST_CHECK_EQUAL(trace.getStatistics().nInterests, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Statistics)
+{
+  FetchTrace trace(16);
+  for (uint64_t i = 0; i < 100; ++i) {
+    trace.record(i % 10 == 0 ? EventType::RETRANSMIT : EventType::SEND, i);
+    trace.recordRtt(i, time::milliseconds(i + 1), 200_ms);
+    trace.record(EventType::VALIDATE, i, 1000);
+  }
+  trace.record(EventType::TIMEOUT, 0);
+  trace.record(EventType::NACK, 1);
+  trace.record(EventType::CONGESTION_MARK, 2);
+  trace.record(EventType::CONGESTION_MARK, 3);
+  advanceClocks(2_s);
+  trace.finish();
+  advanceClocks(1_s);
+
+  auto stats = trace.getStatistics();
+  BOOST_CHECK_EQUAL(stats.duration, 2_s);
+  BOOST_CHECK_EQUAL(stats.nInterests, 100);
+  BOOST_CHECK_EQUAL(stats.nRetransmissions, 10);
+  BOOST_CHECK_EQUAL(stats.nTimeouts, 1);
+  BOOST_CHECK_EQUAL(stats.nNacks, 1);
+  BOOST_CHECK_EQUAL(stats.nCongestionMarks, 2);
+  BOOST_CHECK_EQUAL(stats.nSegments, 100);
+  BOOST_CHECK_EQUAL(stats.nBytes, 100000);
+  BOOST_CHECK_CLOSE(stats.goodput, 50000.0, 0.001);
+  BOOST_CHECK_CLOSE(stats.retxRatio, 0.1, 0.001);
+  BOOST_CHECK_EQUAL(stats.nRttSamples, 100);
+  BOOST_CHECK_EQUAL(stats.minRtt, 1_ms);
+  BOOST_CHECK_EQUAL(stats.maxRtt, 100_ms);
+  BOOST_CHECK_CLOSE(static_cast<double>(stats.rttP50.count()), 50e6, 7.0);
+  BOOST_CHECK_CLOSE(static_cast<double>(stats.rttP99.count()), 99e6, 7.0);
+  BOOST_CHECK_LE(stats.rttP99, stats.maxRtt);
+}
+
+BOOST_AUTO_TEST_CASE(NoRttSamples)
+{
+  FetchTrace trace;
+  auto stats = trace.getStatistics();
+  BOOST_CHECK_EQUAL(stats.duration, 0_ns);
+  BOOST_CHECK_EQUAL(stats.goodput, 0.0);
+  BOOST_CHECK_EQUAL(stats.retxRatio, 0.0);
+  BOOST_CHECK_EQUAL(stats.rttP50, 0_ns);
+  BOOST_CHECK_EQUAL(stats.rttP99, 0_ns);
+}
+
+BOOST_AUTO_TEST_CASE(Csv)
+{
+  FetchTrace trace;
+  advanceClocks(1500_us);
+  trace.record(EventType::SEND, 0, 1000);
+  advanceClocks(10_ms);
+  trace.recordRtt(0, 10_ms, 150_ms);
+  trace.record(EventType::CWND, 0, 2, 0.5);
+
+  std::ostringstream os;
+  trace.writeCsv(os);
+  BOOST_CHECK_EQUAL(os.str(),
+                    "time,event,segment,value,value2\n"
+                    "1.500,send,0,1000,0\n"
+                    "11.500,rtt,0,10,150\n"
+                    "11.500,cwnd,0,2,0.5\n");
+}
+
+BOOST_AUTO_TEST_CASE(Json)
+{
+  FetchTrace trace;
+  trace.record(EventType::SEND, 3, 1000);
+  advanceClocks(4_ms);
+  trace.recordRtt(3, 4_ms, 100_ms);
+  trace.record(EventType::VALIDATE, 3, 8000);
+  trace.record(EventType::TIMEOUT, 4);
+  trace.finish();
+
+  std::ostringstream os;
+  trace.writeJson(os);
+  BOOST_CHECK_EQUAL(os.str(),
+                    "{\"statistics\":{\"duration\":4,\"nInterests\":1,\"nRetransmissions\":0,"
+                    "\"nTimeouts\":1,\"nNacks\":0,\"nCongestionMarks\":0,\"nSegments\":1,\"nBytes\":8000,"
+                    "\"goodput\":2e+06,\"retxRatio\":0,\"nRttSamples\":1,\"minRtt\":4,\"maxRtt\":4,"
+                    "\"rttP50\":4,\"rttP99\":4},\"nRecorded\":4,\"events\":["
+                    "{\"time\":0.000,\"event\":\"send\",\"segment\":3,\"timeout\":1000},"
+                    "{\"time\":4.000,\"event\":\"rtt\",\"segment\":3,\"rtt\":4,\"rto\":100},"
+                    "{\"time\":4.000,\"event\":\"validate\",\"segment\":3,\"size\":8000},"
+                    "{\"time\":4.000,\"event\":\"timeout\",\"segment\":4}]}");
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestFetchTrace
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
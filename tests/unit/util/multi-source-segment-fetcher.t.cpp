@@ -0,0 +1,316 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/multi-source-segment-fetcher.hpp"
+
+#include "ndn-cxx/data.hpp"
+#include "ndn-cxx/lp/nack.hpp"
+#include "ndn-cxx/util/dummy-client-face.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/make-interest-data.hpp"
+#include "tests/unit/dummy-validator.hpp"
+#include "tests/unit/identity-management-time-fixture.hpp"
+
+#include <set>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+class MultiSourceFixture : public IdentityManagementTimeFixture
+{
+public:
+  enum class Reply {
+    DATA,
+    DROP,
+    NACK,
+  };
+
+  MultiSourceFixture()
+    : face(io, m_keyChain)
+    , sources{{"/obj", DelegationList{{0, "/a"}}}, {"/obj", DelegationList{{0, "/b"}}}}
+  {
+  }
+
+  static std::string
+  getSegmentContent(uint64_t segment)
+  {
+    return "segment" + to_string(segment) + ";";
+  }
+
+  static std::string
+  getObjectContent(uint64_t nSegments)
+  {
+    std::string content;
+    for (uint64_t i = 0; i < nSegments; ++i) {
+      content += getSegmentContent(i);
+    }
+    return content;
+  }
+
+  /**
+   * @brief Returns the forwarding hint of @p interest, or its first name component if it has none.
+   */
+  static std::string
+  getSource(const Interest& interest)
+  {
+    if (interest.getForwardingHint().empty()) {
+      return "/" + interest.getName()[0].toUri();
+    }
+    return interest.getForwardingHint()[0].name.toUri();
+  }
+
+  shared_ptr<MultiSourceSegmentFetcher>
+  startFetcher(const MultiSourceSegmentFetcher::Options& options = {})
+  {
+    auto fetcher = MultiSourceSegmentFetcher::start(face, sources, acceptValidator, options);
+    fetcher->onComplete.connect([this] (ConstBufferPtr content) {
+      ++nCompletions;
+      result.assign(content->begin(), content->end());
+    });
+    fetcher->onError.connect([this] (uint32_t code, const std::string&) {
+      ++nErrors;
+      lastError = code;
+    });
+    fetcher->afterSourceFailed.connect([this] (size_t index, const std::string&) {
+      failedSources.push_back(index);
+    });
+    return fetcher;
+  }
+
+  /**
+   * @brief Answers the Interests sent by the fetcher for @p duration.
+   *
+   * @p decide returns what the source, as given by getSource(), does with the Interest.
+   */
+  void
+  run(const std::function<Reply(const std::string& source, const Interest&)>& decide,
+      time::nanoseconds duration)
+  {
+    for (auto elapsed = 0_ns; elapsed < duration; elapsed += 1_ms) {
+      while (nProcessed < face.sentInterests.size()) {
+        Interest interest = face.sentInterests[nProcessed++];
+        switch (decide(getSource(interest), interest)) {
+          case Reply::DATA: {
+            Name name = interest.getName();
+            if (interest.getCanBePrefix()) {
+              name.appendVersion(1).appendSegment(discoverySegment);
+            }
+            uint64_t segment = name[-1].toSegment();
+            auto data = make_shared<Data>(name);
+            data->setFreshnessPeriod(1_s);
+            std::string content = getSegmentContent(segment);
+            data->setContent(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+            data->setFinalBlock(name::Component::fromSegment(nSegments - 1));
+            face.receive(*signData(data));
+            break;
+          }
+          case Reply::DROP:
+            break;
+          case Reply::NACK:
+            face.receive(makeNack(interest, lp::NackReason::NO_ROUTE));
+            break;
+        }
+      }
+      advanceClocks(1_ms);
+    }
+  }
+
+public:
+  DummyClientFace face;
+  DummyValidator acceptValidator;
+  std::vector<MultiSourceSegmentFetcher::Source> sources;
+  uint64_t nSegments = 20;
+  // segment that is sent in response to the Interest that discovers the version
+  uint64_t discoverySegment = 0;
+  size_t nProcessed = 0;
+
+  int nCompletions = 0;
+  int nErrors = 0;
+  uint32_t lastError = 0;
+  std::string result;
+  std::vector<size_t> failedSources;
+};
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_FIXTURE_TEST_SUITE(TestMultiSourceSegmentFetcher, MultiSourceFixture)
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  MultiSourceSegmentFetcher::Options options;
+  options.maxSourceFailures = 0;
+  BOOST_CHECK_THROW(MultiSourceSegmentFetcher::start(face, sources, acceptValidator, options),
+                    std::invalid_argument);
+
+  sources.clear();
+  BOOST_CHECK_THROW(MultiSourceSegmentFetcher::start(face, sources, acceptValidator),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(TwoSources)
+{
+  auto fetcher = startFetcher();
+  advanceClocks(1_ms);
+  BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 1);
+  BOOST_CHECK_EQUAL(getSource(face.sentInterests[0]), "/a");
+  BOOST_CHECK_EQUAL(face.sentInterests[0].getCanBePrefix(), true);
+  BOOST_CHECK_EQUAL(face.sentInterests[0].getMustBeFresh(), true);
+
+  std::map<std::string, int> nInterests;
+  run([&] (const std::string& source, const Interest&) {
+      ++nInterests[source];
+      return Reply::DATA;
+    }, 1_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  BOOST_CHECK_GT(nInterests["/a"], 1);
+  BOOST_CHECK_GT(nInterests["/b"], 1);
+  BOOST_CHECK_GT(fetcher->getNSegmentsReceived(0), 1);
+  BOOST_CHECK_GT(fetcher->getNSegmentsReceived(1), 1);
+  BOOST_CHECK_EQUAL(nInterests["/a"] + nInterests["/b"], nSegments); // no duplicates
+}
+
+BOOST_AUTO_TEST_CASE(StalledSource)
+{
+  // source b does not respond
+  auto fetcher = startFetcher();
+  std::set<uint64_t> requestedFromB;
+  run([&] (const std::string& source, const Interest& interest) {
+      if (source == "/b") {
+        requestedFromB.insert(interest.getName()[-1].toSegment());
+        return Reply::DROP;
+      }
+      return Reply::DATA;
+    }, 200_ms);
+
+  // the segments stalled at b were fetched from a long before their Interests timed out
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  BOOST_CHECK(!requestedFromB.empty());
+  BOOST_CHECK_EQUAL(fetcher->getNSegmentsReceived(1), 0);
+  BOOST_CHECK(failedSources.empty());
+}
+
+BOOST_AUTO_TEST_CASE(NackedSource)
+{
+  auto fetcher = startFetcher();
+  run([] (const std::string& source, const Interest& interest) {
+      return source == "/b" ? Reply::NACK : Reply::DATA;
+    }, 1_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  BOOST_REQUIRE_EQUAL(failedSources.size(), 1);
+  BOOST_CHECK_EQUAL(failedSources[0], 1);
+}
+
+BOOST_AUTO_TEST_CASE(TimedOutSource)
+{
+  MultiSourceSegmentFetcher::Options options;
+  options.maxSourceFailures = 2;
+  auto fetcher = startFetcher(options);
+  run([] (const std::string& source, const Interest&) {
+      return source == "/b" ? Reply::DROP : Reply::DATA;
+    }, 5_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  BOOST_CHECK_EQUAL(fetcher->getNSegmentsReceived(1), 0);
+}
+
+BOOST_AUTO_TEST_CASE(AllSourcesFail)
+{
+  auto fetcher = startFetcher();
+  run([] (const std::string&, const Interest&) { return Reply::NACK; }, 1_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, MultiSourceSegmentFetcher::NO_USABLE_SOURCE);
+  BOOST_CHECK_EQUAL(failedSources.size(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(DiscoveryFailover)
+{
+  auto fetcher = startFetcher();
+  run([] (const std::string& source, const Interest&) {
+      return source == "/a" ? Reply::NACK : Reply::DATA;
+    }, 1_s);
+
+  BOOST_REQUIRE_EQUAL(failedSources.size(), 1);
+  BOOST_CHECK_EQUAL(failedSources[0], 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  BOOST_CHECK_EQUAL(fetcher->getNSegmentsReceived(1), nSegments);
+}
+
+BOOST_AUTO_TEST_CASE(DifferentPrefixes)
+{
+  sources = {{"/a/obj"}, {"/b/obj"}};
+  auto fetcher = startFetcher();
+
+  std::set<Name> names;
+  run([&] (const std::string&, const Interest& interest) {
+      if (!interest.getCanBePrefix()) {
+        names.insert(interest.getName().getPrefix(-1));
+      }
+      return Reply::DATA;
+    }, 1_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+  // the version discovered at the first source is used at the second one
+  std::set<Name> expectedNames{Name("/a/obj").appendVersion(1), Name("/b/obj").appendVersion(1)};
+  BOOST_CHECK_EQUAL_COLLECTIONS(names.begin(), names.end(), expectedNames.begin(), expectedNames.end());
+}
+
+BOOST_AUTO_TEST_CASE(HugeSegmentNumber)
+{
+  discoverySegment = uint64_t(1) << 60;
+  auto fetcher = startFetcher();
+  run([] (const std::string&, const Interest&) { return Reply::DATA; }, 1_s);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(result, getObjectContent(nSegments));
+}
+
+BOOST_AUTO_TEST_CASE(ValidationFailure)
+{
+  acceptValidator.getPolicy().setResult(false);
+  auto fetcher = startFetcher();
+  run([] (const std::string&, const Interest&) { return Reply::DATA; }, 100_ms);
+
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, MultiSourceSegmentFetcher::SEGMENT_VALIDATION_FAIL);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestMultiSourceSegmentFetcher
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn
@@ -30,6 +30,8 @@
 #include "tests/unit/dummy-validator.hpp"
 #include "tests/unit/identity-management-time-fixture.hpp"
 
+#include <boost/filesystem.hpp>
+#include <fstream>
 #include <set>
 
 namespace ndn {
@@ -61,6 +63,19 @@ public:
     return signData(data);
   }
 
+  static shared_ptr<Data>
+  makeSegmentWithContent(uint64_t segment, const std::string& content,
+                         optional<uint64_t> finalSegment = nullopt)
+  {
+    auto data = make_shared<Data>(Name("/hello/world/version0").appendSegment(segment));
+    data->setFreshnessPeriod(1_s);
+    data->setContent(reinterpret_cast<const uint8_t*>(content.data()), content.size());
+    if (finalSegment) {
+      data->setFinalBlock(name::Component::fromSegment(*finalSegment));
+    }
+    return signData(data);
+  }
+
   void
   onError(uint32_t errorCode)
   {
@@ -189,6 +204,28 @@ BOOST_AUTO_TEST_CASE(InvalidOptions)
                     std::invalid_argument);
 }
 
+BOOST_AUTO_TEST_CASE(InvalidRange)
+{
+  SegmentFetcher::Options options;
+  options.startSegment = 5;
+  options.endSegment = 5;
+  DummyValidator acceptValidator;
+  BOOST_CHECK_THROW(SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options),
+                    std::invalid_argument);
+
+  // resuming requires 'in order' or 'file' mode
+  options.endSegment = 10;
+  options.checkpoint.emplace();
+  options.checkpoint->versionedName = "/hello/world/version0";
+  BOOST_CHECK_THROW(SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options),
+                    std::invalid_argument);
+
+  options.inOrder = true;
+  options.checkpoint->versionedName.clear();
+  BOOST_CHECK_THROW(SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options),
+                    std::invalid_argument);
+}
+
 BOOST_AUTO_TEST_CASE(ExceedMaxTimeout)
 {
   DummyValidator acceptValidator;
@@ -310,6 +347,64 @@ BOOST_AUTO_TEST_CASE(ConstantCwnd)
   BOOST_CHECK_EQUAL(fetcher->m_cwnd, 1.0);
 }
 
+class FixedWindowCongestionControl : public CongestionControl
+{
+public:
+  FixedWindowCongestionControl(int& nAcks, int& nCongestionEvents)
+    : CongestionControl(3.0, 3.0)
+    , m_nAcks(nAcks)
+    , m_nCongestionEvents(nCongestionEvents)
+  {
+  }
+
+  void
+  afterAck(const AckSample&) final
+  {
+    ++m_nAcks;
+  }
+
+  void
+  afterCongestionEvent(time::steady_clock::TimePoint) final
+  {
+    ++m_nCongestionEvents;
+  }
+
+private:
+  int& m_nAcks;
+  int& m_nCongestionEvents;
+};
+
+BOOST_AUTO_TEST_CASE(CustomCongestionControl)
+{
+  int nAcks = 0;
+  int nCongestionEvents = 0;
+  SegmentFetcher::Options options;
+  options.congestionControl = [&] {
+    return make_unique<FixedWindowCongestionControl>(nAcks, nCongestionEvents);
+  };
+  DummyValidator acceptValidator;
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  connectSignals(fetcher);
+  advanceClocks(10_ms);
+
+  face.receive(*makeDataSegment("/hello/world/version0", 0, false));
+  advanceClocks(10_ms);
+  BOOST_CHECK_EQUAL(nAcks, 1);
+  BOOST_CHECK_EQUAL(fetcher->m_cwnd, 3.0);
+  BOOST_CHECK_EQUAL(fetcher->m_nSegmentsInFlight, 3);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 4);
+
+  face.receive(*makeDataSegment("/hello/world/version0", 1, false));
+  advanceClocks(10_ms);
+  BOOST_CHECK_EQUAL(nAcks, 2);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 5);
+
+  nackLastInterest(lp::NackReason::CONGESTION);
+  BOOST_CHECK_EQUAL(nCongestionEvents, 1);
+  BOOST_CHECK_EQUAL(fetcher->m_nSegmentsInFlight, 3);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+}
+
 BOOST_AUTO_TEST_CASE(BasicMultipleSegments)
 {
   DummyValidator acceptValidator;
@@ -357,6 +452,28 @@ BOOST_AUTO_TEST_CASE(BasicInOrder)
   BOOST_CHECK_EQUAL(nAfterSegmentTimedOut, 0);
 }
 
+BOOST_AUTO_TEST_CASE(ValidationPipeline)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.inOrder = true;
+  options.nValidationThreads = 2;
+  nSegments = 401;
+
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+  connectSignals(fetcher);
+
+  face.processEvents(1_s);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(dataSize, 14 * 401);
+  BOOST_CHECK_EQUAL(nAfterSegmentValidated, 401);
+  BOOST_CHECK_EQUAL(nOnInOrderData, 401);
+  BOOST_CHECK_EQUAL(nAfterSegmentTimedOut, 0);
+}
+
 BOOST_AUTO_TEST_CASE(FirstSegmentNotZero)
 {
   DummyValidator acceptValidator;
@@ -624,6 +741,408 @@ BOOST_AUTO_TEST_CASE(MoreSegmentsThanNSegments)
   BOOST_CHECK_EQUAL(nAfterSegmentTimedOut, 0);
 }
 
+BOOST_AUTO_TEST_CASE(HugeSegmentNumber)
+{
+  const uint64_t huge = uint64_t(1) << 60;
+  DummyValidator acceptValidator;
+  shared_ptr<SegmentFetcher> fetcher = SegmentFetcher::start(face, Interest("/hello/world"),
+                                                             acceptValidator);
+  connectSignals(fetcher);
+  advanceClocks(10_ms);
+
+  // the discovery Interest is answered with a very large segment number
+  face.receive(*makeDataSegment("/hello/world/version0", huge, false));
+  advanceClocks(10_ms);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_GT(face.sentInterests.size(), 1);
+
+  face.receive(*makeDataSegment("/hello/world/version0", 0, false));
+  face.receive(*makeDataSegment("/hello/world/version0", 1, true));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(dataSize, 14 * 2);
+}
+
+BOOST_AUTO_TEST_CASE(HugeFinalBlockId)
+{
+  const uint64_t huge = uint64_t(1) << 60;
+  DummyValidator acceptValidator;
+  shared_ptr<SegmentFetcher> fetcher = SegmentFetcher::start(face, Interest("/hello/world"),
+                                                             acceptValidator);
+  connectSignals(fetcher);
+  advanceClocks(10_ms);
+
+  face.receive(*makeDataSegment("/hello/world/version0", huge, true));
+  advanceClocks(10_ms);
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+  BOOST_CHECK_GT(face.sentInterests.size(), 1);
+  BOOST_CHECK_EQUAL(face.sentInterests.back().getName().get(-1).isSegment(), true);
+}
+
+BOOST_AUTO_TEST_CASE(ReassembleOutOfOrder)
+{
+  DummyValidator acceptValidator;
+  shared_ptr<SegmentFetcher> fetcher = SegmentFetcher::start(face, Interest("/hello/world"),
+                                                             acceptValidator);
+  ConstBufferPtr result;
+  fetcher->onComplete.connect([&] (ConstBufferPtr buffer) { result = buffer; });
+  advanceClocks(10_ms);
+
+  face.receive(*makeSegmentWithContent(0, "AAAA", 3));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(2, "CCCC", 3));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(3, "DD", 3));
+  advanceClocks(10_ms);
+  // segments 2 and 3 are buffered until segment 1 arrives
+  BOOST_CHECK_EQUAL(fetcher->m_segmentBuffer.size(), 2);
+  BOOST_CHECK(result == nullptr);
+
+  face.receive(*makeSegmentWithContent(1, "BBBB", 3));
+  advanceClocks(10_ms);
+
+  BOOST_REQUIRE(result != nullptr);
+  std::string expected("AAAABBBBCCCCDD");
+  BOOST_CHECK_EQUAL_COLLECTIONS(result->begin(), result->end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(InOrderContent)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.inOrder = true;
+  nSegments = 40;
+  sendNackInsteadOfDropping = false;
+
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+  fetcher->onInOrderComplete.connect(bind(&Fixture::onInOrderComplete, this));
+
+  size_t nContents = 0;
+  fetcher->onInOrderContent.connect([&] (const Block& content) {
+    BOOST_CHECK_EQUAL(content.type(), tlv::Content);
+    ++nContents;
+    dataSize += content.value_size();
+  });
+
+  face.processEvents(1_s);
+
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(nContents, 40);
+  BOOST_CHECK_EQUAL(dataSize, 14 * 40);
+  BOOST_CHECK_EQUAL(nOnInOrderData, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Range)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.startSegment = 3;
+  options.endSegment = 7;
+  nSegments = 10;
+
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+  connectSignals(fetcher);
+
+  face.processEvents(1_s);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(dataSize, 14 * 4);
+  // segment 0 answers the discovery Interest and is not part of the result
+  std::set<uint64_t> expectedSegments{0, 3, 4, 5, 6};
+  BOOST_CHECK_EQUAL_COLLECTIONS(uniqSegmentsSent.begin(), uniqSegmentsSent.end(),
+                                expectedSegments.begin(), expectedSegments.end());
+}
+
+BOOST_AUTO_TEST_CASE(RangeBeyondEnd)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.startSegment = 3;
+  nSegments = 5;
+
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+  connectSignals(fetcher);
+
+  face.processEvents(1_s);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(dataSize, 14 * 2);
+}
+
+BOOST_AUTO_TEST_CASE(EmptyRange)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.startSegment = 8;
+  dataSize = 1;
+
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  connectSignals(fetcher);
+  advanceClocks(10_ms);
+
+  // the object ends before the range
+  face.receive(*makeDataSegment("/hello/world/version0", 4, true));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(dataSize, 0);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(ResumeInOrder)
+{
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  options.inOrder = true;
+  options.checkpointInterval = 2;
+  nSegments = 10;
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+
+  size_t nContents = 0;
+  optional<FetchCheckpoint> checkpoint;
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  connectSignals(fetcher);
+  fetcher->onInOrderContent.connect([&] (const Block&) { ++nContents; });
+  fetcher->onProgress.connect([&] (const FetchCheckpoint& cp) {
+    if (cp.getNSegmentsReceived() >= 4) {
+      checkpoint = cp;
+      fetcher->stop();
+    }
+  });
+  face.processEvents(1_s);
+
+  BOOST_REQUIRE(checkpoint);
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+  BOOST_CHECK_EQUAL(checkpoint->versionedName, "/hello/world/version0");
+  BOOST_REQUIRE_EQUAL(checkpoint->receivedRanges.size(), 1);
+  BOOST_CHECK_EQUAL(checkpoint->receivedRanges[0].first, 0);
+  // only the segments that have been handed to the application
+  BOOST_CHECK_EQUAL(checkpoint->receivedRanges[0].second, nContents);
+
+  size_t nContentsBefore = nContents;
+  face.sentInterests.clear();
+  options.checkpoint = checkpoint;
+  fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+  connectSignals(fetcher);
+  fetcher->onInOrderContent.connect([&] (const Block&) { ++nContents; });
+  face.processEvents(1_s);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(nContents, 10);
+  BOOST_CHECK_GE(face.sentInterests.size(), 10 - nContentsBefore);
+  for (const auto& interest : face.sentInterests) {
+    // no version discovery, and no segment is requested again
+    BOOST_CHECK_EQUAL(interest.getCanBePrefix(), false);
+    BOOST_CHECK_GE(interest.getName()[-1].toSegment(), nContentsBefore);
+  }
+  BOOST_CHECK_EQUAL(fetcher->getCheckpoint().getNSegmentsReceived(), 10);
+}
+
+class FileModeFixture : public Fixture
+{
+public:
+  FileModeFixture()
+    : filepath(boost::filesystem::path(UNIT_TEST_CONFIG_PATH) / "TestSegmentFetcher" / "output")
+  {
+    boost::filesystem::create_directories(filepath.parent_path());
+    options.outputFile = filepath.string();
+  }
+
+  ~FileModeFixture()
+  {
+    boost::system::error_code ec;
+    boost::filesystem::remove_all(filepath.parent_path(), ec); // ignore error
+  }
+
+  std::string
+  readFile() const
+  {
+    std::ifstream is(filepath.string(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+  }
+
+  shared_ptr<SegmentFetcher>
+  startFetcher()
+  {
+    auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options);
+    connectSignals(fetcher);
+    fetcher->onFileProgress.connect([this] (uint64_t n) { progress.push_back(n); });
+    fetcher->onFileComplete.connect([this] (uint64_t size) {
+      ++nCompletions;
+      fileSize = size;
+    });
+    return fetcher;
+  }
+
+  void
+  checkWriteOutOfOrder()
+  {
+    // segment 3 must be requested before it arrives
+    options.initCwnd = 4.0;
+    auto fetcher = startFetcher();
+    advanceClocks(10_ms);
+
+    // segment size is learned from segment 0, even though FinalBlockId is not known yet
+    face.receive(*makeSegmentWithContent(0, "AAAA"));
+    advanceClocks(10_ms);
+    face.receive(*makeSegmentWithContent(3, "DD", 3));
+    advanceClocks(10_ms);
+    face.receive(*makeSegmentWithContent(2, "CCCC", 3));
+    advanceClocks(10_ms);
+    BOOST_CHECK(fetcher->m_segmentBuffer.empty());
+    BOOST_CHECK_EQUAL(nCompletions, 0);
+
+    face.receive(*makeSegmentWithContent(1, "BBBB", 3));
+    advanceClocks(10_ms);
+
+    BOOST_CHECK_EQUAL(nErrors, 0);
+    BOOST_CHECK_EQUAL(nCompletions, 1);
+    BOOST_CHECK_EQUAL(fileSize, 14);
+    BOOST_CHECK_EQUAL(readFile(), "AAAABBBBCCCCDD");
+    BOOST_CHECK_EQUAL(dataSize, 0); // onComplete is not signaled
+    std::vector<uint64_t> expectedProgress{10};
+    BOOST_CHECK_EQUAL_COLLECTIONS(progress.begin(), progress.end(),
+                                  expectedProgress.begin(), expectedProgress.end());
+  }
+
+public:
+  const boost::filesystem::path filepath;
+  DummyValidator acceptValidator;
+  SegmentFetcher::Options options;
+  std::vector<uint64_t> progress;
+  uint64_t fileSize = 0;
+};
+
+BOOST_FIXTURE_TEST_SUITE(FileMode, FileModeFixture)
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  options.inOrder = true;
+  BOOST_CHECK_THROW(SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options),
+                    std::invalid_argument);
+
+  options.inOrder = false;
+  options.outputFile = (filepath.parent_path() / "nonexistent" / "output").string();
+  BOOST_CHECK_THROW(SegmentFetcher::start(face, Interest("/hello/world"), acceptValidator, options),
+                    std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(WriteOutOfOrder)
+{
+  options.progressInterval = 8;
+  checkWriteOutOfOrder();
+}
+
+BOOST_AUTO_TEST_CASE(WriteOutOfOrderMmap)
+{
+  options.useMmap = true;
+  options.progressInterval = 8;
+  checkWriteOutOfOrder();
+}
+
+BOOST_AUTO_TEST_CASE(LastSegmentFirst)
+{
+  auto fetcher = startFetcher();
+  advanceClocks(10_ms);
+
+  // the offset of the last segment is unknown until the segment size is learned
+  face.receive(*makeSegmentWithContent(2, "C", 2));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(1, "BBB", 2));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(0, "AAA", 2));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(readFile(), "AAABBBC");
+}
+
+BOOST_AUTO_TEST_CASE(SingleSegment)
+{
+  auto fetcher = startFetcher();
+  advanceClocks(10_ms);
+
+  face.receive(*makeSegmentWithContent(0, "hello", 0));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(fileSize, 5);
+  BOOST_CHECK_EQUAL(readFile(), "hello");
+}
+
+BOOST_AUTO_TEST_CASE(NonUniformSegments)
+{
+  auto fetcher = startFetcher();
+  advanceClocks(10_ms);
+
+  face.receive(*makeSegmentWithContent(0, "AAAA"));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(1, "BBBBBB", 2));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, static_cast<uint32_t>(SegmentFetcher::FILE_ERROR));
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Resume)
+{
+  options.initCwnd = 4.0;
+  options.checkpointInterval = 1;
+  optional<FetchCheckpoint> checkpoint;
+  auto fetcher = startFetcher();
+  fetcher->onProgress.connect([&] (const FetchCheckpoint& cp) {
+    checkpoint = cp;
+    if (cp.getNSegmentsReceived() == 2) {
+      fetcher->stop();
+    }
+  });
+  advanceClocks(10_ms);
+
+  face.receive(*makeSegmentWithContent(0, "AAAA"));
+  advanceClocks(10_ms);
+  face.receive(*makeSegmentWithContent(1, "BBBB"));
+  advanceClocks(10_ms);
+
+  BOOST_REQUIRE(checkpoint);
+  BOOST_CHECK_EQUAL(checkpoint->segmentSize, 4);
+  BOOST_CHECK_EQUAL(checkpoint->getNSegmentsReceived(), 2);
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+
+  face.sentInterests.clear();
+  options.checkpoint = FetchCheckpoint(checkpoint->wireEncode());
+  fetcher = startFetcher();
+  advanceClocks(10_ms);
+  BOOST_REQUIRE(!face.sentInterests.empty());
+  BOOST_CHECK_EQUAL(face.sentInterests[0].getName(), Name("/hello/world/version0").appendSegment(2));
+
+  face.receive(*makeSegmentWithContent(3, "DD", 3));
+  advanceClocks(10_ms);
+  // segment 3 is written, but segment 2 is still missing
+  BOOST_CHECK_EQUAL(fetcher->getCheckpoint().receivedRanges.size(), 2);
+  face.receive(*makeSegmentWithContent(2, "CCCC", 3));
+  advanceClocks(10_ms);
+
+  BOOST_CHECK_EQUAL(nErrors, 0);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+  BOOST_CHECK_EQUAL(fileSize, 14);
+  BOOST_CHECK_EQUAL(readFile(), "AAAABBBBCCCCDD");
+}
+
+BOOST_AUTO_TEST_SUITE_END() // FileMode
+
 BOOST_AUTO_TEST_CASE(DuplicateNack)
 {
   DummyValidator acceptValidator;
@@ -649,6 +1168,42 @@ BOOST_AUTO_TEST_CASE(DuplicateNack)
   BOOST_CHECK_EQUAL(nAfterSegmentTimedOut, 0);
 }
 
+BOOST_AUTO_TEST_CASE(Trace)
+{
+  DummyValidator acceptValidator;
+  nSegments = 401;
+  segmentsToDropOrNack.push(200);
+  sendNackInsteadOfDropping = true;
+  nackReason = lp::NackReason::DUPLICATE;
+
+  SegmentFetcher::Options options;
+  options.trace = make_shared<FetchTrace>(100);
+  shared_ptr<SegmentFetcher> fetcher = SegmentFetcher::start(face, Interest("/hello/world"),
+                                                             acceptValidator, options);
+  face.onSendInterest.connect(bind(&Fixture::onInterest, this, _1));
+  connectSignals(fetcher);
+
+  face.processEvents(1_s);
+  BOOST_CHECK_EQUAL(nCompletions, 1);
+
+  auto stats = options.trace->getStatistics();
+  BOOST_CHECK_EQUAL(stats.nSegments, 401);
+  BOOST_CHECK_EQUAL(stats.nBytes, 14 * 401);
+  BOOST_CHECK_EQUAL(stats.nNacks, 1);
+  BOOST_CHECK_EQUAL(stats.nRetransmissions, 1);
+  // Interests beyond the last segment may be sent before the FinalBlockId is known
+  BOOST_CHECK_GE(stats.nInterests, 402);
+  BOOST_CHECK_EQUAL(stats.nTimeouts, 0);
+  BOOST_CHECK_GT(stats.nRttSamples, 0);
+
+  BOOST_CHECK_EQUAL(options.trace->getEvents().size(), 100);
+  BOOST_CHECK_GT(options.trace->getNRecorded(), 401 * 4);
+  auto events = options.trace->getEvents();
+  BOOST_CHECK(std::any_of(events.begin(), events.end(),
+                          [] (const auto& e) { return e.type == FetchTrace::EventType::CWND; }));
+  BOOST_CHECK_EQUAL(events.back().time, stats.duration);
+}
+
 BOOST_AUTO_TEST_CASE(CongestionNack)
 {
   DummyValidator acceptValidator;
@@ -730,6 +1285,35 @@ BOOST_AUTO_TEST_CASE(ValidationFailure)
   BOOST_CHECK_EQUAL(nErrors, 1);
 }
 
+BOOST_AUTO_TEST_CASE(ValidationPipelineFailure)
+{
+  DummyValidator validator;
+  validator.getPolicy().setResultCallback([] (const Name& name) {
+    return name.at(-1).toSegment() != 1;
+  });
+  SegmentFetcher::Options options;
+  options.nValidationThreads = 1;
+  options.initCwnd = 4.0;
+  auto fetcher = SegmentFetcher::start(face, Interest("/hello/world"), validator, options);
+  connectSignals(fetcher);
+
+  advanceClocks(1_ms);
+  face.receive(*makeDataSegment("/hello/world/version0", 0, false));
+  advanceClocks(1_ms);
+  // the window advanced when segment 0 arrived
+  BOOST_CHECK_GT(fetcher->m_cwnd, 4.0);
+  BOOST_CHECK_GT(face.sentInterests.size(), 2);
+
+  face.receive(*makeDataSegment("/hello/world/version0", 1, false));
+  advanceClocks(1_ms);
+
+  BOOST_CHECK_EQUAL(nAfterSegmentReceived, 2);
+  BOOST_CHECK_EQUAL(nAfterSegmentValidated, 1);
+  BOOST_CHECK_EQUAL(nErrors, 1);
+  BOOST_CHECK_EQUAL(lastError, SegmentFetcher::SEGMENT_VALIDATION_FAIL);
+  BOOST_CHECK_EQUAL(nCompletions, 0);
+}
+
 BOOST_AUTO_TEST_CASE(Stop)
 {
   DummyValidator acceptValidator;
@@ -0,0 +1,346 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2013-2020 Regents of the University of California.
+ *
+ * This file is part of ndn-cxx library (NDN C++ library with eXperimental eXtensions).
+ *
+ * ndn-cxx library is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-cxx library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ * PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+ *
+ * You should have received copies of the GNU General Public License and GNU Lesser
+ * General Public License along with ndn-cxx, e.g., in COPYING.md file.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * See AUTHORS.md for complete list of ndn-cxx authors and contributors.
+ */
+
+#include "ndn-cxx/util/segment-publisher.hpp"
+
+#include "ndn-cxx/ims/in-memory-storage-fifo.hpp"
+#include "ndn-cxx/security/certificate-fetcher-offline.hpp"
+#include "ndn-cxx/security/signing-helpers.hpp"
+#include "ndn-cxx/security/validation-policy-simple-hierarchy.hpp"
+#include "ndn-cxx/security/verification-helpers.hpp"
+#include "ndn-cxx/util/dummy-client-face.hpp"
+#include "ndn-cxx/util/hc-segment-fetcher.hpp"
+#include "ndn-cxx/util/segment-fetcher.hpp"
+
+#include "tests/boost-test.hpp"
+#include "tests/unit/dummy-validator.hpp"
+#include "tests/unit/identity-management-time-fixture.hpp"
+
+#include <boost/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+
+namespace ndn {
+namespace util {
+namespace tests {
+
+using namespace ndn::tests;
+
+class SegmentPublisherFixture : public IdentityManagementTimeFixture
+{
+public:
+  SegmentPublisherFixture()
+    : face(io, m_keyChain, {true, true})
+    , identity(addIdentity("/publisher"))
+    , content(make_shared<Buffer>(20000))
+  {
+    for (size_t i = 0; i < content->size(); ++i) {
+      (*content)[i] = static_cast<uint8_t>(i * 7);
+    }
+    options.version = 1;
+    options.maxSegmentSize = 1000;
+  }
+
+  /**
+   * @brief Send an Interest for @p name to the publisher and return the reply, if any.
+   */
+  optional<Data>
+  request(const Name& name, bool canBePrefix = false)
+  {
+    advanceClocks(1_ms); // let the publisher complete the prefix registration
+    face.sentData.clear();
+    face.receive(Interest(name).setCanBePrefix(canBePrefix));
+    advanceClocks(1_ms);
+    if (face.sentData.empty()) {
+      return nullopt;
+    }
+    return face.sentData.back();
+  }
+
+  Name
+  segmentName(uint64_t segNum) const
+  {
+    return Name("/publisher/obj").appendVersion(1).appendSegment(segNum);
+  }
+
+  bool
+  isSignedByIdentity(const Data& data) const
+  {
+    return security::verifySignature(data, identity.getDefaultKey().getDefaultCertificate());
+  }
+
+public:
+  DummyClientFace face;
+  security::Identity identity;
+  shared_ptr<Buffer> content;
+  SegmentPublisher::Options options;
+};
+
+BOOST_AUTO_TEST_SUITE(Util)
+BOOST_FIXTURE_TEST_SUITE(TestSegmentPublisher, SegmentPublisherFixture)
+
+BOOST_AUTO_TEST_CASE(InvalidOptions)
+{
+  options.maxSegmentSize = 0;
+  BOOST_CHECK_THROW(SegmentPublisher(face, m_keyChain, "/publisher/obj", content,
+                                     signingByIdentity(identity), options),
+                    std::invalid_argument);
+
+  options.maxSegmentSize = 1000;
+  options.hashChain = true;
+  options.window = 4;
+  BOOST_CHECK_THROW(SegmentPublisher(face, m_keyChain, "/publisher/obj", content,
+                                     signingByIdentity(identity), options),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(FromBuffer)
+{
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+  advanceClocks(1_ms);
+  BOOST_CHECK_EQUAL(publisher.getVersionedName(), Name("/publisher/obj").appendVersion(1));
+  BOOST_REQUIRE(publisher.getNSegments());
+  BOOST_CHECK_EQUAL(*publisher.getNSegments(), 20);
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 20);
+  BOOST_CHECK_EQUAL(publisher.getLead(), 20);
+
+  // version discovery
+  auto first = request("/publisher/obj", true);
+  BOOST_REQUIRE(first);
+  BOOST_CHECK_EQUAL(first->getName(), segmentName(0));
+  BOOST_REQUIRE(first->getFinalBlock());
+  BOOST_CHECK_EQUAL(first->getFinalBlock()->toSegment(), 19);
+
+  std::vector<uint8_t> received;
+  for (uint64_t i = 0; i < 20; ++i) {
+    auto data = request(segmentName(i));
+    BOOST_REQUIRE(data);
+    BOOST_CHECK(isSignedByIdentity(*data));
+    received.insert(received.end(), data->getContent().value_begin(), data->getContent().value_end());
+  }
+  BOOST_CHECK_EQUAL_COLLECTIONS(received.begin(), received.end(), content->begin(), content->end());
+  BOOST_CHECK_EQUAL(*publisher.getHighestRequested(), 19);
+  BOOST_CHECK_EQUAL(publisher.getLead(), 0);
+
+  BOOST_CHECK(!request(segmentName(20)));
+  BOOST_CHECK(!request("/publisher/other", true));
+}
+
+BOOST_AUTO_TEST_CASE(ParallelSigning)
+{
+  options.nSigningThreads = 4;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+  for (uint64_t i = 0; i < 20; ++i) {
+    auto data = request(segmentName(i));
+    BOOST_REQUIRE(data);
+    BOOST_CHECK(isSignedByIdentity(*data));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(HashChain)
+{
+  options.hashChain = true;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+
+  std::vector<Data> segments;
+  for (uint64_t i = 0; i < 20; ++i) {
+    auto data = request(segmentName(i));
+    BOOST_REQUIRE(data);
+    segments.push_back(*data);
+  }
+
+  BOOST_CHECK(isSignedByIdentity(segments[0]));
+  for (uint64_t i = 1; i < 20; ++i) {
+    BOOST_CHECK(isSignedByIdentity(segments[i]));
+
+    const auto& appMetaInfo = segments[i - 1].getMetaInfo().getAppMetaInfo();
+    BOOST_REQUIRE_EQUAL(appMetaInfo.size(), 1);
+    BOOST_CHECK_EQUAL(appMetaInfo.front().type(), SegmentPublisher::NEXT_SIGNATURE_TYPE);
+    const Block& signature = segments[i].getSignatureValue();
+    BOOST_CHECK_EQUAL_COLLECTIONS(appMetaInfo.front().value_begin(), appMetaInfo.front().value_end(),
+                                  signature.value_begin(), signature.value_end());
+  }
+
+  const auto& lastAppMetaInfo = segments.back().getMetaInfo().getAppMetaInfo();
+  BOOST_REQUIRE_EQUAL(lastAppMetaInfo.size(), 1);
+  BOOST_CHECK_EQUAL(lastAppMetaInfo.front().type(), SegmentPublisher::NEXT_SIGNATURE_TYPE);
+  BOOST_CHECK_EQUAL(lastAppMetaInfo.front().value_size(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(FetchHashChain)
+{
+  DummyClientFace consumerFace(io, m_keyChain);
+  consumerFace.linkTo(face);
+
+  options.hashChain = true;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+  advanceClocks(1_ms);
+
+  // every segment must be signed by a key trusted under /publisher
+  security::v2::Validator validator(make_unique<security::v2::ValidationPolicySimpleHierarchy>(),
+                                    make_unique<security::v2::CertificateFetcherOffline>());
+  validator.loadAnchor("publisher", security::v2::Certificate(identity.getDefaultKey().getDefaultCertificate()));
+
+  auto fetcher = HCSegmentFetcher::start(consumerFace, Interest("/publisher/obj"), validator,
+                                         SegmentFetcher::Options());
+  ConstBufferPtr result;
+  size_t nValidated = 0;
+  std::vector<std::string> errors;
+  fetcher->onComplete.connect([&] (ConstBufferPtr buffer) { result = buffer; });
+  fetcher->afterSegmentValidated.connect([&] (const Data&) { ++nValidated; });
+  fetcher->onError.connect([&] (uint32_t, const std::string& msg) { errors.push_back(msg); });
+  advanceClocks(1_ms, 1000);
+
+  BOOST_CHECK(errors.empty());
+  BOOST_CHECK_EQUAL(nValidated, 20);
+  BOOST_REQUIRE(result != nullptr);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result->begin(), result->end(), content->begin(), content->end());
+}
+
+BOOST_AUTO_TEST_CASE(OnDemand)
+{
+  options.window = 4;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 4);
+  BOOST_CHECK(!publisher.getHighestRequested());
+
+  BOOST_CHECK(request("/publisher/obj", true));
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 5);
+  BOOST_CHECK_EQUAL(publisher.getLead(), 4);
+
+  auto data = request(segmentName(10));
+  BOOST_REQUIRE(data);
+  BOOST_CHECK_EQUAL(data->getName(), segmentName(10));
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 15);
+  BOOST_CHECK_EQUAL(*publisher.getHighestRequested(), 10);
+  BOOST_CHECK_EQUAL(publisher.getLead(), 4);
+
+  BOOST_CHECK(request(segmentName(18)));
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 20);
+  BOOST_CHECK_EQUAL(publisher.getLead(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(Stream)
+{
+  std::string text(3500, 'a');
+  std::istringstream is(text);
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", is,
+                             signingByIdentity(identity), options);
+  BOOST_REQUIRE(publisher.getNSegments());
+  BOOST_CHECK_EQUAL(*publisher.getNSegments(), 4);
+
+  for (uint64_t i = 0; i < 4; ++i) {
+    auto data = request(segmentName(i));
+    BOOST_REQUIRE(data);
+    BOOST_REQUIRE(data->getFinalBlock());
+    BOOST_CHECK_EQUAL(data->getFinalBlock()->toSegment(), 3);
+    BOOST_CHECK_EQUAL(data->getContent().value_size(), i < 3 ? 1000 : 500);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(StreamOnDemand)
+{
+  std::string text(3000, 'a');
+  std::istringstream is(text);
+  options.window = 1;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", is,
+                             signingByIdentity(identity), options);
+  BOOST_CHECK(!publisher.getNSegments());
+
+  BOOST_CHECK(request(segmentName(0)));
+  BOOST_CHECK(request(segmentName(1)));
+  BOOST_REQUIRE(publisher.getNSegments());
+  BOOST_CHECK_EQUAL(*publisher.getNSegments(), 3);
+
+  auto last = request(segmentName(2));
+  BOOST_REQUIRE(last);
+  BOOST_REQUIRE(last->getFinalBlock());
+  BOOST_CHECK_EQUAL(last->getFinalBlock()->toSegment(), 2);
+}
+
+BOOST_AUTO_TEST_CASE(FileWithEviction)
+{
+  auto filename = boost::filesystem::unique_path(boost::filesystem::temp_directory_path() /
+                                                 "segment-publisher-%%%%-%%%%").string();
+  {
+    std::ofstream file(filename, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(content->data()), content->size());
+  }
+
+  InMemoryStorageFifo storage(3);
+  options.storage = &storage;
+  options.window = 1;
+  auto publisher = SegmentPublisher::fromFile(face, m_keyChain, "/publisher/obj", filename,
+                                              signingByIdentity(identity), options);
+  BOOST_CHECK_EQUAL(*publisher->getNSegments(), 20);
+
+  for (uint64_t i = 0; i < 10; ++i) {
+    BOOST_CHECK(request(segmentName(i)));
+  }
+  BOOST_CHECK_LE(storage.size(), 3);
+
+  // segment 0 has been evicted and is read again from the file
+  auto data = request(segmentName(0));
+  BOOST_REQUIRE(data);
+  BOOST_CHECK(isSignedByIdentity(*data));
+  BOOST_CHECK_EQUAL_COLLECTIONS(data->getContent().value_begin(), data->getContent().value_end(),
+                                content->begin(), content->begin() + 1000);
+
+  BOOST_CHECK_THROW(SegmentPublisher::fromFile(face, m_keyChain, "/publisher/obj",
+                                               filename + ".nonexistent"),
+                    std::runtime_error);
+  boost::filesystem::remove(filename);
+}
+
+BOOST_AUTO_TEST_CASE(WithSegmentFetcher)
+{
+  DummyClientFace consumerFace(io, m_keyChain);
+  consumerFace.linkTo(face);
+
+  options.window = 8;
+  options.nSigningThreads = 2;
+  SegmentPublisher publisher(face, m_keyChain, "/publisher/obj", content,
+                             signingByIdentity(identity), options);
+  advanceClocks(1_ms);
+
+  DummyValidator validator;
+  auto fetcher = SegmentFetcher::start(consumerFace, Interest("/publisher/obj"), validator);
+  ConstBufferPtr result;
+  fetcher->onComplete.connect([&] (ConstBufferPtr buffer) { result = buffer; });
+  advanceClocks(1_ms, 1000);
+
+  BOOST_REQUIRE(result != nullptr);
+  BOOST_CHECK_EQUAL_COLLECTIONS(result->begin(), result->end(), content->begin(), content->end());
+  BOOST_CHECK_EQUAL(publisher.getNSegmentsProduced(), 20);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestSegmentPublisher
+BOOST_AUTO_TEST_SUITE_END() // Util
+
+} // namespace tests
+} // namespace util
+} // namespace ndn